@@ -21,4 +21,28 @@ void fuego_free_engine(void* cookie);
 
 struct fuego_result_descriptor fuego_process_command(void* cookie, const char* cmd, uint64_t cmdlen);
 
+struct fuego_command;
+
+struct fuego_result_descriptor fuego_submit_command(void* cookie, const char* cmd, uint64_t cmdlen, struct fuego_command** command);
+int fuego_command_finished(struct fuego_command* command);
+int fuego_wait_command(struct fuego_command* command, int timeout_ms);
+struct fuego_result_descriptor fuego_read_command_progress(struct fuego_command* command);
+void fuego_cancel_command(struct fuego_command* command);
+struct fuego_result_descriptor fuego_command_result(struct fuego_command* command);
+void fuego_free_command(struct fuego_command* command);
+
+struct fuego_result_descriptor fuego_create_engine_pool(
+    const char* program_path,
+    const char* config_path,
+    int srand,
+    int fixed_board_size,
+    int max_games,
+    int use_book,
+    int allow_handicap,
+    int pool_size,
+    uint64_t tree_nodes);
+void fuego_free_engine_pool(void* pool);
+struct fuego_result_descriptor fuego_acquire_engine(void* pool);
+void fuego_release_engine(void* pool, void* cookie);
+
 #endif
@@ -0,0 +1,231 @@
+//----------------------------------------------------------------------------
+/** @file FuegoBenchMain.cpp
+    Main function for FuegoBench, a benchmark of the playouts of Fuego.
+
+    Runs playouts with GoUctPlayoutPolicy<GoUctBoard> from a set of
+    positions (see GoUctCheckPerformance::RunPlayouts()) and writes the
+    playouts and moves per second for each position, each board size and
+    in total. The positions are read from SGF files given as arguments; if
+    there are none, the empty boards of the sizes given with @c --size are
+    used. */
+//----------------------------------------------------------------------------
+
+#include "SgSystem.h"
+
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <boost/format.hpp>
+#include "FuegoBenchUtil.h"
+#include "GoGame.h"
+#include "GoNodeUtil.h"
+#include "GoUctCheckPerformance.h"
+#include "SgDebug.h"
+#include "SgException.h"
+#include "SgGameReader.h"
+#include "SgRandom.h"
+
+using std::string;
+using std::vector;
+using GoUctCheckPerformance::PlayoutResult;
+namespace po = boost::program_options;
+
+//----------------------------------------------------------------------------
+
+namespace {
+
+/** @name Settings from command line options */
+// @{
+
+bool g_writeStatistics = false;
+
+int g_moveNumber;
+
+int g_nuPlayouts;
+
+int g_nuThreads;
+
+float g_komi;
+
+string g_sizes;
+
+vector<string> g_inputFiles;
+
+GoUctPlayoutPolicyParam g_policyParam;
+
+// @} // @name
+
+/** A position to run the playouts from. */
+struct Position
+{
+    string m_name;
+
+    GoGame m_game;
+};
+
+vector<int> ParseSizes(const string& sizes)
+{
+    vector<int> result;
+    std::istringstream in(sizes);
+    string token;
+    while (std::getline(in, token, ','))
+    {
+        int size;
+        std::istringstream tokenIn(token);
+        if (! (tokenIn >> size) || size < SG_MIN_SIZE || size > SG_MAX_SIZE)
+            throw SgException(boost::format("Invalid board size '%1%'")
+                              % token);
+        result.push_back(size);
+    }
+    return result;
+}
+
+void ParseOptions(int argc, char** argv)
+{
+    int srand;
+    po::options_description normalOptions("Options");
+    normalOptions.add_options()
+        ("fillboard",
+         po::value<int>(&g_policyParam.m_fillboardTries)->default_value(
+                                         g_policyParam.m_fillboardTries),
+         "fillboard tries of the playout policy")
+        ("gamma-threshold",
+         po::value<float>(&g_policyParam.m_patternGammaThreshold)->
+                    default_value(g_policyParam.m_patternGammaThreshold),
+         "lower gamma threshold of the playout patterns")
+        ("incremental-pattern-codes",
+         po::value<bool>(&g_policyParam.m_incrementalPatternCodes)->
+                    default_value(g_policyParam.m_incrementalPatternCodes),
+         "maintain the pattern codes incrementally in the playout board")
+        ("komi",
+         po::value<float>(&g_komi)->default_value(7.5),
+         "komi for empty boards")
+        ("move",
+         po::value<int>(&g_moveNumber)->default_value(-1),
+         "use the position before this move number of the sgf files "
+         "(-1: end of the main variation)")
+        ("nakade",
+         po::value<bool>(&g_policyParam.m_useNakadeHeuristic)->default_value(
+                                         g_policyParam.m_useNakadeHeuristic),
+         "use the nakade heuristic")
+        ("patterns",
+         po::value<bool>(&g_policyParam.m_usePatternsInPlayout)->
+                    default_value(g_policyParam.m_usePatternsInPlayout),
+         "use pattern gammas in the playouts")
+        ("playouts",
+         po::value<int>(&g_nuPlayouts)->default_value(10000),
+         "number of playouts per position")
+        ("size",
+         po::value<string>(&g_sizes)->default_value("9,13,19"),
+         "comma-separated board sizes of the empty boards")
+        ("srand",
+         po::value<int>(&srand)->default_value(0),
+         "set random seed (-1:none, 0:time(0))")
+        ("statistics", "collect and write the playout policy statistics")
+        ("threads",
+         po::value<int>(&g_nuThreads)->default_value(1),
+         "number of threads");
+    po::variables_map vm =
+        FuegoBenchUtil::ParseOptions(argc, argv,
+                                     "fuego_bench [options] [sgf files]",
+                                     normalOptions, &g_inputFiles);
+    if (vm.count("statistics"))
+        g_writeStatistics = true;
+    g_policyParam.m_statisticsEnabled = g_writeStatistics;
+    if (g_nuPlayouts < 1)
+        throw SgException("Number of playouts must be positive");
+    if (g_nuThreads < 1)
+        throw SgException("Number of threads must be positive");
+    SgRandom::SetSeed(srand);
+}
+
+void LoadSgf(const string& fileName, Position& position)
+{
+    std::ifstream in(fileName.c_str());
+    if (! in)
+        throw SgException(boost::format("Could not open file '%1%'")
+                          % fileName);
+    SgGameReader reader(in);
+    SgNode* root = reader.ReadGame();
+    if (root == 0)
+        throw SgException(boost::format("No games in file '%1%'")
+                          % fileName);
+    if (reader.GetWarnings().any())
+    {
+        SgWarning() << fileName << ":\n";
+        reader.PrintWarnings(SgDebug());
+    }
+    position.m_game.Init(root);
+    if (! GoGameUtil::GotoBeforeMove(&position.m_game, g_moveNumber))
+        throw SgException(boost::format("Invalid move number in '%1%'")
+                          % fileName);
+    GoRules rules;
+    rules.SetKomi(GoNodeUtil::GetKomi(position.m_game.CurrentNode()));
+    rules.SetHandicap(GoNodeUtil::GetHandicap(position.m_game.CurrentNode()));
+    position.m_game.SetRulesGlobal(rules);
+    position.m_name = fileName;
+}
+
+void WriteResult(const string& label, const PlayoutResult& result)
+{
+    std::cout << "==== " << label << " ====\n";
+    result.Write(std::cout, g_writeStatistics);
+    std::cout << '\n';
+}
+
+void MainLoop()
+{
+    vector<std::unique_ptr<Position> > positions;
+    if (g_inputFiles.empty())
+    {
+        vector<int> sizes = ParseSizes(g_sizes);
+        for (size_t i = 0; i < sizes.size(); ++i)
+        {
+            std::unique_ptr<Position> position(new Position);
+            position->m_game.Init(sizes[i], GoRules(0, GoKomi(g_komi)));
+            position->m_name = str(boost::format("empty %1%x%1%")
+                                   % sizes[i]);
+            positions.push_back(std::move(position));
+        }
+    }
+    else
+        for (size_t i = 0; i < g_inputFiles.size(); ++i)
+        {
+            std::unique_ptr<Position> position(new Position);
+            LoadSgf(g_inputFiles[i], *position);
+            positions.push_back(std::move(position));
+        }
+    std::cout << "Threads: " << g_nuThreads << '\n'
+              << "Playouts per position: " << g_nuPlayouts << "\n\n";
+    std::map<int, PlayoutResult> sizeResults;
+    PlayoutResult total;
+    for (size_t i = 0; i < positions.size(); ++i)
+    {
+        const GoBoard& bd = positions[i]->m_game.Board();
+        PlayoutResult result =
+            GoUctCheckPerformance::RunPlayouts(bd, g_policyParam,
+                                               g_nuPlayouts, g_nuThreads);
+        WriteResult(positions[i]->m_name, result);
+        sizeResults[bd.Size()].Merge(result);
+        total.Merge(result);
+    }
+    if (! g_inputFiles.empty())
+        for (std::map<int, PlayoutResult>::const_iterator it =
+                 sizeResults.begin(); it != sizeResults.end(); ++it)
+            WriteResult(str(boost::format("total %1%x%1%") % it->first),
+                        it->second);
+    WriteResult("total", total);
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+    return FuegoBenchUtil::Main(argc, argv, ParseOptions, MainLoop);
+}
+
+//----------------------------------------------------------------------------
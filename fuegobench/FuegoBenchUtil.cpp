@@ -0,0 +1,107 @@
+//----------------------------------------------------------------------------
+/** @file FuegoBenchUtil.cpp
+    See FuegoBenchUtil.h */
+//----------------------------------------------------------------------------
+
+#include "SgSystem.h"
+#include "FuegoBenchUtil.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <boost/program_options/cmdline.hpp>
+#include <boost/program_options/parsers.hpp>
+#include "GoInit.h"
+#include "SgDebug.h"
+#include "SgException.h"
+#include "SgInit.h"
+
+using std::string;
+using std::vector;
+namespace po = boost::program_options;
+
+//----------------------------------------------------------------------------
+
+namespace {
+
+/** Option @c --quiet was given. */
+bool g_quiet = false;
+
+void Help(const string& usage, const po::options_description& desc,
+          std::ostream& out)
+{
+    out << "Usage: " << usage << '\n' << desc << "\n";
+    exit(0);
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------
+
+int FuegoBenchUtil::Main(int argc, char** argv,
+                         const std::function<void(int, char**)>& parseOptions,
+                         const std::function<void()>& mainLoop)
+{
+    try
+    {
+        parseOptions(argc, argv);
+    }
+    catch (const SgException& e)
+    {
+        SgDebug() << e.what() << "\n";
+        return 1;
+    }
+    if (g_quiet)
+        SgDebugToNull();
+    try
+    {
+        SgInit();
+        GoInit();
+        mainLoop();
+        GoFini();
+        SgFini();
+    }
+    catch (const std::exception& e)
+    {
+        SgDebug() << e.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
+
+po::variables_map
+FuegoBenchUtil::ParseOptions(int argc, char** argv, const string& usage,
+                             po::options_description& options,
+                             vector<string>* inputFiles)
+{
+    options.add_options()
+        ("help", "displays this help and exit")
+        ("quiet", "don't print debug messages");
+    po::options_description hiddenOptions;
+    if (inputFiles != 0)
+        hiddenOptions.add_options()
+            ("input-file", po::value<vector<string> >(inputFiles),
+             "input file");
+    po::options_description allOptions;
+    allOptions.add(options).add(hiddenOptions);
+    po::positional_options_description positionalOptions;
+    if (inputFiles != 0)
+        positionalOptions.add("input-file", -1);
+    po::variables_map vm;
+    try
+    {
+        po::store(po::command_line_parser(argc, argv).options(allOptions).
+                                     positional(positionalOptions).run(), vm);
+        po::notify(vm);
+    }
+    catch (...)
+    {
+        Help(usage, options, std::cerr);
+    }
+    if (vm.count("help"))
+        Help(usage, options, std::cout);
+    if (vm.count("quiet"))
+        g_quiet = true;
+    return vm;
+}
+
+//----------------------------------------------------------------------------
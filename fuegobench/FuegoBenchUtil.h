@@ -0,0 +1,47 @@
+//----------------------------------------------------------------------------
+/** @file FuegoBenchUtil.h
+    Command line handling and main function shared by the benchmarks. */
+//----------------------------------------------------------------------------
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/variables_map.hpp>
+
+//----------------------------------------------------------------------------
+
+namespace FuegoBenchUtil
+{
+
+    /** Main function of a benchmark.
+        Calls parseOptions, then SgInit(), GoInit(), mainLoop, GoFini() and
+        SgFini(). Writes the message of an SgException thrown by
+        parseOptions or of an exception thrown by the benchmark to
+        SgDebug().
+        @return The exit code of the program */
+    int Main(int argc, char** argv,
+             const std::function<void(int, char**)>& parseOptions,
+             const std::function<void()>& mainLoop);
+
+    /** Parse the command line options of a benchmark.
+        Adds the options @c --help and @c --quiet to options. Writes the
+        usage and exits on @c --help or an invalid command line. Main()
+        disables the debug output after parsing with @c --quiet.
+        @param argc
+        @param argv
+        @param usage The usage line without options, e.g.
+        "fuego_bench [options] [sgf files]"
+        @param options The options of the benchmark
+        @param inputFiles Receives the positional arguments; null if the
+        benchmark does not take any
+        @return The parsed options */
+    boost::program_options::variables_map
+    ParseOptions(int argc, char** argv, const std::string& usage,
+                 boost::program_options::options_description& options,
+                 std::vector<std::string>* inputFiles = 0);
+}
+
+//----------------------------------------------------------------------------
@@ -0,0 +1,157 @@
+//----------------------------------------------------------------------------
+/** @file HashTableBenchMain.cpp
+    Main function for a benchmark of the hash tables of the searches.
+
+    Runs a mix of stores and lookups of SgSearchHashData in an SgHashTable
+    with one thread and in an SgConcurrentHashTable with an increasing
+    number of threads and writes the operations per second and the speedup
+    over SgHashTable. */
+//----------------------------------------------------------------------------
+
+#include "SgSystem.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <boost/format.hpp>
+#include "FuegoBenchUtil.h"
+#include "SgConcurrentHashTable.h"
+#include "SgDebug.h"
+#include "SgException.h"
+#include "SgSearch.h"
+#include "SgThreadPool.h"
+#include "SgTimer.h"
+#include "SgWrite.h"
+
+using std::uint32_t;
+namespace po = boost::program_options;
+
+//----------------------------------------------------------------------------
+
+namespace {
+
+/** @name Settings from command line options */
+// @{
+
+int g_maxHash;
+
+int g_nuOperations;
+
+int g_lookupPercent;
+
+int g_nuThreads;
+
+// @} // @name
+
+void ParseOptions(int argc, char** argv)
+{
+    po::options_description normalOptions("Options");
+    normalOptions.add_options()
+        ("lookups",
+         po::value<int>(&g_lookupPercent)->default_value(80),
+         "percentage of lookups among the operations")
+        ("operations",
+         po::value<int>(&g_nuOperations)->default_value(4000000),
+         "number of operations of each thread")
+        ("size",
+         po::value<int>(&g_maxHash)->default_value(1 << 20),
+         "number of entries of the hash tables")
+        ("threads",
+         po::value<int>(&g_nuThreads)->default_value(
+                         static_cast<int>(
+                                 std::max(std::thread::hardware_concurrency(),
+                                          1u))),
+         "maximum number of threads");
+    FuegoBenchUtil::ParseOptions(argc, argv,
+                                 "fuego_hashtable_bench [options]",
+                                 normalOptions);
+    if (g_maxHash < 1 || g_nuOperations < 1 || g_nuThreads < 1)
+        throw SgException("Size, operations and threads must be positive");
+    if (g_lookupPercent < 0 || g_lookupPercent > 100)
+        throw SgException("Lookups must be a percentage");
+}
+
+/** Run the operations of one thread on a table.
+    The codes are drawn from twice as many positions as the table has
+    entries, so the table fills up and entries get replaced.
+    @return The number of successful lookups (to keep the compiler from
+    removing the lookups). */
+template<class TABLE>
+size_t RunOperations(TABLE& table, size_t threadIndex)
+{
+    size_t nuFound = 0;
+    uint32_t random = 12345u + 1000003u * static_cast<uint32_t>(threadIndex);
+    const uint32_t nuCodes = 2 * static_cast<uint32_t>(g_maxHash);
+    for (int i = 0; i < g_nuOperations; ++i)
+    {
+        random = random * 1664525u + 1013904223u;
+        const SgHashCode code((random >> 4) % nuCodes);
+        if (static_cast<int>((random >> 24) % 100) < g_lookupPercent)
+        {
+            SgSearchHashData data;
+            if (table.Lookup(code, &data))
+                ++nuFound;
+        }
+        else
+            table.Store(code, SgSearchHashData((random >> 8) % 32,
+                                               (random >> 16) % 1000, 0));
+    }
+    return nuFound;
+}
+
+void WriteResult(const std::string& label, double nuOperations, double time,
+                 double baseRate, size_t nuFound)
+{
+    const double rate = (time > 0 ? nuOperations / time : 0);
+    std::cout << SgWriteLabel(label) << boost::format("%.0f ops/s") % rate
+              << boost::format(", found %.1f%%")
+                 % (100.0 * double(nuFound) / nuOperations);
+    if (baseRate > 0)
+        std::cout << boost::format(" (%.2fx)") % (rate / baseRate);
+    std::cout << '\n';
+}
+
+void MainLoop()
+{
+    double baseRate;
+    {
+        SgHashTable<SgSearchHashData, 4> table(g_maxHash);
+        SgTimer timer;
+        const size_t nuFound = RunOperations(table, 0);
+        const double time = timer.GetTime();
+        baseRate = (time > 0 ? g_nuOperations / time : 0);
+        WriteResult("SgHashTable", g_nuOperations, time, 0, nuFound);
+    }
+    SgThreadPool pool;
+    for (int nuThreads = 1; ; nuThreads *= 2)
+    {
+        if (nuThreads > g_nuThreads)
+            nuThreads = g_nuThreads;
+        SgConcurrentHashTable<SgSearchHashData, 4> table(g_maxHash);
+        pool.SetNumberThreads(nuThreads);
+        std::atomic<size_t> nuFound(0);
+        SgTimer timer;
+        pool.RunOnAll([&table, &nuFound](size_t threadIndex)
+        {
+            nuFound += RunOperations(table, threadIndex);
+        });
+        WriteResult(str(boost::format("Threads %1%") % nuThreads),
+                    double(nuThreads) * g_nuOperations, timer.GetTime(),
+                    baseRate, nuFound.load());
+        if (nuThreads == g_nuThreads)
+            break;
+    }
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+    return FuegoBenchUtil::Main(argc, argv, ParseOptions, MainLoop);
+}
+
+//----------------------------------------------------------------------------
@@ -0,0 +1,127 @@
+//----------------------------------------------------------------------------
+/** @file RegionTrackerBenchMain.cpp
+    Main function for a benchmark of the incremental regions of GoUctBoard.
+
+    Plays random games on a GoUctBoard without and with an attached
+    GoUctRegionTracker and writes the moves per second and the time per
+    region update. The games of both runs are the same, because they use
+    the same random number sequence. */
+//----------------------------------------------------------------------------
+
+#include "SgSystem.h"
+
+#include <iostream>
+#include <boost/format.hpp>
+#include "FuegoBenchUtil.h"
+#include "GoBoard.h"
+#include "GoBoardUtil.h"
+#include "GoUctBoard.h"
+#include "GoUctRegionTracker.h"
+#include "SgDebug.h"
+#include "SgException.h"
+#include "SgRandom.h"
+#include "SgTimer.h"
+#include "SgWrite.h"
+
+namespace po = boost::program_options;
+
+//----------------------------------------------------------------------------
+
+namespace {
+
+/** @name Settings from command line options */
+// @{
+
+int g_size;
+
+int g_nuGames;
+
+// @} // @name
+
+void ParseOptions(int argc, char** argv)
+{
+    po::options_description normalOptions("Options");
+    normalOptions.add_options()
+        ("games",
+         po::value<int>(&g_nuGames)->default_value(20000),
+         "number of random games")
+        ("size",
+         po::value<int>(&g_size)->default_value(9),
+         "board size");
+    FuegoBenchUtil::ParseOptions(argc, argv,
+                                 "fuego_regiontracker_bench [options]",
+                                 normalOptions);
+    if (g_size < SG_MIN_SIZE || g_size > SG_MAX_SIZE)
+        throw SgException("Invalid board size");
+    if (g_nuGames < 1)
+        throw SgException("Games must be positive");
+}
+
+/** Play random games until no moves are left that do not fill an eye.
+    @return The number of moves played. */
+long long RunGames(GoUctBoard& bd, const GoBoard& board)
+{
+    SgRandom::SetSeed(1);
+    SgRandom random;
+    long long nuMoves = 0;
+    const int maxMoves = 3 * board.Size() * board.Size();
+    for (int game = 0; game < g_nuGames; ++game)
+    {
+        bd.Init(board);
+        for (int i = 0; i < maxMoves; ++i)
+        {
+            GoPointList moves;
+            for (GoUctBoard::Iterator it(bd); it; ++it)
+                if (  bd.IsEmpty(*it)
+                   && bd.IsLegal(*it)
+                   && ! GoBoardUtil::IsCompletelySurrounded(bd, *it)
+                   )
+                    moves.PushBack(*it);
+            if (moves.IsEmpty())
+                break;
+            bd.Play(moves[random.Int(moves.Length())]);
+            ++nuMoves;
+        }
+    }
+    return nuMoves;
+}
+
+void WriteResult(const std::string& label, long long nuMoves, double time)
+{
+    std::cout << SgWriteLabel(label)
+              << boost::format("%d moves, time %.3f, %.0f moves/s\n")
+                 % nuMoves % time % (time > 0 ? double(nuMoves) / time : 0);
+}
+
+void MainLoop()
+{
+    GoBoard board(g_size);
+    auto pbd = GoUctBoard::create(board);
+    GoUctBoard& bd = *pbd;
+    SgTimer timer;
+    const long long nuMoves = RunGames(bd, board);
+    const double baseTime = timer.GetTime();
+    WriteResult("GoUctBoard", nuMoves, baseTime);
+    GoUctRegionTracker tracker;
+    bd.SetRegionTracker(&tracker);
+    timer.Start();
+    const long long nuTrackedMoves = RunGames(bd, board);
+    const double time = timer.GetTime();
+    SG_ASSERT(nuTrackedMoves == nuMoves);
+    WriteResult("Tracker", nuTrackedMoves, time);
+    std::cout << SgWriteLabel("Update")
+              << boost::format("%.0f ns/update, %.0f updates/s\n")
+                 % (time > baseTime ? 1e9 * (time - baseTime) / nuMoves : 0)
+                 % (time > baseTime ? nuMoves / (time - baseTime) : 0);
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+    return FuegoBenchUtil::Main(argc, argv, ParseOptions, MainLoop);
+}
+
+//----------------------------------------------------------------------------
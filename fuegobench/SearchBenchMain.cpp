@@ -0,0 +1,272 @@
+//----------------------------------------------------------------------------
+/** @file SearchBenchMain.cpp
+    Main function for a benchmark of the parallel search of SgSearch.
+
+    Runs SgSearch::IteratedSearch() on an artificial game tree, like the
+    trees of the unit tests of SgSearch, with one thread and with an
+    increasing number of threads and writes the nodes per second and the
+    speedup over one thread. The tree is uniform with pseudo-random
+    evaluations; the search depth is the height of the tree, so all searches
+    must find the same value. */
+//----------------------------------------------------------------------------
+
+#include "SgSystem.h"
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <boost/format.hpp>
+#include "FuegoBenchUtil.h"
+#include "SgConcurrentHashTable.h"
+#include "SgDebug.h"
+#include "SgException.h"
+#include "SgHashTable.h"
+#include "SgSearch.h"
+#include "SgTimer.h"
+#include "SgWrite.h"
+
+using std::string;
+using std::vector;
+namespace po = boost::program_options;
+
+//----------------------------------------------------------------------------
+
+namespace {
+
+/** @name Settings from command line options */
+// @{
+
+int g_height;
+
+int g_width;
+
+int g_maxHash;
+
+int g_nuThreads;
+
+// @} // @name
+
+/** Search of a uniform game tree with pseudo-random evaluations.
+    The moves are the numbers 0 to width - 1. A position is identified by
+    its hash code, which is the exclusive or of a code for each move and
+    its depth. The evaluation is the sum of the values of the moves, which
+    are derived from the hash code of the position after the move. */
+class BenchSearch
+    : public SgSearch
+{
+public:
+    BenchSearch(SgSearchHashTable* hash);
+
+    bool CheckDepthLimitReached() const;
+
+    std::unique_ptr<SgSearch> CreateThreadSearch() const;
+
+    bool EndOfGame() const;
+
+    int Evaluate(bool* isExact, int depth);
+
+    bool Execute(SgMove move, int* delta, int depth);
+
+    void Generate(SgVector<SgMove>* moves, int depth);
+
+    SgHashCode GetHashCode() const;
+
+    SgBlackWhite GetToPlay() const;
+
+    string MoveString(SgMove move) const;
+
+    void SetToPlay(SgBlackWhite toPlay);
+
+    void TakeBack();
+
+private:
+    SgBlackWhite m_toPlay;
+
+    SgHashCode m_code;
+
+    /** Evaluation from the view of Black. */
+    int m_value;
+
+    /** Moves played from the root. */
+    vector<SgMove> m_moves;
+
+    /** m_value before each move of m_moves. */
+    vector<int> m_values;
+
+    SgHashCode MoveCode(SgMove move, std::size_t depth) const;
+};
+
+BenchSearch::BenchSearch(SgSearchHashTable* hash)
+    : SgSearch(hash),
+      m_toPlay(SG_BLACK),
+      m_value(0)
+{ }
+
+bool BenchSearch::CheckDepthLimitReached() const
+{
+    return true;
+}
+
+std::unique_ptr<SgSearch> BenchSearch::CreateThreadSearch() const
+{
+    // Always called at the root
+    SG_ASSERT(m_moves.empty());
+    return std::unique_ptr<SgSearch>(new BenchSearch(0));
+}
+
+bool BenchSearch::EndOfGame() const
+{
+    return false;
+}
+
+int BenchSearch::Evaluate(bool* isExact, int depth)
+{
+    SG_UNUSED(depth);
+    *isExact = false;
+    return (m_toPlay == SG_BLACK ? m_value : -m_value);
+}
+
+bool BenchSearch::Execute(SgMove move, int* delta, int depth)
+{
+    SG_UNUSED(delta);
+    SG_UNUSED(depth);
+    m_values.push_back(m_value);
+    m_code.Xor(MoveCode(move, m_moves.size()));
+    m_moves.push_back(move);
+    const int value = static_cast<int>(m_code.Code1() % 101) - 50;
+    m_value += (m_toPlay == SG_BLACK ? value : -value);
+    m_toPlay = SgOppBW(m_toPlay);
+    return true;
+}
+
+void BenchSearch::Generate(SgVector<SgMove>* moves, int depth)
+{
+    SG_UNUSED(depth);
+    if (static_cast<int>(m_moves.size()) >= g_height)
+        return;
+    for (int i = 0; i < g_width; ++i)
+        moves->PushBack(i);
+}
+
+SgHashCode BenchSearch::GetHashCode() const
+{
+    return m_code;
+}
+
+SgBlackWhite BenchSearch::GetToPlay() const
+{
+    return m_toPlay;
+}
+
+inline SgHashCode BenchSearch::MoveCode(SgMove move, std::size_t depth) const
+{
+    return SgHashCode(static_cast<unsigned int>(depth * g_width + move + 1));
+}
+
+string BenchSearch::MoveString(SgMove move) const
+{
+    std::ostringstream buffer;
+    buffer << move;
+    return buffer.str();
+}
+
+void BenchSearch::SetToPlay(SgBlackWhite toPlay)
+{
+    m_toPlay = toPlay;
+}
+
+void BenchSearch::TakeBack()
+{
+    m_toPlay = SgOppBW(m_toPlay);
+    const SgMove move = m_moves.back();
+    m_moves.pop_back();
+    m_code.Xor(MoveCode(move, m_moves.size()));
+    m_value = m_values.back();
+    m_values.pop_back();
+}
+
+void ParseOptions(int argc, char** argv)
+{
+    po::options_description normalOptions("Options");
+    normalOptions.add_options()
+        ("height",
+         po::value<int>(&g_height)->default_value(12),
+         "height of the tree and search depth")
+        ("size",
+         po::value<int>(&g_maxHash)->default_value(1 << 20),
+         "number of entries of the hash table")
+        ("threads",
+         po::value<int>(&g_nuThreads)->default_value(
+                         static_cast<int>(
+                                 std::max(std::thread::hardware_concurrency(),
+                                          1u))),
+         "maximum number of threads")
+        ("width",
+         po::value<int>(&g_width)->default_value(8),
+         "number of moves in each position");
+    FuegoBenchUtil::ParseOptions(argc, argv, "fuego_search_bench [options]",
+                                 normalOptions);
+    if (g_height < 1 || g_width < 1 || g_maxHash < 1 || g_nuThreads < 1)
+        throw SgException("Height, width, size and threads must be positive");
+    if (g_height >= SgSearch::MAX_DEPTH)
+        throw SgException("Height too large");
+}
+
+void MainLoop()
+{
+    double baseTime = 0;
+    for (int nuThreads = 1; ; nuThreads *= 2)
+    {
+        if (nuThreads > g_nuThreads)
+            nuThreads = g_nuThreads;
+        // The parallel search needs the thread-safe hash table, one thread
+        // uses the faster default hash table
+        std::unique_ptr<SgSearchHashTable> hashTable;
+        std::unique_ptr<SgSearchConcurrentHashTable> concurrentHashTable;
+        BenchSearch search(0);
+        if (nuThreads == 1)
+        {
+            hashTable.reset(new SgSearchHashTable(g_maxHash));
+            search.SetHashTable(hashTable.get());
+        }
+        else
+        {
+            concurrentHashTable.reset(
+                                new SgSearchConcurrentHashTable(g_maxHash));
+            search.SetConcurrentHashTable(concurrentHashTable.get());
+        }
+        search.SetNumberThreads(nuThreads);
+        SgVector<SgMove> sequence;
+        SgTimer timer;
+        const int value = search.IteratedSearch(1, g_height, &sequence);
+        const double time = timer.GetTime();
+        if (nuThreads == 1)
+            baseTime = time;
+        const int nuNodes = search.Statistics().NumNodes();
+        std::cout << SgWriteLabel(str(boost::format("Threads %1%")
+                                      % nuThreads))
+                  << boost::format("value %d, time %.3f, %d nodes, "
+                                   "%.0f nodes/s")
+                     % value % time % nuNodes
+                     % (time > 0 ? nuNodes / time : 0);
+        if (nuThreads > 1 && time > 0)
+            std::cout << boost::format(" (%.2fx)") % (baseTime / time);
+        std::cout << '\n';
+        if (nuThreads == g_nuThreads)
+            break;
+    }
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+    return FuegoBenchUtil::Main(argc, argv, ParseOptions, MainLoop);
+}
+
+//----------------------------------------------------------------------------
@@ -0,0 +1,210 @@
+//----------------------------------------------------------------------------
+/** @file SgfBenchMain.cpp
+    Main function for a benchmark of reading SGF files.
+
+    Reads SGF files with SgGameReader::ReadGames(), with the nodes allocated
+    on the heap and in an SgNodeArena, and with SgSgfParser and writes the
+    games, nodes and moves per second. */
+//----------------------------------------------------------------------------
+
+#include "SgSystem.h"
+
+#include <fstream>
+#include <iostream>
+#include <boost/format.hpp>
+#include "FuegoBenchUtil.h"
+#include "SgDebug.h"
+#include "SgException.h"
+#include "SgGameReader.h"
+#include "SgMappedFile.h"
+#include "SgNode.h"
+#include "SgNodeArena.h"
+#include "SgSgfParser.h"
+#include "SgTimer.h"
+#include "SgWrite.h"
+
+using std::string;
+using std::vector;
+namespace po = boost::program_options;
+
+//----------------------------------------------------------------------------
+
+namespace {
+
+/** @name Settings from command line options */
+// @{
+
+int g_repeat;
+
+vector<string> g_inputFiles;
+
+// @} // @name
+
+/** Counts of reading SGF data. */
+struct Result
+{
+    std::size_t m_nuGames;
+
+    std::size_t m_nuNodes;
+
+    std::size_t m_nuMoves;
+
+    double m_time;
+
+    Result();
+
+    void Write(const string& label) const;
+};
+
+Result::Result()
+    : m_nuGames(0),
+      m_nuNodes(0),
+      m_nuMoves(0),
+      m_time(0)
+{ }
+
+void Result::Write(const string& label) const
+{
+    std::cout << "==== " << label << " ====\n"
+              << SgWriteLabel("Games") << m_nuGames << '\n'
+              << SgWriteLabel("Nodes") << m_nuNodes << '\n'
+              << SgWriteLabel("Moves") << m_nuMoves << '\n'
+              << SgWriteLabel("Time") << boost::format("%.3f") % m_time
+              << '\n'
+              << SgWriteLabel("Games/s")
+              << boost::format("%.1f") % (m_time > 0 ? m_nuGames / m_time : 0)
+              << '\n'
+              << SgWriteLabel("Nodes/s")
+              << boost::format("%.1f") % (m_time > 0 ? m_nuNodes / m_time : 0)
+              << "\n\n";
+}
+
+class CountingHandler
+    : public SgSgfHandler
+{
+public:
+    Result& m_result;
+
+    CountingHandler(Result& result)
+        : m_result(result)
+    { }
+
+    void StartNode()
+    {
+        ++m_result.m_nuNodes;
+    }
+
+    void Move(SgBlackWhite color, SgPoint move)
+    {
+        SG_UNUSED(color);
+        SG_UNUSED(move);
+        ++m_result.m_nuMoves;
+    }
+};
+
+void CountNodes(const SgNode* node, Result& result)
+{
+    for ( ; node != 0; node = node->RightBrother())
+    {
+        ++result.m_nuNodes;
+        if (node->HasNodeMove())
+            ++result.m_nuMoves;
+        CountNodes(node->LeftMostSon(), result);
+    }
+}
+
+void ParseOptions(int argc, char** argv)
+{
+    po::options_description normalOptions("Options");
+    normalOptions.add_options()
+        ("repeat",
+         po::value<int>(&g_repeat)->default_value(1),
+         "number of times each file is read");
+    FuegoBenchUtil::ParseOptions(argc, argv,
+                                 "fuego_sgf_bench [options] sgf files",
+                                 normalOptions, &g_inputFiles);
+    if (g_inputFiles.empty())
+        throw SgException("No sgf files given");
+    if (g_repeat < 1)
+        throw SgException("Number of repetitions must be positive");
+}
+
+/** Read a file with SgGameReader, including the time for creating and
+    deleting the trees.
+    @param fileName
+    @param arena The arena for the nodes, null for allocating on the heap
+    @param result */
+void ReadWithGameReader(const string& fileName, SgNodeArena* arena,
+                        Result& result)
+{
+    std::ifstream in(fileName.c_str());
+    if (! in)
+        throw SgException(boost::format("Could not open file '%1%'")
+                          % fileName);
+    SgTimer timer;
+    SgVectorOf<SgNode> roots;
+    {
+        SgNodeArena::Scope scope(arena);
+        SgGameReader reader(in);
+        reader.ReadGames(&roots);
+    }
+    for (SgVectorIteratorOf<SgNode> it(roots); it; ++it)
+    {
+        CountNodes(*it, result);
+        (*it)->DeleteTree();
+    }
+    if (arena != 0)
+        arena->Clear();
+    result.m_nuGames += roots.Length();
+    result.m_time += timer.GetTime();
+}
+
+/** Read a file with SgSgfParser, including the time for mapping the
+    file. */
+void ReadWithParser(const string& fileName, Result& result)
+{
+    SgTimer timer;
+    SgMappedFile file(fileName);
+    SgSgfParser parser(std::string_view(file.Data(), file.Size()));
+    CountingHandler handler(result);
+    result.m_nuGames += parser.ParseGames(handler);
+    result.m_time += timer.GetTime();
+}
+
+void MainLoop()
+{
+    Result readerResult;
+    Result arenaResult;
+    Result parserResult;
+    SgNodeArena arena;
+    for (int i = 0; i < g_repeat; ++i)
+        for (size_t j = 0; j < g_inputFiles.size(); ++j)
+        {
+            ReadWithGameReader(g_inputFiles[j], 0, readerResult);
+            ReadWithGameReader(g_inputFiles[j], &arena, arenaResult);
+            ReadWithParser(g_inputFiles[j], parserResult);
+        }
+    readerResult.Write("SgGameReader");
+    arenaResult.Write("SgGameReader with SgNodeArena");
+    parserResult.Write("SgSgfParser");
+    if (  readerResult.m_nuGames != parserResult.m_nuGames
+       || readerResult.m_nuMoves != parserResult.m_nuMoves
+       )
+        SgWarning() << "Different number of games or moves\n";
+    if (parserResult.m_time > 0)
+        std::cout << SgWriteLabel("Speedup")
+                  << boost::format("%.2f")
+                     % (readerResult.m_time / parserResult.m_time)
+                  << '\n';
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+    return FuegoBenchUtil::Main(argc, argv, ParseOptions, MainLoop);
+}
+
+//----------------------------------------------------------------------------
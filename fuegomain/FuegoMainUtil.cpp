@@ -6,58 +6,26 @@
 #include "SgSystem.h"
 #include "FuegoMainUtil.h"
 
-#include <fstream>
 #include <sstream>
 #include <filesystem>
 #include "GoBook.h"
-#include "SgDebug.h"
-#include "SgStringUtil.h"
+#include "SgException.h"
 
 namespace fs = std::filesystem;
 
 //----------------------------------------------------------------------------
 
-namespace {
-
-bool LoadBookFile(GoBook& book, const fs::path& file)
-{
-    std::string nativeFile = SgStringUtil::GetNativeFileName(file);
-    SgDebug() << "Loading opening book from '" << nativeFile << "'... ";
-    std::ifstream in(nativeFile.c_str());
-    if (! in)
-    {
-        SgDebug() << "not found\n";
-        return false;
-    }
-    try
-    {
-        book.Read(in);
-    }
-    catch (const SgException& e)
-    {
-        SgDebug() << "error: " << e.what() << '\n';
-        return false;
-    }
-    SgDebug() << "ok\n";
-    return true;
-}
-
-} // namespace
-
-//----------------------------------------------------------------------------
-
 void FuegoMainUtil::LoadBook(GoBook& book,
                              const fs::path& programDir)
 {
-    const std::string fileName = "book.dat";
     #ifdef ABS_TOP_SRCDIR
-        if (LoadBookFile(book, path(ABS_TOP_SRCDIR) / "book" / fileName))
+        if (book.ReadFromDir(path(ABS_TOP_SRCDIR) / "book"))
             return;
     #endif
-    if (LoadBookFile(book, programDir / fileName))
+    if (book.ReadFromDir(programDir))
         return;
     #if defined(DATADIR) && defined(PACKAGE)
-        if (LoadBookFile(book, path(DATADIR) / PACKAGE / fileName))
+        if (book.ReadFromDir(path(DATADIR) / PACKAGE))
             return;
     #endif
     throw SgException("Could not find opening book.");
@@ -2,12 +2,36 @@
 /** @file GoAutoBook.cpp  */
 //----------------------------------------------------------------------------
 
+#include <algorithm>
 #include <iomanip>
+#include <iterator>
 #include "SgSystem.h"
 #include "GoAutoBook.h"
 
 //----------------------------------------------------------------------------
 
+namespace {
+
+bool ContainsSorted(const std::vector<SgHashCode>& sorted,
+                    const SgHashCode& hash)
+{
+    return std::binary_search(sorted.begin(), sorted.end(), hash);
+}
+
+void InsertSorted(std::vector<SgHashCode>& sorted,
+                  const std::set<SgHashCode>& hashes)
+{
+    std::vector<SgHashCode> result;
+    result.reserve(sorted.size() + hashes.size());
+    std::set_union(sorted.begin(), sorted.end(), hashes.begin(), hashes.end(),
+                   std::back_inserter(result));
+    sorted.swap(result);
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------
+
 GoAutoBookState::GoAutoBookState(const GoBoard& brd)
     : m_synchronizer(brd)
 {
@@ -76,70 +100,90 @@ GoAutoBookParam::GoAutoBookParam()
 
 GoAutoBook::GoAutoBook(const std::string& filename,
                        const GoAutoBookParam& param)
-    : m_param(param), 
-      m_filename(filename)
+    : m_param(param)
 {
-    std::ifstream is(filename.c_str());
-    if (! is)
+    if (  std::ifstream(filename.c_str())
+       && ! SgBookStore::IsBookFile(filename)
+       )
     {
-        std::ofstream of(filename.c_str());
-        if (! of)
-            throw SgException("Invalid file name!");
-        of.close();
+        ReadTextBook(filename);
+        SgDebug() << "GoAutoBook: Read " << m_data.Size()
+                  << " nodes of text book.\n";
     }
     else
     {
-        while (is)
-        {
-            std::string line;
-            std::getline(is, line);
-            if (line.size() < 19)
-                continue;
-            std::string str;
-            std::istringstream iss(line);
-            iss >> str;
-            SgHashCode hash;
-            hash.FromString(str);
-            SgBookNode node(line.substr(19));
-            m_data[hash] = node;
-        }
-        SgDebug() << "GoAutoBook: Parsed " << m_data.size() << " lines.\n";
+        m_data.Open(filename);
+        SgDebug() << "GoAutoBook: Opened " << m_data.Size() << " nodes.\n";
     }
 }
 
 GoAutoBook::~GoAutoBook()
 { }
 
+void GoAutoBook::AddDisabledLines(const std::set<SgHashCode>& disabled)
+{
+    InsertSorted(m_disabled, disabled);
+    SgDebug() << "Disabled " << disabled.size() << " lines.\n";
+}
+
+void GoAutoBook::AddForcedLines(const std::set<SgHashCode>& forced)
+{
+    InsertSorted(m_forced, forced);
+    SgDebug() << "Forced " << forced.size() << " lines.\n";
+}
+
 bool GoAutoBook::Get(const GoAutoBookState& state, SgBookNode& node) const
 {
-    Map::const_iterator it = m_data.find(state.GetHashCode());
-    if (it != m_data.end())
-    {
-        node = it->second;
-        return true;
-    }
-    return false;
+    return m_data.Get(Key(state.GetHashCode()), node);
+}
+
+std::uint64_t GoAutoBook::Key(const SgHashCode& hash)
+{
+    return (std::uint64_t(hash.Code1()) << 32) | hash.Code2();
 }
 
 void GoAutoBook::Put(const GoAutoBookState& state, const SgBookNode& node)
 {
-    m_data[state.GetHashCode()] = node;
+    m_data.Put(Key(state.GetHashCode()), node);
 }
 
 void GoAutoBook::Flush()
 {
-    Save(m_filename);
+    if (! m_data.IsOpen())
+        throw SgException("GoAutoBook: book was read from a text file,"
+                          " save it to a binary book file");
+    m_data.Flush();
 }
 
-void GoAutoBook::Save(const std::string& filename) const
+/** Read a book file in the old text format into memory.
+    The file is not modified. */
+void GoAutoBook::ReadTextBook(const std::string& filename)
 {
-    std::ofstream out(filename.c_str());
-    for (Map::const_iterator it = m_data.begin(); it != m_data.end(); ++it)
+    std::ifstream is(filename.c_str());
+    bool isEmpty = true;
+    while (is)
     {
-        out << it->first.ToString() << '\t' 
-            << it->second.ToString() << '\n';
+        std::string line;
+        std::getline(is, line);
+        if (! line.empty())
+            isEmpty = false;
+        if (line.size() < 19)
+            continue;
+        std::string str;
+        std::istringstream iss(line);
+        iss >> str;
+        SgHashCode hash;
+        hash.FromString(str);
+        SgBookNode node(line.substr(19));
+        m_data.Put(Key(hash), node);
     }
-    out.close();
+    if (m_data.Size() == 0 && ! isEmpty)
+        throw SgException(filename + ": not a book file");
+}
+
+void GoAutoBook::Save(const std::string& filename) const
+{
+    m_data.Save(filename);
 }
 
 void GoAutoBook::Merge(const GoAutoBook& other)
@@ -150,14 +194,13 @@ void GoAutoBook::Merge(const GoAutoBook& other)
     std::size_t leafsInCommon = 0;
     std::size_t internalInCommon = 0;
     std::size_t leafToInternal = 0;
-    for (Map::const_iterator it = other.m_data.begin();
-         it != other.m_data.end(); ++it)
+    for (SgBookStore::Iterator it(other.m_data); it; ++it)
     {
-        Map::iterator mine = m_data.find(it->first);
-        SgBookNode newNode(it->second);
-        if (mine == m_data.end())
+        SgBookNode newNode(it.Node());
+        SgBookNode oldNode;
+        if (! m_data.Get(it.Key(), oldNode))
         {
-            m_data[it->first] = it->second;
+            m_data.Put(it.Key(), newNode);
             if (newNode.IsLeaf())
                 newLeafs++;
             else
@@ -165,12 +208,11 @@ void GoAutoBook::Merge(const GoAutoBook& other)
         }
         else
         {
-            SgBookNode oldNode(mine->second);
             if (newNode.IsLeaf() && oldNode.IsLeaf())
             {
                 newNode.m_heurValue = 0.5f * (newNode.m_heurValue 
                                              + oldNode.m_heurValue);
-                m_data[it->first] = newNode;
+                m_data.Put(it.Key(), newNode);
                 leafsInCommon++;
             }
             else if (! newNode.IsLeaf())
@@ -183,7 +225,7 @@ void GoAutoBook::Merge(const GoAutoBook& other)
                 // accurate after the merge.  I don't think it matters
                 // that much.
                 newNode.m_count = std::max(newNode.m_count, oldNode.m_count);
-                m_data[it->first] = newNode;
+                m_data.Put(it.Key(), newNode);
                 if (! oldNode.IsLeaf())
                     internalInCommon++;
                 else 
@@ -257,16 +299,16 @@ void GoAutoBook::ImportHashValuePairs(std::istream& in)
         if (! in) 
             break;
         in >> value;
-        if (m_data.count(hash) == 0)
+        SgBookNode node;
+        if (! m_data.Get(Key(hash), node))
         {
             std::ostringstream os;
             os << "Unknown hash: " << hash << '\n';
             throw SgException(os.str());
         }
-        SgBookNode node(m_data[hash]);
         node.m_heurValue = value;
         node.m_value = value;
-        m_data[hash] = node;
+        m_data.Put(Key(hash), node);
         count++;
     }
     SgDebug() << "GoAutoBook::ImportHashValue: imported " 
@@ -291,7 +333,7 @@ SgMove GoAutoBook::FindBestChild(GoAutoBookState& state) const
         if (state.Board().IsLegal(*it))
         {
             state.Play(*it);
-            if (m_forced.count(state.GetHashCode()) > 0)
+            if (ContainsSorted(m_forced, state.GetHashCode()))
             {
                 SgDebug() << "Playing forced move " 
                           << SgWritePoint(*it) << '\n';
@@ -309,7 +351,7 @@ SgMove GoAutoBook::FindBestChild(GoAutoBookState& state) const
         if (state.Board().IsLegal(*it))
         {
             state.Play(*it);
-            if (m_disabled.count(state.GetHashCode()) > 0)
+            if (ContainsSorted(m_disabled, state.GetHashCode()))
                 SgDebug() << "Ignoring disabled move " 
                           << SgWritePoint(*it) << '\n';
             // NOTE: Terminal nodes aren't supported at this time, so 
@@ -8,8 +8,9 @@
 #include <iostream>
 #include <fstream>
 #include <set>
-#include <map>
+#include <vector>
 #include "SgBookBuilder.h"
+#include "SgBookStore.h"
 #include "SgThreadedWorker.h"
 #include "GoBoard.h"
 #include "GoBoardSynchronizer.h"
@@ -82,8 +83,16 @@ struct GoAutoBookParam
 
 //----------------------------------------------------------------------------
 
-/** Simple text-based book format.
-    Entire book is loaded into memory. */
+/** Book of SgBookNode for canonical positions, stored in a SgBookStore.
+    The book file is memory-mapped, so opening a book needs no parsing and
+    the nodes are shared between processes playing with the same book.
+    Nodes added while building the book are appended to the file by
+    Flush().
+
+    Books in the old text format (one line with hash code and
+    SgBookNode::ToString() per node) are read into memory and their file is
+    never written. Such a book can only be converted explicitly by saving it
+    with Save() to a binary book file. */
 class GoAutoBook
 {
 public:
@@ -99,12 +108,18 @@ public:
     /** Store the node in the given state. */
     void Put(const GoAutoBookState& state, const SgBookNode& node);
 
-    /** Since there is no cache, same as Save(). */
+    /** Appends the nodes changed since the last flush to the book
+        file.
+        @throws SgException If the book was read from a text file. */
     void Flush();
 
-    /** Writes book to disk. */
+    /** Writes a compacted copy of the book to another file.
+        @see SgBookStore::Save() */
     void Save(const std::string& filename) const;
 
+    /** Number of nodes in the book. */
+    std::size_t Size() const;
+
     /** Helper function: calls FindBestChild() on the given board.*/
     SgMove LookupMove(const GoBoard& brd) const;
 
@@ -153,17 +168,19 @@ public:
     static std::vector< std::vector<SgMove> > ParseWorkList(std::istream& in);
 
 private:
-    typedef std::map<SgHashCode, SgBookNode> Map;
-
-    Map m_data;
+    SgBookStore m_data;
 
     const GoAutoBookParam& m_param;
 
-    std::set<SgHashCode> m_disabled;
+    /** Disabled states, sorted. */
+    std::vector<SgHashCode> m_disabled;
+
+    /** Forced states, sorted. */
+    std::vector<SgHashCode> m_forced;
 
-    std::set<SgHashCode> m_forced;
+    static std::uint64_t Key(const SgHashCode& hash);
 
-    std::string m_filename;
+    void ReadTextBook(const std::string& filename);
 
     void TruncateByDepth(int depth, GoAutoBookState& state, 
                          GoAutoBook& other, 
@@ -174,16 +191,9 @@ private:
 
 };
 
-inline void GoAutoBook::AddForcedLines(const std::set<SgHashCode>& forced)
-{
-    m_forced.insert(forced.begin(), forced.end());
-    SgDebug() << "Forced " << forced.size() << " lines.\n";
-}
-
-inline void GoAutoBook::AddDisabledLines(const std::set<SgHashCode>& disabled)
+inline std::size_t GoAutoBook::Size() const
 {
-    m_disabled.insert(disabled.begin(), disabled.end());
-    SgDebug() << "Disabled " << disabled.size() << " lines.\n";
+    return m_data.Size();
 }
 
 //----------------------------------------------------------------------------
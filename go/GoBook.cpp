@@ -6,8 +6,10 @@
 #include "GoBook.h"
 
 #include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <sstream>
+#include <boost/static_assert.hpp>
 #include "GoBoard.h"
 #include "GoBoardUtil.h"
 #include "GoGtpCommandUtil.h"
@@ -15,6 +17,8 @@
 #include "GoModBoard.h"
 #include "SgDebug.h"
 #include "SgException.h"
+#include "SgMappedFile.h"
+#include "SgStringUtil.h"
 #include "SgWrite.h"
 
 using std::istringstream;
@@ -23,6 +27,7 @@ using std::ostringstream;
 using std::pair;
 using std::string;
 using std::vector;
+namespace fs = std::filesystem;
 
 //----------------------------------------------------------------------------
 
@@ -48,6 +53,68 @@ bool Erase(vector<T>& v, const T& elem)
     return false;
 }
 
+/** @name Compiled book format
+    See GoBook */
+// @{
+
+const char BINARY_MAGIC[8] = { 'F', 'u', 'e', 'g', 'o', 'B', 'k', '\0' };
+
+const uint32_t BINARY_VERSION = 1;
+
+const uint32_t BINARY_BYTE_ORDER = 0x01020304;
+
+struct BinaryHeader
+{
+    char m_magic[8];
+
+    uint32_t m_version;
+
+    uint32_t m_byteOrder;
+
+    uint32_t m_nuRecords;
+
+    uint32_t m_nuMoves;
+
+    uint64_t m_reserved;
+};
+
+struct BinaryRecord
+{
+    uint64_t m_hashCode;
+
+    uint32_t m_firstMove;
+
+    uint32_t m_line;
+
+    uint16_t m_nuMoves;
+
+    uint8_t m_size;
+
+    uint8_t m_reserved[5];
+};
+
+BOOST_STATIC_ASSERT(sizeof(BinaryHeader) == 32);
+BOOST_STATIC_ASSERT(sizeof(BinaryRecord) == 24);
+
+bool RecordLess(const BinaryRecord& r1, const BinaryRecord& r2)
+{
+    if (r1.m_hashCode != r2.m_hashCode)
+        return r1.m_hashCode < r2.m_hashCode;
+    return r1.m_size < r2.m_size;
+}
+
+/** Finalizer of the SplitMix64 generator, used as a fixed random mapping
+    for BinaryHashCode(). */
+uint64_t Mix64(uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// @} // @name
+
 vector<SgPoint> GetSequence(const GoBoard& bd)
 {
     vector<SgPoint> result;
@@ -64,6 +131,41 @@ vector<SgPoint> GetSequence(const GoBoard& bd)
     return result;
 }
 
+/** Check if a file was modified before another file.
+    @return @c false if a modification time cannot be determined */
+bool IsOlder(const fs::path& file1, const fs::path& file2)
+{
+    std::error_code error1;
+    std::error_code error2;
+    const fs::file_time_type time1 = fs::last_write_time(file1, error1);
+    const fs::file_time_type time2 = fs::last_write_time(file2, error2);
+    return ! error1 && ! error2 && time1 < time2;
+}
+
+/** Read a book file for GoBook::ReadFromDir().
+    @return @c false if the file does not exist or cannot be read */
+bool ReadBookFile(GoBook& book, const fs::path& file)
+{
+    string nativeFile = SgStringUtil::GetNativeFileName(file);
+    SgDebug() << "Loading opening book from '" << nativeFile << "'... ";
+    if (! std::ifstream(nativeFile.c_str()))
+    {
+        SgDebug() << "not found\n";
+        return false;
+    }
+    try
+    {
+        book.Read(nativeFile);
+    }
+    catch (const SgException& e)
+    {
+        SgDebug() << "error: " << e.what() << '\n';
+        return false;
+    }
+    SgDebug() << "ok\n";
+    return true;
+}
+
 } // namepsace
 
 //----------------------------------------------------------------------------
@@ -83,8 +185,17 @@ void GoBook::Entry::ApplyTo(GoBoard& bd) const
 
 //----------------------------------------------------------------------------
 
+GoBook::GoBook()
+    : m_warningMaxSizeShown(false),
+      m_lineCount(0)
+{ }
+
+GoBook::~GoBook()
+{ }
+
 void GoBook::Add(const GoBoard& bd, SgPoint move)
 {
+    CheckNotCompiled();
     if (move != SG_PASS && bd.Occupied(move))
         throw SgException("point is not empty");
     if (! bd.IsLegal(move))
@@ -109,14 +220,31 @@ void GoBook::Add(const GoBoard& bd, SgPoint move)
     }
 }
 
+uint64_t GoBook::BinaryHashCode(const GoBoard& bd)
+{
+    uint64_t code = Mix64((uint64_t(bd.Size()) << 8) | uint64_t(bd.ToPlay()));
+    for (GoBoard::Iterator it(bd); it; ++it)
+        if (bd.Occupied(*it))
+            code ^= Mix64((uint64_t(*it) << 2) | uint64_t(bd.GetColor(*it)));
+    return code;
+}
+
+void GoBook::CheckNotCompiled() const
+{
+    if (IsCompiled())
+        throw SgException("compiled book cannot be modified");
+}
+
 void GoBook::Clear()
 {
     m_entries.clear();
     m_map.clear();
+    m_binary.reset();
 }
 
 void GoBook::Delete(const GoBoard& bd, SgPoint move)
 {
+    CheckNotCompiled();
     const GoBook::MapEntry* mapEntry = LookupEntry(bd);
     if (mapEntry == 0)
         return;
@@ -201,6 +329,12 @@ void GoBook::InsertEntry(const vector<SgPoint>& sequence,
 
 int GoBook::Line(const GoBoard& bd) const
 {
+    if (IsCompiled())
+    {
+        int line = 0;
+        LookupBinary(bd, line);
+        return line;
+    }
     const GoBook::MapEntry* mapEntry = LookupEntry(bd);
     if (mapEntry == 0)
         return 0;
@@ -234,27 +368,65 @@ SgPoint GoBook::LookupMove(const GoBoard& bd) const
 vector<SgPoint> GoBook::LookupAllMoves(const GoBoard& bd) const
 {
     vector<SgPoint> result;
-    const GoBook::MapEntry* mapEntry = LookupEntry(bd);
-    if (mapEntry == 0)
-        return result;
-    size_t id = mapEntry->m_id;
-    SG_ASSERT(id < m_entries.size());
-    const vector<SgPoint>& moves = m_entries[id].m_moves;
-    const int rotation = mapEntry->m_rotation;
-    const int size = mapEntry->m_size;
-    for (vector<SgPoint>::const_iterator it = moves.begin();
-         it != moves.end(); ++it)
+    if (IsCompiled())
     {
-        SgPoint p = SgPointUtil::Rotate(rotation, *it, size);
-        if (! bd.IsLegal(p))
+        int line;
+        result = LookupBinary(bd, line);
+    }
+    else
+    {
+        const GoBook::MapEntry* mapEntry = LookupEntry(bd);
+        if (mapEntry == 0)
+            return result;
+        size_t id = mapEntry->m_id;
+        SG_ASSERT(id < m_entries.size());
+        const vector<SgPoint>& moves = m_entries[id].m_moves;
+        const int rotation = mapEntry->m_rotation;
+        const int size = mapEntry->m_size;
+        for (vector<SgPoint>::const_iterator it = moves.begin();
+             it != moves.end(); ++it)
+            result.push_back(SgPointUtil::Rotate(rotation, *it, size));
+    }
+    for (vector<SgPoint>::const_iterator it = result.begin();
+         it != result.end(); ++it)
+        if (! bd.IsLegal(*it))
         {
             // Should not happen with 64-bit hashes, but not impossible
             SgWarning() << "illegal book move (hash code collision?)\n";
             result.clear();
             break;
         }
-        result.push_back(p);
+    return result;
+}
+
+vector<SgPoint> GoBook::LookupBinary(const GoBoard& bd, int& line) const
+{
+    SG_ASSERT(IsCompiled());
+    vector<SgPoint> result;
+    const char* data = m_binary->Data();
+    const BinaryHeader& header =
+        *reinterpret_cast<const BinaryHeader*>(data);
+    const BinaryRecord* begin =
+        reinterpret_cast<const BinaryRecord*>(data + sizeof(BinaryHeader));
+    const BinaryRecord* end = begin + header.m_nuRecords;
+    const int16_t* moves = reinterpret_cast<const int16_t*>(end);
+    BinaryRecord key;
+    key.m_hashCode = BinaryHashCode(bd);
+    key.m_size = static_cast<uint8_t>(bd.Size());
+    const BinaryRecord* record = std::lower_bound(begin, end, key, RecordLess);
+    if (  record == end
+       || record->m_hashCode != key.m_hashCode
+       || record->m_size != key.m_size
+       )
+        return result;
+    if (uint64_t(record->m_firstMove) + record->m_nuMoves > header.m_nuMoves)
+    {
+        SgWarning() << "invalid record in compiled book\n";
+        return result;
     }
+    line = record->m_line;
+    for (int i = 0; i < record->m_nuMoves; ++i)
+        result.push_back(moves[record->m_firstMove + i]);
     return result;
 }
 
@@ -299,12 +471,59 @@ void GoBook::Read(std::istream& in, const string& streamName)
 
 void GoBook::Read(const string& filename)
 {
-    std::ifstream in(filename.c_str());
+    std::ifstream in(filename.c_str(), std::ios::binary);
     if (! in)
         throw SgException("Cannot find file " + filename);
+    char magic[sizeof(BINARY_MAGIC)];
+    if (  in.read(magic, sizeof(magic))
+       && memcmp(magic, BINARY_MAGIC, sizeof(magic)) == 0
+       )
+    {
+        in.close();
+        ReadBinary(filename);
+        return;
+    }
+    in.clear();
+    in.seekg(0);
     Read(in, filename);
 }
 
+void GoBook::ReadBinary(const string& filename)
+{
+    std::unique_ptr<SgMappedFile> file(new SgMappedFile(filename));
+    const size_t size = file->Size();
+    if (size < sizeof(BinaryHeader))
+        throw SgException(filename + ": not a compiled book");
+    const BinaryHeader& header =
+        *reinterpret_cast<const BinaryHeader*>(file->Data());
+    if (memcmp(header.m_magic, BINARY_MAGIC, sizeof(BINARY_MAGIC)) != 0)
+        throw SgException(filename + ": not a compiled book");
+    if (header.m_byteOrder != BINARY_BYTE_ORDER)
+        throw SgException(filename + ": compiled book has wrong byte order");
+    if (header.m_version != BINARY_VERSION)
+        throw SgException(filename + ": unsupported compiled book version");
+    if (size != sizeof(BinaryHeader)
+                + header.m_nuRecords * sizeof(BinaryRecord)
+                + header.m_nuMoves * sizeof(int16_t))
+        throw SgException(filename + ": compiled book has wrong size");
+    Clear();
+    m_streamName = filename;
+    m_binary = std::move(file);
+}
+
+bool GoBook::ReadFromDir(const fs::path& dir)
+{
+    const fs::path compiledFile = dir / "book.bin";
+    const fs::path textFile = dir / "book.dat";
+    if (IsOlder(compiledFile, textFile))
+        SgDebug() << "Ignoring '"
+                  << SgStringUtil::GetNativeFileName(compiledFile)
+                  << "', it is older than the text book\n";
+    else if (ReadBookFile(*this, compiledFile))
+        return true;
+    return ReadBookFile(*this, textFile);
+}
+
 vector<SgPoint> GoBook::ReadPoints(std::istream& in) const
 {
     vector<SgPoint> result;
@@ -335,6 +554,8 @@ void GoBook::ThrowError(const string& message) const
 
 void GoBook::Write(std::ostream& out) const
 {
+    if (IsCompiled())
+        throw SgException("compiled book cannot be written as text");
     for (vector<Entry>::const_iterator it = m_entries.begin();
          it != m_entries.end(); ++it)
     {
@@ -355,8 +576,85 @@ void GoBook::Write(std::ostream& out) const
     }
 }
 
+/** Write the book in the compiled format.
+    Each entry is replayed in all 8 symmetries; symmetries that lead to the
+    same position are written only once. Entries without moves are pruned
+    as in Write(). A compiled book is copied unchanged. */
+void GoBook::WriteBinary(std::ostream& out) const
+{
+    if (IsCompiled())
+    {
+        out.write(m_binary->Data(), m_binary->Size());
+        return;
+    }
+    vector<BinaryRecord> records;
+    vector<int16_t> moves;
+    GoBoard tempBoard;
+    for (vector<Entry>::const_iterator it = m_entries.begin();
+         it != m_entries.end(); ++it)
+    {
+        if (it->m_moves.empty())
+            continue;
+        const int size = it->m_size;
+        if (tempBoard.Size() != size)
+            tempBoard.Init(size);
+        vector<uint64_t> hashCodes;
+        for (int rot = 0; rot < 8; ++rot)
+        {
+            GoBoardUtil::UndoAll(tempBoard);
+            for (vector<SgPoint>::const_iterator it2 = it->m_sequence.begin();
+                 it2 != it->m_sequence.end(); ++it2)
+            {
+                SgPoint p = SgPointUtil::Rotate(rot, *it2, size);
+                SG_ASSERT(tempBoard.IsLegal(p));
+                tempBoard.Play(p);
+            }
+            const uint64_t hashCode = BinaryHashCode(tempBoard);
+            if (Contains(hashCodes, hashCode))
+                continue;
+            hashCodes.push_back(hashCode);
+            BinaryRecord record;
+            memset(&record, 0, sizeof(record));
+            record.m_hashCode = hashCode;
+            record.m_firstMove = static_cast<uint32_t>(moves.size());
+            record.m_line = static_cast<uint32_t>(it->m_line);
+            record.m_nuMoves = static_cast<uint16_t>(it->m_moves.size());
+            record.m_size = static_cast<uint8_t>(size);
+            records.push_back(record);
+            for (vector<SgPoint>::const_iterator it2 = it->m_moves.begin();
+                 it2 != it->m_moves.end(); ++it2)
+                moves.push_back(static_cast<int16_t>(
+                                     SgPointUtil::Rotate(rot, *it2, size)));
+        }
+    }
+    std::stable_sort(records.begin(), records.end(), RecordLess);
+    BinaryHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.m_magic, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    header.m_version = BINARY_VERSION;
+    header.m_byteOrder = BINARY_BYTE_ORDER;
+    header.m_nuRecords = static_cast<uint32_t>(records.size());
+    header.m_nuMoves = static_cast<uint32_t>(moves.size());
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (! records.empty())
+        out.write(reinterpret_cast<const char*>(&records[0]),
+                  records.size() * sizeof(BinaryRecord));
+    if (! moves.empty())
+        out.write(reinterpret_cast<const char*>(&moves[0]),
+                  moves.size() * sizeof(int16_t));
+}
+
 void GoBook::WriteInfo(std::ostream& out) const
 {
+    if (IsCompiled())
+    {
+        const BinaryHeader& header =
+            *reinterpret_cast<const BinaryHeader*>(m_binary->Data());
+        out << SgWriteLabel("Compiled") << m_binary->FileName() << '\n'
+            << SgWriteLabel("NuTransformed") << header.m_nuRecords << '\n'
+            << SgWriteLabel("NuMoves") << header.m_nuMoves << '\n';
+        return;
+    }
     out << SgWriteLabel("NuBasic") << m_entries.size() << '\n'
         << SgWriteLabel("NuTransformed") << m_map.size() << '\n';
 }
@@ -374,6 +672,7 @@ void GoBookCommands::AddGoGuiAnalyzeCommands(GtpCommand& cmd)
     cmd <<
         "gfx/Book Add/book_add %p\n"
         "none/Book Clear/book_clear\n"
+        "none/Book Compile/book_compile %w\n"
         "gfx/Book Delete/book_delete %p\n"
         "hstring/Book Info/book_info\n"
         "none/Book Load/book_load %r\n"
@@ -406,6 +705,21 @@ void GoBookCommands::CmdClear(GtpCommand& cmd)
     m_book.Clear();
 }
 
+/** Write the book in the compiled binary format.
+    The compiled book can be loaded with @c book_load; see GoBook.
+    Arguments: file name */
+void GoBookCommands::CmdCompile(GtpCommand& cmd)
+{
+    cmd.CheckNuArg(1);
+    if (! m_engine.MpiSynchronizer()->IsRootProcess())
+        return;
+    string fileName = cmd.Arg(0);
+    ofstream out(fileName.c_str(), std::ios::binary);
+    m_book.WriteBinary(out);
+    if (! out)
+        throw GtpFailure() << "error writing to file '" << fileName << "'";
+}
+
 /** Delete a move for the current position to the book.
     Arguments: point <br>
     Returns: Position information after the move deletion as in CmdPosition() */
@@ -535,6 +849,7 @@ void GoBookCommands::Register(GtpEngine& e)
 {
     e.Register("book_add", &GoBookCommands::CmdAdd, this);
     e.Register("book_clear", &GoBookCommands::CmdClear, this);
+    e.Register("book_compile", &GoBookCommands::CmdCompile, this);
     e.Register("book_delete", &GoBookCommands::CmdDelete, this);
     e.Register("book_info", &GoBookCommands::CmdInfo, this);
     e.Register("book_load", &GoBookCommands::CmdLoad, this);
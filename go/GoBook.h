@@ -6,8 +6,11 @@
 #ifndef GO_BOOK_H
 #define GO_BOOK_H
 
+#include <cstdint>
+#include <filesystem>
 #include <iosfwd>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 #include "GtpEngine.h"
@@ -32,9 +35,38 @@ class GoBoard;
     mirroring. If there are duplicates, because of sequences with move
     transpositions or rotating/mirroring, reading will throw an exception
     containing an error message with line number information of the
-    duplicates. */
+    duplicates.
+
+    A book can also be compiled into a binary file with WriteBinary() (GTP
+    command @c book_compile) and loaded with ReadBinary(). The binary file
+    contains one record per position and symmetry, sorted by a hash code of
+    the position, with the moves already transformed to the orientation of
+    the position. ReadBinary() maps the file into memory and lookups do a
+    binary search on the mapped records, so loading takes no time and
+    several engine processes share the same copy of the book in the page
+    cache. A compiled book cannot be modified.
+    @verbatim
+    Header (32 bytes):
+      char[8]  magic "FuegoBk\0"
+      uint32   version (1)
+      uint32   byte order mark 0x01020304
+      uint32   number of records
+      uint32   number of moves
+      uint64   reserved
+    Records sorted by hash code and size (24 bytes each):
+      uint64   hash code (see GoBook::BinaryHashCode())
+      uint32   index of the first move
+      uint32   line number of the entry in the text book
+      uint16   number of moves
+      uint8    board size
+      uint8[5] reserved
+    Moves (int16 each)
+    @endverbatim
+    The numbers are stored in the byte order of the machine that compiled
+    the book; ReadBinary() rejects books with a different byte order. */
 
 class GoGtpEngine;
+class SgMappedFile;
 
 class GoBook
 {
@@ -56,18 +88,25 @@ public:
         void ApplyTo(GoBoard& bd) const;
     };
 
+    GoBook();
+
+    ~GoBook();
+
     /** Add a book move to the current position.
         @throws SgException if move cannot be added (illegal or move sequence
-        to current position cannot be determined) */
+        to current position cannot be determined, or the book is a compiled
+        book) */
     void Add(const GoBoard& bd, SgPoint move);
 
     void Clear();
 
     /** Deletes a book move in the current position.
-        @throws SgException if the move is not a book move. */
+        @throws SgException if the move is not a book move or the book is a
+        compiled book. */
     void Delete(const GoBoard& bd, SgPoint move);
 
     /** Get an entry.
+        Compiled books have no entries.
         @param index The index of the entry
         @see NuEntries() */
     const Entry& GetEntry(std::size_t index) const;
@@ -91,11 +130,39 @@ public:
         @param streamName Name used for error messages (e.g. file name) */
     void Read(std::istream& in, const std::string& streamName = "");
 
-    /** Read book from file. */
+    /** Read book from file.
+        Reads a compiled book with ReadBinary(), if the file starts with the
+        magic string of the binary format. */
     void Read(const std::string& filename);
 
+    /** Map a compiled book.
+        @throws SgException if the file cannot be mapped or is not a valid
+        compiled book */
+    void ReadBinary(const std::string& filename);
+
+    /** Read the book of a directory.
+        Reads the compiled book @c book.bin, or the text book @c book.dat if
+        there is no compiled book, it cannot be read, or it is older than
+        the text book (compiled from an old version of the text book).
+        Writes the files tried to SgDebug().
+        @return @c false if no book could be read */
+    bool ReadFromDir(const std::filesystem::path& dir);
+
+    /** Is the book a compiled book loaded with ReadBinary()? */
+    bool IsCompiled() const;
+
+    /** Write book in text format.
+        @throws SgException if the book is a compiled book */
     void Write(std::ostream& out) const;
 
+    /** Write book in the compiled binary format. */
+    void WriteBinary(std::ostream& out) const;
+
+    /** Hash code of a position used in the compiled format.
+        Unlike SgHashCode, it does not depend on the random Zobrist table of
+        the process. It includes the color to play. */
+    static std::uint64_t BinaryHashCode(const GoBoard& bd);
+
     void WriteInfo(std::ostream& out) const;
 
 private:
@@ -128,6 +195,17 @@ private:
     /** Mapping hash key to entries. */
     Map m_map;
 
+    /** Compiled book, if loaded with ReadBinary(). */
+    std::unique_ptr<SgMappedFile> m_binary;
+
+    /** Find the moves of a position in the compiled book.
+        @return The moves transformed to the position or an empty vector
+        @param bd The position
+        @param line Set to the line number of the entry, if found */
+    std::vector<SgPoint> LookupBinary(const GoBoard& bd, int& line) const;
+
+    void CheckNotCompiled() const;
+
     void InsertEntry(const std::vector<SgPoint>& sequence,
                      const std::vector<SgPoint>& moves, int size,
                      GoBoard& tempBoard, int line);
@@ -147,6 +225,11 @@ inline const GoBook::Entry& GoBook::GetEntry(std::size_t index) const
     return m_entries[index];
 }
 
+inline bool GoBook::IsCompiled() const
+{
+    return m_binary.get() != 0;
+}
+
 inline std::size_t GoBook::NuEntries() const
 {
     return m_entries.size();
@@ -167,6 +250,7 @@ public:
     /** @page gobookcommands GoBookCommands
         - @link CmdAdd() @c book_add @endlink
         - @link CmdClear() @c book_clear @endlink
+        - @link CmdCompile() @c book_compile @endlink
         - @link CmdDelete() @c book_delete @endlink
         - @link CmdInfo() @c book_info @endlink
         - @link CmdLoad() @c book_load @endlink
@@ -179,6 +263,7 @@ public:
     // The callback functions are documented in the cpp file
     void CmdAdd(GtpCommand& cmd);
     void CmdClear(GtpCommand& cmd);
+    void CmdCompile(GtpCommand& cmd);
     void CmdDelete(GtpCommand& cmd);
     void CmdInfo(GtpCommand& cmd);
     void CmdLoad(GtpCommand& cmd);
@@ -160,6 +160,9 @@ GoGtpEngine::GoGtpEngine(int fixedBoardSize, const char* programPath,
 
 GoGtpEngine::~GoGtpEngine() noexcept
 {
+#if GTPENGINE_INTERRUPT
+    StopAsyncCommand();
+#endif
     delete m_player;
 }
 
@@ -1317,6 +1320,8 @@ SgPoint GoGtpEngine::GenBookMove(SgBlackWhite toPlay)
         return SG_NULLMOVE;
     if (m_autoBook.get() != 0)
         return m_autoBook->LookupMove(Board());
+    if (m_sharedBook && m_book.NuEntries() == 0 && ! m_book.IsCompiled())
+        return m_sharedBook->LookupMove(Board());
     return m_book.LookupMove(Board());
 }
 
@@ -1549,6 +1554,10 @@ void GoGtpEngine::SetPlayer(GoPlayer* player)
     {
         m_player->UpdateSubscriber();
         m_player->OnNewGame();
+        m_player->SetProgressCallback([this](const std::string& text)
+                                      {
+                                          WriteProgress(text);
+                                      });
     }
     InitStatistics();
 }
@@ -1560,6 +1569,11 @@ void GoGtpEngine::SetNamedRules(const std::string& namedRules)
     RulesChanged();
 }
 
+void GoGtpEngine::SetSharedBook(const std::shared_ptr<const GoBook>& book)
+{
+    m_sharedBook = book;
+}
+
 void GoGtpEngine::StartStatistics()
 {
     m_statisticsValues.clear();
@@ -144,6 +144,14 @@ public:
 
     GoBook& Book();
 
+    /** Use a book shared with other engines.
+        The shared book is used for book moves as long as the own book
+        returned by Book() is empty, e.g. if several engines in the same
+        process play with the same opening book, which is loaded only once.
+        The GTP commands of GoBookCommands only change the own book.
+        @param book The shared book or null to use only the own book. */
+    void SetSharedBook(const std::shared_ptr<const GoBook>& book);
+
     const GoGame& Game() const;
 
     const GoBoard& Board() const;
@@ -386,6 +394,9 @@ private:
 
     GoBook m_book;
 
+    /** See SetSharedBook() */
+    std::shared_ptr<const GoBook> m_sharedBook;
+
     GoBookCommands m_bookCommands;
 
     std::string m_autoSaveFileName;
@@ -56,6 +56,11 @@ void GoPlayer::OnNewGame()
 void GoPlayer::Ponder()
 { }
 
+void GoPlayer::SetProgressCallback(const ProgressCallback& callback)
+{
+    m_progressCallback = callback;
+}
+
 SgNode* GoPlayer::TransferSearchTraces()
 {
     SgNode* node = m_currentNode;
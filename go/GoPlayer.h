@@ -6,6 +6,7 @@
 #ifndef GO_PLAYER_H
 #define GO_PLAYER_H
 
+#include <functional>
 #include <string>
 #include "GoBoard.h"
 #include "GoBoardSynchronizer.h"
@@ -35,6 +36,9 @@ class GoPlayer
     : public GoBoardSynchronizer
 {
 public:
+    /** Function receiving intermediate results during move generation. */
+    typedef std::function<void(const std::string&)> ProgressCallback;
+
     /** Constructor.
         @param bd The external game board. */
     GoPlayer(const GoBoard& bd);
@@ -111,6 +115,17 @@ public:
         Default implementation does nothing and returns immediately. */
     virtual void Ponder();
 
+    /** Set a function for intermediate results of GenMove().
+        Players can pass text like the current best move and search
+        statistics to this function while generating a move. It may be
+        called from a different thread than GenMove().
+        The default implementation only stores the function.
+        @see GetProgressCallback() */
+    virtual void SetProgressCallback(const ProgressCallback& callback);
+
+    /** See SetProgressCallback() */
+    const ProgressCallback& GetProgressCallback() const;
+
     /** See m_variant */
     int Variant() const;
 
@@ -121,6 +136,9 @@ protected:
     /** Node in game tree. Used for appending search traces */
     SgNode* m_currentNode;
 
+    /** See SetProgressCallback() */
+    ProgressCallback m_progressCallback;
+
 private:
     /** See Board() */
     GoBoard m_bd;
@@ -153,6 +171,11 @@ inline SgNode* GoPlayer::CurrentNode() const
     return m_currentNode;
 }
 
+inline const GoPlayer::ProgressCallback& GoPlayer::GetProgressCallback() const
+{
+    return m_progressCallback;
+}
+
 inline int GoPlayer::Variant() const
 {
     return m_variant;
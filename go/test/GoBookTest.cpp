@@ -5,13 +5,18 @@
 
 #include "SgSystem.h"
 
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
 #include <sstream>
 #include <boost/test/unit_test.hpp>
 #include "GoBoard.h"
 #include "GoBoardUtil.h"
 #include "GoBook.h"
+#include "SgException.h"
 
 using std::istringstream;
+using std::string;
 using std::vector;
 using GoBoardUtil::UndoAll;
 using SgPointUtil::Pt;
@@ -131,6 +136,76 @@ BOOST_AUTO_TEST_CASE(GoBookTest_MatchInclToPlay)
     BOOST_REQUIRE_EQUAL(moves.size(), 0u);
 }
 
+/** Test that a compiled book written with WriteBinary() and mapped with
+    Read() gives the same moves as the text book in all orientations. */
+BOOST_AUTO_TEST_CASE(GoBookTest_Compiled)
+{
+    istringstream in("9 C3 C7 E5 | G3 G7\n"
+                     "9 | E5\n");
+    GoBook book;
+    book.Read(in);
+    const string fileName = "GoBookTest_Compiled.bin";
+    {
+        std::ofstream out(fileName.c_str(), std::ios::binary);
+        book.WriteBinary(out);
+        BOOST_REQUIRE(out);
+    }
+    GoBook compiled;
+    compiled.Read(fileName);
+    std::remove(fileName.c_str());
+    BOOST_REQUIRE(compiled.IsCompiled());
+    GoBoard bd(9);
+    vector<SgPoint> moves = compiled.LookupAllMoves(bd);
+    BOOST_REQUIRE_EQUAL(moves.size(), 1u);
+    BOOST_CHECK_EQUAL(moves[0], Pt(5, 5));
+    for (int rot = 0; rot < 8; ++rot)
+    {
+        UndoAll(bd);
+        bd.Play(SgPointUtil::Rotate(rot, Pt(3, 3), 9));
+        bd.Play(SgPointUtil::Rotate(rot, Pt(3, 7), 9));
+        bd.Play(SgPointUtil::Rotate(rot, Pt(5, 5), 9));
+        BOOST_CHECK(compiled.LookupAllMoves(bd) == book.LookupAllMoves(bd));
+        moves = compiled.LookupAllMoves(bd);
+        BOOST_REQUIRE_EQUAL(moves.size(), 2u);
+        BOOST_CHECK_EQUAL(moves[0], SgPointUtil::Rotate(rot, Pt(7, 3), 9));
+        BOOST_CHECK_EQUAL(moves[1], SgPointUtil::Rotate(rot, Pt(7, 7), 9));
+    }
+    bd.SetToPlay(SG_BLACK);
+    BOOST_CHECK(compiled.LookupAllMoves(bd).empty());
+    BOOST_CHECK_THROW(compiled.Add(bd, Pt(1, 1)), SgException);
+}
+
+/** Test that ReadFromDir() prefers the compiled book, unless it is older
+    than the text book. */
+BOOST_AUTO_TEST_CASE(GoBookTest_ReadFromDir)
+{
+    namespace fs = std::filesystem;
+    const fs::path dir = "GoBookTest_ReadFromDir";
+    fs::create_directory(dir);
+    GoBook book;
+    {
+        istringstream in("9 | E5\n");
+        book.Read(in);
+        std::ofstream text((dir / "book.dat").string().c_str());
+        book.Write(text);
+        std::ofstream compiled((dir / "book.bin").string().c_str(),
+                               std::ios::binary);
+        book.WriteBinary(compiled);
+        BOOST_REQUIRE(text && compiled);
+    }
+    const fs::file_time_type time =
+        fs::last_write_time(dir / "book.dat");
+    fs::last_write_time(dir / "book.bin", time + std::chrono::seconds(1));
+    BOOST_CHECK(book.ReadFromDir(dir));
+    BOOST_CHECK(book.IsCompiled());
+    fs::last_write_time(dir / "book.bin", time - std::chrono::seconds(1));
+    BOOST_CHECK(book.ReadFromDir(dir));
+    BOOST_CHECK(! book.IsCompiled());
+    BOOST_CHECK_EQUAL(book.LookupMove(GoBoard(9)), Pt(5, 5));
+    fs::remove_all(dir);
+    BOOST_CHECK(! book.ReadFromDir(dir));
+}
+
 } // namespace
 
 //----------------------------------------------------------------------------
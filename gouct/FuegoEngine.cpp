@@ -5,8 +5,10 @@
 #include "SgSystem.h"
 #include "FuegoEngine.hpp"
 
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
+#include <mutex>
 
 #include "GoInit.h"
 #include "SgInit.h"
@@ -22,6 +24,53 @@
 
 namespace fs = std::filesystem;
 
+namespace {
+
+// Serializes the construction and destruction of engines. Both register
+// and unregister objects in global data, e.g. the random generators of the
+// search (see SgRandom), the assertion handlers (see SgAssertionHandler)
+// and the global tables of SgInit()/GoInit(). Locked before s_initMutex.
+std::mutex s_engineMutex;
+
+// SgInit()/GoInit() set up global tables, which are shared by all engines
+// of the process, so they are only initialized by the first engine and
+// finalized after the last one
+std::mutex s_initMutex;
+
+int s_nuInitRefs = 0;
+
+void InitLibraries()
+{
+    std::lock_guard lock(s_initMutex);
+    if (s_nuInitRefs == 0) {
+        SgInit();
+        try {
+            GoInit();
+        } catch (...) {
+            SgFini();
+            throw;
+        }
+    }
+    ++s_nuInitRefs;
+}
+
+void FiniLibraries() noexcept
+{
+    std::lock_guard lock(s_initMutex);
+    if (--s_nuInitRefs > 0)
+        return;
+    try {
+        GoFini();
+        SgFini();
+    } catch (std::exception const& e) {
+        SgDebug() << "finalization error: " << e.what();
+    } catch (...) {
+        SgDebug() << "unknown finalization error";
+    }
+}
+
+} // namespace
+
 class FuegoEngineImpl : public GoGtpEngine
 {
     using PlayerType = GoUctPlayer<GoUctGlobalSearch<GoUctPlayoutPolicy<GoUctBoard>,
@@ -33,7 +82,8 @@ class FuegoEngineImpl : public GoGtpEngine
     GoUctBookBuilderCommands<PlayerType> m_autoBookCommands;
 
 public:
-    FuegoEngineImpl(fuego_engine_configuration const& cfg)
+    FuegoEngineImpl(fuego_engine_configuration const& cfg,
+                    std::shared_ptr<const GoBook> const& sharedBook)
         : GoGtpEngine(cfg.fixedBoardSize, cfg.programPath.c_str(), false, !cfg.allowHandicap)
         , m_uctCommands(Board(), m_player, Game())
         , m_autoBookCommands(Board(), m_player, m_autoBook)
@@ -51,51 +101,43 @@ public:
         if (cfg.useBook) {
             LoadBook(Book(), SgPlatform::GetProgramDir());
         }
+        SetSharedBook(sharedBook);
 
         if (!cfg.configPath.empty()) {
+            SgUserAbortScope scope(&m_userAbort);
             ExecuteFile(cfg.configPath);
         }
     }
 
-    void LoadBook(GoBook& book, const fs::path& programDir)
+    // user abort flag of the commands of this engine, see
+    // SgSetThreadUserAbortFlag()
+    volatile bool* UserAbortFlag()
+    {
+        return &m_userAbort;
+    }
+
+    void Prewarm(std::size_t treeNodes)
+    {
+        PlayerType* player = dynamic_cast<PlayerType*>(m_player);
+        if (player != nullptr && !player->Search().Reserve(treeNodes))
+            throw SgException("Could not allocate search tree.");
+    }
+
+    static void LoadBook(GoBook& book, const fs::path& programDir)
     {
-        const std::string fileName = "book.dat";
 #ifdef ABS_TOP_SRCDIR
-        if (LoadBookFile(book, path(ABS_TOP_SRCDIR) / "book" / fileName))
+        if (book.ReadFromDir(path(ABS_TOP_SRCDIR) / "book"))
             return;
 #endif
-        if (LoadBookFile(book, programDir / fileName))
+        if (book.ReadFromDir(programDir))
             return;
 #if defined(DATADIR) && defined(PACKAGE)
-        if (LoadBookFile(book, path(DATADIR) / PACKAGE / fileName))
+        if (book.ReadFromDir(path(DATADIR) / PACKAGE))
             return;
 #endif
         throw SgException("Could not find opening book.");
     }
 
-    static bool LoadBookFile(GoBook& book, const fs::path& file)
-    {
-        std::string nativeFile = SgStringUtil::GetNativeFileName(file);
-        SgDebug() << "Loading opening book from '" << nativeFile << "'... ";
-        std::ifstream in(nativeFile.c_str());
-        if (!in)
-        {
-            SgDebug() << "not found\n";
-            return false;
-        }
-        try
-        {
-            book.Read(in);
-        }
-        catch (const SgException& e)
-        {
-            SgDebug() << "error: " << e.what() << '\n';
-            return false;
-        }
-        SgDebug() << "ok\n";
-        return true;
-    }
-
     void CmdAnalyzeCommands(GtpCommand& cmd) override
     {
         GoGtpEngine::CmdAnalyzeCommands(cmd);
@@ -130,6 +172,41 @@ public:
             "these matters, see the files named COPYING and COPYING.LESSER\n";
     }
 
+    // The following functions use the user abort flag of this engine
+    // instead of the global one, so that interrupting a command does not
+    // abort the commands of other engines in the same process. Interrupt()
+    // and StopPonder() are called from a different thread than the command,
+    // so they set the flag directly instead of calling SgSetUserAbort().
+
+    // installs the flag in the thread of the command, which is a new thread
+    // for asynchronous commands
+    void BeforeHandleCommand() override
+    {
+        SgSetThreadUserAbortFlag(&m_userAbort);
+        GoGtpEngine::BeforeHandleCommand();
+    }
+
+    void Interrupt() override
+    {
+        m_userAbort = true;
+    }
+
+    void InitPonder() override
+    {
+        m_userAbort = false;
+    }
+
+    void Ponder() override
+    {
+        SgUserAbortScope scope(&m_userAbort);
+        GoGtpEngine::Ponder();
+    }
+
+    void StopPonder() override
+    {
+        m_userAbort = true;
+    }
+
     static std::string Version()
     {
         std::ostringstream s;
@@ -146,44 +223,147 @@ public:
 #endif
         return s.str();
     }
+
+private:
+    volatile bool m_userAbort = false;
 };
 
 FuegoEngine::FuegoEngine(fuego_engine_configuration const& cfg)
+    : FuegoEngine(cfg, nullptr, true)
+{ }
+
+FuegoEngine::FuegoEngine(fuego_engine_configuration const& cfg,
+                         std::shared_ptr<const GoBook> const& sharedBook)
+    : FuegoEngine(cfg, sharedBook, false)
+{ }
+
+FuegoEngine::FuegoEngine(fuego_engine_configuration const& cfg,
+                         std::shared_ptr<const GoBook> const& sharedBook,
+                         bool setSeed)
 {
-    SgInit();
+    std::lock_guard lock(s_engineMutex);
+    InitLibraries();
     try {
-        GoInit();
-        try {
+        if (setSeed)
             SgRandom::SetSeed(cfg.srand);
-            impl_ = std::make_unique<FuegoEngineImpl>(cfg);
-            assertionHandler_.emplace(*impl_); // noexcept
-        } catch (...) {
-            GoFini();
-            throw;
-        }
+        impl_ = std::make_unique<FuegoEngineImpl>(cfg, sharedBook);
+        assertionHandler_.emplace(*impl_); // noexcept
     } catch (...) {
-        SgFini();
+        FiniLibraries();
         throw;
     }
 }
 
 FuegoEngine::~FuegoEngine()
 {
+    // the commands of FuegoEngineImpl are destroyed before ~GoGtpEngine
+    impl_->StopAsyncCommand();
+    // the flag of a thread that ran commands with MainLoop()
+    if (SgThreadUserAbortFlag() == ImplUserAbortFlag())
+        SgSetThreadUserAbortFlag(nullptr);
+    std::lock_guard lock(s_engineMutex);
     assertionHandler_ = std::nullopt;
     impl_.reset();
+    FiniLibraries();
+}
+
+volatile bool* FuegoEngine::ImplUserAbortFlag()
+{
+    return static_cast<FuegoEngineImpl&>(*impl_).UserAbortFlag();
+}
+
+std::pair<bool, std::string> FuegoEngine::ProcessCommand(std::string_view command) noexcept
+{
+    SgUserAbortScope scope(ImplUserAbortFlag());
+    return impl_->ExecuteCommand(command);
+}
+
+std::shared_ptr<GtpAsyncCommand> FuegoEngine::SubmitCommand(std::string_view command)
+{
+    return impl_->ExecuteCommandAsync(command);
+}
+
+void FuegoEngine::Prewarm(std::size_t treeNodes)
+{
+    static_cast<FuegoEngineImpl&>(*impl_).Prewarm(treeNodes);
+}
+
+FuegoEnginePool::FuegoEnginePool(fuego_engine_configuration const& cfg,
+                                 std::size_t poolSize, std::size_t treeNodes)
+    : cfg_(cfg)
+    , poolSize_(poolSize)
+    , treeNodes_(treeNodes)
+{
+    InitLibraries();
     try {
-        GoFini();
-        SgFini();
-    } catch (std::exception const& e) {
-        SgDebug() << "finalization error: " << e.what();
+        {
+            // the engines of the pool don't change the seed, so that
+            // creating an engine does not reseed the random generators of
+            // engines that are running
+            std::lock_guard lock(s_engineMutex);
+            SgRandom::SetSeed(cfg_.srand);
+        }
+        if (cfg_.useBook) {
+            auto book = std::make_shared<GoBook>();
+            FuegoEngineImpl::LoadBook(*book, SgPlatform::GetProgramDir());
+            book_ = std::move(book);
+            cfg_.useBook = false;
+        }
+        idle_.reserve(poolSize_);
+        while (idle_.size() < poolSize_)
+            idle_.push_back(CreateEngine());
     } catch (...) {
-        SgDebug() << "unknown finalization error";
+        idle_.clear();
+        book_.reset();
+        FiniLibraries();
+        throw;
     }
 }
 
-std::pair<bool, std::string> FuegoEngine::ProcessCommand(std::string_view command) noexcept
+FuegoEnginePool::~FuegoEnginePool()
 {
-    return impl_->ExecuteCommand(command);
+    idle_.clear();
+    // engines that were not released keep the book alive
+    book_.reset();
+    FiniLibraries();
+}
+
+std::unique_ptr<FuegoEngine> FuegoEnginePool::Acquire()
+{
+    {
+        std::lock_guard lock(mutex_);
+        if (!idle_.empty()) {
+            std::unique_ptr<FuegoEngine> engine = std::move(idle_.back());
+            idle_.pop_back();
+            return engine;
+        }
+    }
+    return CreateEngine();
+}
+
+std::unique_ptr<FuegoEngine> FuegoEnginePool::CreateEngine()
+{
+    auto engine = std::make_unique<FuegoEngine>(cfg_, book_);
+    engine->Prewarm(treeNodes_);
+    return engine;
+}
+
+std::size_t FuegoEnginePool::NuIdle() const
+{
+    std::lock_guard lock(mutex_);
+    return idle_.size();
+}
+
+void FuegoEnginePool::Release(std::unique_ptr<FuegoEngine> engine) noexcept
+{
+    if (!engine)
+        return;
+    engine->engine().StopAsyncCommand();
+    if (!engine->ProcessCommand("clear_board").first)
+        return; // e.g. the maximum number of games was reached
+    std::lock_guard lock(mutex_);
+    if (idle_.size() < poolSize_)
+        idle_.push_back(std::move(engine));
 }
 
 #include <cstring>
@@ -233,6 +413,56 @@ void fuego_free_engine(void* cookie)
     delete peng;
 }
 
+fuego_result_descriptor fuego_create_engine_pool(
+    const char* program_path,
+    const char* config_path,
+    int srand,
+    int fixed_board_size,
+    int max_games,
+    int use_book,
+    int allow_handicap,
+    int pool_size,
+    size_t tree_nodes)
+{
+    try {
+        fuego_engine_configuration engine_cfg;
+        engine_cfg.programPath = program_path ? program_path : "";
+        engine_cfg.configPath = config_path ? config_path : "";
+        engine_cfg.srand = srand;
+        engine_cfg.fixedBoardSize = fixed_board_size;
+        engine_cfg.maxGames = max_games;
+        engine_cfg.useBook = !!use_book;
+        engine_cfg.allowHandicap = allow_handicap;
+        return { new FuegoEnginePool(engine_cfg, std::max(pool_size, 0), tree_nodes), 0 };
+    } catch (std::exception const& e) {
+        return { _strdup(e.what()), 1 };
+    } catch (...) {
+        return { _strdup("fatal error, unknown exception"), 1 };
+    }
+}
+
+void fuego_free_engine_pool(void* pool)
+{
+    delete reinterpret_cast<FuegoEnginePool*>(pool);
+}
+
+fuego_result_descriptor fuego_acquire_engine(void* pool)
+{
+    try {
+        return { reinterpret_cast<FuegoEnginePool*>(pool)->Acquire().release(), 0 };
+    } catch (std::exception const& e) {
+        return { _strdup(e.what()), 1 };
+    } catch (...) {
+        return { _strdup("fatal error, unknown exception"), 1 };
+    }
+}
+
+void fuego_release_engine(void* pool, void* cookie)
+{
+    reinterpret_cast<FuegoEnginePool*>(pool)->Release(
+        std::unique_ptr<FuegoEngine>(reinterpret_cast<FuegoEngine*>(cookie)));
+}
+
 fuego_result_descriptor fuego_process_command(void* cookie, const char* cmd, size_t cmdlen)
 {
     FuegoEngine* peng = reinterpret_cast<FuegoEngine*>(cookie);
@@ -246,4 +476,61 @@ fuego_result_descriptor fuego_process_command(void* cookie, const char* cmd, siz
     }
 }
 
+struct fuego_command {
+    std::shared_ptr<GtpAsyncCommand> command;
+};
+
+fuego_result_descriptor fuego_submit_command(void* cookie, const char* cmd, size_t cmdlen,
+                                             fuego_command** command)
+{
+    FuegoEngine* peng = reinterpret_cast<FuegoEngine*>(cookie);
+    *command = nullptr;
+    try {
+        *command = new fuego_command{ peng->SubmitCommand(std::string_view{ cmd, cmdlen }) };
+        return { nullptr, 0 };
+    } catch (GtpFailure const& e) {
+        return { _strdup(e.Response().c_str()), 1 };
+    } catch (std::exception const& e) {
+        return { _strdup(e.what()), 1 };
+    } catch (...) {
+        return { _strdup("fatal error, unknown exception"), 1 };
+    }
+}
+
+int fuego_command_finished(fuego_command* command)
+{
+    return command->command->IsFinished() ? 1 : 0;
+}
+
+int fuego_wait_command(fuego_command* command, int timeout_ms)
+{
+    GtpAsyncCommand& c = *command->command;
+    if (timeout_ms < 0) {
+        c.Wait();
+        return 1;
+    }
+    return c.WaitFor(timeout_ms / 1000.0) ? 1 : 0;
+}
+
+fuego_result_descriptor fuego_read_command_progress(fuego_command* command)
+{
+    return { _strdup(command->command->ReadProgress().c_str()), 0 };
+}
+
+void fuego_cancel_command(fuego_command* command)
+{
+    command->command->Cancel();
+}
+
+fuego_result_descriptor fuego_command_result(fuego_command* command)
+{
+    GtpAsyncCommand& c = *command->command;
+    c.Wait();
+    return { _strdup(c.Response().c_str()), c.Status() ? 0 : 1 };
+}
+
+void fuego_free_command(fuego_command* command)
+{
+    delete command;
+}
 }
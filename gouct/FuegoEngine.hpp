@@ -4,10 +4,13 @@
 
 #pragma once
 
+#include <cstddef>
+#include <mutex>
 #include <string>
 #include <string_view>
 #include <utility>
 #include <optional>
+#include <vector>
 
 #include "GoGtpEngine.h"
 
@@ -24,10 +27,19 @@ struct fuego_engine_configuration
     bool allowHandicap = true;
 };
 
+class FuegoEnginePool;
+
 class FuegoEngine
 {
 public:
+    // sets the random seed cfg.srand, see SgRandom::SetSeed()
     explicit FuegoEngine(fuego_engine_configuration const&);
+    // sharedBook is an opening book shared with other engines, see
+    // GoGtpEngine::SetSharedBook(); usually with useBook = false. Does not
+    // set the random seed, because it would reseed the random generators
+    // of the other engines in the process, see FuegoEnginePool
+    FuegoEngine(fuego_engine_configuration const&,
+                std::shared_ptr<const GoBook> const& sharedBook);
     FuegoEngine(FuegoEngine const&) = delete;
     FuegoEngine& operator=(FuegoEngine const&) = delete;
     ~FuegoEngine();
@@ -37,9 +49,68 @@ public:
     // returns {success, result}
     std::pair<bool, std::string> ProcessCommand(std::string_view command) noexcept;
 
+    // starts executing a command in a separate thread, see
+    // GtpEngine::ExecuteCommandAsync(); throws GtpFailure
+    std::shared_ptr<GtpAsyncCommand> SubmitCommand(std::string_view command);
+
+    // creates the search threads and allocates the search tree of the
+    // player in advance, see SgUctSearch::Reserve()
+    void Prewarm(std::size_t treeNodes);
+
 private:
     std::unique_ptr<GoGtpEngine> impl_;
     std::optional<GoGtpAssertionHandler> assertionHandler_;
+
+    FuegoEngine(fuego_engine_configuration const&,
+                std::shared_ptr<const GoBook> const& sharedBook,
+                bool setSeed);
+
+    volatile bool* ImplUserAbortFlag();
+};
+
+// Pool of engines for running many games in one process.
+// The opening book is loaded once and shared by all engines of the pool
+// (see GoGtpEngine::SetSharedBook()). The pool keeps up to poolSize idle
+// engines, which are created and prewarmed (see FuegoEngine::Prewarm())
+// in advance, so that Acquire() does not need to build a new engine.
+// Release() stops a running command of an engine, clears the board and
+// keeps it for the next Acquire(). Other settings changed with GTP commands
+// (komi, time settings, parameters) are not reset, so clients should set
+// them at the start of each game.
+// The random seed cfg.srand is set once by the constructor of the pool.
+// Acquire() and Release() are thread-safe. The construction and destruction
+// of engines are serialized by a process-wide mutex, because they change
+// global data (e.g. the list of random generators). Engines can be used in
+// parallel in different threads. Each engine has its own user abort flag
+// (see SgSetThreadUserAbortFlag()), so cancelling a command of one engine
+// does not stop the searches of the others. Other global settings, e.g.
+// SgDebug() and the SgRandom::Global() generator, are still shared.
+class FuegoEnginePool
+{
+public:
+    FuegoEnginePool(fuego_engine_configuration const&, std::size_t poolSize,
+                    std::size_t treeNodes);
+    FuegoEnginePool(FuegoEnginePool const&) = delete;
+    FuegoEnginePool& operator=(FuegoEnginePool const&) = delete;
+    ~FuegoEnginePool();
+
+    // returns an idle engine or creates a new one if there is none
+    std::unique_ptr<FuegoEngine> Acquire();
+
+    // returns an engine to the pool; it is deleted if the pool is full
+    void Release(std::unique_ptr<FuegoEngine> engine) noexcept;
+
+    std::size_t NuIdle() const;
+
+private:
+    fuego_engine_configuration cfg_;
+    std::size_t poolSize_;
+    std::size_t treeNodes_;
+    std::shared_ptr<const GoBook> book_;
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<FuegoEngine>> idle_;
+
+    std::unique_ptr<FuegoEngine> CreateEngine();
 };
 
 extern "C" {
@@ -63,4 +134,61 @@ void fuego_free_engine(void* cookie);
 
 fuego_result_descriptor fuego_process_command(void* cookie, const char* cmd, size_t cmdlen);
 
+// Handle of an asynchronous command
+struct fuego_command;
+
+// Asynchronous commands. On success, fuego_submit_command stores a command
+// handle in *command, which must be freed with fuego_free_command, and
+// returns a null result. On failure, *command is set to null and result is
+// the error message. Other commands submitted with fuego_process_command
+// while it runs fail, except for a few informational ones (name,
+// version, ...). fuego_submit_command fails while a command submitted with
+// fuego_process_command runs in another thread.
+fuego_result_descriptor fuego_submit_command(void* cookie, const char* cmd, size_t cmdlen,
+                                             fuego_command** command);
+
+// returns 1 if the command has finished, 0 otherwise
+int fuego_command_finished(fuego_command* command);
+
+// waits until the command has finished or timeout_ms milliseconds have
+// passed (forever if timeout_ms < 0); returns 1 if the command has finished
+int fuego_wait_command(fuego_command* command, int timeout_ms);
+
+// returns the progress text written by the command since the last call,
+// e.g. the best sequence and statistics of a running genmove search
+fuego_result_descriptor fuego_read_command_progress(fuego_command* command);
+
+// cancels the command (aborts the search); the command still returns a
+// response, e.g. the best move found so far
+void fuego_cancel_command(fuego_command* command);
+
+// waits until the command has finished and returns its response
+fuego_result_descriptor fuego_command_result(fuego_command* command);
+
+void fuego_free_command(fuego_command* command);
+
+// Engine pool. fuego_create_engine_pool returns a pool handle in result on
+// success, which must be freed with fuego_free_engine_pool. pool_size
+// engines are created in advance, each with tree_nodes nodes of the search
+// tree allocated. The engines returned by fuego_acquire_engine are used
+// like the ones of fuego_create_engine and returned with
+// fuego_release_engine (or deleted with fuego_free_engine). They may
+// outlive the pool.
+fuego_result_descriptor fuego_create_engine_pool(
+    const char* program_path,
+    const char* config_path,
+    int srand,
+    int fixed_board_size,
+    int max_games,
+    int use_book,
+    int allow_handicap,
+    int pool_size,
+    size_t tree_nodes);
+
+void fuego_free_engine_pool(void* pool);
+
+fuego_result_descriptor fuego_acquire_engine(void* pool);
+
+void fuego_release_engine(void* pool, void* cookie);
+
 }
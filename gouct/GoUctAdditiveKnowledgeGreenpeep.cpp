@@ -11,6 +11,7 @@
 #include <vector>
 #include <climits>
 #include <algorithm>
+#include <mutex>
 
 #include "GoBoardUtil.h"
 #include "SgPlatform.h"
@@ -216,6 +217,24 @@ GoUctAdditiveKnowledgeParamGreenpeep::GoUctAdditiveKnowledgeParamGreenpeep()
     ReadPatterns(m_predictor9x9, m_predictor19x19);
 }
 
+std::shared_ptr<const GoUctAdditiveKnowledgeParamGreenpeep>
+GoUctAdditiveKnowledgeParamGreenpeep::Shared()
+{
+    static std::mutex s_mutex;
+    // Not created with make_shared, which would keep the memory of the
+    // tables until the weak pointer is destroyed
+    static std::weak_ptr<const GoUctAdditiveKnowledgeParamGreenpeep> s_param;
+    std::lock_guard<std::mutex> lock(s_mutex);
+    std::shared_ptr<const GoUctAdditiveKnowledgeParamGreenpeep> param =
+        s_param.lock();
+    if (! param)
+    {
+        param.reset(new GoUctAdditiveKnowledgeParamGreenpeep());
+        s_param = param;
+    }
+    return param;
+}
+
 //----------------------------------------------------------------------------
 
 GoUctAdditiveKnowledgeGreenpeep::GoUctAdditiveKnowledgeGreenpeep(
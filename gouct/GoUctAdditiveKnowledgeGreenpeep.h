@@ -7,6 +7,7 @@
 
 #include "GoUctAdditiveKnowledge.h"
 #include "GoUctPlayoutPolicy.h"
+#include <memory>
 #include <boost/static_assert.hpp>
 
 
@@ -19,12 +20,21 @@ const int NUMPATTERNS19X19 = 1<<24;
 
 //----------------------------------------------------------------------------
 
+/** The predictor tables of GoUctAdditiveKnowledgeGreenpeep.
+    The tables are large (160 MB) and never change after construction, so
+    they should be shared with Shared(). */
 class GoUctAdditiveKnowledgeParamGreenpeep: public GoUctAdditiveKnowledgeParam
 {
 private:
 public:
     GoUctAdditiveKnowledgeParamGreenpeep();
 
+    /** Tables shared by all searches and threads of the process.
+        The tables are built by the first call and released when the last
+        user releases them. Thread-safe. */
+    static std::shared_ptr<const GoUctAdditiveKnowledgeParamGreenpeep>
+    Shared();
+
     unsigned short m_predictor9x9[NUMPATTERNS9X9];
     
     unsigned short m_predictor19x19[NUMPATTERNS19X19];
@@ -9,6 +9,7 @@
 #include <boost/static_assert.hpp>
 #include <algorithm>
 #include "GoBoardUtil.h"
+#include "GoUctRegionTracker.h"
 #include "SgNbIterator.h"
 #include "SgStack.h"
 
@@ -23,12 +24,24 @@ namespace {
     time. */
 const bool CONSISTENCY = false;
 
+/** Index i of a direction with SgNb8Iterator::Direction(i) == dir. */
+int Nb8Index(int dir)
+{
+    for (int i = 0; i < 8; ++i)
+        if (SgNb8Iterator::Direction(i) == dir)
+            return i;
+    SG_ASSERT(false);
+    return -1;
+}
+
 } // namespace
 
 //----------------------------------------------------------------------------
 
 GoUctBoard::GoUctBoard(const GoBoard& bd)
-    : m_const(bd.Size())
+    : m_const(bd.Size()),
+      m_hasPatternCodes(false),
+      m_regionTracker(0)
 {
     m_size = -1;
     Init(bd);
@@ -66,6 +79,16 @@ void GoUctBoard::CheckConsistency() const
             CheckConsistencyBlock(p);
         if (c == SG_EMPTY)
             SG_ASSERT(m_block[p] == 0);
+        if (m_hasPatternCodes && (Line(p) > 1 || Pos(p) > 1))
+        {
+            int code = 0;
+            for (int i = 0; i < 8; ++i)
+            {
+                SgPoint nb = p + SgNb8Iterator::Direction(i);
+                code += m_color[nb] * m_patternWeight[nb][i];
+            }
+            SG_ASSERT(code == m_patternCode[p]);
+        }
     }
 }
 
@@ -270,9 +293,55 @@ void GoUctBoard::Init(const GoBoard& bd)
                 block.m_liberties.PushBack(*it2);
         }
     }
+    if (m_hasPatternCodes)
+        InitPatternCodes();
+    if (m_regionTracker)
+        m_regionTracker->Init(*this);
     CheckConsistency();
 }
 
+void GoUctBoard::InitPatternCodes()
+{
+    m_patternCode.Fill(0);
+    for (Iterator it(*this); it; ++it)
+    {
+        const SgPoint p = *it;
+        const SgArray<int,8>& weight = m_patternWeight[p];
+        for (int i = 0; i < 8; ++i)
+            m_patternCode[p - SgNb8Iterator::Direction(i)] +=
+                m_color[p] * weight[i];
+    }
+}
+
+/** Compute m_patternWeight.
+    The order of the neighbors in the codes must match
+    GoUctPatterns::CodeOf8Neighbors() and
+    GoUctPatterns::CodeOfEdgeNeighbors(). */
+void GoUctBoard::InitPatternWeights()
+{
+    for (SgPoint p = 0; p < SG_MAXPOINT; ++p)
+        m_patternWeight[p].Fill(0);
+    for (Iterator it(*this); it; ++it)
+    {
+        const SgPoint p = *it;
+        if (Line(p) > 1)
+        {
+            int weight = 1;
+            for (int i = 7; i >= 0; --i, weight *= 3)
+                m_patternWeight[p + SgNb8Iterator::Direction(i)][i] = weight;
+        }
+        else if (Pos(p) > 1)
+        {
+            const int up = Up(p);
+            const int other = (up == SG_NS || up == -SG_NS) ? SG_WE : SG_NS;
+            const int dir[5] = { other, up + other, up, up - other, -other };
+            int weight = 1;
+            for (int i = 4; i >= 0; --i, weight *= 3)
+                m_patternWeight[p + dir[i]][Nb8Index(dir[i])] = weight;
+        }
+    }
+}
+
 void GoUctBoard::InitSize(const GoBoard& bd)
 {
     m_size = bd.Size();
@@ -291,6 +360,7 @@ void GoUctBoard::InitSize(const GoBoard& bd)
             m_isBorder[p] = false;
     }
     m_const.ChangeSize(m_size);
+    InitPatternWeights();
 }
 
 void GoUctBoard::NeighborBlocks(SgPoint p, SgBlackWhite c,
@@ -329,6 +399,8 @@ void GoUctBoard::AddStone(SgPoint p, SgBlackWhite c)
     ++nuNeighbors[p - SG_WE];
     ++nuNeighbors[p + SG_WE];
     ++nuNeighbors[p + SG_NS];
+    if (m_hasPatternCodes)
+        UpdatePatternCodes(p, c - SG_EMPTY);
 }
 
 /** Remove liberty from adjacent blocks and kill opponent blocks without
@@ -406,6 +478,8 @@ void GoUctBoard::KillBlock(const Block* block)
         --nuNeighbors[p - SG_WE];
         --nuNeighbors[p + SG_WE];
         --nuNeighbors[p + SG_NS];
+        if (m_hasPatternCodes)
+            UpdatePatternCodes(p, SG_EMPTY - c);
         m_capturedStones.PushBack(p);
         m_block[p] = 0;
     }
@@ -436,6 +510,8 @@ void GoUctBoard::Play(SgPoint p)
             if (NumStones(p) > 1 || NumLiberties(p) > 1)
                 m_koPoint = SG_NULLPOINT;
         SG_ASSERT(HasLiberties(p)); // Suicide not supported by GoUctBoard
+        if (m_regionTracker)
+            m_regionTracker->OnPlay(p, m_toPlay);
     }
     m_secondLastMove = m_lastMove;
     m_lastMove = p;
@@ -443,4 +519,31 @@ void GoUctBoard::Play(SgPoint p)
     CheckConsistency();
 }
 
+void GoUctBoard::SetPatternCodes(bool enable)
+{
+    if (enable && ! m_hasPatternCodes)
+        InitPatternCodes();
+    m_hasPatternCodes = enable;
+}
+
+void GoUctBoard::SetRegionTracker(GoUctRegionTracker* tracker)
+{
+    m_regionTracker = tracker;
+    if (m_regionTracker)
+        m_regionTracker->Init(*this);
+}
+
+void GoUctBoard::UpdatePatternCodes(SgPoint p, int delta)
+{
+    const SgArray<int,8>& weight = m_patternWeight[p];
+    m_patternCode[p + SG_NS + SG_WE] += delta * weight[0];
+    m_patternCode[p + SG_NS] += delta * weight[1];
+    m_patternCode[p + SG_NS - SG_WE] += delta * weight[2];
+    m_patternCode[p + SG_WE] += delta * weight[3];
+    m_patternCode[p - SG_WE] += delta * weight[4];
+    m_patternCode[p - SG_NS + SG_WE] += delta * weight[5];
+    m_patternCode[p - SG_NS] += delta * weight[6];
+    m_patternCode[p - SG_NS - SG_WE] += delta * weight[7];
+}
+
 //----------------------------------------------------------------------------
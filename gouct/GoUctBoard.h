@@ -27,6 +27,7 @@
 //----------------------------------------------------------------------------
 
 class GoUctBoard;
+class GoUctRegionTracker;
 typedef GoNb4Iterator<GoUctBoard> GoUctNbIterator;
 
 //----------------------------------------------------------------------------
@@ -276,6 +277,45 @@ public:
         ignoring any possible repetition. */
     bool CanCapture(SgPoint p, SgBlackWhite c) const;
 
+    /** @name Incremental pattern codes */
+    // @{
+
+    /** Maintain the 3x3 pattern codes of all points incrementally.
+        If enabled, the codes are computed by Init() and updated by Play()
+        for the added and captured stones, so that PatternCode() is a
+        single table lookup. This costs a few additions per stone and is
+        worth it only if a pattern matcher (GoUctPatterns) is used in the
+        playouts. Default is disabled. */
+    void SetPatternCodes(bool enable);
+
+    bool HasPatternCodes() const;
+
+    /** The 3x3 pattern code of a point.
+        For points not on the first line, the code of the 8 neighbors as
+        computed by GoUctPatterns::CodeOf8Neighbors(); for points on the
+        first line, except the corners, the code of the 5 neighbors as
+        computed by GoUctPatterns::CodeOfEdgeNeighbors(). Undefined for
+        corner points.
+        @pre HasPatternCodes() */
+    int PatternCode(SgPoint p) const;
+
+    // @} // @name
+
+    /** @name Incremental regions */
+    // @{
+
+    /** Attach a tracker that maintains the regions of both colors.
+        The tracker is initialized for the current position, re-initialized
+        by Init() and updated by Play(), which costs little for most moves
+        (see GoUctRegionTracker). The board does not own the tracker. Pass
+        null to detach the tracker. Default is no tracker. */
+    void SetRegionTracker(GoUctRegionTracker* tracker);
+
+    /** The attached region tracker or null. */
+    const GoUctRegionTracker* RegionTracker() const;
+
+    // @} // @name
+
     /** Checks whether all the board data structures are in a consistent
         state. */
     void CheckConsistency() const;
@@ -362,6 +402,19 @@ private:
 
     SgArray<bool,SG_MAXPOINT> m_isBorder;
 
+    /** See SetPatternCodes() */
+    bool m_hasPatternCodes;
+
+    /** See PatternCode() */
+    SgArray<int,SG_MAXPOINT> m_patternCode;
+
+    /** Weights of the stones in the pattern codes of their neighbors.
+        m_patternWeight[p][i] is the weight of the color of p in the code of
+        p - SgNb8Iterator::Direction(i), or 0 if that point has no code. */
+    SgArray<SgArray<int,8>,SG_MAXPOINT> m_patternWeight;
+
+    /** See SetRegionTracker() */
+    GoUctRegionTracker* m_regionTracker;
 
 
     void AddLibToAdjBlocks(SgPoint p, SgBlackWhite c);
@@ -370,8 +423,17 @@ private:
 
     void CreateSingleStoneBlock(SgPoint p, SgBlackWhite c);
 
+    void InitPatternCodes();
+
+    void InitPatternWeights();
+
     void InitSize(const GoBoard& bd);
 
+    /** Update the codes of the neighbors of a point that changed its color.
+        @param p The point
+        @param delta The new color minus the old color */
+    void UpdatePatternCodes(SgPoint p, int delta);
+
     bool IsAdjacentTo(SgPoint p, const Block* block) const;
 
     void MergeBlocks(SgPoint p, const SgArrayList<Block*,4>& adjBlocks);
@@ -606,6 +668,18 @@ inline bool GoUctBoard::CapturingMove() const
     return ! m_capturedStones.IsEmpty();
 }
 
+inline bool GoUctBoard::HasPatternCodes() const
+{
+    return m_hasPatternCodes;
+}
+
+inline int GoUctBoard::PatternCode(SgPoint p) const
+{
+    SG_ASSERT(m_hasPatternCodes);
+    SG_ASSERT(IsValidPoint(p));
+    return m_patternCode[p];
+}
+
 inline int GoUctBoard::FirstBoardPoint() const
 {
     return m_const.FirstBoardPoint();
@@ -897,6 +971,11 @@ inline SgGrid GoUctBoard::Pos(SgPoint p) const
     return m_const.Pos(p);
 }
 
+inline const GoUctRegionTracker* GoUctBoard::RegionTracker() const
+{
+    return m_regionTracker;
+}
+
 inline int GoUctBoard::Right(SgPoint p) const
 {
     return m_const.Right(p);
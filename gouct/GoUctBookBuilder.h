@@ -7,6 +7,7 @@
 #include <cmath>
 #include <iostream>
 #include <fstream>
+#include <memory>
 #include <set>
 #include "SgBookBuilder.h"
 #include "SgThreadedWorker.h"
@@ -17,7 +18,10 @@
 //----------------------------------------------------------------------------
 
 /** Expands a Book using the given player to evaluate game positions.
-    Supports multithreaded evaluation of children.
+    Supports multithreaded evaluation of children. In a parallel expansion
+    (see SgBookBuilder::NumParallelExpansions()), each worker evaluates a
+    whole leaf (sorting search and evaluation of its children), so several
+    leaves are expanded at the same time.
     @todo Copy settings from passed player to other players. */
 template<class PLAYER>
 class GoUctBookBuilder : public SgBookBuilder
@@ -105,6 +109,11 @@ protected:
 
     void EvaluateChildren(const std::vector<SgMove>& childrenToDo,
                           std::vector<std::pair<SgMove, float> >& scores);
+
+    void EvaluateLeaves(const std::vector<std::vector<SgMove> >& leaves,
+                        std::size_t count,
+                        std::vector<LeafEvaluation>& evaluations);
+
     void Init();
 
     void StartIteration();
@@ -138,6 +147,27 @@ private:
         PLAYER* m_player;
     };
 
+    /** Copyable worker for EvaluateLeaves().
+        Gets the index of a leaf in m_leaves. */
+    class LeafWorker
+    {
+    public:
+        LeafWorker(GoUctBookBuilder& builder, PLAYER& player);
+
+        LeafEvaluation operator()(const size_t& index);
+
+    private:
+        GoUctBookBuilder* m_builder;
+
+        PLAYER* m_player;
+
+        /** Canonical hash codes of the children, to check if they are
+            already in the book. */
+        std::shared_ptr<GoAutoBookState> m_state;
+
+        float Evaluate(const std::vector<SgMove>& leaf, SgMove move);
+    };
+
     /** Book this builder is expanding */
     GoAutoBook* m_book;
    
@@ -184,9 +214,22 @@ private:
 
     SgThreadedWorker<SgMove,float,Worker>* m_threadedWorker;
 
+    /** Workers for EvaluateLeaves(), using the same players. */
+    std::vector<LeafWorker> m_leafWorkers;
+
+    SgThreadedWorker<size_t,LeafEvaluation,LeafWorker>* m_leafThreadedWorker;
+
+    /** Leaves of the current EvaluateLeaves(). */
+    const std::vector<std::vector<SgMove> >* m_leaves;
+
+    /** Count argument of the current EvaluateLeaves(). */
+    size_t m_leafCount;
+
     void CreateWorkers();
 
     void DestroyWorkers();
+
+    static void SortMoves(PLAYER& player, std::vector<SgMove>& moves);
 };
 
 //----------------------------------------------------------------------------
@@ -263,7 +306,11 @@ GoUctBookBuilder<PLAYER>::GoUctBookBuilder(const GoBoard& bd)
       m_numWorkers(1),
       m_numThreadsPerWorker(1),
       m_numGamesPerEvaluation(10000),
-      m_numGamesPerSort(10000)
+      m_numGamesPerSort(10000),
+      m_threadedWorker(0),
+      m_leafThreadedWorker(0),
+      m_leaves(0),
+      m_leafCount(0)
 {
     SetAlpha(30.0);
     SetExpandWidth(8);
@@ -298,9 +345,12 @@ void GoUctBookBuilder<PLAYER>::CreateWorkers()
 
         m_players.push_back(newPlayer);
         m_workers.push_back(Worker(i, *m_players[i]));
+        m_leafWorkers.push_back(LeafWorker(*this, *m_players[i]));
     }
     m_threadedWorker 
         = new SgThreadedWorker<SgMove,float,Worker>(m_workers);
+    m_leafThreadedWorker = new SgThreadedWorker<size_t,LeafEvaluation,
+                                                LeafWorker>(m_leafWorkers);
 }
 
 /** Destroys copied players, boards, and threads. */
@@ -311,7 +361,9 @@ void GoUctBookBuilder<PLAYER>::DestroyWorkers()
     for (size_t i = 0; i < m_numWorkers; ++i)
         delete m_players[i];
     delete m_threadedWorker;
+    delete m_leafThreadedWorker;
     m_workers.clear();
+    m_leafWorkers.clear();
     m_players.clear();
 }
 
@@ -351,6 +403,65 @@ float GoUctBookBuilder<PLAYER>::Worker::operator()(const SgMove& move)
 
 //----------------------------------------------------------------------------
 
+template<class PLAYER>
+GoUctBookBuilder<PLAYER>::LeafWorker::LeafWorker(GoUctBookBuilder& builder,
+                                                 PLAYER& player)
+    : m_builder(&builder),
+      m_player(&player),
+      m_state(new GoAutoBookState(player.Board()))
+{ }
+
+/** Evaluates a leaf like SgBookBuilder::EvaluateLeaves().
+    Only reads the book, which is not modified while the leaves are
+    evaluated. */
+template<class PLAYER>
+SgBookBuilder::LeafEvaluation
+GoUctBookBuilder<PLAYER>::LeafWorker::operator()(const size_t& index)
+{
+    const std::vector<SgMove>& leaf = (*m_builder->m_leaves)[index];
+    LeafEvaluation evaluation;
+    m_player->SetMaxGames(m_builder->m_numGamesPerSort);
+    Evaluate(leaf, SG_NULLMOVE);
+    std::vector<SgMove> children;
+    SortMoves(*m_player, children);
+    // The board of the player is still in the leaf position
+    m_state->Synchronize();
+    m_player->SetMaxGames(m_builder->m_numGamesPerEvaluation);
+    const size_t limit = std::min(m_builder->m_leafCount, children.size());
+    for (size_t i = 0; i < limit; ++i)
+    {
+        m_state->Play(children[i]);
+        SgBookNode child;
+        const bool isInBook = m_builder->m_book->Get(*m_state, child);
+        m_state->Undo();
+        if (! isInBook)
+            evaluation.m_scores.push_back(
+                              std::make_pair(children[i],
+                                             Evaluate(leaf, children[i])));
+    }
+    return evaluation;
+}
+
+/** Search the position after the moves of the leaf and an optional move.
+    @return The value of the root of the search */
+template<class PLAYER>
+float GoUctBookBuilder<PLAYER>::LeafWorker::Evaluate(
+                                             const std::vector<SgMove>& leaf,
+                                             SgMove move)
+{
+    m_player->UpdateSubscriber();
+    for (size_t i = 0; i < leaf.size(); ++i)
+        m_player->Board().Play(leaf[i]);
+    if (move >= 0)
+        m_player->Board().Play(move);
+    m_player->GenMove(SgTimeRecord(true, 9999), m_player->Board().ToPlay());
+    GoUctSearch& search 
+        = dynamic_cast<GoUctSearch&>(m_player->Search());
+    return static_cast<float>(search.Tree().Root().Mean());
+}
+
+//----------------------------------------------------------------------------
+
 template<class PLAYER>
 inline void GoUctBookBuilder<PLAYER>::SetPlayer(PLAYER& player)
 {
@@ -461,13 +572,25 @@ bool GoUctBookBuilder<PLAYER>::GenerateMoves(size_t count,
     SgDebug() << m_state.Board() << '\n';
     m_players[0]->SetMaxGames(m_numGamesPerSort);
     m_workers[0](SG_NULLMOVE);
+    SortMoves(*m_players[0], moves);
+    SgDebug() << '\n';
+    return false;
+}
+
+/** Moves of the last search of a player, sorted by the count of the
+    search. */
+template<class PLAYER>
+void GoUctBookBuilder<PLAYER>::SortMoves(PLAYER& player,
+                                         std::vector<SgMove>& moves)
+{
     std::vector<std::pair<SgUctValue, SgMove> > ordered;
     // Store counts for each move in vector.
     {
-        const SgUctTree& tree = m_players[0]->Search().Tree();
+        const GoBoard& bd = player.Board();
+        const SgUctTree& tree = player.Search().Tree();
         const SgUctNode& root = tree.Root();
-        for (GoBoard::Iterator it(m_state.Board()); it; ++it)
-            if (m_state.Board().IsLegal(*it))
+        for (GoBoard::Iterator it(bd); it; ++it)
+            if (bd.IsLegal(*it))
             {
                 SgMove move = *it;
                 const SgUctNode* node = 
@@ -482,8 +605,6 @@ bool GoUctBookBuilder<PLAYER>::GenerateMoves(size_t count,
     std::stable_sort(ordered.begin(), ordered.end());
     for (size_t i = 0; i < ordered.size(); ++i)
         moves.push_back(ordered[i].second);
-    SgDebug() << '\n';
-    return false;
 }
 
 template<class PLAYER>
@@ -505,6 +626,25 @@ void GoUctBookBuilder<PLAYER>
     m_threadedWorker->DoWork(childrenToDo, scores);
 }
 
+template<class PLAYER>
+void GoUctBookBuilder<PLAYER>
+::EvaluateLeaves(const std::vector<std::vector<SgMove> >& leaves,
+                 std::size_t count, std::vector<LeafEvaluation>& evaluations)
+{
+    SgDebug() << "Evaluating " << leaves.size() << " leaves\n";
+    m_leaves = &leaves;
+    m_leafCount = count;
+    std::vector<size_t> work;
+    for (size_t i = 0; i < leaves.size(); ++i)
+        work.push_back(i);
+    std::vector<std::pair<size_t, LeafEvaluation> > output;
+    m_leafThreadedWorker->DoWork(work, output);
+    m_leaves = 0;
+    evaluations.assign(leaves.size(), LeafEvaluation());
+    for (size_t i = 0; i < output.size(); ++i)
+        evaluations[output[i].first] = output[i].second;
+}
+
 template<class PLAYER>
 void GoUctBookBuilder<PLAYER>::AfterEvaluateChildren()
 { }
@@ -11,6 +11,7 @@
 #include "GoUctGlobalSearch.h"
 #include "GoUctPlayer.h"
 #include "GoUctBookBuilder.h"
+#include "SgException.h"
 #include "SgGameReader.h"
 
 class GoBoard;
@@ -105,6 +106,8 @@ private:
     GoAutoBookMoveSelectType MoveSelectArg(const GtpCommand& cmd, 
                                            std::size_t number);
 
+    std::unique_ptr<GoAutoBook> OpenBook(const std::string& filename) const;
+
     std::string MoveSelectToString(GoAutoBookMoveSelectType moveSelect);
 };
 
@@ -132,6 +135,7 @@ void GoUctBookBuilderCommands<PLAYER>::AddGoGuiAnalyzeCommands(GtpCommand& cmd)
         "none/AutoBook Expand/autobook_expand %s\n"
         "none/AutoBook Open/autobook_open %r\n"
         "none/AutoBook Save/autobook_save\n"
+        "none/AutoBook Save As/autobook_save %w\n"
         "none/AutoBook Refresh/autobook_refresh\n"
         "none/AutoBook Merge/autobook_merge %r\n"
         "none/AutoBook Load Disabled Lines/autobook_load_disabled_lines %r\n"
@@ -225,6 +229,22 @@ GoAutoBookMoveSelectType GoUctBookBuilderCommands<PLAYER>
     throw GtpFailure() << "unknown move select argument \"" << arg << '"';
 }
 
+/** Open a book for a command.
+    Books in the old text format are only read (see GoAutoBook). */
+template<class PLAYER>
+std::unique_ptr<GoAutoBook>
+GoUctBookBuilderCommands<PLAYER>::OpenBook(const std::string& filename) const
+{
+    try
+    {
+        return std::unique_ptr<GoAutoBook>(new GoAutoBook(filename, m_param));
+    }
+    catch (const SgException& e)
+    {
+        throw GtpFailure(e.what());
+    }
+}
+
 template<class PLAYER>
 std::string GoUctBookBuilderCommands<PLAYER>::
 MoveSelectToString(GoAutoBookMoveSelectType moveSelect)
@@ -275,7 +295,7 @@ void GoUctBookBuilderCommands<PLAYER>::ShowInfluence(GtpCommand& cmd,
 template<class PLAYER>
 void GoUctBookBuilderCommands<PLAYER>::CmdOpen(GtpCommand& cmd)
 {
-    m_book.reset(new GoAutoBook(cmd.Arg(), m_param));
+    m_book = OpenBook(cmd.Arg());
 }
 
 /** Closes the current autobook. */
@@ -286,14 +306,27 @@ void GoUctBookBuilderCommands<PLAYER>::CmdClose(GtpCommand& cmd)
     m_book.reset(0);
 }
 
-/** Saves the current book to its file. */
+/** Saves the current book to its file.
+    With a file name argument, writes a compacted copy of the book to that
+    file instead. This is the only way to convert a book in the old text
+    format, which is never written to its own file implicitly. */
 template<class PLAYER>
 void GoUctBookBuilderCommands<PLAYER>::CmdSave(GtpCommand& cmd)
 {
     if (m_book.get() == 0)
         throw GtpFailure() << "No opened autobook!\n";
-    cmd.CheckArgNone();
-    m_book->Flush();
+    cmd.CheckNuArgLessEqual(1);
+    try
+    {
+        if (cmd.NuArg() == 1)
+            m_book->Save(cmd.Arg(0));
+        else
+            m_book->Flush();
+    }
+    catch (const SgException& e)
+    {
+        throw GtpFailure(e.what());
+    }
 }
 
 /** Returns info on current state. */
@@ -444,8 +477,8 @@ void GoUctBookBuilderCommands<PLAYER>::CmdMerge(GtpCommand& cmd)
 {
     if (m_book.get() == 0)
         throw GtpFailure() << "No opened autobook!\n";
-    GoAutoBook other(cmd.Arg(), m_param);
-    m_book->Merge(other);
+    std::unique_ptr<GoAutoBook> other = OpenBook(cmd.Arg());
+    m_book->Merge(*other);
 }
 
 /** Import values directly into the current book.
@@ -486,11 +519,18 @@ void GoUctBookBuilderCommands<PLAYER>::CmdTruncateByDepth(GtpCommand& cmd)
         throw GtpFailure() << "No opened autobook!\n";
     cmd.CheckNuArg(2);
     int depth = cmd.ArgMin<int>(0, 0);
-    GoAutoBook other(cmd.Arg(1), m_param);
+    std::unique_ptr<GoAutoBook> other = OpenBook(cmd.Arg(1));
     GoAutoBookState state(m_bd);
     state.Synchronize();
-    m_book->TruncateByDepth(depth, state, other);
-    other.Flush();
+    m_book->TruncateByDepth(depth, state, *other);
+    try
+    {
+        other->Flush();
+    }
+    catch (const SgException& e)
+    {
+        throw GtpFailure(e.what());
+    }
 }
 
 template<class PLAYER>
@@ -505,6 +545,8 @@ void GoUctBookBuilderCommands<PLAYER>::CmdParam(GtpCommand& cmd)
             << m_bookBuilder.ExpandThreshold() << '\n'
             << "[string] max_memory " << m_bookBuilder.MaxMemory() << '\n'
             << "[string] num_workers " << m_bookBuilder.NumWorkers() << '\n'
+            << "[string] num_parallel_expansions "
+            << m_bookBuilder.NumParallelExpansions() << '\n'
             << "[string] num_threads_per_worker " << m_bookBuilder.NumThreadsPerWorker() << '\n'
             << "[string] num_games_per_evaluation " 
             << m_bookBuilder.NumGamesPerEvaluation() << '\n'
@@ -522,6 +564,9 @@ void GoUctBookBuilderCommands<PLAYER>::CmdParam(GtpCommand& cmd)
             m_bookBuilder.SetMaxMemory(cmd.ArgMin<std::size_t>(1, 1));
         else if (name == "num_workers")
             m_bookBuilder.SetNumWorkers(cmd.ArgMin<int>(1, 1));
+        else if (name == "num_parallel_expansions")
+            m_bookBuilder.SetNumParallelExpansions(
+                                                cmd.ArgMin<std::size_t>(1, 1));
         else if (name == "num_threads_per_worker")
             m_bookBuilder.SetNumThreadsPerWorker(cmd.ArgMin<int>(1, 1));
         else if (name == "num_games_per_evaluation")
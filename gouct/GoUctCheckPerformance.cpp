@@ -0,0 +1,213 @@
+//----------------------------------------------------------------------------
+/** @file GoUctCheckPerformance.cpp
+    See GoUctCheckPerformance.h */
+//----------------------------------------------------------------------------
+
+#include "SgSystem.h"
+#include "GoUctCheckPerformance.h"
+
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <boost/io/ios_state.hpp>
+#include "GoBoard.h"
+#include "GoUctBoard.h"
+#include "GoUctDefaultMoveFilter.h"
+#include "GoUctGlobalSearch.h"
+#include "SgTimer.h"
+#include "SgWrite.h"
+
+using namespace std;
+
+//----------------------------------------------------------------------------
+
+namespace {
+
+typedef GoUctPlayoutPolicy<GoUctBoard> Policy;
+
+typedef GoUctGlobalSearchState<Policy> State;
+
+/** Add the values of a statistics n times, which gives the statistics of
+    the union of the values. */
+void Merge(SgUctStatistics& statistics, const SgUctStatistics& other)
+{
+    if (other.IsDefined())
+        statistics.Add(other.Mean(), other.Count());
+}
+
+void Merge(GoUctPlayoutPolicyStat& statistics,
+           const GoUctPlayoutPolicyStat& other)
+{
+    statistics.m_nuMoves += other.m_nuMoves;
+    Merge(statistics.m_nonRandLen, other.m_nonRandLen);
+    Merge(statistics.m_moveListLen, other.m_moveListLen);
+    for (size_t i = 0; i < statistics.m_nuMoveType.size(); ++i)
+        statistics.m_nuMoveType[i] += other.m_nuMoveType[i];
+}
+
+/** Play playouts with a state, like the playout phase of
+    SgUctSearch::PlayGame(). */
+void RunThread(State& state, size_t nuPlayouts, size_t maxGameLength,
+               GoUctCheckPerformance::PlayoutResult& result)
+{
+    for (size_t i = 0; i < nuPlayouts; ++i)
+    {
+        state.GameStart();
+        state.StartPlayouts();
+        state.StartPlayout();
+        size_t nuMoves = 0;
+        while (nuMoves < maxGameLength)
+        {
+            bool skipRaveUpdate;
+            SgMove move = state.GeneratePlayoutMove(skipRaveUpdate);
+            if (move == SG_NULLMOVE)
+                break;
+            state.ExecutePlayout(move);
+            ++nuMoves;
+        }
+        SgUctValue eval = state.Evaluate();
+        bool isBlackToPlay = (state.UctBoard().ToPlay() == SG_BLACK);
+        if ((eval > 0.5) == isBlackToPlay)
+            ++result.m_nuBlackWins;
+        state.EndPlayout();
+        state.TakeBackPlayout(nuMoves);
+        ++result.m_nuPlayouts;
+        result.m_nuMoves += nuMoves;
+    }
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------
+
+GoUctCheckPerformance::PlayoutResult::PlayoutResult()
+{
+    Clear();
+}
+
+void GoUctCheckPerformance::PlayoutResult::Clear()
+{
+    m_nuPlayouts = 0;
+    m_nuMoves = 0;
+    m_nuBlackWins = 0;
+    m_time = 0;
+    m_statistics[SG_BLACK].Clear();
+    m_statistics[SG_WHITE].Clear();
+}
+
+void GoUctCheckPerformance::PlayoutResult::Merge(const PlayoutResult& result)
+{
+    m_nuPlayouts += result.m_nuPlayouts;
+    m_nuMoves += result.m_nuMoves;
+    m_nuBlackWins += result.m_nuBlackWins;
+    m_time += result.m_time;
+    ::Merge(m_statistics[SG_BLACK], result.m_statistics[SG_BLACK]);
+    ::Merge(m_statistics[SG_WHITE], result.m_statistics[SG_WHITE]);
+}
+
+double GoUctCheckPerformance::PlayoutResult::MovesPerSecond() const
+{
+    return m_time > 0 ? double(m_nuMoves) / m_time : 0;
+}
+
+double GoUctCheckPerformance::PlayoutResult::PlayoutsPerSecond() const
+{
+    return m_time > 0 ? double(m_nuPlayouts) / m_time : 0;
+}
+
+void GoUctCheckPerformance::PlayoutResult::Write(std::ostream& out,
+                                                 bool writeStatistics) const
+{
+    boost::io::ios_all_saver saver(out);
+    out << SgWriteLabel("Playouts") << m_nuPlayouts << '\n'
+        << SgWriteLabel("Moves") << m_nuMoves << '\n'
+        << SgWriteLabel("Time") << fixed << setprecision(2) << m_time << '\n'
+        << SgWriteLabel("Playouts/s") << setprecision(1)
+        << PlayoutsPerSecond() << '\n'
+        << SgWriteLabel("Moves/s") << MovesPerSecond() << '\n'
+        << SgWriteLabel("Moves/playout")
+        << (m_nuPlayouts > 0 ? double(m_nuMoves) / double(m_nuPlayouts) : 0)
+        << '\n'
+        << SgWriteLabel("BlackWins")
+        << (m_nuPlayouts > 0 ?
+            100.0 * double(m_nuBlackWins) / double(m_nuPlayouts) : 0)
+        << "%\n";
+    if (writeStatistics)
+    {
+        out << "Black statistics:\n";
+        m_statistics[SG_BLACK].Write(out);
+        out << "White statistics:\n";
+        m_statistics[SG_WHITE].Write(out);
+    }
+}
+
+GoUctCheckPerformance::PlayoutResult
+GoUctCheckPerformance::RunPlayouts(const GoBoard& bd,
+                                   const GoUctPlayoutPolicyParam& param,
+                                   std::size_t nuPlayouts,
+                                   std::size_t nuThreads)
+{
+    SG_ASSERT(nuThreads > 0);
+    GoUctGlobalSearchStateParam stateParam;
+    stateParam.m_mercyRule = false;
+    stateParam.m_territoryStatistics = false;
+    GoUctDefaultMoveFilterParam treeFilterParam;
+    SgBWSet safe;
+    SgPointArray<bool> allSafe(false);
+    vector<unique_ptr<State> > states;
+    for (size_t i = 0; i < nuThreads; ++i)
+    {
+        unique_ptr<State> state(new State(static_cast<unsigned int>(i), bd,
+                                          0, stateParam, param,
+                                          treeFilterParam, safe, allSafe));
+        state->SetPolicy(new Policy(state->UctBoard(), param));
+        state->StartSearch();
+        states.push_back(std::move(state));
+    }
+    // Only simple ko is checked in the playouts, limit the length to stop
+    // playouts caught in a superko cycle
+    const size_t maxGameLength = 3 * size_t(bd.Size() * bd.Size());
+    vector<PlayoutResult> results(nuThreads);
+    vector<exception_ptr> exceptions(nuThreads);
+    SgTimer timer;
+    vector<thread> threads;
+    for (size_t i = 1; i < nuThreads; ++i)
+        threads.emplace_back([&, i]()
+        {
+            try
+            {
+                RunThread(*states[i], nuPlayouts / nuThreads
+                          + (i < nuPlayouts % nuThreads ? 1 : 0),
+                          maxGameLength, results[i]);
+            }
+            catch (...)
+            {
+                exceptions[i] = current_exception();
+            }
+        });
+    RunThread(*states[0], nuPlayouts / nuThreads
+              + (nuPlayouts % nuThreads > 0 ? 1 : 0),
+              maxGameLength, results[0]);
+    for (size_t i = 0; i < threads.size(); ++i)
+        threads[i].join();
+    double time = timer.GetTime();
+    for (size_t i = 0; i < nuThreads; ++i)
+        if (exceptions[i])
+            rethrow_exception(exceptions[i]);
+    PlayoutResult result;
+    for (size_t i = 0; i < nuThreads; ++i)
+    {
+        results[i].m_statistics[SG_BLACK] =
+            states[i]->Policy()->Statistics(SG_BLACK);
+        results[i].m_statistics[SG_WHITE] =
+            states[i]->Policy()->Statistics(SG_WHITE);
+        result.Merge(results[i]);
+    }
+    result.m_time = time;
+    return result;
+}
+
+//----------------------------------------------------------------------------
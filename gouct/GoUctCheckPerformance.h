@@ -0,0 +1,91 @@
+//----------------------------------------------------------------------------
+/** @file GoUctCheckPerformance.h
+    Check performance of the playouts of GoUctGlobalSearch.
+
+    The checks run playouts with GoUctPlayoutPolicy<GoUctBoard> from a given
+    position without a search tree, so that the measured time is dominated by
+    GoUctBoard and the playout policy. They are used by the benchmark program
+    fuego_bench to detect performance regressions. */
+//----------------------------------------------------------------------------
+
+#ifndef GOUCT_CHECKPERFORMANCE_H
+#define GOUCT_CHECKPERFORMANCE_H
+
+#include <cstddef>
+#include <iosfwd>
+#include "GoUctPlayoutPolicy.h"
+#include "SgBWArray.h"
+
+class GoBoard;
+
+//----------------------------------------------------------------------------
+
+namespace GoUctCheckPerformance
+{
+
+/** Result of RunPlayouts(). */
+struct PlayoutResult
+{
+    std::size_t m_nuPlayouts;
+
+    /** Number of moves played in all playouts. */
+    std::size_t m_nuMoves;
+
+    /** Number of playouts won by Black. */
+    std::size_t m_nuBlackWins;
+
+    /** Wall clock time in seconds. */
+    double m_time;
+
+    /** Statistics of the playout policies of all threads.
+        Only collected if GoUctPlayoutPolicyParam::m_statisticsEnabled. */
+    SgBWArray<GoUctPlayoutPolicyStat> m_statistics;
+
+    PlayoutResult();
+
+    void Clear();
+
+    /** Add the counts of another result.
+        The time is added too, so the result of several positions run
+        one after the other has the total time. */
+    void Merge(const PlayoutResult& result);
+
+    double PlayoutsPerSecond() const;
+
+    double MovesPerSecond() const;
+
+    /** Write the counts and rates.
+        @verbatim
+        Playouts       10000
+        Moves          1102341
+        Time           1.52
+        Playouts/s     6578.9
+        Moves/s        725224.3
+        Moves/playout  110.2
+        BlackWins      48.3%
+        @endverbatim
+        @param out The stream
+        @param writeStatistics Also write the statistics of the playout
+        policy of both colors */
+    void Write(std::ostream& out, bool writeStatistics) const;
+};
+
+/** Run playouts from a position.
+    Each thread has its own GoUctGlobalSearchState and playout policy and
+    plays its share of the playouts from the position with the move
+    generation of the playout phase of GoUctGlobalSearch (mercy rule and
+    territory statistics disabled). Creating the states is not included in
+    the measured time.
+    @param bd The position
+    @param param The parameters of the playout policy
+    @param nuPlayouts The total number of playouts
+    @param nuThreads The number of threads */
+PlayoutResult RunPlayouts(const GoBoard& bd,
+                          const GoUctPlayoutPolicyParam& param,
+                          std::size_t nuPlayouts, std::size_t nuThreads);
+
+} // namespace GoUctCheckPerformance
+
+//----------------------------------------------------------------------------
+
+#endif // GOUCT_CHECKPERFORMANCE_H
@@ -49,6 +49,7 @@ bool IsBlockedInDeterministicMode(const string& name)
 	return name == "ignore_clock"
     	|| name == "reuse_subtree"
         || name == "number_threads"
+        || name == "expand_threads"
         || name == "max_nodes"
         ;
 }
@@ -136,6 +137,34 @@ string MoveSelectToString(SgUctMoveSelect moveSelect)
     }
 }
 
+SgUctThreadAffinity ThreadAffinityArg(const GtpCommand& cmd, size_t number)
+{
+    string arg = cmd.ArgToLower(number);
+    if (arg == "none")
+        return SG_UCTTHREADAFFINITY_NONE;
+    if (arg == "compact")
+        return SG_UCTTHREADAFFINITY_COMPACT;
+    if (arg == "scatter")
+        return SG_UCTTHREADAFFINITY_SCATTER;
+    throw GtpFailure() << "unknown thread affinity argument \"" << arg << '"';
+}
+
+string ThreadAffinityToString(SgUctThreadAffinity affinity)
+{
+    switch (affinity)
+    {
+    case SG_UCTTHREADAFFINITY_NONE:
+        return "none";
+    case SG_UCTTHREADAFFINITY_COMPACT:
+        return "compact";
+    case SG_UCTTHREADAFFINITY_SCATTER:
+        return "scatter";
+    default:
+        SG_ASSERT(false);
+        return "?";
+    }
+}
+
 GoUctGlobalSearchMode SearchModeArg(const GtpCommand& cmd, size_t number)
 {
     string arg = cmd.ArgToLower(number);
@@ -318,6 +347,7 @@ void GoUctCommands::AddGoGuiAnalyzeCommands(GtpCommand& cmd)
         "none/Uct SaveGames/uct_savegames %w\n"
         "none/Uct SaveTree/uct_savetree %w\n"
         "gfx/Uct Sequence/uct_sequence\n"
+        "hstring/Uct Stat Phases/uct_stat_phases\n"
         "hstring/Uct Stat Player/uct_stat_player\n"
         "none/Uct Stat Player Clear/uct_stat_player_clear\n"
         "hstring/Uct Stat Policy/uct_stat_policy\n"
@@ -611,6 +641,7 @@ void GoUctCommands::CmdParamGlobalSearch(GtpCommand& cmd)
     @arg @c ignore_clock See GoUctPlayer::IgnoreClock
     @arg @c ponder See GoUctPlayer::EnablePonder
     @arg @c reuse_subtree See GoUctPlayer::ReuseSubtree
+    @arg @c reuse_subtree_in_place See GoUctPlayer::ReuseSubtreeInPlace
     @arg @c use_root_filter See GoUctPlayer::UseRootFilter
     @arg @c max_games See GoUctPlayer::MaxGames
     @arg @c max_ponder_time See GoUctPlayer::MaxPonderTime
@@ -631,6 +662,8 @@ void GoUctCommands::CmdParamPlayer(GtpCommand& cmd)
             << "[bool] ignore_clock " << p.IgnoreClock() << '\n'
             << "[bool] ponder " << p.EnablePonder() << '\n'
             << "[bool] reuse_subtree " << p.ReuseSubtree() << '\n'
+            << "[bool] reuse_subtree_in_place " << p.ReuseSubtreeInPlace()
+            << '\n'
             << "[bool] use_root_filter " << p.UseRootFilter() << '\n'
             << "[string] max_games " << p.MaxGames() << '\n'
             << "[string] max_ponder_time " << p.MaxPonderTime() << '\n'
@@ -660,6 +693,8 @@ void GoUctCommands::CmdParamPlayer(GtpCommand& cmd)
             p.SetEnablePonder(cmd.Arg<bool>(1));
         else if (name == "reuse_subtree")
             p.SetReuseSubtree(cmd.Arg<bool>(1));
+        else if (name == "reuse_subtree_in_place")
+            p.SetReuseSubtreeInPlace(cmd.Arg<bool>(1));
         else if (name == "use_root_filter")
             p.SetUseRootFilter(cmd.Arg<bool>(1));
         else if (name == "max_games")
@@ -692,7 +727,9 @@ void GoUctCommands::CmdParamPlayer(GtpCommand& cmd)
     @arg @c nakade_heuristic
         See GoUctPlayoutPolicyParam::m_useNakadeHeuristic
     @arg @c fillboard_tries
-        See GoUctPlayoutPolicyParam::m_fillboardTries */
+        See GoUctPlayoutPolicyParam::m_fillboardTries
+    @arg @c incremental_pattern_codes
+        See GoUctPlayoutPolicyParam::m_incrementalPatternCodes */
 void GoUctCommands::CmdParamPolicy(GtpCommand& cmd)
 {
     cmd.CheckNuArgLessEqual(2);
@@ -701,7 +738,9 @@ void GoUctCommands::CmdParamPolicy(GtpCommand& cmd)
     {
         // Boolean parameters first for better layout of GoGui parameter
         // dialog, alphabetically otherwise
-        cmd << "[bool] nakade_heuristic " << p.m_useNakadeHeuristic << '\n'
+        cmd << "[bool] incremental_pattern_codes "
+            << p.m_incrementalPatternCodes << '\n'
+            << "[bool] nakade_heuristic " << p.m_useNakadeHeuristic << '\n'
             << "[bool] statistics_enabled " << p.m_statisticsEnabled << '\n'
             << "[bool] use_patterns_in_playout " 
             << p.m_usePatternsInPlayout << '\n'
@@ -719,7 +758,9 @@ void GoUctCommands::CmdParamPolicy(GtpCommand& cmd)
     else if (cmd.NuArg() == 2)
     {
         string name = cmd.Arg(0);
-        if (name == "nakade_heuristic")
+        if (name == "incremental_pattern_codes")
+            p.m_incrementalPatternCodes = cmd.Arg<bool>(1);
+        else if (name == "nakade_heuristic")
             p.m_useNakadeHeuristic = cmd.Arg<bool>(1);
         else if (name == "statistics_enabled")
             p.m_statisticsEnabled = cmd.Arg<bool>(1);
@@ -841,12 +882,17 @@ void GoUctCommands::CmdParamTreeFilter(GtpCommand& cmd)
     @arg @c keep_games See GoUctSearch::KeepGames
     @arg @c lock_free See SgUctSearch::LockFree
     @arg @c log_games See SgUctSearch::LogGames
+    @arg @c phase_statistics See SgUctSearch::PhaseStatistics
     @arg @c prune_full_tree See SgUctSearch::PruneFullTree
     @arg @c rave See SgUctSearch::Rave
     @arg @c weight_rave_updates SgUctSearch::WeightRaveUpdates
+    @arg @c analyze_interval See SgUctSearch::AnalyzeInterval
+    @arg @c analyze_moves See SgUctSearch::AnalyzeMoves
     @arg @c bias_term_constant See SgUctSearch::BiasTermConstant
     @arg @c bias_term_frequency See SgUctSearch::BiasTermFrequency
     @arg @c expand_threshold See SgUctSearch::ExpandThreshold
+    @arg @c expand_batch_size See SgUctSearch::ExpandBatchSize
+    @arg @c expand_threads See SgUctSearch::NumberExpandThreads
     @arg @c first_play_urgency See SgUctSearch::FirstPlayUrgency
     @arg @c knowledge_threshold See SgUctSearch::KnowledgeThreshold
     @arg @c live_gfx @c none|counts|sequence See GoUctSearch::LiveGfx
@@ -857,7 +903,10 @@ void GoUctCommands::CmdParamTreeFilter(GtpCommand& cmd)
     @arg @c number_playouts See SgUctSearch::NumberPlayouts
     @arg @c prune_min_count See SgUctSearch::PruneMinCount
     @arg @c rave_weight_final See SgUctSearch::RaveWeightFinal
-    @arg @c rave_weight_initial See SgUctSearch::RaveWeightInitial */
+    @arg @c rave_weight_initial See SgUctSearch::RaveWeightInitial
+    @arg @c thread_affinity @c none|compact|scatter See
+    SgUctSearch::ThreadAffinity
+    @arg @c transposition_table_size See SgUctSearch::TranspositionTableSize */
 void GoUctCommands::CmdParamSearch(GtpCommand& cmd)
 {
     cmd.CheckNuArgLessEqual(2);
@@ -871,6 +920,7 @@ void GoUctCommands::CmdParamSearch(GtpCommand& cmd)
             << "[bool] keep_games " << s.KeepGames() << '\n'
             << "[bool] lock_free " << s.LockFree() << '\n'
             << "[bool] log_games " << s.LogGames() << '\n'
+            << "[bool] phase_statistics " << s.PhaseStatistics() << '\n'
             << "[bool] prune_full_tree " << s.PruneFullTree() << '\n'
             << "[bool] rave " << s.Rave() << '\n'
             << "[bool] update_multiple_playouts_as_single " 
@@ -881,10 +931,14 @@ void GoUctCommands::CmdParamSearch(GtpCommand& cmd)
             << s.AdditiveKnowledge().KnowledgeWeight() << '\n'
             << "[string] additive_predictor_decay " 
             << s.AdditiveKnowledge().PredictorDecay() << '\n'
+            << "[string] analyze_interval " << s.AnalyzeInterval() << '\n'
+            << "[string] analyze_moves " << s.AnalyzeMoves() << '\n'
             << "[string] bias_term_constant " << s.BiasTermConstant() << '\n'
             << "[string] bias_term_frequency "
             << s.BiasTermFrequency() << '\n'
             << "[string] bias_term_depth " << s.BiasTermDepth() << '\n'
+            << "[string] expand_batch_size " << s.ExpandBatchSize() << '\n'
+            << "[string] expand_threads " << s.NumberExpandThreads() << '\n'
             << "[string] expand_threshold " << s.ExpandThreshold() << '\n'
             << "[string] first_play_urgency " << s.FirstPlayUrgency() << '\n'
             << "[string] knowledge_threshold "
@@ -905,6 +959,10 @@ void GoUctCommands::CmdParamSearch(GtpCommand& cmd)
             << "[string] rave_weight_final " << s.RaveWeightFinal() << '\n'
             << "[string] rave_weight_initial "
             << s.RaveWeightInitial() << '\n'
+            << "[list/none/compact/scatter] thread_affinity "
+            << ThreadAffinityToString(s.ThreadAffinity()) << '\n'
+            << "[string] transposition_table_size "
+            << s.TranspositionTableSize() << '\n'
             ;
     }
     else if (cmd.NuArg() == 2)
@@ -920,6 +978,10 @@ void GoUctCommands::CmdParamSearch(GtpCommand& cmd)
         	s.AdditiveKnowledge().SetKnowledgeWeight(cmd.Arg<float>(1));
         else if (name == "additive_predictor_decay")
             s.AdditiveKnowledge().SetPredictorDecay(cmd.Arg<float>(1));
+        else if (name == "analyze_interval")
+            s.SetAnalyzeInterval(cmd.ArgMin<double>(1, 0));
+        else if (name == "analyze_moves")
+            s.SetAnalyzeMoves(cmd.ArgMin<size_t>(1, 1));
         else if (name == "bias_term_constant")
             s.SetBiasTermConstant(cmd.Arg<float>(1));
         else if (name == "bias_term_frequency")
@@ -928,6 +990,10 @@ void GoUctCommands::CmdParamSearch(GtpCommand& cmd)
             s.SetBiasTermDepth((int)cmd.Arg<size_t>(1));
         else if (name == "check_float_precision")
             s.SetCheckFloatPrecision(cmd.Arg<bool>(1));
+        else if (name == "expand_batch_size")
+            s.SetExpandBatchSize(cmd.ArgMin<size_t>(1, 1));
+        else if (name == "expand_threads")
+            s.SetNumberExpandThreads(cmd.Arg<size_t>(1));
         else if (name == "expand_threshold")
             s.SetExpandThreshold(cmd.ArgMin<SgUctValue>(1, 0));
         else if (name == "first_play_urgency")
@@ -954,6 +1020,8 @@ void GoUctCommands::CmdParamSearch(GtpCommand& cmd)
              s.SetNumberThreads(cmd.ArgMin<unsigned int>(1, 1));
         else if (name == "number_playouts")
             s.SetNumberPlayouts(cmd.ArgMin<int>(1, 1));
+        else if (name == "phase_statistics")
+            s.SetPhaseStatistics(cmd.Arg<bool>(1));
         else if (name == "prune_full_tree")
             s.SetPruneFullTree(cmd.Arg<bool>(1));
         else if (name == "prune_min_count")
@@ -966,6 +1034,10 @@ void GoUctCommands::CmdParamSearch(GtpCommand& cmd)
             s.SetRaveWeightFinal(cmd.Arg<float>(1));
         else if (name == "rave_weight_initial")
             s.SetRaveWeightInitial(cmd.Arg<float>(1));
+        else if (name == "thread_affinity")
+            s.SetThreadAffinity(ThreadAffinityArg(cmd, 1));
+        else if (name == "transposition_table_size")
+            s.SetTranspositionTableSize(cmd.Arg<size_t>(1));
         else if (name == "update_multiple_playouts_as_single")
             s.SetUpdateMultiplePlayoutsAsSingle(cmd.Arg<bool>(1));
         else if (name == "virtual_loss")
@@ -1154,6 +1226,28 @@ void GoUctCommands::CmdSequence(GtpCommand& cmd)
     GoUctUtil::GfxSequence(Search(), Search().ToPlay(), cmd);
 }
 
+/** Write the time spent in the phases of the games of the last search.
+    Arguments: optional @c raw for the machine-readable format <br>
+    Requires that the search parameter @c phase_statistics was enabled
+    during the search.
+    @see SgUctSearch::WritePhaseStatistics() */
+void GoUctCommands::CmdStatPhases(GtpCommand& cmd)
+{
+    cmd.CheckNuArgLessEqual(1);
+    bool raw = false;
+    if (cmd.NuArg() == 1)
+    {
+        if (cmd.ArgToLower(0) != "raw")
+            throw GtpFailure() << "unknown argument \"" << cmd.Arg(0) << '"';
+        raw = true;
+    }
+    const GoUctSearch& search = Search();
+    if (! search.PhaseStatistics())
+        throw GtpFailure("phase statistics not enabled"
+                         " (uct_param_search phase_statistics 1)");
+    search.WritePhaseStatistics(cmd, raw);
+}
+
 /** Write statistics of GoUctPlayer.
     Arguments: none
     @see GoUctPlayer::Statistics */
@@ -1541,6 +1635,7 @@ void GoUctCommands::Register(GtpEngine& e)
     Register(e, "uct_savetree", &GoUctCommands::CmdSaveTree);
     Register(e, "uct_sequence", &GoUctCommands::CmdSequence);
     Register(e, "uct_score", &GoUctCommands::CmdScore);
+    Register(e, "uct_stat_phases", &GoUctCommands::CmdStatPhases);
     Register(e, "uct_stat_player", &GoUctCommands::CmdStatPlayer);
     Register(e, "uct_stat_player_clear", &GoUctCommands::CmdStatPlayerClear);
     Register(e, "uct_stat_policy", &GoUctCommands::CmdStatPolicy);
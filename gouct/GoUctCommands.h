@@ -80,6 +80,7 @@ public:
         - @link CmdSaveTree() @c uct_savetree @endlink
         - @link CmdSequence() @c uct_sequence @endlink
         - @link CmdScore() @c uct_score @endlink
+        - @link CmdStatPhases() @c uct_stat_phases @endlink
         - @link CmdStatPlayer() @c uct_stat_player @endlink
         - @link CmdStatPlayerClear() @c uct_stat_player_clear @endlink
         - @link CmdStatPolicy() @c uct_stat_policy @endlink
@@ -121,6 +122,7 @@ public:
     void CmdSaveTree(GtpCommand& cmd);
     void CmdScore(GtpCommand& cmd);
     void CmdSequence(GtpCommand& cmd);
+    void CmdStatPhases(GtpCommand& cmd);
     void CmdStatPlayer(GtpCommand& cmd);
     void CmdStatPlayerClear(GtpCommand& cmd);
     void CmdStatPolicy(GtpCommand& cmd);
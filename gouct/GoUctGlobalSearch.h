@@ -154,6 +154,10 @@ public:
     /** Generates all legal moves with no knowledge values. */
     void GenerateLegalMoves(std::vector<SgUctMoveInfo>& moves);
 
+    /** Generates the legal moves without filter and prior knowledge. */
+    void GenerateLeafMoves(std::vector<SgUctMoveInfo>& moves,
+                           SgUctProvenType& provenType);
+
     SgMove GeneratePlayoutMove(bool& skipRaveUpdate);
 
     void ExecutePlayout(SgMove move);
@@ -518,6 +522,15 @@ bool GoUctGlobalSearchState<POLICY>::GenerateAllMoves(SgUctValue count,
     return false;
 }
 
+template<class POLICY>
+void GoUctGlobalSearchState<POLICY>::GenerateLeafMoves(
+                                             std::vector<SgUctMoveInfo>& moves,
+                                             SgUctProvenType& provenType)
+{
+    provenType = SG_NOT_PROVEN;
+    GenerateLegalMoves(moves);
+}
+
 template<class POLICY>
 SgMove GoUctGlobalSearchState<POLICY>::GeneratePlayoutMove(
                                                          bool& skipRaveUpdate)
@@ -604,6 +617,7 @@ template<class POLICY>
 void GoUctGlobalSearchState<POLICY>::StartSearch()
 {
     GoUctState::StartSearch();
+    SetPatternCodes(m_policyParam.m_incrementalPatternCodes);
     const GoBoard& bd = Board();
     const int size = bd.Size();
     const float maxScore = float(size * size) + std::abs(GetKomi());
@@ -15,20 +15,17 @@
 //----------------------------------------------------------------------------
 GoUctKnowledgeFactory::GoUctKnowledgeFactory(
     const GoUctPlayoutPolicyParam& param) :
-    m_greenpeepParam(0),
     m_param(param)
 { }
 
 GoUctKnowledgeFactory::~GoUctKnowledgeFactory()
-{
-	if (m_greenpeepParam)
-    	delete m_greenpeepParam;
-}
+{ }
 
-GoUctAdditiveKnowledgeParamGreenpeep& GoUctKnowledgeFactory::GreenpeepParam()
+const GoUctAdditiveKnowledgeParamGreenpeep&
+GoUctKnowledgeFactory::GreenpeepParam()
 {
 	if (! m_greenpeepParam)
-    	m_greenpeepParam = new GoUctAdditiveKnowledgeParamGreenpeep();
+    	m_greenpeepParam = GoUctAdditiveKnowledgeParamGreenpeep::Shared();
     return *m_greenpeepParam;
 }
 
@@ -7,6 +7,7 @@
 #ifndef GOUCT_KNOWLEDGE_FACTORY_H
 #define GOUCT_KNOWLEDGE_FACTORY_H
 
+#include <memory>
 #include "GoBoard.h"
 #include "GoUctAdditiveKnowledgeGreenpeep.h"
 
@@ -19,10 +20,13 @@ public:
 
     GoUctAdditiveKnowledge* Create(const GoBoard& bd);
 
-    GoUctAdditiveKnowledgeParamGreenpeep& GreenpeepParam();
+    /** The Greenpeep tables, shared with all other factories.
+        See GoUctAdditiveKnowledgeParamGreenpeep::Shared() */
+    const GoUctAdditiveKnowledgeParamGreenpeep& GreenpeepParam();
 
 private:
-    GoUctAdditiveKnowledgeParamGreenpeep* m_greenpeepParam; 
+    std::shared_ptr<const GoUctAdditiveKnowledgeParamGreenpeep>
+    m_greenpeepParam;
 
     /** The param used for additive knowledge */
     const GoUctPlayoutPolicyParam& m_param;
@@ -0,0 +1,525 @@
+//----------------------------------------------------------------------------
+/** @file GoUctPatternTables.h
+    Lookup tables for the hard-coded MoGo patterns of GoUctPatterns,
+    generated at compile time. */
+//----------------------------------------------------------------------------
+
+#pragma once
+
+#include <array>
+#include <utility>
+#include "SgBlackWhite.h"
+#include "SgBoardColor.h"
+
+//----------------------------------------------------------------------------
+
+/** Neighborhood of a move candidate, decoded from a pattern code.
+    Implements the part of the GoBoard interface that is needed by the
+    pattern matching functions in GoUctPatternTables, such that they can be
+    evaluated at compile time. The points are the indices of a 3x3 grid with
+    the move candidate P in the middle. For edge patterns, the points on the
+    off-board side of P are SG_BORDER. */
+class GoUctPatternBoard
+{
+public:
+    static constexpr int NS = 3;
+
+    static constexpr int WE = 1;
+
+    /** The move candidate. */
+    static constexpr int P = NS + WE;
+
+    /** Neighborhood of a code of the 8 neighbors of a point.
+        See GoUctPatterns::CodeOf8Neighbors() */
+    static constexpr GoUctPatternBoard Center(int code, SgBlackWhite toPlay);
+
+    /** Neighborhood of a code of the 5 neighbors of a point on the edge.
+        The board edge is on the -WE side of P.
+        See GoUctPatterns::CodeOfEdgeNeighbors() */
+    static constexpr GoUctPatternBoard Edge(int code, SgBlackWhite toPlay);
+
+    constexpr SgBoardColor GetColor(int p) const;
+
+    constexpr bool IsColor(int p, int c) const;
+
+    constexpr bool IsEmpty(int p) const;
+
+    constexpr bool IsEdge() const;
+
+    /** Number of empty points among the 8 neighbors of P. */
+    constexpr int Num8EmptyNeighbors() const;
+
+    /** Number of diagonal neighbors of P with color c. */
+    constexpr int NumDiagonals(SgBlackWhite c) const;
+
+    /** Number of empty neighbors of P. */
+    constexpr int NumEmptyNeighbors() const;
+
+    /** Number of neighbors of P with color c. */
+    constexpr int NumNeighbors(SgBlackWhite c) const;
+
+    constexpr SgBlackWhite ToPlay() const;
+
+    /** Direction of P towards the center of the board.
+        REQUIRES: IsEdge() */
+    constexpr int Up() const;
+
+private:
+    SgBoardColor m_color[9];
+
+    bool m_isEdge;
+
+    SgBlackWhite m_toPlay;
+
+    constexpr GoUctPatternBoard(bool isEdge, SgBlackWhite toPlay);
+};
+
+constexpr GoUctPatternBoard::GoUctPatternBoard(bool isEdge,
+                                               SgBlackWhite toPlay)
+    : m_color{ SG_EMPTY, SG_EMPTY, SG_EMPTY, SG_EMPTY, SG_EMPTY, SG_EMPTY,
+               SG_EMPTY, SG_EMPTY, SG_EMPTY },
+      m_isEdge(isEdge),
+      m_toPlay(toPlay)
+{ }
+
+constexpr GoUctPatternBoard GoUctPatternBoard::Center(int code,
+                                                      SgBlackWhite toPlay)
+{
+    // Same order as SgNb8Iterator, decoding gives points in reverse order
+    constexpr int nb8[8] = { -NS - WE, -NS, -NS + WE, -WE, +WE, +NS - WE,
+                             +NS, +NS + WE };
+    GoUctPatternBoard bd(false, toPlay);
+    for (int i = 7; i >= 0; --i)
+    {
+        bd.m_color[P + nb8[i]] = code % 3;
+        code /= 3;
+    }
+    return bd;
+}
+
+constexpr GoUctPatternBoard GoUctPatternBoard::Edge(int code,
+                                                    SgBlackWhite toPlay)
+{
+    constexpr int up = WE;
+    constexpr int other = NS;
+    constexpr int nb5[5] = { other, up + other, up, up - other, -other };
+    GoUctPatternBoard bd(true, toPlay);
+    for (int i = 4; i >= 0; --i)
+    {
+        bd.m_color[P + nb5[i]] = code % 3;
+        code /= 3;
+    }
+    bd.m_color[P - up - other] = SG_BORDER;
+    bd.m_color[P - up] = SG_BORDER;
+    bd.m_color[P - up + other] = SG_BORDER;
+    return bd;
+}
+
+constexpr SgBoardColor GoUctPatternBoard::GetColor(int p) const
+{
+    return m_color[p];
+}
+
+constexpr bool GoUctPatternBoard::IsColor(int p, int c) const
+{
+    return m_color[p] == c;
+}
+
+constexpr bool GoUctPatternBoard::IsEdge() const
+{
+    return m_isEdge;
+}
+
+constexpr bool GoUctPatternBoard::IsEmpty(int p) const
+{
+    return m_color[p] == SG_EMPTY;
+}
+
+constexpr int GoUctPatternBoard::Num8EmptyNeighbors() const
+{
+    return NumEmptyNeighbors()
+        + IsEmpty(P - NS - WE) + IsEmpty(P - NS + WE)
+        + IsEmpty(P + NS - WE) + IsEmpty(P + NS + WE);
+}
+
+constexpr int GoUctPatternBoard::NumDiagonals(SgBlackWhite c) const
+{
+    return IsColor(P - NS - WE, c) + IsColor(P - NS + WE, c)
+        + IsColor(P + NS - WE, c) + IsColor(P + NS + WE, c);
+}
+
+constexpr int GoUctPatternBoard::NumEmptyNeighbors() const
+{
+    return IsEmpty(P - NS) + IsEmpty(P - WE) + IsEmpty(P + WE)
+        + IsEmpty(P + NS);
+}
+
+constexpr int GoUctPatternBoard::NumNeighbors(SgBlackWhite c) const
+{
+    return IsColor(P - NS, c) + IsColor(P - WE, c) + IsColor(P + WE, c)
+        + IsColor(P + NS, c);
+}
+
+constexpr SgBlackWhite GoUctPatternBoard::ToPlay() const
+{
+    return m_toPlay;
+}
+
+constexpr int GoUctPatternBoard::Up() const
+{
+    return WE;
+}
+
+//----------------------------------------------------------------------------
+
+/** Procedural matching of the MoGo patterns and the lookup tables generated
+    from it at compile time.
+    See GoUctPatterns for a description of the patterns. The matching
+    functions only look at the 3x3 neighborhood of a point, so they can be
+    evaluated for all codes of the neighborhood. The tables are constant
+    data, which is shared by all processes using the library. */
+namespace GoUctPatternTables {
+
+/** 3^5 = size of edge pattern table */
+constexpr int POWER3_5 = 3 * 3 * 3 * 3 * 3;
+
+/** 3^8 = size of center pattern table. */
+constexpr int POWER3_8 = 3 * 3 * 3 * 3 * 3 * 3 * 3 * 3;
+
+typedef std::array<bool, POWER3_5> EdgeTable;
+
+typedef std::array<bool, POWER3_8> CenterTable;
+
+constexpr SgBlackWhite Opp(SgBlackWhite c)
+{
+    return SG_BLACK + SG_WHITE - c;
+}
+
+constexpr int OtherDir(int dir)
+{
+    const int ns = GoUctPatternBoard::NS;
+    if (dir == ns || dir == -ns)
+        return GoUctPatternBoard::WE;
+    return ns;
+}
+
+/** Find direction of a neighboring stone in color c */
+constexpr int FindDir(const GoUctPatternBoard& bd, SgBlackWhite c)
+{
+    const int p = GoUctPatternBoard::P;
+    const int ns = GoUctPatternBoard::NS;
+    const int we = GoUctPatternBoard::WE;
+    if (bd.IsColor(p + ns, c))
+        return ns;
+    if (bd.IsColor(p - ns, c))
+        return -ns;
+    if (bd.IsColor(p + we, c))
+        return we;
+    return -we;
+}
+
+constexpr bool CheckCut1(const GoUctPatternBoard& bd, SgBlackWhite c,
+                         int cDir, int otherDir)
+{
+    const int p = GoUctPatternBoard::P;
+    return bd.IsColor(p + otherDir, c)
+        && bd.IsColor(p + cDir + otherDir, Opp(c));
+}
+
+constexpr bool CheckCut2(const GoUctPatternBoard& bd, SgBlackWhite c,
+                         int cDir, int otherDir)
+{
+    const int p = GoUctPatternBoard::P;
+    const SgBlackWhite opp = Opp(c);
+    return   bd.IsColor(p - cDir, c)
+          && ( (  bd.IsColor(p + otherDir, opp)
+               && ! bd.IsColor(p - otherDir + cDir, c)
+               && ! bd.IsColor(p - otherDir - cDir, c)
+               )
+             ||
+               (  bd.IsColor(p - otherDir, opp)
+               && ! bd.IsColor(p + otherDir + cDir, c)
+               && ! bd.IsColor(p + otherDir - cDir, c)
+               )
+             );
+}
+
+constexpr bool CheckHane1(const GoUctPatternBoard& bd, SgBlackWhite c,
+                          SgBlackWhite opp, int cDir, int otherDir)
+{
+    const int p = GoUctPatternBoard::P;
+    return    bd.IsColor(p + cDir, c)
+           && bd.IsColor(p + cDir + otherDir, opp)
+           && bd.IsColor(p + cDir - otherDir, opp)
+           && bd.IsEmpty(p + otherDir)
+           && bd.IsEmpty(p - otherDir)
+           ;
+}
+
+constexpr bool MatchCut(const GoUctPatternBoard& bd)
+{
+    const int p = GoUctPatternBoard::P;
+    const int ns = GoUctPatternBoard::NS;
+    const int we = GoUctPatternBoard::WE;
+    if (bd.Num8EmptyNeighbors() > 6)
+        return false;
+
+    const int nuEmpty = bd.NumEmptyNeighbors();
+    //cut1
+    const SgEmptyBlackWhite c1 = bd.GetColor(p + ns);
+    if (   c1 != SG_EMPTY
+       && bd.NumNeighbors(c1) >= 2
+       && ! (bd.NumNeighbors(c1) == 3 && nuEmpty == 1)
+       && (  CheckCut1(bd, c1, ns, we)
+          || CheckCut1(bd, c1, ns, -we)
+          )
+       )
+        return true;
+    const SgEmptyBlackWhite c2 = bd.GetColor(p - ns);
+    if (  c2 != SG_EMPTY
+       && bd.NumNeighbors(c2) >= 2
+       && ! (bd.NumNeighbors(c2) == 3 && nuEmpty == 1)
+       && (  CheckCut1(bd, c2, -ns, we)
+          || CheckCut1(bd, c2, -ns, -we)
+          )
+       )
+        return true;
+    //cut2
+    if (  c1 != SG_EMPTY
+       && bd.NumNeighbors(c1) == 2
+       && bd.NumNeighbors(Opp(c1)) > 0
+       && bd.NumDiagonals(c1) <= 2
+       && CheckCut2(bd, c1, ns, we)
+       )
+        return true;
+    const SgEmptyBlackWhite c3 = bd.GetColor(p + we);
+    if (  c3 != SG_EMPTY
+       && bd.NumNeighbors(c3) == 2
+       && bd.NumNeighbors(Opp(c3)) > 0
+       && bd.NumDiagonals(c3) <= 2
+       && CheckCut2(bd, c3, we, ns)
+       )
+        return true;
+    return false;
+}
+
+constexpr bool MatchEdge(const GoUctPatternBoard& bd, int nuBlack,
+                         int nuWhite)
+{
+    const int p = GoUctPatternBoard::P;
+    const int up = bd.Up();
+    const int side = OtherDir(up);
+    const int nuEmpty = bd.NumEmptyNeighbors();
+    const SgEmptyBlackWhite upColor = bd.GetColor(p + up);
+    // edge1
+    if (  nuEmpty > 0
+       && (nuBlack > 0 || nuWhite > 0)
+       && upColor == SG_EMPTY
+       )
+    {
+        const SgEmptyBlackWhite c1 = bd.GetColor(p + side);
+        if (c1 != SG_EMPTY && bd.GetColor(p + side + up) == Opp(c1))
+            return true;
+        const SgEmptyBlackWhite c2 = bd.GetColor(p - side);
+        if (c2 != SG_EMPTY && bd.GetColor(p - side + up) == Opp(c2))
+            return true;
+    }
+
+    // edge2
+    if (  upColor != SG_EMPTY
+       && (  (upColor == SG_BLACK && nuBlack == 1 && nuWhite > 0)
+          || (upColor == SG_WHITE && nuWhite == 1 && nuBlack > 0)
+          )
+       )
+        return true;
+
+    const SgBlackWhite toPlay = bd.ToPlay();
+    // edge3
+    if (  upColor == toPlay
+       && bd.NumDiagonals(Opp(upColor)) > 0
+       )
+        return true;
+
+    // edge4
+    if (  upColor == Opp(toPlay)
+       && bd.NumNeighbors(upColor) <= 2
+       && bd.NumDiagonals(toPlay) > 0
+       )
+    {
+        if (  bd.GetColor(p + side + up) == toPlay
+           && bd.GetColor(p + side) != upColor
+           )
+            return true;
+        if (  bd.GetColor(p - side + up) == toPlay
+           && bd.GetColor(p - side) != upColor
+           )
+            return true;
+    }
+    // edge5
+    if (  upColor == Opp(toPlay)
+       && bd.NumNeighbors(upColor) == 2
+       && bd.NumNeighbors(toPlay) == 1
+       )
+    {
+        if (  bd.GetColor(p + side + up) == toPlay
+           && bd.GetColor(p + side) == upColor
+           )
+            return true;
+        if (  bd.GetColor(p - side + up) == toPlay
+           && bd.GetColor(p - side) == upColor
+           )
+            return true;
+    }
+    return false;
+}
+
+constexpr bool MatchHane(const GoUctPatternBoard& bd, int nuBlack,
+                         int nuWhite)
+{
+    const int p = GoUctPatternBoard::P;
+    const int ns = GoUctPatternBoard::NS;
+    const int we = GoUctPatternBoard::WE;
+    const int nuEmpty = bd.NumEmptyNeighbors();
+    if (nuEmpty < 2 || nuEmpty > 3)
+        return false;
+    if (  (nuBlack < 1 || nuBlack > 2)
+       && (nuWhite < 1 || nuWhite > 2)
+       )
+        return false;
+    if (nuEmpty == 2) // hane3 pattern
+    {
+        if (nuBlack == 1 && nuWhite == 1)
+        {
+            const int dirB = FindDir(bd, SG_BLACK);
+            const int dirW = FindDir(bd, SG_WHITE);
+            if (! bd.IsEmpty(p + dirB + dirW))
+                return true;
+        }
+    }
+    else if (nuEmpty == 3) // hane2 or hane4
+    {
+        const SgBlackWhite col = (nuBlack == 1) ? SG_BLACK : SG_WHITE;
+        const SgBlackWhite opp = Opp(col);
+        const int dir = FindDir(bd, col);
+        const int otherDir = OtherDir(dir);
+        if (  bd.IsEmpty(p + dir + otherDir)
+           && bd.IsColor(p + dir - otherDir, opp)
+           )
+            return true; // hane2
+        if (  bd.IsEmpty(p + dir - otherDir)
+           && bd.IsColor(p + dir + otherDir, opp)
+           )
+            return true; // hane2
+        if (bd.ToPlay() == opp)
+        {
+            const SgEmptyBlackWhite c1 = bd.GetColor(p + dir + otherDir);
+            if (c1 != SG_EMPTY)
+            {
+                const SgEmptyBlackWhite c2 = bd.GetColor(p + dir - otherDir);
+                if (Opp(c1) == c2)
+                    return true; // hane4
+            }
+        }
+    }
+
+    // hane1 pattern
+    const int nuBlackDiag = bd.NumDiagonals(SG_BLACK);
+    if (  nuBlackDiag >= 2
+       && nuWhite > 0
+       && (  CheckHane1(bd, SG_WHITE, SG_BLACK, ns, we)
+          || CheckHane1(bd, SG_WHITE, SG_BLACK, -ns, we)
+          || CheckHane1(bd, SG_WHITE, SG_BLACK, we, ns)
+          || CheckHane1(bd, SG_WHITE, SG_BLACK, -we, ns)
+          )
+       )
+        return true;
+    const int nuWhiteDiag = bd.NumDiagonals(SG_WHITE);
+    if (  nuWhiteDiag >= 2
+       && nuBlack > 0
+       && (  CheckHane1(bd, SG_BLACK, SG_WHITE, ns, we)
+          || CheckHane1(bd, SG_BLACK, SG_WHITE, -ns, we)
+          || CheckHane1(bd, SG_BLACK, SG_WHITE, we, ns)
+          || CheckHane1(bd, SG_BLACK, SG_WHITE, -we, ns)
+          )
+       )
+        return true;
+    return false;
+}
+
+constexpr bool MatchAnyPattern(const GoUctPatternBoard& bd)
+{
+    const int nuBlack = bd.NumNeighbors(SG_BLACK);
+    const int nuWhite = bd.NumNeighbors(SG_WHITE);
+
+    // All patterns have at least one adjacent stone
+    if (nuBlack == 0 && nuWhite == 0)
+        return false;
+
+    if (bd.IsEdge())
+        return MatchEdge(bd, nuBlack, nuWhite);
+    else // Center
+        return   MatchHane(bd, nuBlack, nuWhite)
+              || MatchCut(bd);
+}
+
+constexpr EdgeTable MakeEdgeTable(SgBlackWhite toPlay)
+{
+    EdgeTable table{};
+    for (int i = 0; i < POWER3_5; ++i)
+        table[i] = MatchAnyPattern(GoUctPatternBoard::Edge(i, toPlay));
+    return table;
+}
+
+/** Number of codes in a part of the center table.
+    The center table is generated in parts, because compilers limit the
+    number of evaluation steps of a constant expression (e.g. clang's
+    -fconstexpr-steps). */
+constexpr int CENTER_PART_SIZE = 3 * 3 * 3 * 3 * 3 * 3;
+
+constexpr int NU_CENTER_PARTS = POWER3_8 / CENTER_PART_SIZE;
+
+typedef std::array<bool, CENTER_PART_SIZE> CenterTablePart;
+
+constexpr CenterTablePart MakeCenterTablePart(SgBlackWhite toPlay, int part)
+{
+    CenterTablePart table{};
+    for (int i = 0; i < CENTER_PART_SIZE; ++i)
+        table[i] = MatchAnyPattern(
+                GoUctPatternBoard::Center(part * CENTER_PART_SIZE + i, toPlay));
+    return table;
+}
+
+/** Each part is a separate constant expression. */
+template<SgBlackWhite TOPLAY, int PART>
+inline constexpr CenterTablePart gCenterPart =
+    MakeCenterTablePart(TOPLAY, PART);
+
+template<SgBlackWhite TOPLAY, int... PARTS>
+constexpr CenterTable MakeCenterTable(std::integer_sequence<int, PARTS...>)
+{
+    CenterTable table{};
+    const CenterTablePart* parts[] = { &gCenterPart<TOPLAY, PARTS>... };
+    for (int i = 0; i < POWER3_8; ++i)
+        table[i] = (*parts[i / CENTER_PART_SIZE])[i % CENTER_PART_SIZE];
+    return table;
+}
+
+/** Center patterns for each color to play, indexed by the code of the
+    8 neighbors. See GoUctPatterns::CodeOf8Neighbors() */
+inline constexpr std::array<CenterTable, 2> gCenterTable = {
+    MakeCenterTable<SG_BLACK>(
+                      std::make_integer_sequence<int, NU_CENTER_PARTS>()),
+    MakeCenterTable<SG_WHITE>(
+                      std::make_integer_sequence<int, NU_CENTER_PARTS>())
+};
+
+/** Edge patterns for each color to play, indexed by the code of the
+    5 neighbors. See GoUctPatterns::CodeOfEdgeNeighbors() */
+inline constexpr std::array<EdgeTable, 2> gEdgeTable = {
+    MakeEdgeTable(SG_BLACK),
+    MakeEdgeTable(SG_WHITE)
+};
+
+} // namespace GoUctPatternTables
+
+//----------------------------------------------------------------------------
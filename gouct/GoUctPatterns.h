@@ -9,12 +9,16 @@
 #include "GoUctGlobalPatternData.h"
 #include "GoUctLocalPatternData.h"
 #include "GoUctPatternData.h"
+#include "GoUctPatternTables.h"
 #include "SgBoardColor.h"
 #include "SgBWArray.h"
 #include "SgPoint.h"
 #include <cstdio>
 #include <utility>
 #include <string>
+#include <type_traits>
+
+class GoUctBoard;
 
 //----------------------------------------------------------------------------
 
@@ -35,6 +39,10 @@
     ? = Don't care      W = White to Play
     @endverbatim
 
+    The patterns are looked up in tables indexed by the code of the
+    neighborhood of a point. The tables are generated at compile time by
+    the matching functions in GoUctPatternTables.
+
     Patterns for Hane. <br>
     True is returned if any pattern is matched.
     @verbatim
@@ -133,7 +141,7 @@ public:
 	float GetPatternGamma(const BOARD& bd, const SgPoint p,
 			const SgBlackWhite toPlay) const;
 
-	/** provide interface of other gamma patterns*/
+	/** Use the gamma values of another pattern type. */
 	void InitializeGammaPatternFromProcessedData(PatternType patternType);
 private:
 	/** Match any of the center patterns, and return gamma */
@@ -144,13 +152,14 @@ private:
 
 	/** Copy gamma values from pt into table */
     template<class TABLE>
-    void SetGammaValues(const GoUctPatternData::BWTable& pt, TABLE& table);
+    static void SetGammaValues(const GoUctPatternData::BWTable& pt,
+                               TABLE& table);
     
     /** 3^5 = size of edge pattern table */
-    static const int GOUCT_POWER3_5 = 3 * 3 * 3 * 3 * 3;
+    static const int GOUCT_POWER3_5 = GoUctPatternTables::POWER3_5;
 
     /** 3^8 = size of center pattern table. */
-    static const int GOUCT_POWER3_8 = 3 * 3 * 3 * 3 * 3 * 3 * 3 * 3;
+    static const int GOUCT_POWER3_8 = GoUctPatternTables::POWER3_8;
 
     /** See m_edgeTable. */
     typedef SgArray<PatternInfo, GOUCT_POWER3_5> GoUctEdgePatternTable;
@@ -158,54 +167,54 @@ private:
     /** See m_table. */
     typedef SgArray<PatternInfo, GOUCT_POWER3_8> GoUctPatternTable;
 
-    const BOARD& m_bd;
-
-    /** lookup table for 8-neighborhood of a move candidate */
-    SgBWArray<GoUctPatternTable> m_table;
-
-    /** lookup table on the edge of board */
-    SgBWArray<GoUctEdgePatternTable> m_edgeTable;
-
-    static bool CheckCut1(const GoBoard& bd, SgPoint p, SgBlackWhite c,
-                          int cDir, int otherDir);
-
-    static bool CheckCut2(const GoBoard& bd, SgPoint p, const SgBlackWhite c,
-                          int cDir, int otherDir);
+    /** Lookup tables for the patterns and gamma values.
+        The tables do not depend on the board, they are built once on first
+        use and shared by all instances with the same pattern type.
+        The pattern flags are copied from GoUctPatternTables, such that
+        matching with gamma values needs only one lookup. */
+    struct Tables
+    {
+        /** Tables without gamma values. */
+        Tables();
 
-    static bool CheckHane1(const GoBoard& bd, SgPoint p, SgBlackWhite c,
-                           SgBlackWhite opp, int cDir, int otherDir);
+        /** Tables with the gamma values of a pattern type. */
+        explicit Tables(PatternType patternType);
 
-    static int CodeOf8Neighbors(const BOARD& bd, SgPoint p);
+        /** lookup table for 8-neighborhood of a move candidate */
+        SgBWArray<GoUctPatternTable> m_table;
 
-    static int CodeOfEdgeNeighbors(const BOARD& bd, SgPoint p);
+        /** lookup table on the edge of board */
+        SgBWArray<GoUctEdgePatternTable> m_edgeTable;
+    };
 
-    static int EdgeDirection(GoBoard& bd, SgPoint p, int index);
+    const BOARD& m_bd;
 
-    static int EBWCodeOfPoint(const BOARD& bd, SgPoint p);
+    /** The shared tables. */
+    const Tables* m_tables;
 
-    static int FindDir(const GoBoard& bd, SgPoint p, SgBlackWhite c);
+    /** The shared tables with the gamma values of a pattern type. */
+    static const Tables& SharedTables(PatternType patternType);
 
-    static void InitCenterPatternTable(SgBWArray<GoUctPatternTable>& table);
+    /** The shared tables without gamma values. */
+    static const Tables& SharedTablesNoGamma();
 
-    static void InitEdgePatternTable(SgBWArray<GoUctEdgePatternTable>&
-                                     edgeTable);
+    /** Code of the 8 neighbors of a point.
+        Uses the incremental code of GoUctBoard::PatternCode(), if the
+        board is a GoUctBoard that maintains pattern codes. */
+    static int CodeOf8Neighbors(const BOARD& bd, SgPoint p);
 
-    static bool MatchCut(const GoBoard& bd, SgPoint p);
+    /** Code of the 5 neighbors of a point on the edge.
+        See CodeOf8Neighbors() */
+    static int CodeOfEdgeNeighbors(const BOARD& bd, SgPoint p);
 
-    static bool MatchEdge(const GoBoard& bd, SgPoint p, const int nuBlack,
-                          const int nuWhite);
+    static int ComputeCodeOf8Neighbors(const BOARD& bd, SgPoint p);
 
-    static bool MatchHane(const GoBoard& bd, SgPoint p, const int nuBlack,
-                          const int nuWhite);
+    static int ComputeCodeOfEdgeNeighbors(const BOARD& bd, SgPoint p);
 
-    static bool MatchAnyPattern(const GoBoard& bd, SgPoint p);
+    static int EBWCodeOfPoint(const BOARD& bd, SgPoint p);
 
     static int OtherDir(int dir);
 
-    static int SetupCodedEdgePosition(GoBoard& bd, int code);
-
-    static int SetupCodedPosition(GoBoard& bd, int code);
-
     /** Match any of the center patterns. */
     bool MatchAnyCenter(SgPoint p) const;
 
@@ -220,70 +229,61 @@ private:
 };
 
 template<class BOARD>
-GoUctPatterns<BOARD>::GoUctPatterns(const BOARD& bd, PatternType patternType)
-    : m_bd(bd)
+GoUctPatterns<BOARD>::Tables::Tables()
 {
-    //must be initialized before MoGo-style patterns
-    InitializeGammaPatternFromProcessedData(patternType);
-    InitCenterPatternTable(m_table);
-    InitEdgePatternTable(m_edgeTable);
+    for (SgBWIterator it; it; ++it)
+    {
+        for (int i = 0; i < GOUCT_POWER3_8; ++i)
+            m_table[*it][i].SetIsPattern(
+                                GoUctPatternTables::gCenterTable[*it][i]);
+        for (int i = 0; i < GOUCT_POWER3_5; ++i)
+            m_edgeTable[*it][i].SetIsPattern(
+                                  GoUctPatternTables::gEdgeTable[*it][i]);
+    }
 }
 
 template<class BOARD>
-GoUctPatterns<BOARD>::GoUctPatterns(const BOARD& bd)
-    : m_bd(bd)
+GoUctPatterns<BOARD>::Tables::Tables(PatternType patternType)
+    : Tables()
 {
-    InitCenterPatternTable(m_table);
-    InitEdgePatternTable(m_edgeTable);
+    const GoUctPatternData::PatternData& pt = patternType == PATTERN_LOCAL ?
+                                              GoUctLocalPatternData::gData :
+                                              GoUctGlobalPatternData::gData;
+    SetGammaValues(pt.m_edgePatterns, m_edgeTable);
+    SetGammaValues(pt.m_centerPatterns, m_table);
 }
 
+//----------------------------------------------------------------------------
+
 template<class BOARD>
-bool GoUctPatterns<BOARD>::CheckHane1(const GoBoard& bd, SgPoint p,
-                                      SgBlackWhite c, SgBlackWhite opp,
-                                      int cDir, int otherDir)
-{
-    return    bd.IsColor(p + cDir, c)
-           && bd.IsColor(p + cDir + otherDir, opp)
-           && bd.IsColor(p + cDir - otherDir, opp)
-           && bd.IsEmpty(p + otherDir)
-           && bd.IsEmpty(p - otherDir)
-           ;
-}
+GoUctPatterns<BOARD>::GoUctPatterns(const BOARD& bd, PatternType patternType)
+    : m_bd(bd),
+      m_tables(&SharedTables(patternType))
+{ }
 
 template<class BOARD>
-bool GoUctPatterns<BOARD>::CheckCut1(const GoBoard& bd, SgPoint p,
-                                     SgBlackWhite c, int cDir, int otherDir)
-{
-    SG_ASSERT_BW(c);
-    return bd.IsColor(p + otherDir, c)
-        && bd.IsColor(p + cDir + otherDir, SgOppBW(c));
-}
+GoUctPatterns<BOARD>::GoUctPatterns(const BOARD& bd)
+    : m_bd(bd),
+      m_tables(&SharedTablesNoGamma())
+{ }
 
 template<class BOARD>
-bool GoUctPatterns<BOARD>::CheckCut2(const GoBoard& bd, SgPoint p,
-                                     const SgBlackWhite c, int cDir,
-                                     int otherDir)
+inline int GoUctPatterns<BOARD>::CodeOf8Neighbors(const BOARD& bd, SgPoint p)
 {
-    SG_ASSERT_BW(c);
-    SG_ASSERT(bd.IsColor(p + cDir, c));
-    const SgBlackWhite opp = SgOppBW(c);
-    return   bd.IsColor(p - cDir, c)
-          && ( (  bd.IsColor(p + otherDir, opp)
-               && ! bd.IsColor(p - otherDir + cDir, c)
-               && ! bd.IsColor(p - otherDir - cDir, c)
-               )
-             ||
-               (  bd.IsColor(p - otherDir, opp)
-               && ! bd.IsColor(p + otherDir + cDir, c)
-               && ! bd.IsColor(p + otherDir - cDir, c)
-               )
-             );
+    SG_ASSERT(bd.Line(p) > 1);
+    if constexpr (std::is_same<BOARD, GoUctBoard>::value)
+        if (bd.HasPatternCodes())
+        {
+            SG_ASSERT(bd.PatternCode(p) == ComputeCodeOf8Neighbors(bd, p));
+            return bd.PatternCode(p);
+        }
+    return ComputeCodeOf8Neighbors(bd, p);
 }
 
 template<class BOARD>
-inline int GoUctPatterns<BOARD>::CodeOf8Neighbors(const BOARD& bd, SgPoint p)
+inline int GoUctPatterns<BOARD>::ComputeCodeOf8Neighbors(const BOARD& bd,
+                                                         SgPoint p)
 {
-    SG_ASSERT(bd.Line(p) > 1);
     int code = (((((( EBWCodeOfPoint(bd, p - SG_NS - SG_WE) * 3
                     + EBWCodeOfPoint(bd, p - SG_NS)) * 3
                     + EBWCodeOfPoint(bd, p - SG_NS + SG_WE)) * 3
@@ -303,6 +303,19 @@ inline int GoUctPatterns<BOARD>::CodeOfEdgeNeighbors(const BOARD& bd,
 {
     SG_ASSERT(bd.Line(p) == 1);
     SG_ASSERT(bd.Pos(p) > 1);
+    if constexpr (std::is_same<BOARD, GoUctBoard>::value)
+        if (bd.HasPatternCodes())
+        {
+            SG_ASSERT(bd.PatternCode(p) == ComputeCodeOfEdgeNeighbors(bd, p));
+            return bd.PatternCode(p);
+        }
+    return ComputeCodeOfEdgeNeighbors(bd, p);
+}
+
+template<class BOARD>
+inline int GoUctPatterns<BOARD>::ComputeCodeOfEdgeNeighbors(const BOARD& bd,
+                                                            SgPoint p)
+{
     const int up = bd.Up(p);
     const int other = OtherDir(up);
     int code = (((EBWCodeOfPoint(bd, p + other) * 3
@@ -325,280 +338,18 @@ inline int GoUctPatterns<BOARD>::EBWCodeOfPoint(const BOARD& bd, SgPoint p)
     return bd.GetColor(p);
 }
 
-template<class BOARD>
-int GoUctPatterns<BOARD>::EdgeDirection(GoBoard& bd, SgPoint p, int index)
-{
-    const int up = bd.Up(p);
-    switch (index)
-    {
-        case 0:
-            return OtherDir(up);
-        case 1:
-            return up + OtherDir(up);
-        case 2:
-            return up;
-        case 3:
-            return up - OtherDir(up);
-        default:
-            SG_ASSERT(index == 4);
-            return - OtherDir(up);
-    }
-}
-
-/** Find direction of a neighboring stone in color c */
-template<class BOARD>
-int GoUctPatterns<BOARD>::FindDir(const GoBoard& bd, SgPoint p,
-                                  SgBlackWhite c)
-{
-    if (bd.IsColor(p + SG_NS, c))
-        return SG_NS;
-    if (bd.IsColor(p - SG_NS, c))
-        return -SG_NS;
-    if (bd.IsColor(p + SG_WE, c))
-        return SG_WE;
-    SG_ASSERT(bd.IsColor(p - SG_WE, c));
-    return -SG_WE;
-}
-
-template<class BOARD>
-void GoUctPatterns<BOARD>::InitEdgePatternTable(
-                                  SgBWArray<GoUctEdgePatternTable>& edgeTable)
-{
-    GoBoard bd(5);
-    const SgPoint p = SgPointUtil::Pt(1, 3);
-    for (int i = 0; i < GOUCT_POWER3_5; ++i)
-    {
-        int count = SetupCodedEdgePosition(bd, i);
-        for (SgBWIterator it; it; ++it)
-        {
-            bd.SetToPlay(*it);
-            const bool isPattern = MatchAnyPattern(bd, p);
-            edgeTable[*it][i].SetIsPattern(isPattern);
-        }
-        while (count-- > 0)
-            bd.Undo();
-    }
-}
-
-template<class BOARD>
-void GoUctPatterns<BOARD>::InitCenterPatternTable(
-                                          SgBWArray<GoUctPatternTable>& table)
-{
-    GoBoard bd(5);
-    const SgPoint p = SgPointUtil::Pt(3, 3);
-    for (int i = 0; i < GOUCT_POWER3_8; ++i)
-    {
-        int count = SetupCodedPosition(bd, i);
-        for (SgBWIterator it; it; ++it)
-        {
-            bd.SetToPlay(*it);
-            const bool isPattern = MatchAnyPattern(bd, p);
-            table[*it][i].SetIsPattern(isPattern);
-        }
-        while (count-- > 0)
-            bd.Undo();
-    }
-}
-
-template<class BOARD>
-bool GoUctPatterns<BOARD>::MatchCut(const GoBoard& bd, SgPoint p)
-{
-    if (bd.Num8EmptyNeighbors(p) > 6)
-        return false;
-
-    const int nuEmpty = bd.NumEmptyNeighbors(p);
-    //cut1
-    const SgEmptyBlackWhite c1 = bd.GetColor(p + SG_NS);
-    if (   c1 != SG_EMPTY
-       && bd.NumNeighbors(p, c1) >= 2
-       && ! (bd.NumNeighbors(p, c1) == 3 && nuEmpty == 1)
-       && (  CheckCut1(bd, p, c1, SG_NS, SG_WE)
-          || CheckCut1(bd, p, c1, SG_NS, -SG_WE)
-          )
-       )
-        return true;
-    const SgEmptyBlackWhite c2 = bd.GetColor(p - SG_NS);
-    if (  c2 != SG_EMPTY
-       && bd.NumNeighbors(p, c2) >= 2
-       && ! (bd.NumNeighbors(p, c2) == 3 && nuEmpty == 1)
-       && (  CheckCut1(bd, p, c2, -SG_NS, SG_WE)
-          || CheckCut1(bd, p, c2, -SG_NS, -SG_WE)
-          )
-       )
-        return true;
-    //cut2
-    if (  c1 != SG_EMPTY
-       && bd.NumNeighbors(p, c1) == 2
-       && bd.NumNeighbors(p, SgOppBW(c1)) > 0
-       && bd.NumDiagonals(p, c1) <= 2
-       && CheckCut2(bd, p, c1, SG_NS, SG_WE)
-       )
-        return true;
-    const SgEmptyBlackWhite c3 = bd.GetColor(p + SG_WE);
-    if (  c3 != SG_EMPTY
-       && bd.NumNeighbors(p, c3) == 2
-       && bd.NumNeighbors(p, SgOppBW(c3)) > 0
-       && bd.NumDiagonals(p, c3) <= 2
-       && CheckCut2(bd, p, c3, SG_WE, SG_NS)
-       )
-        return true;
-    return false;
-}
-
-template<class BOARD>
-bool GoUctPatterns<BOARD>::MatchEdge(const GoBoard& bd, SgPoint p,
-                                     const int nuBlack, const int nuWhite)
-{
-    const int up = bd.Up(p);
-    const int side = OtherDir(up);
-    const int nuEmpty = bd.NumEmptyNeighbors(p);
-    const SgEmptyBlackWhite upColor = bd.GetColor(p + up);
-    // edge1
-    if (  nuEmpty > 0
-       && (nuBlack > 0 || nuWhite > 0)
-       && upColor == SG_EMPTY
-       )
-    {
-        const SgEmptyBlackWhite c1 = bd.GetColor(p + side);
-        if (c1 != SG_EMPTY && bd.GetColor(p + side + up) == SgOppBW(c1))
-            return true;
-        const SgEmptyBlackWhite c2 = bd.GetColor(p - side);
-        if (c2 != SG_EMPTY && bd.GetColor(p - side + up) == SgOppBW(c2))
-            return true;
-    }
-
-    // edge2
-    if (  upColor != SG_EMPTY
-       && (  (upColor == SG_BLACK && nuBlack == 1 && nuWhite > 0)
-          || (upColor == SG_WHITE && nuWhite == 1 && nuBlack > 0)
-          )
-       )
-        return true;
-
-    const SgBlackWhite toPlay = bd.ToPlay();
-    // edge3
-    if (  upColor == toPlay
-       && bd.NumDiagonals(p, SgOppBW(upColor)) > 0
-       )
-        return true;
-
-    // edge4
-    if (  upColor == SgOppBW(toPlay)
-       && bd.NumNeighbors(p, upColor) <= 2
-       && bd.NumDiagonals(p, toPlay) > 0
-       )
-    {
-        if (  bd.GetColor(p + side + up) == toPlay
-           && bd.GetColor(p + side) != upColor
-           )
-            return true;
-        if (  bd.GetColor(p - side + up) == toPlay
-           && bd.GetColor(p - side) != upColor
-           )
-            return true;
-    }
-    // edge5
-    if (  upColor == SgOppBW(toPlay)
-       && bd.NumNeighbors(p, upColor) == 2
-       && bd.NumNeighbors(p, toPlay) == 1
-       )
-    {
-        if (  bd.GetColor(p + side + up) == toPlay
-           && bd.GetColor(p + side) == upColor
-           )
-            return true;
-        if (  bd.GetColor(p - side + up) == toPlay
-           && bd.GetColor(p - side) == upColor
-           )
-            return true;
-    }
-    return false;
-}
-
-template<class BOARD>
-bool GoUctPatterns<BOARD>::MatchHane(const GoBoard& bd, SgPoint p,
-                                     const int nuBlack, const int nuWhite)
-{
-    const int nuEmpty = bd.NumEmptyNeighbors(p);
-    if (nuEmpty < 2 || nuEmpty > 3)
-        return false;
-    if (  (nuBlack < 1 || nuBlack > 2)
-       && (nuWhite < 1 || nuWhite > 2)
-       )
-        return false;
-    if (nuEmpty == 2) // hane3 pattern
-    {
-        if (nuBlack == 1 && nuWhite == 1)
-        {
-            const int dirB = FindDir(bd, p, SG_BLACK);
-            const int dirW = FindDir(bd, p, SG_WHITE);
-            if (! bd.IsEmpty(p + dirB + dirW))
-                return true;
-        }
-    }
-    else if (nuEmpty == 3) // hane2 or hane4
-    {
-        SG_ASSERT(nuBlack + nuWhite == 1);
-        const SgBlackWhite col = (nuBlack == 1) ? SG_BLACK : SG_WHITE;
-        const SgBlackWhite opp = SgOppBW(col);
-        const int dir = FindDir(bd, p, col);
-        const int otherDir = OtherDir(dir);
-        if (  bd.IsEmpty(p + dir + otherDir)
-           && bd.IsColor(p + dir - otherDir, opp)
-           )
-            return true; // hane2
-        if (  bd.IsEmpty(p + dir - otherDir)
-           && bd.IsColor(p + dir + otherDir, opp)
-           )
-            return true; // hane2
-        if (bd.ToPlay() == opp)
-        {
-            const SgEmptyBlackWhite c1 = bd.GetColor(p + dir + otherDir);
-            if (c1 != SG_EMPTY)
-            {
-                const SgEmptyBlackWhite c2 =
-                bd.GetColor(p + dir - otherDir);
-                if (SgOppBW(c1) == c2)
-                    return true; // hane4
-            }
-        }
-    }
-
-    // hane1 pattern
-    const int nuBlackDiag = bd.NumDiagonals(p, SG_BLACK);
-    if (  nuBlackDiag >= 2
-       && nuWhite > 0
-       && (  CheckHane1(bd, p, SG_WHITE, SG_BLACK, SG_NS, SG_WE)
-          || CheckHane1(bd, p, SG_WHITE, SG_BLACK, -SG_NS, SG_WE)
-          || CheckHane1(bd, p, SG_WHITE, SG_BLACK, SG_WE, SG_NS)
-          || CheckHane1(bd, p, SG_WHITE, SG_BLACK, -SG_WE, SG_NS)
-          )
-       )
-        return true;
-    const int nuWhiteDiag = bd.NumDiagonals(p, SG_WHITE);
-    if (  nuWhiteDiag >= 2
-       && nuBlack > 0
-       && (  CheckHane1(bd, p, SG_BLACK, SG_WHITE, SG_NS, SG_WE)
-          || CheckHane1(bd, p, SG_BLACK, SG_WHITE, -SG_NS, SG_WE)
-          || CheckHane1(bd, p, SG_BLACK, SG_WHITE, SG_WE, SG_NS)
-          || CheckHane1(bd, p, SG_BLACK, SG_WHITE, -SG_WE, SG_NS)
-          )
-       )
-        return true;
-    return false;
-}
-
 template<class BOARD>
 inline bool GoUctPatterns<BOARD>::MatchAnyCenter(SgPoint p) const
 {
-    return m_table[m_bd.ToPlay()][CodeOf8Neighbors(m_bd, p)].IsPattern();
+    return GoUctPatternTables::gCenterTable[m_bd.ToPlay()]
+                                           [CodeOf8Neighbors(m_bd, p)];
 }
 
 template<class BOARD>
 inline bool GoUctPatterns<BOARD>::MatchAnyEdge(SgPoint p) const
 {
-    return
-        m_edgeTable[m_bd.ToPlay()][CodeOfEdgeNeighbors(m_bd, p)].IsPattern();
+    return GoUctPatternTables::gEdgeTable[m_bd.ToPlay()]
+                                         [CodeOfEdgeNeighbors(m_bd, p)];
 }
 
 template<class BOARD>
@@ -618,29 +369,6 @@ inline bool GoUctPatterns<BOARD>::MatchAny(SgPoint p) const
         return false;
 }
 
-/** Procedural matching function - used to initialize the table. */
-template<class BOARD>
-bool GoUctPatterns<BOARD>::MatchAnyPattern(const GoBoard& bd, SgPoint p)
-{
-    SG_ASSERT(bd.IsEmpty(p));
-    const int nuBlack = bd.NumNeighbors(p, SG_BLACK);
-    const int nuWhite = bd.NumNeighbors(p, SG_WHITE);
-
-    // Quick refutation using the incremental neighbor counts of the board
-    // All patterns have at least one adjacent stone
-    if (nuBlack == 0 && nuWhite == 0)
-        return false;
-
-    // Filter edge moves on (1,1) points in corners
-    if (bd.Pos(p) == 1)
-        return false;
-    if (bd.Line(p) == 1)
-        return MatchEdge(bd, p, nuBlack, nuWhite);
-    else // Center
-        return   MatchHane(bd, p, nuBlack, nuWhite)
-              || MatchCut(bd, p);
-}
-
 template<class BOARD>
 inline int GoUctPatterns<BOARD>::OtherDir(int dir)
 {
@@ -650,41 +378,25 @@ inline int GoUctPatterns<BOARD>::OtherDir(int dir)
 }
 
 template<class BOARD>
-int GoUctPatterns<BOARD>::SetupCodedEdgePosition(GoBoard& bd, int code)
+const typename GoUctPatterns<BOARD>::Tables&
+GoUctPatterns<BOARD>::SharedTables(PatternType patternType)
 {
-    const SgPoint p = SgPointUtil::Pt(1, 3);
-    int count = 0;
-    for (int i = 4; i >= 0; --i) // decoding gives points in reverse order
+    // Function-local statics are initialized thread-safe on first use
+    if (patternType == PATTERN_LOCAL)
     {
-        const SgPoint nb = p + EdgeDirection(bd, p, i);
-        int c = code % 3;
-        code /= 3;
-        if (c != SG_EMPTY)
-        {
-            ++count;
-            bd.Play(nb, c);
-        }
+        static const Tables s_localTables(PATTERN_LOCAL);
+        return s_localTables;
     }
-    return count;
+    static const Tables s_globalTables(PATTERN_GLOBAL);
+    return s_globalTables;
 }
 
 template<class BOARD>
-int GoUctPatterns<BOARD>::SetupCodedPosition(GoBoard& bd, int code)
+const typename GoUctPatterns<BOARD>::Tables&
+GoUctPatterns<BOARD>::SharedTablesNoGamma()
 {
-    const SgPoint p = SgPointUtil::Pt(3, 3);
-    int count = 0;
-    for (int i = 7; i >= 0; --i) // decoding gives points in reverse order
-    {
-        const SgPoint nb = p + SgNb8Iterator::Direction(i);
-        int c = code % 3;
-        code /= 3;
-        if (c != SG_EMPTY)
-        {
-            ++count;
-            bd.Play(nb, c);
-        }
-    }
-    return count;
+    static const Tables s_tables;
+    return s_tables;
 }
 
 template<class BOARD>
@@ -721,30 +433,23 @@ template<class BOARD>
 void GoUctPatterns<BOARD>
 	::InitializeGammaPatternFromProcessedData(PatternType patternType)
 {
-    m_table[SG_BLACK].Fill(PatternInfo());
-    m_table[SG_WHITE].Fill(PatternInfo());
-    m_edgeTable[SG_BLACK].Fill(PatternInfo());
-    m_edgeTable[SG_WHITE].Fill(PatternInfo());
-
-    const GoUctPatternData::PatternData& pt = patternType == PATTERN_LOCAL ?
-                                              GoUctLocalPatternData::gData :
-                                              GoUctGlobalPatternData::gData;
-    SetGammaValues(pt.m_edgePatterns, m_edgeTable);
-    SetGammaValues(pt.m_centerPatterns, m_table);
+    m_tables = &SharedTables(patternType);
 }
 
 template<class BOARD>
 inline float GoUctPatterns<BOARD>::
 MatchAnyCenterForGamma(SgPoint p, const SgBlackWhite toPlay) const
 {
-    return m_table[toPlay][CodeOf8Neighbors(m_bd, p)].GetGammaValue();
+    return m_tables->m_table[toPlay][CodeOf8Neighbors(m_bd, p)]
+        .GetGammaValue();
 }
 
 template<class BOARD>
 inline float GoUctPatterns<BOARD>::
 MatchAnyEdgeForGamma(SgPoint p, const SgBlackWhite toPlay) const
 {
-    return m_edgeTable[toPlay][CodeOfEdgeNeighbors(m_bd, p)].GetGammaValue();
+    return m_tables->m_edgeTable[toPlay][CodeOfEdgeNeighbors(m_bd, p)]
+        .GetGammaValue();
 }
 
 template<class BOARD>
@@ -767,7 +472,8 @@ inline bool GoUctPatterns<BOARD>::MatchAny(SgPoint p, float& gamma) const
 template<class BOARD>
 inline bool GoUctPatterns<BOARD>::MatchAnyCenter(SgPoint p, float& gamma) const
 {
-	const PatternInfo& pi = m_table[m_bd.ToPlay()][CodeOf8Neighbors(m_bd, p)];
+	const PatternInfo& pi =
+        m_tables->m_table[m_bd.ToPlay()][CodeOf8Neighbors(m_bd, p)];
     gamma = pi.GetGammaValue();
 	return pi.IsPattern();
 }
@@ -775,7 +481,8 @@ inline bool GoUctPatterns<BOARD>::MatchAnyCenter(SgPoint p, float& gamma) const
 template<class BOARD>
 inline bool GoUctPatterns<BOARD>::MatchAnyEdge(SgPoint p, float& gamma) const
 {
-	const PatternInfo& pi = m_edgeTable[m_bd.ToPlay()][CodeOfEdgeNeighbors(m_bd, p)];
+	const PatternInfo& pi =
+        m_tables->m_edgeTable[m_bd.ToPlay()][CodeOfEdgeNeighbors(m_bd, p)];
     gamma = pi.GetGammaValue();
 	return pi.IsPattern();
 }
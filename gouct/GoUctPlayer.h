@@ -59,6 +59,10 @@ public:
     {
         std::size_t m_nuGenMove;
 
+        /** Fraction of the games of the old search tree that are in the
+            reused subtree.
+            The same measure is used for reusing the subtree in place and
+            for copying it (see FindInitTree()). */
         SgStatisticsExt<float,std::size_t> m_reuse;
 
         SgStatisticsExt<double,std::size_t> m_gamesPerSecond;
@@ -101,6 +105,11 @@ public:
 
     void Ponder();
 
+    /** Also sets the analysis callback of the search, which passes one
+        line of SgUctSearch::AnalyzeInfo() to the callback every
+        SgUctSearch::AnalyzeInterval() seconds. */
+    void SetProgressCallback(const ProgressCallback& callback);
+
     // @} // @name
 
 
@@ -207,6 +216,19 @@ public:
     /** See ReuseSubtree() */
     void SetReuseSubtree(bool enable);
 
+    /** Reuse the subtree by re-rooting the search tree in place.
+        If true, the subtree is reused with SgUctSearch::RerootTree() instead
+        of being copied with SgUctTree::ExtractSubtree(). This takes constant
+        time instead of time proportional to the size of the subtree. The
+        unreachable nodes are reclaimed when the search prunes the full tree,
+        so the copy is still used if SgUctSearch::PruneFullTree() is false
+        and the tree is more than half full.
+        Only used if ReuseSubtree() is true. Default is true. */
+    bool ReuseSubtreeInPlace() const;
+
+    /** See ReuseSubtreeInPlace() */
+    void SetReuseSubtreeInPlace(bool enable);
+
     /** Threshold for position value to resign.
         Default is 0.01. */
     SgUctValue ResignThreshold() const;
@@ -275,6 +297,9 @@ public:
     /** See ReuseSubtree() */
     bool m_reuseSubtree;
 
+    /** See ReuseSubtreeInPlace() */
+    bool m_reuseSubtreeInPlace;
+
     /** See EarlyPass() */
     bool m_earlyPass;
 
@@ -310,13 +335,15 @@ public:
 
     SgMove GenMovePlayoutPolicy(SgBlackWhite toPlay);
 
+    float AddReuse(SgUctValue initTreeCount, SgUctValue oldTreeCount);
+
     bool DoEarlyPassSearch(SgUctValue maxGames, double maxTime,
                            SgPoint searchMove, SgPoint& move);
 
     SgPoint DoSearch(SgBlackWhite toPlay, double maxTime,
                      bool isDuringPondering);
 
-    void FindInitTree(SgUctTree& initTree, SgBlackWhite toPlay,
+    bool FindInitTree(SgUctTree& initTree, SgBlackWhite toPlay,
                       double maxTime);
 
     void SetDefaultParameters(int boardSize);
@@ -403,6 +430,12 @@ inline bool GoUctPlayer<SEARCH, THREAD>::ReuseSubtree() const
     return m_reuseSubtree;
 }
 
+template <class SEARCH, class THREAD>
+inline bool GoUctPlayer<SEARCH, THREAD>::ReuseSubtreeInPlace() const
+{
+    return m_reuseSubtreeInPlace;
+}
+
 template <class SEARCH, class THREAD>
 inline GoUctMoveFilter& GoUctPlayer<SEARCH, THREAD>::RootFilter()
 {
@@ -551,6 +584,7 @@ GoUctPlayer<SEARCH, THREAD>::GoUctPlayer(const GoBoard& bd)
       m_enablePonder(false),
       m_useRootFilter(true),
       m_reuseSubtree(true),
+      m_reuseSubtreeInPlace(true),
       m_earlyPass(true),
       m_sureWinThreshold(0.80f),
       m_lastBoardSize(-1),
@@ -796,9 +830,11 @@ SgPoint GoUctPlayer<SEARCH, THREAD>::DoSearch(SgBlackWhite toPlay,
     {
         initTree = &m_search.GetTempTree();
         timeInitTree = -timer.GetTime();
-        FindInitTree(*initTree, toPlay, maxTime);
+        bool isInPlace = FindInitTree(*initTree, toPlay, maxTime);
         timeInitTree += timer.GetTime();
-        if (isDuringPondering)
+        // A tree reused in place is never truncated, and the search tree
+        // was swapped into initTree, so it must be passed to the search
+        if (isDuringPondering && ! isInPlace)
         {
             bool aborted = SgUserAbort();
             m_mpiSynchronizer->SynchronizeUserAbort(aborted);
@@ -880,13 +916,30 @@ SgPoint GoUctPlayer<SEARCH, THREAD>::DoSearch(SgBlackWhite toPlay,
     return move;
 }
 
+/** Add the fraction of the games of the old search tree that are in the
+    reused subtree to the statistics.
+    @param initTreeCount The count of the root of the reused subtree
+    @param oldTreeCount The count of the root of the old search tree
+    @return The fraction, 0 if the old tree has no games */
+template <class SEARCH, class THREAD>
+float GoUctPlayer<SEARCH, THREAD>::AddReuse(SgUctValue initTreeCount,
+                                            SgUctValue oldTreeCount)
+{
+    const float reuse =
+        (oldTreeCount > 0 ? float(initTreeCount / oldTreeCount) : 0.f);
+    m_statistics.m_reuse.Add(reuse);
+    return reuse;
+}
+
 /** Find initial tree for search, if subtree reusing is enabled.
     Goes back in the tree until the node is found, the search tree is valid
     for and checks if the path of nodes corresponds to an alternating
     sequence of moves starting with the color to play of the search tree.
+    @return @c true, if the search tree was re-rooted in place and swapped
+    into initTree (see ReuseSubtreeInPlace())
     @see SetReuseSubtree */
 template <class SEARCH, class THREAD>
-void GoUctPlayer<SEARCH, THREAD>::FindInitTree(SgUctTree& initTree, 
+bool GoUctPlayer<SEARCH, THREAD>::FindInitTree(SgUctTree& initTree, 
                                                SgBlackWhite toPlay,
                                                double maxTime)
 {
@@ -898,26 +951,41 @@ void GoUctPlayer<SEARCH, THREAD>::FindInitTree(SgUctTree& initTree,
                                                     sequence))
     {
         SgDebug() << "GoUctPlayer: No tree to reuse found\n";
-        return;
+        return false;
     }
-    SgUctTreeUtil::ExtractSubtree(m_search.Tree(), initTree, sequence, true,
-                                  maxTime, m_search.PruneMinCount());
-    size_t initTreeNodes = initTree.NuNodes();
-    size_t oldTreeNodes = m_search.Tree().NuNodes();
-    if (oldTreeNodes > 1 && initTreeNodes >= 1)
+    const SgUctTree& tree = m_search.Tree();
+    bool isInPlace = false;
+    if (  m_reuseSubtreeInPlace
+       && (m_search.PruneFullTree() || 2 * tree.NuNodes() < tree.MaxNodes())
+       )
     {
-        float reuse = float(initTreeNodes) / float(oldTreeNodes);
-        int reusePercent = static_cast<int>(100 * reuse);
-        SgDebug() << "GoUctPlayer: Reusing " << initTreeNodes
-                  << " nodes (" << reusePercent << "%)\n";
-
-        //SgDebug() << SgWritePointList(sequence, "Sequence", false);
-        m_statistics.m_reuse.Add(reuse);
+        const SgUctValue oldTreeCount = tree.Root().MoveCount();
+        isInPlace = m_search.RerootTree(initTree, sequence);
+        if (isInPlace)
+        {
+            // Counting the reachable nodes would need a traversal of the
+            // tree, so the reuse is measured in games in both branches
+            const float reuse =
+                AddReuse(initTree.Root().MoveCount(), oldTreeCount);
+            SgDebug() << "GoUctPlayer: Reusing subtree in place ("
+                      << static_cast<int>(100 * reuse) << "% of games)\n";
+        }
+        else
+        {
+            SgDebug() << "GoUctPlayer: Subtree to reuse not found\n";
+            m_statistics.m_reuse.Add(0.f);
+        }
     }
     else
     {
-        SgDebug() << "GoUctPlayer: Subtree to reuse has 0 nodes\n";
-        m_statistics.m_reuse.Add(0.f);
+        const SgUctValue oldTreeCount = tree.Root().MoveCount();
+        SgUctTreeUtil::ExtractSubtree(tree, initTree, sequence, true,
+                                      maxTime, m_search.PruneMinCount());
+        const float reuse =
+            AddReuse(initTree.Root().MoveCount(), oldTreeCount);
+        SgDebug() << "GoUctPlayer: Reusing " << initTree.NuNodes()
+                  << " nodes (" << static_cast<int>(100 * reuse)
+                  << "% of games)\n";
     }
 
     // Check consistency
@@ -933,6 +1001,7 @@ void GoUctPlayer<SEARCH, THREAD>::FindInitTree(SgUctTree& initTree,
                 SG_ASSERT(false);
             }
     }
+    return isInPlace;
 }
 
 template <class SEARCH, class THREAD>
@@ -1036,6 +1105,20 @@ void GoUctPlayer<SEARCH, THREAD>::OnBoardChange()
     }
 }
 
+template <class SEARCH, class THREAD>
+void GoUctPlayer<SEARCH, THREAD>::SetProgressCallback(
+                                            const ProgressCallback& callback)
+{
+    GoPlayer::SetProgressCallback(callback);
+    if (callback)
+        m_search.SetAnalyzeCallback([callback](const std::string& info)
+                                    {
+                                        callback(info + '\n');
+                                    });
+    else
+        m_search.SetAnalyzeCallback(SgUctSearch::AnalyzeCallback());
+}
+
 template <class SEARCH, class THREAD>
 void GoUctPlayer<SEARCH, THREAD>::Ponder()
 {
@@ -1090,6 +1173,12 @@ void GoUctPlayer<SEARCH, THREAD>::SetReuseSubtree(bool enable)
     m_reuseSubtree = enable;
 }
 
+template <class SEARCH, class THREAD>
+void GoUctPlayer<SEARCH, THREAD>::SetReuseSubtreeInPlace(bool enable)
+{
+    m_reuseSubtreeInPlace = enable;
+}
+
 template <class SEARCH, class THREAD>
 SgDefaultTimeControl& GoUctPlayer<SEARCH, THREAD>::TimeControl()
 {
@@ -15,6 +15,7 @@ GoUctPlayoutPolicyParam::GoUctPlayoutPolicyParam()
       m_useNakadeHeuristic(false),
       m_usePatternsInPlayout(true),
       m_usePatternsInPriorKnowledge(true),
+      m_incrementalPatternCodes(false),
       m_fillboardTries(0),
       m_patternGammaThreshold(50.f),
       m_knowledgeType(KNOWLEDGE_GREENPEEP),
@@ -68,6 +68,11 @@ public:
     /** Use learned pattern probabilities in prior knowledge */
     bool m_usePatternsInPriorKnowledge;
 
+    /** Maintain the pattern codes incrementally in the playout board.
+        See GoUctBoard::SetPatternCodes(). Default is false, because the
+        speedup in the playouts was within the measurement noise. */
+    bool m_incrementalPatternCodes;
+
     /** See GoUctPureRandomGenerator::GenerateFillboardMove.
         Default is 0 */
     int m_fillboardTries;
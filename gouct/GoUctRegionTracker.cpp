@@ -0,0 +1,495 @@
+//----------------------------------------------------------------------------
+/** @file GoUctRegionTracker.cpp
+    See GoUctRegionTracker.h */
+//----------------------------------------------------------------------------
+
+#include "SgSystem.h"
+#include "GoUctRegionTracker.h"
+
+#include "GoUctBoard.h"
+#include "SgNbIterator.h"
+#include "SgStack.h"
+
+//----------------------------------------------------------------------------
+
+namespace {
+
+/** Do a consistency check after each update.
+    This is an expensive check and therefore has to be enabled at compile
+    time. */
+const bool CONSISTENCY = false;
+
+/** The 8 neighbors of a point in clockwise order, starting with a 4-neighbor.
+    Consecutive neighbors are 4-neighbors of each other. */
+const int RING[8] = {
+    -SG_NS, -SG_NS + SG_WE, SG_WE, SG_NS + SG_WE,
+    SG_NS, SG_NS - SG_WE, -SG_WE, -SG_NS - SG_WE
+};
+
+} // namespace
+
+//----------------------------------------------------------------------------
+
+const int GoUctRegionTracker::NO_REGION;
+
+GoUctRegionTracker::GoUctRegionTracker()
+    : m_board(0),
+      m_numSplitSearches(0)
+{ }
+
+/** Add a point that is no longer occupied by c to the regions of c.
+    Creates a new region, adds the point to the largest adjacent region and
+    merges the other adjacent regions into it. */
+void GoUctRegionTracker::AddPoint(SgPoint p, SgBlackWhite c)
+{
+    SG_ASSERT(m_regionIndex[c][p] == NO_REGION);
+    const SgArray<int,SG_MAXPOINT>& regionIndex = m_regionIndex[c];
+    int adjRegions[4];
+    int numAdjRegions = 0;
+    int largest = NO_REGION;
+    for (SgNb4Iterator it(p); it; ++it)
+    {
+        const int index = regionIndex[*it];
+        if (index == NO_REGION)
+            continue;
+        bool isNew = true;
+        for (int i = 0; i < numAdjRegions; ++i)
+            if (adjRegions[i] == index)
+                isNew = false;
+        if (! isNew)
+            continue;
+        adjRegions[numAdjRegions++] = index;
+        if (  largest == NO_REGION
+           || m_regions[c][index].m_size > m_regions[c][largest].m_size
+           )
+            largest = index;
+    }
+    if (largest == NO_REGION)
+    {
+        CreateRegion(c, p);
+        return;
+    }
+    InsertPoint(c, largest, p);
+    for (int i = 0; i < numAdjRegions; ++i)
+        if (adjRegions[i] != largest)
+            MergeRegions(c, largest, adjRegions[i]);
+}
+
+void GoUctRegionTracker::CheckConsistency() const
+{
+    if (! CONSISTENCY)
+        return;
+    const GoUctBoard& bd = *m_board;
+    for (SgBWIterator cit; cit; ++cit)
+    {
+        const SgBlackWhite c = *cit;
+        SgMarker mark;
+        int numRegions = 0;
+        for (GoUctBoard::Iterator it(bd); it; ++it)
+        {
+            SgPoint p = *it;
+            if (bd.IsColor(p, c))
+            {
+                SG_ASSERT(m_regionIndex[c][p] == NO_REGION);
+                continue;
+            }
+            if (mark.Contains(p))
+                continue;
+            ++numRegions;
+            const int index = m_regionIndex[c][p];
+            SG_ASSERT(index != NO_REGION);
+            int size = 0;
+            int numEmpty = 0;
+            SgStack<SgPoint,SG_MAXPOINT> stack;
+            mark.Include(p);
+            stack.Push(p);
+            while (! stack.IsEmpty())
+            {
+                SgPoint q = stack.Pop();
+                SG_ASSERT(m_regionIndex[c][q] == index);
+                ++size;
+                if (bd.IsEmpty(q))
+                    ++numEmpty;
+                for (SgNb4Iterator it2(q); it2; ++it2)
+                    if (  ! bd.IsBorder(*it2) && ! bd.IsColor(*it2, c)
+                       && mark.NewMark(*it2)
+                       )
+                        stack.Push(*it2);
+            }
+            SG_ASSERT(size == m_regions[c][index].m_size);
+            SG_ASSERT(numEmpty == m_regions[c][index].m_numEmpty);
+            int listSize = 0;
+            for (Iterator it2(*this, p, c); it2; ++it2)
+            {
+                SG_ASSERT(m_regionIndex[c][*it2] == index);
+                SG_ASSERT(m_prev[c][m_next[c][*it2]] == *it2);
+                ++listSize;
+            }
+            SG_ASSERT(listSize == size);
+        }
+        SG_ASSERT(numRegions == NumRegions(c));
+    }
+}
+
+/** Create a region containing a single point.
+    @return The index of the region */
+int GoUctRegionTracker::CreateRegion(SgBlackWhite c, SgPoint p)
+{
+    const int index = m_freeRegions[c].Last();
+    m_freeRegions[c].PopBack();
+    Region& region = m_regions[c][index];
+    region.m_size = 1;
+    region.m_numEmpty = (m_board->IsEmpty(p) ? 1 : 0);
+    region.m_first = p;
+    m_regionIndex[c][p] = index;
+    m_next[c][p] = p;
+    m_prev[c][p] = p;
+    return index;
+}
+
+/** Create the region of c that contains a point by a flood fill. */
+void GoUctRegionTracker::FillRegion(SgBlackWhite c, SgPoint p)
+{
+    const GoUctBoard& bd = *m_board;
+    const int index = CreateRegion(c, p);
+    SgStack<SgPoint,SG_MAXPOINT> stack;
+    stack.Push(p);
+    while (! stack.IsEmpty())
+    {
+        SgPoint q = stack.Pop();
+        for (SgNb4Iterator it(q); it; ++it)
+        {
+            SgPoint nb = *it;
+            if (  ! bd.IsBorder(nb) && ! bd.IsColor(nb, c)
+               && m_regionIndex[c][nb] == NO_REGION
+               )
+            {
+                InsertPoint(c, index, nb);
+                stack.Push(nb);
+            }
+        }
+    }
+}
+
+void GoUctRegionTracker::FreeRegion(SgBlackWhite c, int index)
+{
+    m_freeRegions[c].PushBack(index);
+}
+
+void GoUctRegionTracker::Init(const GoUctBoard& bd)
+{
+    m_board = &bd;
+    m_numSplitSearches = 0;
+    for (SgBWIterator cit; cit; ++cit)
+    {
+        const SgBlackWhite c = *cit;
+        m_regionIndex[c].Fill(NO_REGION);
+        m_freeRegions[c].Clear();
+        for (int i = SG_MAXPOINT - 1; i >= 0; --i)
+            m_freeRegions[c].PushBack(i);
+        for (GoUctBoard::Iterator it(bd); it; ++it)
+            if (! bd.IsColor(*it, c) && m_regionIndex[c][*it] == NO_REGION)
+                FillRegion(c, *it);
+    }
+    CheckConsistency();
+}
+
+/** Add a point to the list of points of a region. */
+void GoUctRegionTracker::InsertPoint(SgBlackWhite c, int index, SgPoint p)
+{
+    Region& region = m_regions[c][index];
+    SgArray<SgPoint,SG_MAXPOINT>& next = m_next[c];
+    SgArray<SgPoint,SG_MAXPOINT>& prev = m_prev[c];
+    const SgPoint first = region.m_first;
+    const SgPoint second = next[first];
+    next[first] = p;
+    prev[p] = first;
+    next[p] = second;
+    prev[second] = p;
+    ++region.m_size;
+    if (m_board->IsEmpty(p))
+        ++region.m_numEmpty;
+    m_regionIndex[c][p] = index;
+}
+
+/** Find the 4-neighbors of a point that are not connected to each other in
+    a region by the 8 neighbors of the point.
+    The point must already be removed from the region.
+    @param p The point
+    @param c The color of the region
+    @param index The index of the region
+    @param[out] seeds One 4-neighbor of each group of 4-neighbors in the
+    region, which are connected by the 8 neighbors
+    @return The number of seeds */
+int GoUctRegionTracker::LocalSeeds(SgPoint p, SgBlackWhite c, int index,
+                                   SgPoint seeds[MAX_SEARCHES]) const
+{
+    const SgArray<int,SG_MAXPOINT>& regionIndex = m_regionIndex[c];
+    bool isInRegion[8];
+    int start = -1;
+    for (int i = 0; i < 8; ++i)
+    {
+        isInRegion[i] = (regionIndex[p + RING[i]] == index);
+        if (! isInRegion[i])
+            start = i;
+    }
+    if (start < 0)
+    {
+        // All 8 neighbors are in the region
+        seeds[0] = p + RING[0];
+        return 1;
+    }
+    int numSeeds = 0;
+    SgPoint seed = SG_NULLPOINT;
+    for (int k = 1; k <= 8; ++k)
+    {
+        const int i = (start + k) % 8;
+        if (! isInRegion[i])
+        {
+            if (seed != SG_NULLPOINT)
+            {
+                seeds[numSeeds++] = seed;
+                seed = SG_NULLPOINT;
+            }
+        }
+        else if (i % 2 == 0 && seed == SG_NULLPOINT)
+            seed = p + RING[i];
+    }
+    // The last neighbor (start) is not in the region, so the last group
+    // has been added
+    SG_ASSERT(seed == SG_NULLPOINT);
+    return numSeeds;
+}
+
+/** Merge a region into another region. */
+void GoUctRegionTracker::MergeRegions(SgBlackWhite c, int index, int other)
+{
+    SG_ASSERT(index != other);
+    Region& region = m_regions[c][index];
+    const Region& otherRegion = m_regions[c][other];
+    SgArray<int,SG_MAXPOINT>& regionIndex = m_regionIndex[c];
+    SgArray<SgPoint,SG_MAXPOINT>& next = m_next[c];
+    SgArray<SgPoint,SG_MAXPOINT>& prev = m_prev[c];
+    SgPoint p = otherRegion.m_first;
+    do
+    {
+        regionIndex[p] = index;
+        p = next[p];
+    }
+    while (p != otherRegion.m_first);
+    // Splice the circular lists
+    const SgPoint first = region.m_first;
+    const SgPoint second = next[first];
+    const SgPoint otherFirst = otherRegion.m_first;
+    const SgPoint otherLast = prev[otherFirst];
+    next[first] = otherFirst;
+    prev[otherFirst] = first;
+    next[otherLast] = second;
+    prev[second] = otherLast;
+    region.m_size += otherRegion.m_size;
+    region.m_numEmpty += otherRegion.m_numEmpty;
+    FreeRegion(c, other);
+}
+
+void GoUctRegionTracker::OnPlay(SgPoint p, SgBlackWhite c)
+{
+    SG_ASSERT(m_board);
+    SG_ASSERT(m_board->IsColor(p, c));
+    const SgBlackWhite opp = SgOppBW(c);
+    const GoPointList& captured = m_board->CapturedStones();
+    // p stays in the region of the opponent, the captured stones stay in
+    // the regions of c. Update the number of empty points before
+    // RemovePoint(), which reads the colors of the moved points.
+    --m_regions[opp][m_regionIndex[opp][p]].m_numEmpty;
+    for (GoPointList::Iterator it(captured); it; ++it)
+        ++m_regions[c][m_regionIndex[c][*it]].m_numEmpty;
+    RemovePoint(p, c);
+    for (GoPointList::Iterator it(captured); it; ++it)
+        AddPoint(*it, opp);
+    CheckConsistency();
+}
+
+/** Remove a point that became occupied by c from the regions of c.
+    Removes the region if it becomes empty and splits it if the point
+    connected several parts of the region. */
+void GoUctRegionTracker::RemovePoint(SgPoint p, SgBlackWhite c)
+{
+    const int index = m_regionIndex[c][p];
+    SG_ASSERT(index != NO_REGION);
+    Region& region = m_regions[c][index];
+    UnlinkPoint(c, p);
+    --region.m_numEmpty;
+    if (region.m_size == 0)
+    {
+        FreeRegion(c, index);
+        return;
+    }
+    SgPoint seeds[MAX_SEARCHES];
+    const int numSeeds = LocalSeeds(p, c, index, seeds);
+    if (numSeeds > 1)
+        SplitRegion(c, index, seeds, numSeeds);
+}
+
+/** Split a region into its connected parts after a point was removed.
+    Searches the region from each seed in turn, one point at a time. A
+    search that reaches a point of another search joins the group of that
+    search. A group whose searches have no more points to expand has found
+    a separate part of the region. The searches stop as soon as only one
+    group is left, or only one group has points to expand, which keeps the
+    original region (or the largest group, if all groups are finished). The
+    points of the other groups are moved to new regions.
+    @param c The color of the region
+    @param index The region
+    @param seeds Points of the region, which are not connected in the
+    neighborhood of the removed point
+    @param numSeeds The number of seeds, at most MAX_SEARCHES */
+void GoUctRegionTracker::SplitRegion(SgBlackWhite c, int index,
+                                     const SgPoint* seeds, int numSeeds)
+{
+    SG_ASSERT(numSeeds >= 2 && numSeeds <= MAX_SEARCHES);
+    ++m_numSplitSearches;
+    const SgArray<int,SG_MAXPOINT>& regionIndex = m_regionIndex[c];
+    SgReserveMarker reserve(m_marker);
+    m_marker.Clear();
+    int group[MAX_SEARCHES];
+    int head[MAX_SEARCHES];
+    for (int i = 0; i < numSeeds; ++i)
+    {
+        group[i] = i;
+        head[i] = 0;
+        m_reached[i].SetTo(seeds[i]);
+        m_marker.Include(seeds[i]);
+        m_searchOf[seeds[i]] = i;
+    }
+    int numGroups = numSeeds;
+    while (true)
+    {
+        for (int i = 0; i < numSeeds; ++i)
+        {
+            SgArrayList<SgPoint,SG_MAXPOINT>& reached = m_reached[i];
+            if (head[i] == reached.Length())
+                continue;
+            const SgPoint p = reached[head[i]++];
+            for (SgNb4Iterator it(p); it; ++it)
+            {
+                const SgPoint nb = *it;
+                if (regionIndex[nb] != index)
+                    continue;
+                if (m_marker.NewMark(nb))
+                {
+                    m_searchOf[nb] = i;
+                    reached.PushBack(nb);
+                }
+                else
+                {
+                    const int g = group[m_searchOf[nb]];
+                    if (g != group[i])
+                    {
+                        // Two searches met, join their groups
+                        const int oldGroup = group[i];
+                        for (int j = 0; j < numSeeds; ++j)
+                            if (group[j] == oldGroup)
+                                group[j] = g;
+                        --numGroups;
+                    }
+                }
+            }
+        }
+        if (numGroups == 1)
+            // No split
+            return;
+        int numActiveGroups = 0;
+        for (int g = 0; g < numSeeds; ++g)
+        {
+            bool isGroup = false;
+            bool isActive = false;
+            for (int i = 0; i < numSeeds; ++i)
+                if (group[i] == g)
+                {
+                    isGroup = true;
+                    if (head[i] < m_reached[i].Length())
+                        isActive = true;
+                }
+            if (isGroup && isActive)
+                ++numActiveGroups;
+        }
+        if (numActiveGroups <= 1)
+            break;
+    }
+    // Find the group that keeps the region: the active group, or the group
+    // with the most points, if all groups are finished
+    int keepGroup = -1;
+    int keepSize = -1;
+    for (int g = 0; g < numSeeds; ++g)
+    {
+        int size = 0;
+        bool isActive = false;
+        bool isGroup = false;
+        for (int i = 0; i < numSeeds; ++i)
+            if (group[i] == g)
+            {
+                isGroup = true;
+                size += m_reached[i].Length();
+                if (head[i] < m_reached[i].Length())
+                    isActive = true;
+            }
+        if (! isGroup)
+            continue;
+        if (isActive)
+        {
+            keepGroup = g;
+            break;
+        }
+        if (size > keepSize)
+        {
+            keepGroup = g;
+            keepSize = size;
+        }
+    }
+    // Move the points of the other groups to new regions
+    Region& region = m_regions[c][index];
+    for (int g = 0; g < numSeeds; ++g)
+    {
+        if (g == keepGroup)
+            continue;
+        int newIndex = NO_REGION;
+        for (int i = 0; i < numSeeds; ++i)
+        {
+            if (group[i] != g)
+                continue;
+            for (SgArrayList<SgPoint,SG_MAXPOINT>::Iterator it(m_reached[i]);
+                 it; ++it)
+            {
+                const SgPoint p = *it;
+                const bool isEmpty = m_board->IsEmpty(p);
+                UnlinkPoint(c, p);
+                if (isEmpty)
+                    --region.m_numEmpty;
+                if (newIndex == NO_REGION)
+                    newIndex = CreateRegion(c, p);
+                else
+                    InsertPoint(c, newIndex, p);
+            }
+        }
+    }
+    SG_ASSERT(region.m_size > 0);
+}
+
+/** Remove a point from the list of points of its region.
+    Updates the size, but not the number of empty points of the region. */
+void GoUctRegionTracker::UnlinkPoint(SgBlackWhite c, SgPoint p)
+{
+    Region& region = m_regions[c][m_regionIndex[c][p]];
+    SgArray<SgPoint,SG_MAXPOINT>& next = m_next[c];
+    SgArray<SgPoint,SG_MAXPOINT>& prev = m_prev[c];
+    const SgPoint nextPoint = next[p];
+    const SgPoint prevPoint = prev[p];
+    next[prevPoint] = nextPoint;
+    prev[nextPoint] = prevPoint;
+    if (region.m_first == p)
+        region.m_first = nextPoint;
+    --region.m_size;
+    m_regionIndex[c][p] = NO_REGION;
+}
+
+//----------------------------------------------------------------------------
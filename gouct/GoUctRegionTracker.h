@@ -0,0 +1,272 @@
+//----------------------------------------------------------------------------
+/** @file GoUctRegionTracker.h
+    Incremental regions of a GoUctBoard. */
+//----------------------------------------------------------------------------
+
+#ifndef GOUCT_REGIONTRACKER_H
+#define GOUCT_REGIONTRACKER_H
+
+#include "SgArray.h"
+#include "SgArrayList.h"
+#include "SgBlackWhite.h"
+#include "SgBWArray.h"
+#include "SgMarker.h"
+#include "SgPoint.h"
+
+class GoUctBoard;
+
+//----------------------------------------------------------------------------
+
+/** Regions of both colors of a GoUctBoard, updated incrementally after each
+    move.
+    A region of a color is a maximal 4-connected set of points that are not
+    occupied by that color, as the regions of GoRegionBoard. In contrast to
+    GoRegionBoard, which needs a GoBoard and rebuilds the affected regions
+    and blocks in GoRegionBoard::OnExecutedMove(), the tracker only keeps
+    the points, the size and the number of empty points of each region,
+    such that it is cheap enough to be updated in the playouts. The blocks
+    are those of GoUctBoard; the eye and safety information of GoRegion is
+    not computed.
+
+    The tracker is attached to a board with GoUctBoard::SetRegionTracker()
+    and then updated by GoUctBoard::Play(). A move removes a point from the
+    regions of the color to play, which can split a region, and adds the
+    captured stones to the regions of the opponent, which can merge regions.
+    Merges relabel the points of the smaller regions. Whether a region is
+    split is first decided from the 8 neighbors of the move; only if these
+    do not connect the neighbors of the move in the region, the tracker
+    searches from each neighbor in turn, one point at a time, until all
+    but one of the searches have met or exhausted their part of the
+    region. Therefore the cost of a split is proportional to the size of
+    the smaller parts. */
+class GoUctRegionTracker
+{
+public:
+    /** Region index of points that are not in a region of a color. */
+    static const int NO_REGION = -1;
+
+    GoUctRegionTracker();
+
+    /** Compute the regions of the current position of a board.
+        Called by GoUctBoard::SetRegionTracker() and GoUctBoard::Init().
+        The board must stay alive while the tracker is attached to it. */
+    void Init(const GoUctBoard& bd);
+
+    /** Update the regions after a move.
+        Called by GoUctBoard::Play() after the move and the captures were
+        executed on the board.
+        @param p The move, not a pass
+        @param c The color of the move */
+    void OnPlay(SgPoint p, SgBlackWhite c);
+
+    /** Number of regions of a color. */
+    int NumRegions(SgBlackWhite c) const;
+
+    /** Index of the region of a color that contains a point.
+        The index is a number between 0 and SG_MAXPOINT - 1. It does not
+        change while the region is only merged with smaller regions or
+        loses points; the indices of removed regions are reused.
+        @return The index or NO_REGION, if the point is occupied by c or a
+        border point */
+    int RegionIndex(SgPoint p, SgBlackWhite c) const;
+
+    /** Return whether two points are in the same region of a color. */
+    bool InSameRegion(SgPoint p1, SgPoint p2, SgBlackWhite c) const;
+
+    /** Number of points of the region of a color that contains a point.
+        @pre RegionIndex(p, c) != NO_REGION */
+    int RegionSize(SgPoint p, SgBlackWhite c) const;
+
+    /** Number of empty points of the region of a color that contains a
+        point. The other points of the region are stones of the opponent.
+        @pre RegionIndex(p, c) != NO_REGION */
+    int NumEmpty(SgPoint p, SgBlackWhite c) const;
+
+    /** Number of searches done to decide whether a move split a region.
+        Counts the moves, which could not be decided from the 8 neighbors,
+        since the last Init(). */
+    int NumSplitSearches() const;
+
+    /** Check that the regions are those of the board.
+        This is an expensive check and therefore has to be enabled at
+        compile time (see GoUctRegionTracker.cpp). */
+    void CheckConsistency() const;
+
+    /** Iterate through the points of the region of a color that contains a
+        point.
+        No moves are allowed to be executed during the iteration. */
+    class Iterator
+    {
+    public:
+        /** @pre RegionIndex(p, c) != NO_REGION */
+        Iterator(const GoUctRegionTracker& tracker, SgPoint p,
+                 SgBlackWhite c);
+
+        /** Advance the state of the iteration to the next point. */
+        void operator++();
+
+        /** Return the current point. */
+        SgPoint operator*() const;
+
+        /** Return true if iteration is valid, otherwise false. */
+        operator bool() const;
+
+    private:
+        const SgArray<SgPoint,SG_MAXPOINT>& m_next;
+
+        SgPoint m_first;
+
+        SgPoint m_current;
+
+        bool m_isValid;
+
+        /** Not implemented. */
+        operator int() const;
+
+        /** Not implemented. */
+        Iterator(const Iterator&);
+
+        /** Not implemented. */
+        Iterator& operator=(const Iterator&);
+    };
+
+private:
+    /** Data of a region. */
+    struct Region
+    {
+        int m_size;
+
+        int m_numEmpty;
+
+        /** A point of the region, start of the list of its points. */
+        SgPoint m_first;
+    };
+
+    /** Maximum number of searches in a split. */
+    static const int MAX_SEARCHES = 4;
+
+    const GoUctBoard* m_board;
+
+    /** Region index of each point for each color. */
+    SgBWArray<SgArray<int,SG_MAXPOINT> > m_regionIndex;
+
+    /** Next point of the same region in a circular list. */
+    SgBWArray<SgArray<SgPoint,SG_MAXPOINT> > m_next;
+
+    /** Previous point of the same region in a circular list. */
+    SgBWArray<SgArray<SgPoint,SG_MAXPOINT> > m_prev;
+
+    SgBWArray<SgArray<Region,SG_MAXPOINT> > m_regions;
+
+    /** Indices of the unused regions. */
+    SgBWArray<SgArrayList<int,SG_MAXPOINT> > m_freeRegions;
+
+    /** See NumSplitSearches() */
+    int m_numSplitSearches;
+
+    /** @name Data of the searches in SplitRegion() */
+    // @{
+
+    SgMarker m_marker;
+
+    /** The search that reached a marked point first. */
+    SgArray<int,SG_MAXPOINT> m_searchOf;
+
+    /** Points reached by each search in the order they were reached. */
+    SgArray<SgArrayList<SgPoint,SG_MAXPOINT>,MAX_SEARCHES> m_reached;
+
+    // @} // @name
+
+    void AddPoint(SgPoint p, SgBlackWhite c);
+
+    int CreateRegion(SgBlackWhite c, SgPoint p);
+
+    void FillRegion(SgBlackWhite c, SgPoint p);
+
+    void FreeRegion(SgBlackWhite c, int index);
+
+    void InsertPoint(SgBlackWhite c, int index, SgPoint p);
+
+    int LocalSeeds(SgPoint p, SgBlackWhite c, int index,
+                   SgPoint seeds[MAX_SEARCHES]) const;
+
+    void MergeRegions(SgBlackWhite c, int index, int other);
+
+    void RemovePoint(SgPoint p, SgBlackWhite c);
+
+    void SplitRegion(SgBlackWhite c, int index, const SgPoint* seeds,
+                     int numSeeds);
+
+    void UnlinkPoint(SgBlackWhite c, SgPoint p);
+
+    /** Not implemented. */
+    GoUctRegionTracker(const GoUctRegionTracker&);
+
+    /** Not implemented. */
+    GoUctRegionTracker& operator=(const GoUctRegionTracker&);
+};
+
+inline bool GoUctRegionTracker::InSameRegion(SgPoint p1, SgPoint p2,
+                                             SgBlackWhite c) const
+{
+    const int index = m_regionIndex[c][p1];
+    return index != NO_REGION && index == m_regionIndex[c][p2];
+}
+
+inline int GoUctRegionTracker::NumEmpty(SgPoint p, SgBlackWhite c) const
+{
+    SG_ASSERT(m_regionIndex[c][p] != NO_REGION);
+    return m_regions[c][m_regionIndex[c][p]].m_numEmpty;
+}
+
+inline int GoUctRegionTracker::NumRegions(SgBlackWhite c) const
+{
+    return SG_MAXPOINT - m_freeRegions[c].Length();
+}
+
+inline int GoUctRegionTracker::NumSplitSearches() const
+{
+    return m_numSplitSearches;
+}
+
+inline int GoUctRegionTracker::RegionIndex(SgPoint p, SgBlackWhite c) const
+{
+    return m_regionIndex[c][p];
+}
+
+inline int GoUctRegionTracker::RegionSize(SgPoint p, SgBlackWhite c) const
+{
+    SG_ASSERT(m_regionIndex[c][p] != NO_REGION);
+    return m_regions[c][m_regionIndex[c][p]].m_size;
+}
+
+inline GoUctRegionTracker::Iterator::Iterator(
+                                          const GoUctRegionTracker& tracker,
+                                          SgPoint p, SgBlackWhite c)
+    : m_next(tracker.m_next[c]),
+      m_first(tracker.m_regions[c][tracker.m_regionIndex[c][p]].m_first),
+      m_current(m_first),
+      m_isValid(true)
+{
+    SG_ASSERT(tracker.m_regionIndex[c][p] != NO_REGION);
+}
+
+inline void GoUctRegionTracker::Iterator::operator++()
+{
+    m_current = m_next[m_current];
+    m_isValid = (m_current != m_first);
+}
+
+inline SgPoint GoUctRegionTracker::Iterator::operator*() const
+{
+    return m_current;
+}
+
+inline GoUctRegionTracker::Iterator::operator bool() const
+{
+    return m_isValid;
+}
+
+//----------------------------------------------------------------------------
+
+#endif // GOUCT_REGIONTRACKER_H
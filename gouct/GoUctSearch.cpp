@@ -132,6 +132,12 @@ void GoUctState::ExecutePlayout(SgMove move)
     ++m_gameLength;
 }
 
+std::uint64_t GoUctState::PositionHash() const
+{
+    const SgHashCode hash = m_bd.GetHashCodeInclToPlay();
+    return (std::uint64_t(hash.Code1()) << 32) | hash.Code2();
+}
+
 void GoUctState::GameStart()
 {
     m_isInPlayout = false;
@@ -148,6 +154,11 @@ void GoUctState::StartPlayouts()
     m_isInPlayout = true;
 }
 
+void GoUctState::SetPatternCodes(bool enable)
+{
+    m_uctBd.SetPatternCodes(enable);
+}
+
 void GoUctState::StartSearch()
 {
     m_synchronizer.UpdateSubscriber();
@@ -212,7 +223,10 @@ void GoUctSearch::OnSearchIteration(SgUctValue gameNumber,
         DisplayGfx();
     }
     if (! LockFree() && m_root != 0)
+    {
+        SgNodeArena::Scope scope(&m_gameArena);
         AppendGame(m_root, gameNumber, threadId, m_toPlay, info);
+    }
 }
 
 void GoUctSearch::DisplayGfx()
@@ -246,8 +260,10 @@ void GoUctSearch::OnStartSearch()
         m_root->DeleteTree();
         m_root = 0;
     }
+    m_gameArena.Clear();
     if (m_keepGames)
     {
+        SgNodeArena::Scope scope(&m_gameArena);
         m_root = GoNodeUtil::CreateRoot(m_bd);
         if (LockFree())
             SgWarning() <<
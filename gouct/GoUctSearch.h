@@ -12,6 +12,7 @@
 #include "GoUctBoard.h"
 #include "SgUctSearch.h"
 #include "SgBlackWhite.h"
+#include "SgNodeArena.h"
 #include "SgStatistics.h"
 
 class SgNode;
@@ -58,6 +59,9 @@ public:
 
     void StartPlayouts();
 
+    /** Hash code of Board() including the color to play. */
+    std::uint64_t PositionHash() const;
+
     // @} // @name
 
     /** Board used during in-tree phase. */
@@ -66,6 +70,9 @@ public:
     /** Board used during playout phase. */
     const GoUctBoard& UctBoard() const;
 
+    /** See GoUctBoard::SetPatternCodes() */
+    void SetPatternCodes(bool enable);
+
     bool IsInPlayout() const;
 
     /** Length of the current game from the root position of the search. */
@@ -263,6 +270,9 @@ private:
 
     GoBoard& m_bd;
 
+    /** Memory for the nodes of m_root. */
+    SgNodeArena m_gameArena;
+
     /** See SetKeepGames() */
     SgNode* m_root;
 
@@ -7,6 +7,7 @@
 
 #include <boost/test/unit_test.hpp>
 #include "GoUctBoard.h"
+#include "SgRandom.h"
 
 using SgPointUtil::Pt;
 
@@ -52,6 +53,70 @@ BOOST_AUTO_TEST_CASE(GoUctBoardTest_IsLibertyOfBlock)
     BOOST_CHECK(! bd.IsLibertyOfBlock(Pt(2, 3), bd.Anchor(Pt(1, 2))));
 }
 
+/** Compute the pattern code of a point from scratch in the order
+    documented in GoUctBoard::PatternCode(). */
+int ComputePatternCode(const GoUctBoard& bd, SgPoint p)
+{
+    int code = 0;
+    if (bd.Line(p) > 1)
+        for (int i = 0; i < 8; ++i)
+            code = 3 * code + bd.GetColor(p + SgNb8Iterator::Direction(i));
+    else
+    {
+        const int up = bd.Up(p);
+        const int other = (up == SG_NS || up == -SG_NS) ? SG_WE : SG_NS;
+        const int dir[5] = { other, up + other, up, up - other, -other };
+        for (int i = 0; i < 5; ++i)
+            code = 3 * code + bd.GetColor(p + dir[i]);
+    }
+    return code;
+}
+
+void CheckPatternCodes(const GoUctBoard& bd)
+{
+    for (GoUctBoard::Iterator it(bd); it; ++it)
+        if (bd.Line(*it) > 1 || bd.Pos(*it) > 1)
+            BOOST_REQUIRE_EQUAL(bd.PatternCode(*it),
+                                ComputePatternCode(bd, *it));
+}
+
+/** Check the incremental pattern codes in random games with captures. */
+BOOST_AUTO_TEST_CASE(GoUctBoardTest_PatternCodes)
+{
+    GoSetup setup;
+    setup.AddBlack(Pt(1, 2));
+    setup.AddWhite(Pt(5, 5));
+    GoBoard board(9, setup);
+    auto pbd = GoUctBoard::create(board);
+    GoUctBoard& bd = *pbd;
+    bd.SetPatternCodes(true);
+    BOOST_CHECK(bd.HasPatternCodes());
+    CheckPatternCodes(bd);
+    SgRandom random;
+    int nuCaptures = 0;
+    for (int game = 0; game < 20; ++game)
+    {
+        bd.Init(board);
+        CheckPatternCodes(bd);
+        for (int i = 0; i < 200; ++i)
+        {
+            GoPointList moves;
+            for (GoUctBoard::Iterator it(bd); it; ++it)
+                if (  bd.IsEmpty(*it)
+                   && bd.IsLegal(*it)
+                   && ! GoBoardUtil::IsCompletelySurrounded(bd, *it)
+                   )
+                    moves.PushBack(*it);
+            if (moves.IsEmpty())
+                break;
+            bd.Play(moves[random.Int(moves.Length())]);
+            nuCaptures += bd.NuCapturedStones();
+            CheckPatternCodes(bd);
+        }
+    }
+    BOOST_CHECK(nuCaptures > 0);
+}
+
 } // namespace
 
 //----------------------------------------------------------------------------
@@ -0,0 +1,105 @@
+//----------------------------------------------------------------------------
+/** @file GoUctPatternsTest.cpp
+    Unit tests for GoUctPatterns. */
+//----------------------------------------------------------------------------
+
+#include "SgSystem.h"
+
+#include <boost/test/unit_test.hpp>
+#include "GoBoard.h"
+#include "GoSetup.h"
+#include "GoUctBoard.h"
+#include "GoUctPatterns.h"
+
+using SgPointUtil::Pt;
+
+//----------------------------------------------------------------------------
+
+namespace {
+
+/** Check MatchAny() on a GoBoard and a GoUctBoard for both colors. */
+void CheckMatchAny(GoSetup setup, SgPoint p, bool expected)
+{
+    for (SgBWIterator it; it; ++it)
+    {
+        setup.m_player = *it;
+        GoBoard bd(9, setup);
+        GoUctPatterns<GoBoard> patterns(bd);
+        BOOST_CHECK_EQUAL(patterns.MatchAny(p), expected);
+        auto uctBd = GoUctBoard::create(bd);
+        GoUctPatterns<GoUctBoard> uctPatterns(*uctBd);
+        BOOST_CHECK_EQUAL(uctPatterns.MatchAny(p), expected);
+    }
+}
+
+/** Hane pattern in the center.
+    @verbatim
+    6 . . . . .
+    5 . X O X .
+    4 . . + . .
+    3 . . . . .
+      B C D E F
+    @endverbatim */
+BOOST_AUTO_TEST_CASE(GoUctPatternsTest_Hane)
+{
+    GoSetup setup;
+    setup.AddBlack(Pt(3, 5));
+    setup.AddWhite(Pt(4, 5));
+    setup.AddBlack(Pt(5, 5));
+    CheckMatchAny(setup, Pt(4, 4), true);
+    CheckMatchAny(setup, Pt(4, 3), false);
+}
+
+/** Cut pattern in the center.
+    @verbatim
+    6 . . . . .
+    5 . X O . .
+    4 . O + . .
+    3 . . . . .
+      B C D E F
+    @endverbatim */
+BOOST_AUTO_TEST_CASE(GoUctPatternsTest_Cut)
+{
+    GoSetup setup;
+    setup.AddBlack(Pt(3, 5));
+    setup.AddWhite(Pt(4, 5));
+    setup.AddWhite(Pt(3, 4));
+    CheckMatchAny(setup, Pt(4, 4), true);
+    // Cut1 does not match with a third adjacent stone and one liberty
+    setup.AddWhite(Pt(5, 4));
+    CheckMatchAny(setup, Pt(4, 4), false);
+}
+
+/** Edge pattern and the excluded corner points.
+    @verbatim
+    3 . . . . .
+    2 X . X . .
+    1 + O O + .
+      A B C D E
+    @endverbatim */
+BOOST_AUTO_TEST_CASE(GoUctPatternsTest_Edge)
+{
+    GoSetup setup;
+    setup.AddBlack(Pt(3, 2));
+    setup.AddWhite(Pt(3, 1));
+    CheckMatchAny(setup, Pt(4, 1), true);
+    CheckMatchAny(setup, Pt(5, 1), false);
+    setup.AddBlack(Pt(1, 2));
+    setup.AddWhite(Pt(2, 1));
+    CheckMatchAny(setup, Pt(1, 1), false);
+}
+
+/** Points without adjacent stones never match. */
+BOOST_AUTO_TEST_CASE(GoUctPatternsTest_NoAdjacentStones)
+{
+    GoSetup setup;
+    setup.AddBlack(Pt(3, 3));
+    setup.AddWhite(Pt(5, 3));
+    setup.AddWhite(Pt(3, 5));
+    setup.AddBlack(Pt(5, 5));
+    CheckMatchAny(setup, Pt(4, 4), false);
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------
@@ -0,0 +1,170 @@
+//----------------------------------------------------------------------------
+/** @file GoUctRegionTrackerTest.cpp
+    Unit tests for GoUctRegionTracker. */
+//----------------------------------------------------------------------------
+
+#include "SgSystem.h"
+
+#include <map>
+#include <boost/test/unit_test.hpp>
+#include "GoBoardUtil.h"
+#include "GoUctBoard.h"
+#include "GoUctRegionTracker.h"
+#include "SgRandom.h"
+
+using SgPointUtil::Pt;
+
+//----------------------------------------------------------------------------
+
+namespace {
+
+/** Compare the regions of a color with regions computed by flood fill. */
+void CheckRegions(const GoUctBoard& bd, const GoUctRegionTracker& tracker,
+                  SgBlackWhite c)
+{
+    SgArray<int,SG_MAXPOINT> fillIndex;
+    fillIndex.Fill(GoUctRegionTracker::NO_REGION);
+    std::map<int,int> indexOfFill;
+    int nuRegions = 0;
+    for (GoUctBoard::Iterator it(bd); it; ++it)
+    {
+        if (bd.GetColor(*it) == c)
+        {
+            BOOST_REQUIRE_EQUAL(tracker.RegionIndex(*it, c),
+                                GoUctRegionTracker::NO_REGION);
+            continue;
+        }
+        if (fillIndex[*it] != GoUctRegionTracker::NO_REGION)
+            continue;
+        int size = 0;
+        int nuEmpty = 0;
+        SgArrayList<SgPoint,SG_MAXPOINT> stack;
+        stack.PushBack(*it);
+        fillIndex[*it] = nuRegions;
+        while (! stack.IsEmpty())
+        {
+            const SgPoint p = stack.Last();
+            stack.PopBack();
+            ++size;
+            if (bd.IsEmpty(p))
+                ++nuEmpty;
+            for (SgNb4Iterator nb(p); nb; ++nb)
+                if (  bd.IsValidPoint(*nb)
+                   && bd.GetColor(*nb) != c
+                   && fillIndex[*nb] == GoUctRegionTracker::NO_REGION
+                   )
+                {
+                    fillIndex[*nb] = nuRegions;
+                    stack.PushBack(*nb);
+                }
+        }
+        const int index = tracker.RegionIndex(*it, c);
+        BOOST_REQUIRE(index != GoUctRegionTracker::NO_REGION);
+        BOOST_REQUIRE(indexOfFill.insert(std::make_pair(index,
+                                                        nuRegions)).second);
+        BOOST_REQUIRE_EQUAL(tracker.RegionSize(*it, c), size);
+        BOOST_REQUIRE_EQUAL(tracker.NumEmpty(*it, c), nuEmpty);
+        int nuPoints = 0;
+        for (GoUctRegionTracker::Iterator it2(tracker, *it, c); it2; ++it2)
+        {
+            BOOST_REQUIRE_EQUAL(fillIndex[*it2], nuRegions);
+            ++nuPoints;
+        }
+        BOOST_REQUIRE_EQUAL(nuPoints, size);
+        ++nuRegions;
+    }
+    for (GoUctBoard::Iterator it(bd); it; ++it)
+        if (bd.GetColor(*it) != c)
+            BOOST_REQUIRE_EQUAL(indexOfFill[tracker.RegionIndex(*it, c)],
+                                fillIndex[*it]);
+    BOOST_REQUIRE_EQUAL(tracker.NumRegions(c), nuRegions);
+}
+
+void CheckRegions(const GoUctBoard& bd, const GoUctRegionTracker& tracker)
+{
+    CheckRegions(bd, tracker, SG_BLACK);
+    CheckRegions(bd, tracker, SG_WHITE);
+}
+
+/** Test that a move splits a region and a capture merges regions again.
+    White splits off the corner point 1-1 from the regions of White, Black
+    captures White 2-1 by playing 1-1, which splits off 2-1 from the regions
+    of Black. */
+BOOST_AUTO_TEST_CASE(GoUctRegionTrackerTest_SplitMerge)
+{
+    GoSetup setup;
+    setup.AddBlack(Pt(3, 1));
+    setup.AddBlack(Pt(2, 2));
+    setup.AddWhite(Pt(1, 2));
+    setup.m_player = SG_WHITE;
+    GoBoard board(9, setup);
+    auto pbd = GoUctBoard::create(board);
+    GoUctBoard& bd = *pbd;
+    GoUctRegionTracker tracker;
+    bd.SetRegionTracker(&tracker);
+    BOOST_CHECK_EQUAL(bd.RegionTracker(), &tracker);
+    BOOST_CHECK_EQUAL(tracker.NumRegions(SG_WHITE), 1);
+    BOOST_CHECK_EQUAL(tracker.NumRegions(SG_BLACK), 1);
+    bd.Play(Pt(2, 1));
+    BOOST_CHECK_EQUAL(tracker.NumRegions(SG_WHITE), 2);
+    BOOST_CHECK(! tracker.InSameRegion(Pt(1, 1), Pt(9, 9), SG_WHITE));
+    BOOST_CHECK_EQUAL(tracker.RegionSize(Pt(1, 1), SG_WHITE), 1);
+    BOOST_CHECK_EQUAL(tracker.NumEmpty(Pt(1, 1), SG_WHITE), 1);
+    BOOST_CHECK_EQUAL(tracker.RegionSize(Pt(9, 9), SG_WHITE), 81 - 3);
+    BOOST_CHECK_EQUAL(tracker.NumEmpty(Pt(9, 9), SG_WHITE), 81 - 5);
+    CheckRegions(bd, tracker);
+    bd.Play(Pt(1, 1));
+    BOOST_CHECK_EQUAL(bd.NuCapturedStones(), 1);
+    BOOST_CHECK_EQUAL(tracker.NumRegions(SG_WHITE), 1);
+    BOOST_CHECK(tracker.InSameRegion(Pt(1, 1), Pt(9, 9), SG_WHITE));
+    BOOST_CHECK_EQUAL(tracker.RegionSize(Pt(9, 9), SG_WHITE), 81 - 1);
+    BOOST_CHECK_EQUAL(tracker.NumRegions(SG_BLACK), 2);
+    BOOST_CHECK_EQUAL(tracker.RegionSize(Pt(2, 1), SG_BLACK), 1);
+    CheckRegions(bd, tracker);
+    bd.SetRegionTracker(0);
+    BOOST_CHECK(bd.RegionTracker() == 0);
+}
+
+/** Check the incremental regions in random games with captures. */
+BOOST_AUTO_TEST_CASE(GoUctRegionTrackerTest_RandomGames)
+{
+    GoSetup setup;
+    setup.AddBlack(Pt(1, 2));
+    setup.AddWhite(Pt(5, 5));
+    GoBoard board(9, setup);
+    auto pbd = GoUctBoard::create(board);
+    GoUctBoard& bd = *pbd;
+    GoUctRegionTracker tracker;
+    bd.SetRegionTracker(&tracker);
+    CheckRegions(bd, tracker);
+    SgRandom random;
+    int nuCaptures = 0;
+    int nuSplitSearches = 0;
+    for (int game = 0; game < 20; ++game)
+    {
+        bd.Init(board);
+        CheckRegions(bd, tracker);
+        for (int i = 0; i < 200; ++i)
+        {
+            GoPointList moves;
+            for (GoUctBoard::Iterator it(bd); it; ++it)
+                if (  bd.IsEmpty(*it)
+                   && bd.IsLegal(*it)
+                   && ! GoBoardUtil::IsCompletelySurrounded(bd, *it)
+                   )
+                    moves.PushBack(*it);
+            if (moves.IsEmpty())
+                break;
+            bd.Play(moves[random.Int(moves.Length())]);
+            nuCaptures += bd.NuCapturedStones();
+            CheckRegions(bd, tracker);
+        }
+        nuSplitSearches += tracker.NumSplitSearches();
+    }
+    BOOST_CHECK(nuCaptures > 0);
+    BOOST_CHECK(nuSplitSearches > 0);
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------
@@ -15,6 +15,7 @@
 #   include <mutex>
 #   include <barrier>
 #   include <condition_variable>
+#   include <optional>
 #endif
 
 #ifdef _MSC_VER
@@ -365,6 +366,37 @@ bool ReadThread::ReadCommand(GtpCommand& cmd)
     return true;
 }
 
+//----------------------------------------------------------------------------
+
+/** Decrements the counter of running synchronous commands of GtpEngine at
+    the end of a command.
+    The counter is incremented by GtpEngine::RunCommand() together with the
+    check for a running asynchronous command. */
+class SyncCommandCounter
+{
+public:
+    SyncCommandCounter(std::mutex& mutex, int& nuSyncCommands);
+
+    ~SyncCommandCounter();
+
+private:
+    std::mutex& m_mutex;
+
+    int& m_nuSyncCommands;
+};
+
+SyncCommandCounter::SyncCommandCounter(std::mutex& mutex,
+                                       int& nuSyncCommands)
+    : m_mutex(mutex),
+      m_nuSyncCommands(nuSyncCommands)
+{ }
+
+SyncCommandCounter::~SyncCommandCounter()
+{
+    std::lock_guard lock(m_mutex);
+    --m_nuSyncCommands;
+}
+
 } // namespace
 
 #endif // GTPENGINE_INTERRUPT
@@ -598,8 +630,83 @@ GtpCallbackBase::~GtpCallbackBase() throw()
 
 //----------------------------------------------------------------------------
 
+#if GTPENGINE_INTERRUPT
+
+GtpAsyncCommand::GtpAsyncCommand(GtpEngine& engine, const std::string& line)
+    : m_engine(engine),
+      m_line(line),
+      m_isStarted(false),
+      m_isFinished(false),
+      m_isCancelled(false),
+      m_status(false)
+{ }
+
+void GtpAsyncCommand::Cancel()
+{
+    std::lock_guard lock(m_mutex);
+    m_isCancelled = true;
+    // If the command has not started yet, GtpEngine::ExecuteAsync() calls
+    // Interrupt() after BeforeHandleCommand(), which may reset the interrupt
+    if (m_isStarted && ! m_isFinished)
+        m_engine.Interrupt();
+}
+
+bool GtpAsyncCommand::IsCancelled() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_isCancelled;
+}
+
+bool GtpAsyncCommand::IsFinished() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_isFinished;
+}
+
+std::string GtpAsyncCommand::ReadProgress()
+{
+    std::lock_guard lock(m_mutex);
+    std::string progress;
+    progress.swap(m_progress);
+    return progress;
+}
+
+std::string GtpAsyncCommand::Response() const
+{
+    std::lock_guard lock(m_mutex);
+    assert(m_isFinished);
+    return m_response;
+}
+
+bool GtpAsyncCommand::Status() const
+{
+    std::lock_guard lock(m_mutex);
+    assert(m_isFinished);
+    return m_status;
+}
+
+void GtpAsyncCommand::Wait() const
+{
+    std::unique_lock lock(m_mutex);
+    m_finished.wait(lock, [this] { return m_isFinished; });
+}
+
+bool GtpAsyncCommand::WaitFor(double seconds) const
+{
+    std::unique_lock lock(m_mutex);
+    return m_finished.wait_for(lock, std::chrono::duration<double>(seconds),
+                               [this] { return m_isFinished; });
+}
+
+#endif // GTPENGINE_INTERRUPT
+
+//----------------------------------------------------------------------------
+
 GtpEngine::GtpEngine()
     : m_quit(false)
+#if GTPENGINE_INTERRUPT
+    , m_nuSyncCommands(0)
+#endif
 {
     Register("known_command", &GtpEngine::CmdKnownCommand, this);
     Register("list_commands", &GtpEngine::CmdListCommands, this);
@@ -607,10 +714,20 @@ GtpEngine::GtpEngine()
     Register("protocol_version", &GtpEngine::CmdProtocolVersion, this);
     Register("quit", &GtpEngine::CmdQuit, this);
     Register("version", &GtpEngine::CmdVersion, this);
+#if GTPENGINE_INTERRUPT
+    AllowConcurrent("known_command");
+    AllowConcurrent("list_commands");
+    AllowConcurrent("name");
+    AllowConcurrent("protocol_version");
+    AllowConcurrent("version");
+#endif
 }
 
 GtpEngine::~GtpEngine()
 {
+#if GTPENGINE_INTERRUPT
+    StopAsyncCommand();
+#endif
     typedef CallbackMap::iterator Iterator;
     for (Iterator i = m_callbacks.begin(); i != m_callbacks.end(); ++i)
     {
@@ -621,6 +738,15 @@ GtpEngine::~GtpEngine()
     }
 }
 
+#if GTPENGINE_INTERRUPT
+
+void GtpEngine::AllowConcurrent(const std::string& command)
+{
+    m_concurrentCommands.insert(command);
+}
+
+#endif // GTPENGINE_INTERRUPT
+
 void GtpEngine::BeforeHandleCommand()
 {
     // Default implementation does nothing
@@ -684,11 +810,9 @@ std::pair<bool, std::string> GtpEngine::ExecuteCommand(std::string_view cmdline)
             return { false, (std::ostringstream{} << "Bad command: "sv << cmdline).str() };
         GtpCommand cmd;
         cmd.Init(cmdline);
-    
-        std::ostringstream rss;
-        GtpOutputStream gtpLog(rss);
-        bool status = HandleCommand(cmd, gtpLog);
-        return { status, cmd.Response() };
+        std::string response;
+        bool status = RunCommand(cmd, response);
+        return { status, response };
     } catch (std::exception const& e) {
         return { false, e.what() };
     } catch (...) {
@@ -732,33 +856,162 @@ void GtpEngine::ExecuteFile(const std::string& name, std::ostream& log)
     }
 }
 
-bool GtpEngine::HandleCommand(GtpCommand& cmd, GtpOutputStream& out)
+/** Call the handler of a command.
+    @param cmd The command
+    @param[out] response The response or error message
+    @return The status of the command */
+bool GtpEngine::CallCommand(GtpCommand& cmd, std::string& response)
 {
-    BeforeHandleCommand();
-    bool status = true;
-    std::string response;
     try
     {
         CallbackMap::const_iterator pos = m_callbacks.find(cmd.Name());
         if (pos == m_callbacks.end())
         {
-            status = false;
             response = "unknown command: " + cmd.Name();
+            return false;
         }
-        else
+        GtpCallbackBase* callback = pos->second;
+        (*callback)(cmd);
+        response = cmd.Response();
+        return true;
+    }
+    catch (const GtpFailure& failure)
+    {
+        response = failure.Response();
+        return false;
+    }
+}
+
+#if GTPENGINE_INTERRUPT
+
+std::shared_ptr<GtpAsyncCommand>
+GtpEngine::ExecuteCommandAsync(std::string_view cmdline)
+{
+    std::string line(cmdline);
+    if (! IsCommandLine(line))
+        throw GtpFailure() << "Bad command: " << line;
+    Trim(line);
+    std::lock_guard lock(m_asyncMutex);
+    if (m_asyncCommand && ! m_asyncCommand->IsFinished())
+        throw GtpFailure() << "command '" << m_asyncCommand->Line()
+                           << "' is still running";
+    if (m_nuSyncCommands > 0)
+        throw GtpFailure() << "engine is busy with a synchronous command";
+    if (m_asyncThread.joinable())
+        m_asyncThread.join();
+    m_asyncCommand = std::make_shared<GtpAsyncCommand>(*this, line);
+    m_asyncThread = std::thread(&GtpEngine::ExecuteAsync, this,
+                                m_asyncCommand);
+    return m_asyncCommand;
+}
+
+/** Thread function for ExecuteCommandAsync(). */
+void GtpEngine::ExecuteAsync(std::shared_ptr<GtpAsyncCommand> command)
+{
+    bool status;
+    std::string response;
+    try
+    {
+        GtpCommand cmd(command->Line());
+        BeforeHandleCommand();
         {
-            GtpCallbackBase* callback = pos->second;
-            (*callback)(cmd);
-            response = cmd.Response();
+            std::lock_guard lock(command->m_mutex);
+            command->m_isStarted = true;
+            if (command->m_isCancelled)
+                Interrupt();
         }
+        status = CallCommand(cmd, response);
+        BeforeWritingResponse();
     }
-    catch (const GtpFailure& failure)
+    catch (const std::exception& e)
     {
         status = false;
-        response = failure.Response();
+        response = e.what();
+    }
+    {
+        std::lock_guard lock(command->m_mutex);
+        command->m_status = status;
+        command->m_response = response;
+        command->m_isFinished = true;
+    }
+    command->m_finished.notify_all();
+}
+
+bool GtpEngine::IsAsyncCommandRunning() const
+{
+    std::lock_guard lock(m_asyncMutex);
+    return m_asyncCommand && ! m_asyncCommand->IsFinished();
+}
+
+void GtpEngine::StopAsyncCommand()
+{
+    std::thread thread;
+    std::shared_ptr<GtpAsyncCommand> command;
+    {
+        std::lock_guard lock(m_asyncMutex);
+        if (! m_asyncThread.joinable())
+            return;
+        thread.swap(m_asyncThread);
+        command = m_asyncCommand;
+    }
+    // Join without holding m_asyncMutex, the command might call
+    // WriteProgress()
+    command->Cancel();
+    thread.join();
+}
+
+#endif // GTPENGINE_INTERRUPT
+
+/** Execute a command with the hook functions.
+    Fails, if an asynchronous command is running and the command is not
+    allowed to run concurrently. Otherwise ExecuteCommandAsync() fails while
+    the command runs.
+    @param cmd The command
+    @param[out] response The response or error message
+    @return The status of the command */
+bool GtpEngine::RunCommand(GtpCommand& cmd, std::string& response)
+{
+    bool status;
+#if GTPENGINE_INTERRUPT
+    std::optional<SyncCommandCounter> syncCommandCounter;
+    bool isAsyncCommandRunning;
+    {
+        std::lock_guard lock(m_asyncMutex);
+        isAsyncCommandRunning =
+            (m_asyncCommand && ! m_asyncCommand->IsFinished());
+        if (! isAsyncCommandRunning)
+        {
+            ++m_nuSyncCommands;
+            syncCommandCounter.emplace(m_asyncMutex, m_nuSyncCommands);
+        }
+    }
+    if (isAsyncCommandRunning)
+    {
+        // Don't call BeforeHandleCommand(), it could reset an interrupt of
+        // the asynchronous command
+        if (m_concurrentCommands.count(cmd.Name()) > 0)
+            status = CallCommand(cmd, response);
+        else
+        {
+            status = false;
+            response = "engine is busy with an asynchronous command";
+        }
+    }
+    else
+#endif
+    {
+        BeforeHandleCommand();
+        status = CallCommand(cmd, response);
     }
-    response = ReplaceEmptyLines(response);
     BeforeWritingResponse();
+    return status;
+}
+
+bool GtpEngine::HandleCommand(GtpCommand& cmd, GtpOutputStream& out)
+{
+    std::string response;
+    bool status = RunCommand(cmd, response);
+    response = ReplaceEmptyLines(response);
     std::ostringstream ostr;
     ostr << (status ? '=' : '?') << cmd.ID() << ' ' << response;
     size_t size = response.size();
@@ -839,6 +1092,24 @@ bool GtpEngine::IsQuitSet() const
     return m_quit;
 }
 
+void GtpEngine::WriteProgress(const std::string& text)
+{
+#if GTPENGINE_INTERRUPT
+    std::shared_ptr<GtpAsyncCommand> command;
+    {
+        std::lock_guard lock(m_asyncMutex);
+        command = m_asyncCommand;
+    }
+    if (! command)
+        return;
+    std::lock_guard lock(command->m_mutex);
+    if (! command->m_isFinished)
+        command->m_progress += text;
+#else
+    static_cast<void>(text);
+#endif
+}
+
 
 #if GTPENGINE_PONDER
 
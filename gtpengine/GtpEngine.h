@@ -58,6 +58,15 @@
 #define GTPENGINE_INTERRUPT 1
 #endif
 
+#if GTPENGINE_INTERRUPT
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string_view>
+#include <thread>
+#endif
+
 //----------------------------------------------------------------------------
 
 /** GTP failure.
@@ -568,6 +577,109 @@ void GtpCallback<ENGINE>::operator()(GtpCommand& cmd)
 
 //----------------------------------------------------------------------------
 
+#if GTPENGINE_INTERRUPT
+
+class GtpEngine;
+
+/** Handle of a command executed asynchronously.
+    Returned by GtpEngine::ExecuteCommandAsync(). All functions can be
+    called from any thread.
+    @see @ref gtpengineasync */
+class GtpAsyncCommand
+{
+public:
+    GtpAsyncCommand(GtpEngine& engine, const std::string& line);
+
+    /** The command line. */
+    const std::string& Line() const;
+
+    /** Has the command finished? */
+    bool IsFinished() const;
+
+    /** Wait until the command has finished. */
+    void Wait() const;
+
+    /** Wait until the command has finished or a timeout has expired.
+        @param seconds The timeout
+        @return IsFinished() */
+    bool WaitFor(double seconds) const;
+
+    /** Cancel the command.
+        Calls GtpEngine::Interrupt() if the command is running, or makes it
+        call Interrupt() when it starts. The command still needs to finish
+        and returns a normal response if it handles the interrupt (e.g. the
+        best move found so far for genmove). */
+    void Cancel();
+
+    /** Was Cancel() called? */
+    bool IsCancelled() const;
+
+    /** Did the command succeed?
+        REQUIRES: IsFinished() */
+    bool Status() const;
+
+    /** The response of the command, or the error message if it failed.
+        REQUIRES: IsFinished() */
+    std::string Response() const;
+
+    /** Get the text written with GtpEngine::WriteProgress() since the last
+        call. */
+    std::string ReadProgress();
+
+private:
+    friend class GtpEngine;
+
+    GtpEngine& m_engine;
+
+    const std::string m_line;
+
+    mutable std::mutex m_mutex;
+
+    mutable std::condition_variable m_finished;
+
+    bool m_isStarted;
+
+    bool m_isFinished;
+
+    bool m_isCancelled;
+
+    bool m_status;
+
+    std::string m_response;
+
+    std::string m_progress;
+
+    /** Not implemented. */
+    GtpAsyncCommand(const GtpAsyncCommand&);
+
+    /** Not implemented. */
+    GtpAsyncCommand& operator=(const GtpAsyncCommand&);
+};
+
+inline const std::string& GtpAsyncCommand::Line() const
+{
+    return m_line;
+}
+
+#endif // GTPENGINE_INTERRUPT
+
+//----------------------------------------------------------------------------
+
+/** @page gtpengineasync Asynchronous Commands
+    GtpEngine::ExecuteCommandAsync() executes a command in a separate thread
+    and returns a GtpAsyncCommand, which can be used to wait for the
+    response, to read intermediate results written by the command with
+    GtpEngine::WriteProgress() and to cancel the command with
+    GtpEngine::Interrupt() (for example, GoGtpEngine sets the user abort
+    flag, which stops the search of genmove). Only one asynchronous command
+    can run at a time. While it runs, other commands fail with an error
+    response, unless they were marked with GtpEngine::AllowConcurrent() as
+    safe to execute concurrently. ExecuteCommandAsync() also fails while a
+    synchronous command is running (e.g. one executed with
+    GtpEngine::ExecuteCommand() in another thread). Asynchronous commands
+    are only available
+    if GtpEngine was compiled with GTPENGINE_INTERRUPT. */
+
 /** @page gtpenginesimulatedelay Simulated Delays
     If the engine receives a special comment line
     <code># gtpengine-sleep n</code>, it will sleep for @c n seconds before
@@ -631,6 +743,38 @@ public:
 
     std::pair<bool, std::string> ExecuteCommand(std::string_view cmdline) noexcept;
 
+#if GTPENGINE_INTERRUPT
+    /** Start executing a command in a separate thread.
+        @param cmdline The command line
+        @return The handle of the command
+        @throw GtpFailure If the command line is empty or another command
+        (asynchronous or not) is running
+        @see @ref gtpengineasync */
+    std::shared_ptr<GtpAsyncCommand>
+    ExecuteCommandAsync(std::string_view cmdline);
+
+    /** Is an asynchronous command running? */
+    bool IsAsyncCommandRunning() const;
+
+    /** Cancel the running asynchronous command and wait until it has
+        finished.
+        Subclasses with commands that can be executed asynchronously should
+        call this function in their destructor, because the base class
+        destructor is called after their members were destroyed. */
+    void StopAsyncCommand();
+
+    /** Allow executing a command while an asynchronous command is running.
+        Only for commands that do not use any state modified by other
+        commands. */
+    void AllowConcurrent(const std::string& command);
+#endif
+
+    /** Write intermediate results of the running asynchronous command.
+        Can be called from any thread, e.g. from a search thread. Does
+        nothing if no asynchronous command is running.
+        @see GtpAsyncCommand::ReadProgress() */
+    void WriteProgress(const std::string& text);
+
     /** Run the main command loop.
         Reads lines from input stream, calls the corresponding command
         handler and writes the response to the output stream.
@@ -737,12 +881,36 @@ private:
 
     CallbackMap m_callbacks;
 
+#if GTPENGINE_INTERRUPT
+    /** See AllowConcurrent() */
+    std::set<std::string> m_concurrentCommands;
+
+    /** Protects m_asyncCommand, m_asyncThread and m_nuSyncCommands. */
+    mutable std::mutex m_asyncMutex;
+
+    /** Number of synchronous commands running, that were not started while
+        an asynchronous command was running.
+        ExecuteCommandAsync() fails if it is not zero. */
+    int m_nuSyncCommands;
+
+    /** The last asynchronous command. */
+    std::shared_ptr<GtpAsyncCommand> m_asyncCommand;
+
+    std::thread m_asyncThread;
+
+    void ExecuteAsync(std::shared_ptr<GtpAsyncCommand> command);
+#endif
+
     /** Not to be implemented. */
     GtpEngine(const GtpEngine& engine);
 
     /** Not to be implemented. */
     GtpEngine& operator=(const GtpEngine& engine) const;
 
+    bool CallCommand(GtpCommand& cmd, std::string& response);
+
+    bool RunCommand(GtpCommand& cmd, std::string& response);
+
     bool HandleCommand(GtpCommand& cmd, GtpOutputStream& out);
 };
 
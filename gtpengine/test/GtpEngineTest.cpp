@@ -5,6 +5,10 @@
 
 #include "../GtpEngine.h"
 
+#include <atomic>
+#include <chrono>
+#include <thread>
+
 #ifdef GTPENGINETEST_MAIN
 #define BOOST_AUTO_TEST_MAIN
 #endif
@@ -136,6 +140,144 @@ BOOST_AUTO_TEST_CASE(GtpCommandTest_Response)
     BOOST_CHECK_EQUAL(cmd.Response(), "Funny");
 }
 
+#if GTPENGINE_INTERRUPT
+
+/** GTP engine with a command that runs until it is interrupted.
+    For testing asynchronous commands. */
+class WaitEngine
+    : public GtpEngine
+{
+public:
+    WaitEngine();
+
+    ~WaitEngine();
+
+    void CmdWait(GtpCommand& cmd);
+
+    void Interrupt();
+
+    /** Is the command wait running? */
+    bool IsWaiting() const;
+
+protected:
+    void BeforeHandleCommand();
+
+private:
+    std::atomic<bool> m_interrupted;
+
+    std::atomic<bool> m_isWaiting;
+};
+
+WaitEngine::WaitEngine()
+    : m_interrupted(false),
+      m_isWaiting(false)
+{
+    Register("wait", &WaitEngine::CmdWait, this);
+}
+
+WaitEngine::~WaitEngine()
+{
+    StopAsyncCommand();
+}
+
+void WaitEngine::BeforeHandleCommand()
+{
+    m_interrupted = false;
+}
+
+void WaitEngine::CmdWait(GtpCommand& cmd)
+{
+    WriteProgress("started\n");
+    m_isWaiting = true;
+    while (! m_interrupted)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    m_isWaiting = false;
+    cmd << "interrupted";
+}
+
+void WaitEngine::Interrupt()
+{
+    m_interrupted = true;
+}
+
+bool WaitEngine::IsWaiting() const
+{
+    return m_isWaiting;
+}
+
+BOOST_AUTO_TEST_CASE(GtpEngineTest_ExecuteCommandAsync)
+{
+    WaitEngine engine;
+    std::shared_ptr<GtpAsyncCommand> command =
+        engine.ExecuteCommandAsync("wait");
+    BOOST_CHECK_EQUAL(command->Line(), "wait");
+    BOOST_CHECK(! command->WaitFor(0.01));
+    BOOST_CHECK(engine.IsAsyncCommandRunning());
+    BOOST_CHECK_THROW(engine.ExecuteCommandAsync("wait"), GtpFailure);
+    BOOST_CHECK(! engine.ExecuteCommand(std::string_view("wait")).first);
+    BOOST_CHECK_EQUAL(engine.ExecuteCommand(std::string_view("wait")).second,
+                      "engine is busy with an asynchronous command");
+    std::pair<bool,std::string> result =
+        engine.ExecuteCommand(std::string_view("protocol_version"));
+    BOOST_CHECK(result.first);
+    BOOST_CHECK_EQUAL(result.second, "2");
+    BOOST_CHECK_EQUAL(command->ReadProgress(), "started\n");
+    BOOST_CHECK_EQUAL(command->ReadProgress(), "");
+    command->Cancel();
+    command->Wait();
+    BOOST_CHECK(command->IsFinished());
+    BOOST_CHECK(command->IsCancelled());
+    BOOST_CHECK(command->Status());
+    BOOST_CHECK_EQUAL(command->Response(), "interrupted");
+    BOOST_CHECK(! engine.IsAsyncCommandRunning());
+    BOOST_CHECK(engine.ExecuteCommand(std::string_view("name")).first);
+}
+
+/** Check that a command cancelled before it started is interrupted,
+    although BeforeHandleCommand() resets the interrupt flag. */
+BOOST_AUTO_TEST_CASE(GtpEngineTest_ExecuteCommandAsyncCancel)
+{
+    WaitEngine engine;
+    for (int i = 0; i < 10; ++i)
+    {
+        std::shared_ptr<GtpAsyncCommand> command =
+            engine.ExecuteCommandAsync("wait");
+        command->Cancel();
+        BOOST_CHECK(command->WaitFor(10));
+    }
+    std::shared_ptr<GtpAsyncCommand> command =
+        engine.ExecuteCommandAsync("unknown");
+    command->Wait();
+    BOOST_CHECK(! command->Status());
+}
+
+/** Check that an asynchronous command cannot be started while a
+    synchronous command runs in another thread. */
+BOOST_AUTO_TEST_CASE(GtpEngineTest_ExecuteCommandAsyncBusy)
+{
+    WaitEngine engine;
+    std::pair<bool,std::string> result;
+    std::thread thread([&engine, &result]
+                       {
+                           result =
+                               engine.ExecuteCommand(std::string_view("wait"));
+                       });
+    while (! engine.IsWaiting())
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    BOOST_CHECK(! engine.IsAsyncCommandRunning());
+    BOOST_CHECK_THROW(engine.ExecuteCommandAsync("name"), GtpFailure);
+    engine.Interrupt();
+    thread.join();
+    BOOST_CHECK(result.first);
+    BOOST_CHECK_EQUAL(result.second, "interrupted");
+    std::shared_ptr<GtpAsyncCommand> command =
+        engine.ExecuteCommandAsync("name");
+    command->Wait();
+    BOOST_CHECK(command->Status());
+}
+
+#endif // GTPENGINE_INTERRUPT
+
 } // namespace
 
 //----------------------------------------------------------------------------
@@ -5,6 +5,7 @@
 #include "SgSystem.h"
 #include "SgBookBuilder.h"
 
+#include <algorithm>
 #include <sstream>
 //#include <boost/numeric/conversion/bounds.hpp>
 #include "SgDebug.h"
@@ -53,11 +54,19 @@ void SgBookNode::FromString(const std::string& str)
 
 //----------------------------------------------------------------------------
 
+SgBookBuilder::LeafEvaluation::LeafEvaluation()
+    : m_isDetermined(false),
+      m_value(0)
+{ }
+
+//----------------------------------------------------------------------------
+
 SgBookBuilder::SgBookBuilder()
     : m_alpha(50),
       m_useWidening(true),
       m_expandWidth(16),
       m_expandThreshold(1000),
+      m_numParallelExpansions(1),
       m_flushIterations(100)
 { }
 
@@ -105,7 +114,8 @@ void SgBookBuilder::Expand(int numExpansions)
     Init();
     EnsureRootExists();
     int num = 0;
-    for (; num < numExpansions; ++num) 
+    int lastFlush = 0;
+    while (num < numExpansions)
     {
         {
             std::ostringstream os;
@@ -122,12 +132,31 @@ void SgBookBuilder::Expand(int numExpansions)
             }
         }
         StartIteration();
-        std::vector<SgMove> pv;
-        DoExpansion(pv);
+        if (m_numParallelExpansions > 1)
+        {
+            std::size_t count = std::min(m_numParallelExpansions,
+                                         std::size_t(numExpansions - num));
+            std::size_t numExpanded = DoParallelExpansion(count);
+            if (numExpanded == 0)
+            {
+                PrintMessage("No leaf to expand!\n");
+                break;
+            }
+            num += static_cast<int>(numExpanded);
+        }
+        else
+        {
+            std::vector<SgMove> pv;
+            DoExpansion(pv);
+            ++num;
+        }
         EndIteration();
 
-        if (num && (num % m_flushIterations) == 0) 
+        if (num - lastFlush >= static_cast<int>(m_flushIterations))
+        {
             FlushBook();
+            lastFlush = num;
+        }
     }
     FlushBook();
     Fini();
@@ -502,6 +531,161 @@ void SgBookBuilder::DoExpansion(std::vector<SgMove>& pv)
     WriteNode(node);
 }
 
+/** Expands up to count leaves together.
+    Returns the number of expanded leaves.
+    @ref bookparallel */
+std::size_t SgBookBuilder::DoParallelExpansion(std::size_t count)
+{
+    ClearAllVisited();
+    std::vector<std::vector<SgMove> > leaves;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        std::vector<SgMove> pv;
+        if (! SelectLeaf(pv))
+            break;
+        leaves.push_back(pv);
+    }
+    if (leaves.empty())
+        return 0;
+    std::vector<LeafEvaluation> evaluations;
+    EvaluateLeaves(leaves, m_expandWidth, evaluations);
+    SG_ASSERT(evaluations.size() == leaves.size());
+    for (std::size_t i = 0; i < leaves.size(); ++i)
+        BackUpLeaf(leaves[i], evaluations[i]);
+    return leaves.size();
+}
+
+/** Follows the most urgent children to a leaf like DoExpansion() and
+    adds a virtual loss to the leaf.
+    Returns false if a terminal node or a leaf that was already selected
+    is reached. Leaves are marked with MarkAsVisited().
+    @ref bookparallel */
+bool SgBookBuilder::SelectLeaf(std::vector<SgMove>& pv)
+{
+    SgBookNode node;
+    if (! GetNode(node))
+        SG_ASSERT(false);
+    if (node.IsTerminal())
+        return false;
+    if (node.IsLeaf())
+    {
+        if (HasBeenVisited())
+            return false;
+        MarkAsVisited();
+        node.m_priority += m_alpha;
+        WriteNode(node);
+        return true;
+    }
+    UpdateValue(node);
+    SgMove mostUrgent = UpdatePriority(node);
+    WriteNode(node);
+    if (node.IsTerminal() || mostUrgent == SG_NULLMOVE)
+        return false;
+    PlayMove(mostUrgent);
+    pv.push_back(mostUrgent);
+    bool selected = SelectLeaf(pv);
+    UndoMove(mostUrgent);
+    if (! selected)
+        return false;
+    // Pass the virtual loss on to the priority of this node
+    GetNode(node);
+    UpdatePriority(node);
+    WriteNode(node);
+    return true;
+}
+
+/** Adds the evaluation of a leaf selected by SelectLeaf() to the book
+    and backs up the values along the path, like the return from
+    DoExpansion().
+    @ref bookparallel */
+void SgBookBuilder::BackUpLeaf(const std::vector<SgMove>& pv,
+                               const LeafEvaluation& evaluation)
+{
+    for (std::size_t i = 0; i < pv.size(); ++i)
+        PlayMove(pv[i]);
+    SgBookNode node;
+    GetNode(node);
+    node.m_priority -= m_alpha;
+    WriteNode(node);
+    if (evaluation.m_isDetermined)
+    {
+        PrintMessage("ExpandChildren: State is determined!\n");
+        WriteNode(SgBookNode(evaluation.m_value));
+    }
+    else
+        for (std::size_t i = 0; i < evaluation.m_scores.size(); ++i)
+        {
+            PlayMove(evaluation.m_scores[i].first);
+            SgBookNode child;
+            if (! GetNode(child))
+            {
+                WriteNode(evaluation.m_scores[i].second);
+                ++m_numEvals;
+            }
+            UndoMove(evaluation.m_scores[i].first);
+        }
+    for (std::size_t i = pv.size() + 1; i-- > 0; )
+    {
+        GetNode(node);
+        // Widen internal nodes at the same visit counts as DoExpansion()
+        if (  i < pv.size()
+           && m_useWidening
+           && node.m_count % m_expandThreshold == 0
+           )
+        {
+            std::size_t width = (node.m_count / m_expandThreshold + 1)
+                              * m_expandWidth;
+            ++m_numWidenings;
+            ExpandChildren(width);
+            GetNode(node);
+        }
+        UpdateValue(node);
+        UpdatePriority(node);
+        node.IncrementCount();
+        WriteNode(node);
+        if (i > 0)
+            UndoMove(pv[i - 1]);
+    }
+}
+
+void SgBookBuilder::EvaluateLeaves(const std::vector<std::vector<SgMove> >&
+                                   leaves, std::size_t count,
+                                   std::vector<LeafEvaluation>& evaluations)
+{
+    evaluations.assign(leaves.size(), LeafEvaluation());
+    for (std::size_t i = 0; i < leaves.size(); ++i)
+    {
+        const std::vector<SgMove>& leaf = leaves[i];
+        LeafEvaluation& evaluation = evaluations[i];
+        for (std::size_t j = 0; j < leaf.size(); ++j)
+            PlayMove(leaf[j]);
+        std::vector<SgMove> children;
+        evaluation.m_isDetermined =
+            GenerateMoves(count, children, evaluation.m_value);
+        if (! evaluation.m_isDetermined)
+        {
+            std::vector<SgMove> childrenToDo;
+            std::size_t limit = std::min(count, children.size());
+            for (std::size_t j = 0; j < limit; ++j)
+            {
+                PlayMove(children[j]);
+                SgBookNode child;
+                if (! GetNode(child))
+                    childrenToDo.push_back(children[j]);
+                UndoMove(children[j]);
+            }
+            if (! childrenToDo.empty())
+            {
+                BeforeEvaluateChildren();
+                EvaluateChildren(childrenToDo, evaluation.m_scores);
+                AfterEvaluateChildren();
+            }
+        }
+        for (std::size_t j = leaf.size(); j-- > 0; )
+            UndoMove(leaf[j]);
+    }
+}
+
 //----------------------------------------------------------------------------
 
 /** Refresh's each child of the given state. UpdateValue() and
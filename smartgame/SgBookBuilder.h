@@ -148,6 +148,25 @@ inline std::ostream& operator<<(std::ostream& os, const SgBookNode& node)
 
     A book refresh should be performed after this operation. */
 
+/** @page bookparallel Parallel Book Expansion
+    @ingroup sgopeningbook
+
+    If SgBookBuilder::NumParallelExpansions() is greater than one,
+    SgBookBuilder::Expand() selects several leaves before evaluating any
+    of them. After a leaf is selected, its priority is increased by
+    SgBookBuilder::Alpha() (a virtual loss, as if its value was worse by one
+    than the value of its parent) and the priorities of its ancestors are
+    updated, so that the next selection prefers a different leaf. The
+    selection stops early if it reaches a leaf that was already selected.
+
+    The selected leaves are evaluated with
+    SgBookBuilder::EvaluateLeaves(), which can evaluate them in parallel
+    with independent searches, because it does not modify the book. Then
+    the results are added to the book one leaf after the other, the virtual
+    loss is removed, and the values and priorities are backed up along the
+    path to each leaf as in a sequential expansion. Widening of internal
+    nodes is done during the back up. */
+
 //----------------------------------------------------------------------------
 
 /** Base class for automated book building.
@@ -214,6 +233,14 @@ public:
     /** See UseWidening() */
     void SetExpandThreshold(std::size_t threshold);
 
+    /** Number of leaves that Expand() selects and evaluates together.
+        A value of 1 expands one leaf at a time.
+        @ref bookparallel */
+    std::size_t NumParallelExpansions() const;
+
+    /** See NumParallelExpansions() */
+    void SetNumParallelExpansions(std::size_t num);
+
     //---------------------------------------------------------------------    
 
     /** Computes the expansion priority for the child using Alpha(),
@@ -234,6 +261,20 @@ public:
     virtual float Value(const SgBookNode& node) const = 0;
 
 protected:
+    /** Result of the evaluation of a leaf by EvaluateLeaves(). */
+    struct LeafEvaluation
+    {
+        /** State is determined with value m_value. */
+        bool m_isDetermined;
+
+        float m_value;
+
+        /** Values of the evaluated children. */
+        std::vector<std::pair<SgMove, float> > m_scores;
+
+        LeafEvaluation();
+    };
+
     /** See Alpha() */
     float m_alpha;
 
@@ -245,6 +286,9 @@ protected:
 
     /** See UseWidening() */
     std::size_t m_expandThreshold;
+
+    /** See NumParallelExpansions() */
+    std::size_t m_numParallelExpansions;
     
     /** Number of iterations after which the db is flushed to disk. */
     std::size_t m_flushIterations;
@@ -290,6 +334,21 @@ protected:
     virtual void EvaluateChildren(const std::vector<SgMove>& childrenToDo,
                     std::vector<std::pair<SgMove, float> >& scores) = 0;
 
+    /** Evaluate several leaves for a parallel expansion.
+        For each leaf, generates the moves with GenerateMoves() and
+        evaluates the first count children that are not in the book.
+        Must not modify the book.
+        The default implementation evaluates the leaves one after the other
+        with GenerateMoves() and EvaluateChildren(); subclasses can evaluate
+        them in parallel.
+        @param leaves The leaves as move sequences from the current state
+        @param count The number of children to consider
+        @param[out] evaluations The evaluations in the order of leaves
+        @ref bookparallel */
+    virtual void EvaluateLeaves(const std::vector<std::vector<SgMove> >&
+                                leaves, std::size_t count,
+                                std::vector<LeafEvaluation>& evaluations);
+
     /** Hook function: called before any work is done. 
         Default implementation does nothing. */
     virtual void Init();
@@ -343,6 +402,13 @@ private:
 
     void DoExpansion(std::vector<SgMove>& pv);
 
+    std::size_t DoParallelExpansion(std::size_t count);
+
+    bool SelectLeaf(std::vector<SgMove>& pv);
+
+    void BackUpLeaf(const std::vector<SgMove>& pv,
+                    const LeafEvaluation& evaluation);
+
     bool Refresh(bool root);
 
     void IncreaseWidth(bool root);
@@ -392,6 +458,16 @@ inline void SgBookBuilder::SetExpandThreshold(std::size_t threshold)
     m_expandThreshold = threshold;
 }
 
+inline std::size_t SgBookBuilder::NumParallelExpansions() const
+{
+    return m_numParallelExpansions;
+}
+
+inline void SgBookBuilder::SetNumParallelExpansions(std::size_t num)
+{
+    m_numParallelExpansions = num;
+}
+
 //----------------------------------------------------------------------------
 
 #endif // SG_BOOKBUILDER_HPP
@@ -0,0 +1,297 @@
+//----------------------------------------------------------------------------
+/** @file SgBookStore.cpp
+    See SgBookStore.h */
+//----------------------------------------------------------------------------
+
+#include "SgSystem.h"
+#include "SgBookStore.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <boost/static_assert.hpp>
+#include "SgDebug.h"
+#include "SgException.h"
+#include "SgMappedFile.h"
+
+using std::string;
+using std::uint32_t;
+using std::uint64_t;
+
+//----------------------------------------------------------------------------
+
+namespace {
+
+const char BOOK_MAGIC[8] = { 'S', 'g', 'B', 'o', 'o', 'k', 'S', '\0' };
+
+const uint32_t BOOK_VERSION = 1;
+
+const uint32_t BOOK_BYTE_ORDER = 0x01020304;
+
+const std::size_t MIN_SLOTS = 1024;
+
+struct Header
+{
+    char m_magic[8];
+
+    uint32_t m_version;
+
+    uint32_t m_byteOrder;
+};
+
+BOOST_STATIC_ASSERT(sizeof(Header) == 16);
+
+void WriteHeader(std::ostream& out)
+{
+    Header header;
+    memcpy(header.m_magic, BOOK_MAGIC, sizeof(BOOK_MAGIC));
+    header.m_version = BOOK_VERSION;
+    header.m_byteOrder = BOOK_BYTE_ORDER;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+/** The keys are hash codes, but only the lower bits are used for the slot,
+    so mix in the upper bits. */
+std::size_t SlotHash(uint64_t key)
+{
+    return static_cast<std::size_t>(key ^ (key >> 29) ^ (key >> 47));
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------
+
+SgBookStore::Iterator::Iterator(const SgBookStore& store)
+    : m_store(store),
+      m_slot(0)
+{
+    SkipEmpty();
+}
+
+void SgBookStore::Iterator::SkipEmpty()
+{
+    while (m_slot < m_store.m_slots.size() && m_store.m_slots[m_slot] == 0)
+        ++m_slot;
+}
+
+//----------------------------------------------------------------------------
+
+SgBookStore::SgBookStore()
+{
+    BOOST_STATIC_ASSERT(sizeof(Record) == 24);
+    Clear();
+}
+
+SgBookStore::~SgBookStore()
+{ }
+
+void SgBookStore::Clear()
+{
+    m_file.reset();
+    m_fileName.clear();
+    m_nuMapped = 0;
+    m_records.clear();
+    m_slots.assign(MIN_SLOTS, 0);
+    m_size = 0;
+}
+
+std::size_t SgBookStore::FindSlot(uint64_t key) const
+{
+    const std::size_t mask = m_slots.size() - 1;
+    std::size_t slot = SlotHash(key) & mask;
+    while (m_slots[slot] != 0 && GetRecord(m_slots[slot] - 1).m_key != key)
+        slot = (slot + 1) & mask;
+    return slot;
+}
+
+void SgBookStore::Flush()
+{
+    if (! IsOpen())
+        throw SgException("SgBookStore: no book file opened");
+    if (m_records.empty())
+        return;
+    const std::size_t nuRecords = m_nuMapped + m_records.size();
+    {
+        std::ofstream out(m_fileName.c_str(),
+                          std::ios::binary | std::ios::app);
+        out.write(reinterpret_cast<const char*>(&m_records[0]),
+                  m_records.size() * sizeof(Record));
+        if (! out)
+            throw SgException("SgBookStore: error writing " + m_fileName);
+    }
+    m_records.clear();
+    Map();
+    if (m_nuMapped != nuRecords)
+        throw SgException("SgBookStore: " + m_fileName
+                          + " was modified by another process");
+}
+
+bool SgBookStore::Get(uint64_t key, SgBookNode& node) const
+{
+    const uint32_t index = m_slots[FindSlot(key)];
+    if (index == 0)
+        return false;
+    const Record& record = GetRecord(index - 1);
+    node.m_heurValue = record.m_heurValue;
+    node.m_value = record.m_value;
+    node.m_priority = record.m_priority;
+    node.m_count = record.m_count;
+    return true;
+}
+
+const SgBookStore::Record& SgBookStore::GetRecord(uint32_t index) const
+{
+    if (index < m_nuMapped)
+        return reinterpret_cast<const Record*>(m_file->Data()
+                                               + sizeof(Header))[index];
+    SG_ASSERT(index - m_nuMapped < m_records.size());
+    return m_records[index - m_nuMapped];
+}
+
+bool SgBookStore::IsBookFile(const string& fileName)
+{
+    std::ifstream in(fileName.c_str(), std::ios::binary);
+    char magic[sizeof(BOOK_MAGIC)];
+    return in.read(magic, sizeof(magic))
+        && memcmp(magic, BOOK_MAGIC, sizeof(magic)) == 0;
+}
+
+/** Map the book file and set m_nuMapped.
+    Records that do not fit completely into the file are not counted. */
+void SgBookStore::Map()
+{
+    std::unique_ptr<SgMappedFile> file(new SgMappedFile(m_fileName));
+    const Header* header = reinterpret_cast<const Header*>(file->Data());
+    if (  file->Size() < sizeof(Header)
+       || memcmp(header->m_magic, BOOK_MAGIC, sizeof(BOOK_MAGIC)) != 0
+       )
+        throw SgException(m_fileName + ": not a book file");
+    if (header->m_byteOrder != BOOK_BYTE_ORDER)
+        throw SgException(m_fileName + ": book file has wrong byte order");
+    if (header->m_version != BOOK_VERSION)
+        throw SgException(m_fileName + ": unsupported book file version");
+    m_file = std::move(file);
+    m_nuMapped = (m_file->Size() - sizeof(Header)) / sizeof(Record);
+}
+
+void SgBookStore::Open(const string& fileName)
+{
+    Clear();
+    if (! std::filesystem::exists(fileName))
+    {
+        std::ofstream out(fileName.c_str(), std::ios::binary);
+        WriteHeader(out);
+        if (! out)
+            throw SgException("SgBookStore: cannot create " + fileName);
+    }
+    m_fileName = fileName;
+    try
+    {
+        Map();
+        const std::size_t size =
+            sizeof(Header) + m_nuMapped * sizeof(Record);
+        if (m_file->Size() != size)
+        {
+            SgWarning() << fileName << ": removing incomplete record\n";
+            m_file.reset();
+            std::filesystem::resize_file(fileName, size);
+            Map();
+        }
+    }
+    catch (...)
+    {
+        Clear();
+        throw;
+    }
+    std::size_t nuSlots = MIN_SLOTS;
+    while (nuSlots < 2 * m_nuMapped)
+        nuSlots *= 2;
+    Rehash(nuSlots);
+}
+
+void SgBookStore::Put(uint64_t key, const SgBookNode& node)
+{
+    if (2 * (m_size + 1) > m_slots.size())
+        Rehash(2 * m_slots.size());
+    Record record;
+    record.m_key = key;
+    record.m_heurValue = node.m_heurValue;
+    record.m_value = node.m_value;
+    record.m_priority = node.m_priority;
+    record.m_count = node.m_count;
+    const std::size_t slot = FindSlot(key);
+    const uint32_t index = m_slots[slot];
+    if (index != 0)
+    {
+        const Record& old = GetRecord(index - 1);
+        if (  old.m_heurValue == record.m_heurValue
+           && old.m_value == record.m_value
+           && old.m_priority == record.m_priority
+           && old.m_count == record.m_count
+           )
+            return;
+        if (index - 1 >= m_nuMapped)
+        {
+            m_records[index - 1 - m_nuMapped] = record;
+            return;
+        }
+    }
+    else
+        ++m_size;
+    if (m_nuMapped + m_records.size() >= 0xffffffffUL)
+        throw SgException("SgBookStore: too many records");
+    m_records.push_back(record);
+    m_slots[slot] = static_cast<uint32_t>(m_nuMapped + m_records.size());
+}
+
+/** Rebuild the hash table.
+    Records are inserted in the order of the file, so the last record
+    of a key wins. */
+void SgBookStore::Rehash(std::size_t nuSlots)
+{
+    SG_ASSERT((nuSlots & (nuSlots - 1)) == 0);
+    m_slots.assign(nuSlots, 0);
+    m_size = 0;
+    const std::size_t nuRecords = m_nuMapped + m_records.size();
+    for (std::size_t i = 0; i < nuRecords; ++i)
+    {
+        const std::size_t slot =
+            FindSlot(GetRecord(static_cast<uint32_t>(i)).m_key);
+        if (m_slots[slot] == 0)
+            ++m_size;
+        m_slots[slot] = static_cast<uint32_t>(i + 1);
+    }
+}
+
+void SgBookStore::Save(const string& fileName) const
+{
+    if (  IsOpen()
+       && std::filesystem::exists(fileName)
+       && std::filesystem::equivalent(fileName, m_fileName)
+       )
+        throw SgException("SgBookStore: cannot save over opened book file "
+                          + fileName);
+    const string tmpFileName = fileName + ".tmp";
+    {
+        std::ofstream out(tmpFileName.c_str(), std::ios::binary);
+        WriteHeader(out);
+        for (std::size_t i = 0; i < m_slots.size(); ++i)
+            if (m_slots[i] != 0)
+            {
+                const Record& record = GetRecord(m_slots[i] - 1);
+                out.write(reinterpret_cast<const char*>(&record),
+                          sizeof(record));
+            }
+        if (! out)
+            throw SgException("SgBookStore: error writing " + tmpFileName);
+    }
+#ifdef WIN32
+    std::remove(fileName.c_str());
+#endif
+    if (std::rename(tmpFileName.c_str(), fileName.c_str()) != 0)
+        throw SgException("SgBookStore: cannot rename " + tmpFileName
+                          + " to " + fileName);
+}
+
+//----------------------------------------------------------------------------
@@ -0,0 +1,201 @@
+//----------------------------------------------------------------------------
+/** @file SgBookStore.h
+    Hash table of book nodes stored in a memory-mapped file. */
+//----------------------------------------------------------------------------
+
+#ifndef SG_BOOKSTORE_H
+#define SG_BOOKSTORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "SgBookBuilder.h"
+
+class SgMappedFile;
+
+//----------------------------------------------------------------------------
+
+/** Hash table of book nodes stored in a memory-mapped file.
+    The file is a log of fixed-size records (key and SgBookNode). Open() maps
+    the file and builds an open-addressing index of the record numbers, so
+    the nodes themselves are not parsed or copied and are shared with other
+    processes using the same file. Put() stores new or changed nodes in
+    memory, Flush() appends them to the file. A key that occurs more than
+    once in the file has the value of its last record; Save() writes a
+    compacted copy with one record per key.
+    @verbatim
+    Header (16 bytes):
+      char[8]  magic "SgBookS\0"
+      uint32   version (1)
+      uint32   byte order mark 0x01020304
+    Records (24 bytes each):
+      uint64   key
+      float    heuristic value
+      float    value
+      float    priority
+      uint32   count
+    @endverbatim
+    The numbers are stored in the byte order of the machine that wrote the
+    file. An incomplete record at the end of the file (e.g. after a crash
+    during Flush()) is removed by Open(). */
+class SgBookStore
+{
+public:
+    /** Iterator over all keys and nodes, in no particular order. */
+    class Iterator
+    {
+    public:
+        Iterator(const SgBookStore& store);
+
+        std::uint64_t Key() const;
+
+        SgBookNode Node() const;
+
+        void operator++();
+
+        operator bool() const;
+
+    private:
+        const SgBookStore& m_store;
+
+        std::size_t m_slot;
+
+        void SkipEmpty();
+    };
+
+    SgBookStore();
+
+    ~SgBookStore();
+
+    /** Map a book file.
+        Creates an empty book file, if it does not exist. Discards all nodes
+        not yet flushed.
+        @throws SgException if the file cannot be created or mapped or is not
+        a book file */
+    void Open(const std::string& fileName);
+
+    /** Is a book file opened? */
+    bool IsOpen() const;
+
+    /** Name of the opened book file. */
+    const std::string& FileName() const;
+
+    /** Does a file start with the magic string of the book format? */
+    static bool IsBookFile(const std::string& fileName);
+
+    bool Get(std::uint64_t key, SgBookNode& node) const;
+
+    void Put(std::uint64_t key, const SgBookNode& node);
+
+    /** Number of keys. */
+    std::size_t Size() const;
+
+    /** Append the nodes changed since the last Open() or Flush() to the
+        book file.
+        @throws SgException if no book file is opened or writing fails */
+    void Flush();
+
+    /** Write all nodes to a file with one record per key.
+        The file is written under a temporary name and renamed, so an
+        existing file is replaced only if writing succeeded.
+        @throws SgException if writing fails or the file is the opened book
+        file (use Flush()) */
+    void Save(const std::string& fileName) const;
+
+private:
+    struct Record
+    {
+        std::uint64_t m_key;
+
+        float m_heurValue;
+
+        float m_value;
+
+        float m_priority;
+
+        std::uint32_t m_count;
+    };
+
+    std::string m_fileName;
+
+    /** Records of the book file. */
+    std::unique_ptr<SgMappedFile> m_file;
+
+    /** Number of records in m_file. */
+    std::size_t m_nuMapped;
+
+    /** Records not yet flushed.
+        The record number of m_records[i] is m_nuMapped + i, which stays
+        the same after it is appended to the file by Flush(). */
+    std::vector<Record> m_records;
+
+    /** Open-addressing hash table of record numbers plus one, zero for
+        an empty slot. The size is a power of two. */
+    std::vector<std::uint32_t> m_slots;
+
+    std::size_t m_size;
+
+    /** Not implemented. */
+    SgBookStore(const SgBookStore&);
+
+    /** Not implemented. */
+    SgBookStore& operator=(const SgBookStore&);
+
+    const Record& GetRecord(std::uint32_t index) const;
+
+    std::size_t FindSlot(std::uint64_t key) const;
+
+    void Rehash(std::size_t nuSlots);
+
+    void Map();
+
+    void Clear();
+};
+
+inline SgBookNode SgBookStore::Iterator::Node() const
+{
+    const Record& record = m_store.GetRecord(m_store.m_slots[m_slot] - 1);
+    SgBookNode node;
+    node.m_heurValue = record.m_heurValue;
+    node.m_value = record.m_value;
+    node.m_priority = record.m_priority;
+    node.m_count = record.m_count;
+    return node;
+}
+
+inline std::uint64_t SgBookStore::Iterator::Key() const
+{
+    return m_store.GetRecord(m_store.m_slots[m_slot] - 1).m_key;
+}
+
+inline void SgBookStore::Iterator::operator++()
+{
+    ++m_slot;
+    SkipEmpty();
+}
+
+inline SgBookStore::Iterator::operator bool() const
+{
+    return m_slot < m_store.m_slots.size();
+}
+
+inline const std::string& SgBookStore::FileName() const
+{
+    return m_fileName;
+}
+
+inline bool SgBookStore::IsOpen() const
+{
+    return m_file.get() != 0;
+}
+
+inline std::size_t SgBookStore::Size() const
+{
+    return m_size;
+}
+
+//----------------------------------------------------------------------------
+
+#endif // SG_BOOKSTORE_H
@@ -0,0 +1,415 @@
+//----------------------------------------------------------------------------
+/** @file SgConcurrentHashTable.h
+    Hash table that can be shared by several search threads. */
+//----------------------------------------------------------------------------
+
+#ifndef SG_CONCURRENTHASHTABLE_H
+#define SG_CONCURRENTHASHTABLE_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include "SgHashTable.h"
+
+//----------------------------------------------------------------------------
+
+/** Small number that identifies the calling thread.
+    The threads are numbered in the order of their first call. */
+inline unsigned int SgConcurrentHashTableThreadIndex()
+{
+    static std::atomic<unsigned int> s_nuThreads(0);
+    thread_local const unsigned int t_index = s_nuThreads++;
+    return t_index;
+}
+
+//----------------------------------------------------------------------------
+
+/** Thread-safe variant of SgHashTable.
+    Has the same interface and the same replacement scheme as SgHashTable:
+    a code is stored in one of BLOCK_SIZE consecutive entries, overwriting
+    an invalid entry, the entry with the same code, or the least valuable
+    entry as determined by DATA::IsBetterThan(). Lookup() stops at the
+    first invalid entry of the block.
+
+    Each entry is protected by a sequence lock: the sequence number is odd
+    while a thread writes the entry, and is incremented at the end of the
+    write. Readers do not write to the entry; they copy it and retry if the
+    sequence number was odd or changed during the copy, so a lookup never
+    returns a torn entry. Writers of the same entry wait for each other,
+    but writers of different entries do not interact. The code and data are
+    copied as 64-bit atomic words with relaxed ordering, therefore
+    SgHashEntry<DATA> must be trivially copyable.
+
+    Store() chooses the entry of the block before it locks it, so two
+    threads storing the same code at the same time can put it into two
+    entries of the block. This only wastes an entry; Lookup() returns the
+    first one.
+
+    Age() and Clear() lock each entry and can be called while other threads
+    use the table, but they are intended to be called between searches.
+    Each thread counts the statistics in its own cache line.
+    @see SgHashTable */
+template <class DATA, int BLOCK_SIZE = 1>
+class SgConcurrentHashTable
+{
+public:
+    /** Create a hash table with 'maxHash' entries. */
+    explicit SgConcurrentHashTable(int maxHash);
+
+    ~SgConcurrentHashTable();
+
+    /** See SgHashTable::Age() */
+    void Age();
+
+    /** See SgHashTable::Clear() */
+    void Clear();
+
+    /** Return true and the data stored under that code, or false if
+        none stored. */
+    bool Lookup(const SgHashCode& code, DATA* data) const;
+
+    /** Size of hash table. */
+    int MaxHash() const;
+
+    /** Store 'data' under the hash code 'code'.
+        See SgHashTable::Store() */
+    bool Store(const SgHashCode& code, const DATA& data);
+
+    /** number of collisions on store */
+    size_t NuCollisions() const;
+
+    /** total number of stores attempted */
+    size_t NuStores() const;
+
+    /** total number of lookups attempted */
+    size_t NuLookups() const;
+
+    /** number of successful lookups */
+    size_t NuFound() const;
+
+private:
+    typedef SgHashEntry<DATA> Entry;
+
+    static_assert(std::is_trivially_copyable<Entry>::value,
+                  "SgConcurrentHashTable needs trivially copyable entries");
+
+    static const std::size_t NU_WORDS =
+        (sizeof(Entry) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+    /** Entry with sequence lock. */
+    struct Slot
+    {
+        /** Odd while the entry is written. */
+        std::atomic<std::uint32_t> m_sequence;
+
+        /** The SgHashEntry<DATA> as 64-bit words. */
+        std::atomic<std::uint64_t> m_words[NU_WORDS];
+    };
+
+    std::unique_ptr<Slot[]> m_slots;
+
+    /** size of hash table */
+    int m_maxHash;
+
+    /** Statistics counters of the threads with the same
+        SgConcurrentHashTableThreadIndex() modulo NU_COUNTERS.
+        Each set of counters has its own cache line, so threads do not
+        contend for the counters. */
+    struct alignas(64) Counters
+    {
+        /** number of collisions on store */
+        std::atomic<size_t> m_nuCollisions;
+
+        /** total number of stores attempted */
+        std::atomic<size_t> m_nuStores;
+
+        /** total number of lookups attempted */
+        std::atomic<size_t> m_nuLookups;
+
+        /** number of successful lookups */
+        std::atomic<size_t> m_nuFound;
+    };
+
+    static const std::size_t NU_COUNTERS = 16;
+
+    mutable Counters m_counters[NU_COUNTERS];
+
+    /** Counters of the calling thread. */
+    Counters& ThreadCounters() const;
+
+    /** Sum of a counter over all threads. */
+    size_t SumCounters(std::atomic<size_t> Counters::* counter) const;
+
+    /** Lock a slot for writing.
+        @return The sequence number at the start of the write. */
+    static std::uint32_t Lock(Slot& slot);
+
+    /** Copy the words of a slot without checking the sequence number. */
+    static void Load(const Slot& slot, Entry& entry);
+
+    /** Copy an entry out of a slot, retrying if it is written. */
+    static void Read(const Slot& slot, Entry& entry);
+
+    /** Write an entry to a slot locked with Lock() and unlock it. */
+    static void WriteAndUnlock(Slot& slot, std::uint32_t sequence,
+                               const Entry& entry);
+
+    /** not implemented */
+    SgConcurrentHashTable(const SgConcurrentHashTable&);
+
+    /** not implemented */
+    SgConcurrentHashTable& operator=(const SgConcurrentHashTable&);
+};
+
+template <class DATA, int BLOCK_SIZE>
+SgConcurrentHashTable<DATA, BLOCK_SIZE>::SgConcurrentHashTable(int maxHash)
+    : m_slots(new Slot[maxHash + BLOCK_SIZE - 1]),
+      m_maxHash(maxHash)
+{
+    for (std::size_t i = 0; i < NU_COUNTERS; ++i)
+    {
+        m_counters[i].m_nuCollisions.store(0, std::memory_order_relaxed);
+        m_counters[i].m_nuStores.store(0, std::memory_order_relaxed);
+        m_counters[i].m_nuLookups.store(0, std::memory_order_relaxed);
+        m_counters[i].m_nuFound.store(0, std::memory_order_relaxed);
+    }
+    const Entry entry;
+    std::uint64_t words[NU_WORDS] = { };
+    std::memcpy(words, &entry, sizeof(Entry));
+    for (int i = m_maxHash + BLOCK_SIZE - 2; i >= 0; --i)
+    {
+        Slot& slot = m_slots[i];
+        slot.m_sequence.store(0, std::memory_order_relaxed);
+        for (std::size_t j = 0; j < NU_WORDS; ++j)
+            slot.m_words[j].store(words[j], std::memory_order_relaxed);
+    }
+    Clear();
+}
+
+template <class DATA, int BLOCK_SIZE>
+SgConcurrentHashTable<DATA, BLOCK_SIZE>::~SgConcurrentHashTable()
+{ }
+
+template <class DATA, int BLOCK_SIZE>
+void SgConcurrentHashTable<DATA, BLOCK_SIZE>::Age()
+{
+    for (int i = m_maxHash + BLOCK_SIZE - 2; i >= 0; --i)
+    {
+        Slot& slot = m_slots[i];
+        const std::uint32_t sequence = Lock(slot);
+        Entry entry;
+        Load(slot, entry);
+        entry.m_data.AgeData();
+        WriteAndUnlock(slot, sequence, entry);
+    }
+}
+
+template <class DATA, int BLOCK_SIZE>
+void SgConcurrentHashTable<DATA, BLOCK_SIZE>::Clear()
+{
+    for (int i = m_maxHash + BLOCK_SIZE - 2; i >= 0; --i)
+    {
+        Slot& slot = m_slots[i];
+        const std::uint32_t sequence = Lock(slot);
+        Entry entry;
+        Load(slot, entry);
+        entry.m_data.Invalidate();
+        WriteAndUnlock(slot, sequence, entry);
+    }
+}
+
+template <class DATA, int BLOCK_SIZE>
+void SgConcurrentHashTable<DATA, BLOCK_SIZE>::Load(const Slot& slot,
+                                                   Entry& entry)
+{
+    std::uint64_t words[NU_WORDS];
+    for (std::size_t i = 0; i < NU_WORDS; ++i)
+        words[i] = slot.m_words[i].load(std::memory_order_relaxed);
+    std::memcpy(&entry, words, sizeof(Entry));
+}
+
+template <class DATA, int BLOCK_SIZE>
+std::uint32_t SgConcurrentHashTable<DATA, BLOCK_SIZE>::Lock(Slot& slot)
+{
+    std::uint32_t sequence = slot.m_sequence.load(std::memory_order_relaxed);
+    while (true)
+    {
+        if (  (sequence & 1) == 0
+           && slot.m_sequence.compare_exchange_weak(sequence, sequence + 1,
+                                                    std::memory_order_acquire,
+                                                    std::memory_order_relaxed)
+           )
+            break;
+        if ((sequence & 1) != 0)
+        {
+            std::this_thread::yield();
+            sequence = slot.m_sequence.load(std::memory_order_relaxed);
+        }
+    }
+    // Readers must not see the new words before the odd sequence number
+    std::atomic_thread_fence(std::memory_order_release);
+    return sequence + 1;
+}
+
+template <class DATA, int BLOCK_SIZE>
+bool SgConcurrentHashTable<DATA, BLOCK_SIZE>::Lookup(const SgHashCode& code,
+                                                     DATA* data) const
+{
+    Counters& counters = ThreadCounters();
+    counters.m_nuLookups.fetch_add(1, std::memory_order_relaxed);
+    int h = code.Hash(m_maxHash);
+    Entry entry;
+    for (int i = h; i < h + BLOCK_SIZE; i++)
+    {
+        Read(m_slots[i], entry);
+        if (! entry.m_data.IsValid())
+            return false;
+        if (entry.m_hash == code)
+        {
+            *data = entry.m_data;
+            counters.m_nuFound.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+template <class DATA, int BLOCK_SIZE>
+int SgConcurrentHashTable<DATA, BLOCK_SIZE>::MaxHash() const
+{
+    return m_maxHash;
+}
+
+template <class DATA, int BLOCK_SIZE>
+size_t SgConcurrentHashTable<DATA, BLOCK_SIZE>::NuCollisions() const
+{
+    return SumCounters(&Counters::m_nuCollisions);
+}
+
+template <class DATA, int BLOCK_SIZE>
+size_t SgConcurrentHashTable<DATA, BLOCK_SIZE>::NuFound() const
+{
+    return SumCounters(&Counters::m_nuFound);
+}
+
+template <class DATA, int BLOCK_SIZE>
+size_t SgConcurrentHashTable<DATA, BLOCK_SIZE>::NuLookups() const
+{
+    return SumCounters(&Counters::m_nuLookups);
+}
+
+template <class DATA, int BLOCK_SIZE>
+size_t SgConcurrentHashTable<DATA, BLOCK_SIZE>::NuStores() const
+{
+    return SumCounters(&Counters::m_nuStores);
+}
+
+template <class DATA, int BLOCK_SIZE>
+void SgConcurrentHashTable<DATA, BLOCK_SIZE>::Read(const Slot& slot,
+                                                   Entry& entry)
+{
+    std::uint64_t words[NU_WORDS];
+    while (true)
+    {
+        const std::uint32_t sequence =
+            slot.m_sequence.load(std::memory_order_acquire);
+        if ((sequence & 1) != 0)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        for (std::size_t i = 0; i < NU_WORDS; ++i)
+            words[i] = slot.m_words[i].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.m_sequence.load(std::memory_order_relaxed) == sequence)
+            break;
+    }
+    std::memcpy(&entry, words, sizeof(Entry));
+}
+
+template <class DATA, int BLOCK_SIZE>
+bool SgConcurrentHashTable<DATA, BLOCK_SIZE>::Store(const SgHashCode& code,
+                                                    const DATA& data)
+{
+    Counters& counters = ThreadCounters();
+    counters.m_nuStores.fetch_add(1, std::memory_order_relaxed);
+    int h = code.Hash(m_maxHash);
+    int best = -1;
+    Entry bestEntry;
+    bool collision = true;
+    Entry entry;
+    for (int i = h; i < h + BLOCK_SIZE; i++)
+    {
+        Read(m_slots[i], entry);
+        if (! entry.m_data.IsValid() || entry.m_hash == code)
+        {
+            best = i;
+            collision = false;
+            break;
+        }
+        else if (best == -1 || bestEntry.m_data.IsBetterThan(entry.m_data))
+        {
+            best = i;
+            bestEntry = entry;
+        }
+    }
+    if (collision)
+        counters.m_nuCollisions.fetch_add(1, std::memory_order_relaxed);
+    SG_ASSERTRANGE(best, h, h + BLOCK_SIZE - 1);
+    Slot& slot = m_slots[best];
+    const std::uint32_t sequence = Lock(slot);
+    WriteAndUnlock(slot, sequence, Entry(code, data));
+    return true;
+}
+
+template <class DATA, int BLOCK_SIZE>
+size_t SgConcurrentHashTable<DATA, BLOCK_SIZE>::SumCounters(
+                           std::atomic<size_t> Counters::* counter) const
+{
+    size_t sum = 0;
+    for (std::size_t i = 0; i < NU_COUNTERS; ++i)
+        sum += (m_counters[i].*counter).load(std::memory_order_relaxed);
+    return sum;
+}
+
+template <class DATA, int BLOCK_SIZE>
+typename SgConcurrentHashTable<DATA, BLOCK_SIZE>::Counters&
+SgConcurrentHashTable<DATA, BLOCK_SIZE>::ThreadCounters() const
+{
+    return m_counters[SgConcurrentHashTableThreadIndex() % NU_COUNTERS];
+}
+
+template <class DATA, int BLOCK_SIZE>
+void SgConcurrentHashTable<DATA, BLOCK_SIZE>::WriteAndUnlock(Slot& slot,
+                                                     std::uint32_t sequence,
+                                                     const Entry& entry)
+{
+    SG_ASSERT((sequence & 1) != 0);
+    std::uint64_t words[NU_WORDS] = { };
+    std::memcpy(words, &entry, sizeof(Entry));
+    for (std::size_t i = 0; i < NU_WORDS; ++i)
+        slot.m_words[i].store(words[i], std::memory_order_relaxed);
+    slot.m_sequence.store(sequence + 1, std::memory_order_release);
+}
+
+//----------------------------------------------------------------------------
+
+/** Writes statistics on hash table use (not the content) */
+template <class DATA, int BLOCK_SIZE>
+std::ostream& operator<<(std::ostream& out,
+                         const SgConcurrentHashTable<DATA, BLOCK_SIZE>& hash)
+{
+    out << "HashTableStatistics:\n"
+        << SgWriteLabel("Stores") << hash.NuStores() << '\n'
+        << SgWriteLabel("LookupAttempt") << hash.NuLookups() << '\n'
+        << SgWriteLabel("LookupSuccess") << hash.NuFound() << '\n'
+        << SgWriteLabel("Collisions") << hash.NuCollisions() << '\n';
+    return out;
+}
+
+//----------------------------------------------------------------------------
+
+#endif // SG_CONCURRENTHASHTABLE_H
@@ -6,8 +6,10 @@
 #include "SgDfpnSearch.h"
 #include "SgSearchTracer.h"
 
+#include <algorithm>
 #include <cmath>
 #include "SgDebug.h"
+#include "SgException.h"
 #include "SgWrite.h"
 
 //----------------------------------------------------------------------------
@@ -19,11 +21,42 @@ namespace {
 */
 const bool USE_WIDENING = true;
 
+/** Size of the DfpnBusyTable of a parallel search.
+    Only the states on the current paths of the threads are counted, so a
+    small table suffices. */
+const std::size_t BUSY_TABLE_SIZE = 1 << 14;
+
 inline SgEmptyBlackWhite Winner(bool isWinning, SgEmptyBlackWhite toPlay)
 {
 	return isWinning ? toPlay : SgOppBW(toPlay);
 }
 
+/** Key of a state in DfpnBusyTable: the upper 48 bits of the entry. */
+inline std::uint64_t BusyKey(const SgHashCode& hash)
+{
+    std::uint64_t key = (std::uint64_t(hash.Code1()) << 32) | hash.Code2();
+    key &= ~std::uint64_t(0xffff);
+    // Zero marks entries that were never used
+    return key == 0 ? 0x10000 : key;
+}
+
+/** Index of the first entry to probe for a key. */
+inline std::size_t BusyIndex(std::uint64_t key)
+{
+    return static_cast<std::size_t>((key >> 16) ^ (key >> 40));
+}
+
+/** The virtual disproof number of a child searched by other threads.
+    See DfpnSolver::NumberThreads() */
+inline DfpnBoundType VirtualDelta(DfpnBoundType delta, unsigned int nuThreads)
+{
+    if (nuThreads == 0 || delta >= DfpnBounds::INFTY)
+        return delta;
+    return static_cast<DfpnBoundType>(
+        std::min(std::uint64_t(delta) * (1 + nuThreads),
+                 std::uint64_t(DfpnBounds::INFTY - 1)));
+}
+
 } // namespace
 //----------------------------------------------------------------------------
 
@@ -48,12 +81,97 @@ DfpnChildren::DfpnChildren()
 
 //----------------------------------------------------------------------------
 
+const std::size_t DfpnBusyTable::MAX_PROBES;
+
+DfpnBusyTable::DfpnBusyTable(std::size_t maxEntries)
+{
+    std::size_t size = 1;
+    while (size < maxEntries)
+        size *= 2;
+    m_mask = size - 1;
+    m_entries.reset(new std::atomic<std::uint64_t>[size]);
+    for (std::size_t i = 0; i < size; ++i)
+        m_entries[i].store(0, std::memory_order_relaxed);
+}
+
+DfpnBusyTable::~DfpnBusyTable()
+{ }
+
+void DfpnBusyTable::Enter(const SgHashCode& hash)
+{
+    const std::uint64_t key = BusyKey(hash);
+    std::size_t index = BusyIndex(key) & m_mask;
+    for (std::size_t i = 0; i < MAX_PROBES; ++i, index = (index + 1) & m_mask)
+    {
+        std::atomic<std::uint64_t>& entry = m_entries[index];
+        std::uint64_t value = entry.load(std::memory_order_relaxed);
+        while (true)
+        {
+            const bool isFree = ((value & 0xffff) == 0);
+            if ((value & ~std::uint64_t(0xffff)) == key)
+            {
+                if (entry.compare_exchange_weak(value, value + 1,
+                                                std::memory_order_relaxed))
+                    return;
+            }
+            else if (isFree)
+            {
+                if (entry.compare_exchange_weak(value, key | 1,
+                                                std::memory_order_relaxed))
+                    return;
+            }
+            else
+                break;
+        }
+    }
+}
+
+void DfpnBusyTable::Leave(const SgHashCode& hash)
+{
+    const std::uint64_t key = BusyKey(hash);
+    std::size_t index = BusyIndex(key) & m_mask;
+    for (std::size_t i = 0; i < MAX_PROBES; ++i, index = (index + 1) & m_mask)
+    {
+        std::atomic<std::uint64_t>& entry = m_entries[index];
+        std::uint64_t value = entry.load(std::memory_order_relaxed);
+        // Check the key and the count in the compare-and-swap, because an
+        // entry with count zero can get another key
+        while (  (value & ~std::uint64_t(0xffff)) == key
+              && (value & 0xffff) != 0
+              )
+            if (entry.compare_exchange_weak(value, value - 1,
+                                            std::memory_order_relaxed))
+                return;
+    }
+}
+
+unsigned int DfpnBusyTable::NuThreads(const SgHashCode& hash) const
+{
+    const std::uint64_t key = BusyKey(hash);
+    std::size_t index = BusyIndex(key) & m_mask;
+    for (std::size_t i = 0; i < MAX_PROBES; ++i, index = (index + 1) & m_mask)
+    {
+        const std::uint64_t value =
+            m_entries[index].load(std::memory_order_relaxed);
+        if ((value & ~std::uint64_t(0xffff)) == key)
+            return static_cast<unsigned int>(value & 0xffff);
+    }
+    return 0;
+}
+
+//----------------------------------------------------------------------------
+
 DfpnSolver::DfpnSolver()
     : m_hashTable(0),
+      m_concurrentHashTable(0),
       m_timelimit(0.0),
       m_wideningBase(1),
       m_wideningFactor(0.25f),
-      m_epsilon(0.0f)
+      m_epsilon(0.0f),
+      m_numberThreads(1),
+      m_busyTable(0),
+      m_stopFlag(false),
+      m_stop(&m_stopFlag)
 { }
 
 DfpnSolver::~DfpnSolver()
@@ -63,10 +181,14 @@ bool DfpnSolver::CheckAbort()
 {
     if (! m_aborted)
     {
-        if (SgUserAbort()) 
+        if (m_stop->load(std::memory_order_relaxed))
+            // Another thread has finished the search
+            m_aborted = true;
+        else if (SgUserAbort()) 
         {
             m_aborted = true;
             SgDebug() << "DfpnSolver::CheckAbort(): Abort flag!\n";
+            m_stop->store(true, std::memory_order_relaxed);
         }
         else if (m_timelimit > 0)
         {
@@ -77,6 +199,7 @@ bool DfpnSolver::CheckAbort()
                 {
                     m_aborted = true;
                     SgDebug() << "DfpnSolver::CheckAbort(): Timelimit!\n";
+                    m_stop->store(true, std::memory_order_relaxed);
                 }
                 else
                 {
@@ -97,6 +220,24 @@ bool DfpnSolver::CheckAbort()
     return m_aborted;
 }
 
+void DfpnSolver::ClearStatistics()
+{
+    m_numTerminal = 0;
+    m_numMIDcalls = 0;
+    m_generateMoves = 0;
+    m_totalWastedWork = 0;
+    m_prunedSiblingStats.Clear();
+    m_moveOrderingPercent.Clear();
+    m_moveOrderingIndex.Clear();
+    m_deltaIncrease.Clear();
+    m_checkTimerAbortCalls = 0;
+}
+
+std::unique_ptr<DfpnSolver> DfpnSolver::CreateThreadSolver() const
+{
+    return std::unique_ptr<DfpnSolver>();
+}
+
 void DfpnSolver::GetPVFromHash(PointSequence& pv)
 {
     // to do: SgAssertRestore r(state of search in subclass);
@@ -129,6 +270,29 @@ void DfpnSolver::LookupData(DfpnData& data, const DfpnChildren& children,
     UndoMove();
 }
 
+/** Read the bounds of all children and the number of threads searching
+    them. Used in a parallel search instead of LookupData(), because the
+    other threads can change the bounds of all children. */
+void DfpnSolver::LookupChildren(std::vector<DfpnData>& childrenData,
+                                std::vector<unsigned int>& nuThreads,
+                                const DfpnChildren& children)
+{
+    SG_ASSERT(m_busyTable != 0);
+    for (std::size_t i = 0; i < children.Size(); ++i)
+    {
+        PlayMove(children.MoveAt(i));
+        DfpnData& data = childrenData[i];
+        if (! TTRead(data))
+        {
+            data.m_bounds.phi = 1;
+            data.m_bounds.delta = 1;
+            data.m_work = 0;
+        }
+        nuThreads[i] = m_busyTable->NuThreads(Hash());
+        UndoMove();
+    }
+}
+
 size_t DfpnSolver::MID(const DfpnBounds& maxBounds, DfpnHistory& history)
 {
     maxBounds.CheckConsistency();
@@ -174,10 +338,17 @@ size_t DfpnSolver::MID(const DfpnBounds& maxBounds, DfpnHistory& history)
     DfpnChildren children;
     GenerateChildren(children.Children());
 
-    // Not thread safe: perhaps move into while loop below later...
     std::vector<DfpnData> childrenData(children.Size());
-    for (size_t i = 0; i < children.Size(); ++i)
-        LookupData(childrenData[i], children, i);
+    // Number of other threads in each child, empty with one thread
+    std::vector<unsigned int> nuThreads;
+    if (m_busyTable != 0)
+    {
+        nuThreads.resize(children.Size());
+        LookupChildren(childrenData, nuThreads, children);
+    }
+    else
+        for (size_t i = 0; i < children.Size(); ++i)
+            LookupData(childrenData[i], children, i);
     // Index used for progressive widening
     size_t maxChildIndex = ComputeMaxChildIndex(childrenData);
 
@@ -194,7 +365,18 @@ size_t DfpnSolver::MID(const DfpnBounds& maxBounds, DfpnHistory& history)
         // Select most proving child
         std::size_t bestIndex = 999999;
         DfpnBoundType delta2 = DfpnBounds::INFTY;
-        SelectChild(bestIndex, delta2, childrenData, maxChildIndex);
+        SelectChild(bestIndex, delta2, childrenData, maxChildIndex,
+                    nuThreads);
+        if (  ! nuThreads.empty()
+           && childrenData[bestIndex].m_bounds.delta >= maxBounds.phi
+           )
+        {
+            // The virtual bounds selected a child that cannot be searched
+            // within the bounds of this state
+            delta2 = DfpnBounds::INFTY;
+            SelectChild(bestIndex, delta2, childrenData, maxChildIndex,
+                        std::vector<unsigned int>());
+        }
         bestMove = children.MoveAt(bestIndex);
 
         // Compute maximum bound for child
@@ -212,12 +394,27 @@ size_t DfpnSolver::MID(const DfpnBounds& maxBounds, DfpnHistory& history)
         // Recurse on best child
         PlayMove(bestMove);
         history.Push(bestMove, currentHash);
-        localWork += MID(childMaxBounds, history);
+        if (m_busyTable != 0)
+        {
+            const SgHashCode childHash = Hash();
+            m_busyTable->Enter(childHash);
+            localWork += MID(childMaxBounds, history);
+            m_busyTable->Leave(childHash);
+        }
+        else
+            localWork += MID(childMaxBounds, history);
         history.Pop();
         UndoMove();
 
-        // Update bounds for best child
-        LookupData(childrenData[bestIndex], children, bestIndex);
+        // Update bounds for best child, or for all children in a parallel
+        // search
+        if (m_busyTable != 0)
+        {
+            LookupChildren(childrenData, nuThreads, children);
+            maxChildIndex = ComputeMaxChildIndex(childrenData);
+        }
+        else
+            LookupData(childrenData[bestIndex], children, bestIndex);
 
         // Compute some stats when find winning move
         if (childrenData[bestIndex].m_bounds.IsLosing())
@@ -264,7 +461,14 @@ size_t DfpnSolver::MID(const DfpnBounds& maxBounds, DfpnHistory& history)
         }
     }
     
-    // Store search results
+    // Store search results. In a parallel search, do not overwrite a result
+    // of another thread that solved the state in the meantime.
+    if (m_busyTable != 0 && ! currentBounds.IsSolved())
+    {
+        DfpnData stored;
+        if (TTRead(stored) && stored.m_bounds.IsSolved())
+            return localWork;
+    }
     TTWrite(DfpnData(currentBounds, bestMove, localWork + prevWork));
     return localWork;
 }
@@ -318,6 +522,7 @@ void DfpnSolver::PrintStatistics(SgEmptyBlackWhite winner,
 {
     std::ostringstream os;
     os << '\n'
+       << SgWriteLabel("Threads") << m_numberThreads << '\n'
        << SgWriteLabel("MID calls") << m_numMIDcalls << '\n'
        << SgWriteLabel("Generate moves") << m_generateMoves << '\n'
        << SgWriteLabel("Terminal") << m_numTerminal << '\n'
@@ -343,32 +548,46 @@ void DfpnSolver::PrintStatistics(SgEmptyBlackWhite winner,
        << SgWriteLabel("Winner") << SgEBW(winner) << '\n';
     WriteMoveSequence(os, pv);
     os << '\n';
-    if (m_hashTable)
+    if (m_concurrentHashTable)
+        os << '\n' << *m_concurrentHashTable << '\n';
+    else if (m_hashTable)
         os << '\n' << *m_hashTable << '\n';
     SgDebug() << os.str();
 }
 
+/** Select the child with the smallest delta.
+    @param[out] bestIndex
+    @param[in,out] delta2 The second smallest delta
+    @param childrenData
+    @param maxChildIndex
+    @param nuThreads The number of other threads in each child for
+    virtual bounds in a parallel search, empty for the real bounds. */
 void DfpnSolver::SelectChild(std::size_t& bestIndex, DfpnBoundType& delta2,
                              const std::vector<DfpnData>& childrenData,
-                             size_t maxChildIndex) const
+                             size_t maxChildIndex,
+                             const std::vector<unsigned int>& nuThreads) const
 {
     DfpnBoundType delta1 = DfpnBounds::INFTY;
 
     SG_ASSERT(1 <= maxChildIndex && maxChildIndex <= childrenData.size());
+    SG_ASSERT(nuThreads.empty() || nuThreads.size() == childrenData.size());
     for (std::size_t i = 0; i < maxChildIndex; ++i)
     {
         const DfpnBounds& child = childrenData[i].m_bounds;
+        const DfpnBoundType delta =
+            nuThreads.empty() ? child.delta
+                              : VirtualDelta(child.delta, nuThreads[i]);
 
         // Store the child with smallest delta and record 2nd smallest delta
-        if (child.delta < delta1)
+        if (delta < delta1)
         {
             delta2 = delta1;
-            delta1 = child.delta;
+            delta1 = delta;
             bestIndex = i;
         }
-        else if (child.delta < delta2)
+        else if (delta < delta2)
         {
-            delta2 = child.delta;
+            delta2 = delta;
         }
 
         // Winning move found
@@ -389,17 +608,35 @@ SgEmptyBlackWhite DfpnSolver::StartSearch(DfpnHashTable& hashTable,
                                           PointSequence& pv,
                                           const DfpnBounds& maxBounds)
 {
-    m_aborted = false;
     m_hashTable = &hashTable;
-    m_numTerminal = 0;
-    m_numMIDcalls = 0;
-    m_generateMoves = 0;
-    m_totalWastedWork = 0;
-    m_prunedSiblingStats.Clear();
-    m_moveOrderingPercent.Clear();
-    m_moveOrderingIndex.Clear();
-    m_deltaIncrease.Clear();
-    m_checkTimerAbortCalls = 0;
+    m_concurrentHashTable = 0;
+    return Solve(pv, maxBounds);
+}
+
+SgEmptyBlackWhite
+DfpnSolver::StartSearch(DfpnConcurrentHashTable& hashTable,
+                        PointSequence& pv)
+{
+    return StartSearch(hashTable, pv,
+                       DfpnBounds(DfpnBounds::MAX_WORK, DfpnBounds::MAX_WORK));
+}
+
+SgEmptyBlackWhite
+DfpnSolver::StartSearch(DfpnConcurrentHashTable& hashTable,
+                        PointSequence& pv, const DfpnBounds& maxBounds)
+{
+    m_hashTable = 0;
+    m_concurrentHashTable = &hashTable;
+    return Solve(pv, maxBounds);
+}
+
+/** Solve the current state with the hashtable set by StartSearch(). */
+SgEmptyBlackWhite DfpnSolver::Solve(PointSequence& pv,
+                                    const DfpnBounds& maxBounds)
+{
+    m_aborted = false;
+    m_stopFlag = false;
+    ClearStatistics();
 
     // Skip search if already solved
     DfpnData data;
@@ -415,8 +652,13 @@ SgEmptyBlackWhite DfpnSolver::StartSearch(DfpnHashTable& hashTable,
     }
 
     m_timer.Start();
-    DfpnHistory history;
-    MID(maxBounds, history);
+    if (m_numberThreads > 1 && m_concurrentHashTable != 0)
+        SearchParallel(maxBounds);
+    else
+    {
+        DfpnHistory history;
+        MID(maxBounds, history);
+    }
     m_timer.Stop();
 
     GetPVFromHash(pv);
@@ -433,6 +675,71 @@ SgEmptyBlackWhite DfpnSolver::StartSearch(DfpnHashTable& hashTable,
     return winner;
 }
 
+/** Search the root state with NumberThreads() threads.
+    The solvers of the other threads are created with CreateThreadSolver().
+    Each thread calls MID() for the root state until one thread has
+    returned from the root state with the root solved or all threads are
+    aborted. Adds the counters of the other threads to the counters of
+    this solver. */
+void DfpnSolver::SearchParallel(const DfpnBounds& maxBounds)
+{
+    m_threadSolvers.clear();
+    for (std::size_t i = 1; i < m_numberThreads; ++i)
+    {
+        std::unique_ptr<DfpnSolver> solver = CreateThreadSolver();
+        if (! solver)
+            throw SgException("DfpnSolver: CreateThreadSolver() is needed "
+                              "for more than one thread");
+        m_threadSolvers.push_back(std::move(solver));
+    }
+    DfpnBusyTable busyTable(BUSY_TABLE_SIZE);
+    m_busyTable = &busyTable;
+    for (std::size_t i = 0; i < m_threadSolvers.size(); ++i)
+    {
+        DfpnSolver& solver = *m_threadSolvers[i];
+        solver.m_hashTable = m_hashTable;
+        solver.m_concurrentHashTable = m_concurrentHashTable;
+        solver.m_busyTable = &busyTable;
+        solver.m_stop = &m_stopFlag;
+        // Only the main thread checks the time limit
+        solver.m_timelimit = 0;
+        solver.m_wideningBase = m_wideningBase;
+        solver.m_wideningFactor = m_wideningFactor;
+        solver.m_epsilon = m_epsilon;
+        solver.m_aborted = false;
+        solver.ClearStatistics();
+    }
+    m_threadPool.SetNumberThreads(m_numberThreads);
+    m_threadPool.RunOnAll([this, &maxBounds](std::size_t threadIndex)
+    {
+        DfpnSolver& solver =
+            (threadIndex == 0 ? *this : *m_threadSolvers[threadIndex - 1]);
+        do
+        {
+            DfpnHistory history;
+            solver.MID(maxBounds, history);
+            DfpnData data;
+            if (solver.TTRead(data) && ! maxBounds.GreaterThan(data.m_bounds))
+                break;
+        }
+        while (! solver.CheckAbort());
+        m_stopFlag = true;
+    });
+    m_busyTable = 0;
+    for (std::size_t i = 0; i < m_threadSolvers.size(); ++i)
+    {
+        const DfpnSolver& solver = *m_threadSolvers[i];
+        m_numTerminal += solver.m_numTerminal;
+        m_numMIDcalls += solver.m_numMIDcalls;
+        m_generateMoves += solver.m_generateMoves;
+        m_totalWastedWork += solver.m_totalWastedWork;
+    }
+    // The main thread is aborted, if another thread has finished first
+    DfpnData data;
+    if (TTRead(data) && ! maxBounds.GreaterThan(data.m_bounds))
+        m_aborted = false;
+}
+
 void DfpnSolver::UpdateBounds(DfpnBounds& bounds, 
                               const std::vector<DfpnData>& childData,
                               size_t maxChildIndex) const
@@ -458,6 +765,23 @@ void DfpnSolver::UpdateBounds(DfpnBounds& bounds,
 
 bool DfpnSolver::Validate(DfpnHashTable& positions, const SgBlackWhite winner,
                           SgSearchTracer& tracer)
+{
+    m_hashTable = &positions;
+    m_concurrentHashTable = 0;
+    return ValidateState(winner, tracer);
+}
+
+bool DfpnSolver::Validate(DfpnConcurrentHashTable& positions,
+                          const SgBlackWhite winner, SgSearchTracer& tracer)
+{
+    m_hashTable = 0;
+    m_concurrentHashTable = &positions;
+    return ValidateState(winner, tracer);
+}
+
+/** Validate with the hashtable set by Validate(). */
+bool DfpnSolver::ValidateState(const SgBlackWhite winner,
+                               SgSearchTracer& tracer)
 {
     SG_ASSERT_BW(winner);
 
@@ -465,7 +789,7 @@ bool DfpnSolver::Validate(DfpnHashTable& positions, const SgBlackWhite winner,
     if (! TTRead(data))
     {
         PointSequence pv;
-        StartSearch(positions, pv);
+        Solve(pv, DfpnBounds(DfpnBounds::MAX_WORK, DfpnBounds::MAX_WORK));
         const bool wasRead = TTRead(data);
         SG_DEBUG_ONLY(wasRead);
         SG_ASSERT(wasRead);
@@ -514,7 +838,7 @@ bool DfpnSolver::Validate(DfpnHashTable& positions, const SgBlackWhite winner,
     {
         tracer.AddTraceNode(*it, GetColorToMove());
         PlayMove(*it);
-        if (! Validate(positions, winner, tracer))
+        if (! ValidateState(winner, tracer))
             return false;
         UndoMove();
         tracer.TakeBackTraceNode();
@@ -5,12 +5,17 @@
 #pragma once
 
 #include "SgBoardColor.h"
+#include "SgConcurrentHashTable.h"
 #include "SgHashTable.h"
 #include "SgStatistics.h"
+#include "SgThreadPool.h"
 #include "SgTimer.h"
 #include "SgSearchTracer.h"
 
+#include <atomic>
+#include <cstdint>
 #include <limits>
+#include <memory>
 #include <ostream>
 
 typedef std::vector<SgMove> PointSequence;
@@ -203,8 +208,6 @@ public:
 
     DfpnData(const DfpnBounds& bounds, SgMove bestMove, size_t work);
 
-    ~DfpnData();
-
     std::string Print() const; 
     
     /** @name SgHashTable methods. */
@@ -235,9 +238,6 @@ inline DfpnData::DfpnData(const DfpnBounds& bounds,
       m_isValid(true)
 {  }
 
-inline DfpnData::~DfpnData()
-{ }
-
 inline std::string DfpnData::Print() const
 {
     std::ostringstream os;
@@ -346,6 +346,59 @@ inline SgMove DfpnHistory::LastMove() const
 */
 typedef SgHashTable<DfpnData, 4> DfpnHashTable;
 
+/** Thread-safe hashtable for a parallel dfpn search.
+    Can be shared by the threads of a parallel search (see
+    DfpnSolver::NumberThreads()), but is slower than DfpnHashTable in a
+    search with one thread.
+    @ingroup dfpn
+*/
+typedef SgConcurrentHashTable<DfpnData, 4> DfpnConcurrentHashTable;
+
+//----------------------------------------------------------------------------
+
+/** Number of threads searching each state in a parallel dfpn search.
+    A lock-free table of fixed size that maps the hash code of a state to
+    the number of threads that are in a MID call for the state. Each entry
+    is a single 64-bit word with 48 bits of the hash code and a 16-bit
+    count, such that an entry with count zero can be reused for another
+    state with a single compare-and-swap. If no entry is free within a few
+    probes, the state is not counted. The counts are only used for
+    selecting the children, so collisions of the 48-bit keys are harmless.
+    @ingroup dfpn
+*/
+class DfpnBusyTable
+{
+public:
+    /** Create table.
+        @param maxEntries The size is maxEntries rounded up to a power of
+        two. */
+    explicit DfpnBusyTable(std::size_t maxEntries);
+
+    ~DfpnBusyTable();
+
+    /** Increment the count of a state. */
+    void Enter(const SgHashCode& hash);
+
+    /** Decrement the count of a state incremented by Enter(). */
+    void Leave(const SgHashCode& hash);
+
+    /** Number of threads in a state. */
+    unsigned int NuThreads(const SgHashCode& hash) const;
+
+private:
+    static const std::size_t MAX_PROBES = 8;
+
+    std::size_t m_mask;
+
+    std::unique_ptr<std::atomic<std::uint64_t>[]> m_entries;
+
+    /** Not implemented. */
+    DfpnBusyTable(const DfpnBusyTable&);
+
+    /** Not implemented. */
+    DfpnBusyTable& operator=(const DfpnBusyTable&);
+};
+
 //----------------------------------------------------------------------------
 
 /** Solver using DFPN search. 
@@ -369,10 +422,22 @@ public:
     StartSearch(DfpnHashTable& positions, PointSequence& pv,
                          const DfpnBounds& maxBounds);
 
+    /** Solve the given state using the given thread-safe hashtable.
+        Needed for a parallel search (see NumberThreads()). */
+    SgEmptyBlackWhite
+    StartSearch(DfpnConcurrentHashTable& positions, PointSequence& pv);
+
+    SgEmptyBlackWhite
+    StartSearch(DfpnConcurrentHashTable& positions, PointSequence& pv,
+                const DfpnBounds& maxBounds);
+
     /** Validate the current position is a win for winner. */
     bool Validate(DfpnHashTable& positions, const SgBlackWhite winner,
                   SgSearchTracer& tracer);
 
+    bool Validate(DfpnConcurrentHashTable& positions,
+                  const SgBlackWhite winner, SgSearchTracer& tracer);
+
     /** Returns various histograms pertaining to the evaluation
         function from the last search. */
     std::string EvaluationInfo() const;
@@ -403,6 +468,12 @@ public:
     virtual void WriteMoveSequence(std::ostream& stream,
                                    const PointSequence& sequence) const = 0;
 
+    /** Create a solver for an additional search thread.
+        Needed for NumberThreads() greater than one. The new solver must be
+        in the current state of this solver; the solver parameters are
+        copied by the caller. The default implementation returns null. */
+    virtual std::unique_ptr<DfpnSolver> CreateThreadSolver() const;
+
     size_t NumGenerateMovesCalls() const;
     
     size_t NumMIDcalls() const;
@@ -446,6 +517,25 @@ public:
     
     /** See Epsilon() */
     void SetEpsilon(float epsilon);
+
+    /** Number of threads.
+        With more than one thread, the threads search the same root state
+        with the shared DfpnHashTable. A thread that selects a child in MID
+        treats the proof and disproof numbers of children, which other
+        threads are searching, as if they were larger by a factor of one
+        plus the number of these threads (virtual proof numbers), such that
+        the threads tend to search different subtrees. The threads also
+        reread the bounds of all children after each MID call of a child to
+        use the results of the other threads. Needs CreateThreadSolver()
+        and a DfpnConcurrentHashTable; with a DfpnHashTable, the search
+        uses one thread.
+        The counters NumMIDcalls() etc. are summed over all threads, the
+        histograms of the statistics only contain the main thread.
+        Default is 1. */
+    std::size_t NumberThreads() const;
+
+    /** See NumberThreads() */
+    void SetNumberThreads(std::size_t numberThreads);
     
     // @}
 
@@ -453,6 +543,9 @@ private:
 
     DfpnHashTable* m_hashTable;
 
+    /** Hashtable used instead of m_hashTable, if not null. */
+    DfpnConcurrentHashTable* m_concurrentHashTable;
+
     SgTimer m_timer;
 
     /** See TimeLimit() */
@@ -467,6 +560,26 @@ private:
     /** See Epsilon() */
     float m_epsilon;
 
+    /** See NumberThreads() */
+    std::size_t m_numberThreads;
+
+    /** Threads of a parallel search, the main thread is this solver. */
+    SgThreadPool m_threadPool;
+
+    /** Solvers of the other threads of the last parallel search. */
+    std::vector<std::unique_ptr<DfpnSolver> > m_threadSolvers;
+
+    /** Counts of the threads in each state in a parallel search, null in a
+        search with one thread. Shared by the solvers of all threads. */
+    DfpnBusyTable* m_busyTable;
+
+    /** Flag to stop all threads, set by the first thread that aborts or
+        returns from the root state. */
+    std::atomic<bool> m_stopFlag;
+
+    /** The m_stopFlag of the solver of the main thread. */
+    std::atomic<bool>* m_stop;
+
     /** Number of calls to CheckAbort() before we check the timer.
         This is to avoid expensive calls to SgTime::Get(). Try to scale
         this so that it is checked twice a second. */
@@ -494,7 +607,8 @@ private:
 
     void SelectChild(std::size_t& bestIndex, DfpnBoundType& delta2, 
                      const std::vector<DfpnData>& childrenDfpnBounds,
-                     size_t maxChildIndex) const;
+                     size_t maxChildIndex,
+                     const std::vector<unsigned int>& nuThreads) const;
 
     void UpdateBounds(DfpnBounds& bounds, 
                       const std::vector<DfpnData>& childBounds,
@@ -505,6 +619,16 @@ private:
     void LookupData(DfpnData& data, const DfpnChildren& children, 
                     std::size_t childIndex);
 
+    void LookupChildren(std::vector<DfpnData>& childrenData,
+                        std::vector<unsigned int>& nuThreads,
+                        const DfpnChildren& children);
+
+    void ClearStatistics();
+
+    void SearchParallel(const DfpnBounds& maxBounds);
+
+    SgEmptyBlackWhite Solve(PointSequence& pv, const DfpnBounds& maxBounds);
+
     virtual bool TTRead(DfpnData& data);
 
     virtual void TTWrite(const DfpnData& data);
@@ -517,6 +641,8 @@ private:
     
     size_t ComputeMaxChildIndex(const std::vector<DfpnData>&
                                 childrenData) const;
+
+    bool ValidateState(const SgBlackWhite winner, SgSearchTracer& tracer);
 };
 
 inline float DfpnSolver::Epsilon() const
@@ -524,6 +650,11 @@ inline float DfpnSolver::Epsilon() const
     return m_epsilon;
 }
 
+inline std::size_t DfpnSolver::NumberThreads() const
+{
+    return m_numberThreads;
+}
+
 inline size_t DfpnSolver::NumGenerateMovesCalls() const
 {
     return m_generateMoves;
@@ -550,6 +681,12 @@ inline void DfpnSolver::SetEpsilon(float epsilon)
     m_epsilon = epsilon;
 }
 
+inline void DfpnSolver::SetNumberThreads(std::size_t numberThreads)
+{
+    SG_ASSERT(numberThreads >= 1);
+    m_numberThreads = numberThreads;
+}
+
 inline void DfpnSolver::SetTimelimit(double timelimit)
 {
     m_timelimit = timelimit;
@@ -572,6 +709,8 @@ inline double DfpnSolver::Timelimit() const
 
 inline bool DfpnSolver::TTRead(DfpnData& data)
 {
+    if (m_concurrentHashTable != 0)
+        return m_concurrentHashTable->Lookup(Hash(), &data);
     return m_hashTable->Lookup(Hash(), &data);
 }
 
@@ -580,7 +719,10 @@ inline void DfpnSolver::TTWrite(const DfpnData& data)
     #ifndef NDEBUG
         data.m_bounds.CheckConsistency();
     #endif
-    m_hashTable->Store(Hash(), data);
+    if (m_concurrentHashTable != 0)
+        m_concurrentHashTable->Store(Hash(), data);
+    else
+        m_hashTable->Store(Hash(), data);
 }
 
 inline int DfpnSolver::WideningBase() const
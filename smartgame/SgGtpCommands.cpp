@@ -14,6 +14,7 @@
 #include "SgDebug.h"
 #include "SgRandom.h"
 #include "SgTime.h"
+#include "SgUctCheckPerformance.h"
 
 #if __APPLE__
 #include "TargetConditionals.h"
@@ -262,6 +263,36 @@ void SgGtpCommands::CmdQuiet(GtpCommand& cmd)
         SgSwapDebugStr(&cerr);
 }
 
+/** Run SgUctCheckPerformance::CheckNodePerformance().
+    Arguments: [threads [seconds]] <br>
+    Default is 1 thread and 10 seconds. Compare the output of builds with
+    and without SG_UCT_COMPACT_NODE. */
+void SgGtpCommands::CmdUctNodePerformance(GtpCommand& cmd)
+{
+    cmd.CheckNuArgLessEqual(2);
+    size_t nuThreads = 1;
+    double maxTime = 10;
+    if (cmd.NuArg() > 0)
+        nuThreads = cmd.ArgMin<size_t>(0, 1);
+    if (cmd.NuArg() > 1)
+        maxTime = cmd.ArgMin<double>(1, 0);
+    cmd << '\n';
+    SgUctCheckPerformance::CheckNodePerformance(cmd, nuThreads, maxTime);
+}
+
+/** Run SgUctCheckPerformance::CheckStartLatency().
+    Arguments: [max_threads] <br>
+    Default is 64 threads. */
+void SgGtpCommands::CmdUctStartLatency(GtpCommand& cmd)
+{
+    cmd.CheckNuArgLessEqual(1);
+    size_t maxThreads = 64;
+    if (cmd.NuArg() > 0)
+        maxThreads = cmd.ArgMin<size_t>(0, 1);
+    cmd << '\n';
+    SgUctCheckPerformance::CheckStartLatency(cmd, maxThreads);
+}
+
 void SgGtpCommands::Register(GtpEngine& engine)
 {
     engine.Register("cputime", &SgGtpCommands::CmdCpuTime, this);
@@ -276,6 +307,10 @@ void SgGtpCommands::Register(GtpEngine& engine)
     engine.Register("sg_compare_int", &SgGtpCommands::CmdCompareInt, this);
     engine.Register("sg_exec", &SgGtpCommands::CmdExec, this);
     engine.Register("sg_param", &SgGtpCommands::CmdParam, this);
+    engine.Register("sg_uct_node_performance",
+                    &SgGtpCommands::CmdUctNodePerformance, this);
+    engine.Register("sg_uct_start_latency",
+                    &SgGtpCommands::CmdUctStartLatency, this);
     engine.Register("quiet", &SgGtpCommands::CmdQuiet, this);
 }
 
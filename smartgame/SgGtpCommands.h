@@ -43,6 +43,8 @@ public:
         - @link CmdDebugger() @c sg_debugger @endlink
         - @link CmdExec() @c sg_exec @endlink
         - @link CmdParam() @c sg_param @endlink
+        - @link CmdUctNodePerformance() @c sg_uct_node_performance @endlink
+        - @link CmdUctStartLatency() @c sg_uct_start_latency @endlink
         - @link CmdQuiet() @c quiet @endlink */
     /** @name Command Callbacks */
     // @{
@@ -59,6 +61,8 @@ public:
     virtual void CmdPid(GtpCommand&);
     virtual void CmdSetRandomSeed(GtpCommand&);
     virtual void CmdQuiet(GtpCommand&);
+    virtual void CmdUctNodePerformance(GtpCommand&);
+    virtual void CmdUctStartLatency(GtpCommand&);
     // @} // @name
 
     void AddGoGuiAnalyzeCommands(GtpCommand& cmd);
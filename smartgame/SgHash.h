@@ -33,9 +33,6 @@ public:
     /** Construct hash code from integer index */
     SgHash(unsigned int key);
 
-    ~SgHash()
-    { }
-
     /** Reinitialize the hash code.
         Caution: after Clear() hash code matches code of empty board. */
     void Clear();
@@ -42,6 +42,8 @@ struct SgHashEntry
     The table size is increased by BLOCK_SIZE - 1 entries to avoid
     an expensive modulo operation in the scan.
     A good value for BLOCK_SIZE is 4.
+    SgHashTable is not thread-safe; see SgConcurrentHashTable for a table
+    that can be shared by several threads.
 */
 template <class DATA, int BLOCK_SIZE = 1>
 class SgHashTable
@@ -0,0 +1,108 @@
+//----------------------------------------------------------------------------
+/** @file SgMappedFile.cpp
+    See SgMappedFile.h */
+//----------------------------------------------------------------------------
+
+#include "SgSystem.h"
+#include "SgMappedFile.h"
+
+#include "SgException.h"
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using std::string;
+
+//----------------------------------------------------------------------------
+
+#ifdef WIN32
+
+SgMappedFile::SgMappedFile(const string& fileName)
+    : m_fileName(fileName),
+      m_data(0),
+      m_size(0),
+      m_file(INVALID_HANDLE_VALUE),
+      m_mapping(0)
+{
+    m_file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, 0,
+                         OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+    if (m_file == INVALID_HANDLE_VALUE)
+        throw SgException("Cannot open file " + fileName);
+    LARGE_INTEGER size;
+    if (! GetFileSizeEx(m_file, &size))
+    {
+        CloseHandle(m_file);
+        throw SgException("Cannot get size of file " + fileName);
+    }
+    m_size = static_cast<std::size_t>(size.QuadPart);
+    if (m_size == 0)
+        return;
+    m_mapping = CreateFileMappingA(m_file, 0, PAGE_READONLY, 0, 0, 0);
+    if (m_mapping != 0)
+        m_data = static_cast<const char*>(MapViewOfFile(m_mapping,
+                                                        FILE_MAP_READ, 0, 0,
+                                                        0));
+    if (m_data == 0)
+    {
+        if (m_mapping != 0)
+            CloseHandle(m_mapping);
+        CloseHandle(m_file);
+        throw SgException("Cannot map file " + fileName);
+    }
+}
+
+SgMappedFile::~SgMappedFile()
+{
+    if (m_data != 0)
+        UnmapViewOfFile(m_data);
+    if (m_mapping != 0)
+        CloseHandle(m_mapping);
+    CloseHandle(m_file);
+}
+
+#else
+
+SgMappedFile::SgMappedFile(const string& fileName)
+    : m_fileName(fileName),
+      m_data(0),
+      m_size(0)
+{
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw SgException("Cannot open file " + fileName);
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        throw SgException("Cannot get size of file " + fileName);
+    }
+    m_size = static_cast<std::size_t>(st.st_size);
+    if (m_size > 0)
+    {
+        void* data = mmap(0, m_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (data == MAP_FAILED)
+        {
+            close(fd);
+            throw SgException("Cannot map file " + fileName);
+        }
+        m_data = static_cast<const char*>(data);
+    }
+    // The mapping stays valid after closing the file
+    close(fd);
+}
+
+SgMappedFile::~SgMappedFile()
+{
+    if (m_data != 0)
+        munmap(const_cast<char*>(m_data), m_size);
+}
+
+#endif
+
+//----------------------------------------------------------------------------
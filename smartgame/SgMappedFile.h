@@ -0,0 +1,71 @@
+//----------------------------------------------------------------------------
+/** @file SgMappedFile.h
+    Read-only memory mapping of a file. */
+//----------------------------------------------------------------------------
+
+#ifndef SG_MAPPEDFILE_H
+#define SG_MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+//----------------------------------------------------------------------------
+
+/** A file mapped read-only into memory.
+    The pages are loaded on demand by the operating system and shared by all
+    processes that map the same file, so large read-only data files (e.g.
+    opening books) need no parsing at startup and are held only once in
+    memory. */
+class SgMappedFile
+{
+public:
+    /** Map a file.
+        @throws SgException if the file cannot be opened or mapped */
+    explicit SgMappedFile(const std::string& fileName);
+
+    ~SgMappedFile();
+
+    const char* Data() const;
+
+    std::size_t Size() const;
+
+    const std::string& FileName() const;
+
+private:
+    std::string m_fileName;
+
+    const char* m_data;
+
+    std::size_t m_size;
+
+#ifdef WIN32
+    void* m_file;
+
+    void* m_mapping;
+#endif
+
+    /** Not implemented. */
+    SgMappedFile(const SgMappedFile&);
+
+    /** Not implemented. */
+    SgMappedFile& operator=(const SgMappedFile&);
+};
+
+inline const char* SgMappedFile::Data() const
+{
+    return m_data;
+}
+
+inline const std::string& SgMappedFile::FileName() const
+{
+    return m_fileName;
+}
+
+inline std::size_t SgMappedFile::Size() const
+{
+    return m_size;
+}
+
+//----------------------------------------------------------------------------
+
+#endif // SG_MAPPEDFILE_H
@@ -434,10 +434,24 @@ void SgNode::PromotePath()
 
 void SgNode::DeleteSubtree()
 {
-    // 'delete' does all the work of keeping the tree pointers consistent, so
-    // can just keep deleting until no nodes below the current node remain.
-    while (HasSon())
-        delete LeftMostSon();
+    // Delete the nodes bottom-up. Each node is a leaf and the leftmost son
+    // when it is deleted, and is detached from the tree before, so that the
+    // destructor does not need to relink the remaining nodes.
+    SgNode* node = m_son;
+    while (node != 0 && node != this)
+    {
+        if (node->m_son != 0)
+        {
+            node = node->m_son;
+            continue;
+        }
+        SgNode* father = node->m_father;
+        father->m_son = node->m_brother;
+        node->m_father = 0;
+        node->m_brother = 0;
+        delete node;
+        node = (father->m_son != 0 ? father->m_son : father);
+    }
 }
 
 void SgNode::DeleteBranches()
@@ -26,6 +26,7 @@
 #define SG_NODE_H
 
 #include <string>
+#include "SgNodeArena.h"
 #include "SgProp.h"
 #include "SgPointSet.h"
 #include "SgVector.h"
@@ -61,6 +62,11 @@ public:
 
     ~SgNode();
 
+    /** Allocate in the current SgNodeArena, if there is one. */
+    static void* operator new(std::size_t size);
+
+    static void operator delete(void* p);
+
     /** Return a newly allocated copy of this node and its subtree. */
     SgNode* CopyTree() const;
 
@@ -387,6 +393,16 @@ private:
 #endif
 };
 
+inline void SgNode::operator delete(void* p)
+{
+    SgNodeArena::Free(p);
+}
+
+inline void* SgNode::operator new(std::size_t size)
+{
+    return SgNodeArena::Allocate(size);
+}
+
 //----------------------------------------------------------------------------
 
 /** Iterator for iterating through all the sons of a SgNode */
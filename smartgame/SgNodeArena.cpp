@@ -0,0 +1,150 @@
+//----------------------------------------------------------------------------
+/** @file SgNodeArena.cpp
+    See SgNodeArena.h */
+//----------------------------------------------------------------------------
+
+#include "SgSystem.h"
+#include "SgNodeArena.h"
+
+#include <new>
+
+using std::size_t;
+
+//----------------------------------------------------------------------------
+
+namespace {
+
+/** Stored in front of each object, keeps the objects aligned. */
+union Header
+{
+    SgNodeArena* m_arena;
+
+    std::max_align_t m_align;
+};
+
+const size_t HEADER_SIZE = sizeof(Header);
+
+thread_local SgNodeArena* t_currentArena = 0;
+
+inline size_t RoundUp(size_t size)
+{
+    return (size + HEADER_SIZE - 1) / HEADER_SIZE * HEADER_SIZE;
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------
+
+SgNodeArena::Scope::Scope(SgNodeArena* arena)
+    : m_oldArena(t_currentArena)
+{
+    t_currentArena = arena;
+}
+
+SgNodeArena::Scope::~Scope()
+{
+    t_currentArena = m_oldArena;
+}
+
+//----------------------------------------------------------------------------
+
+SgNodeArena::SgNodeArena(size_t blockSize)
+    : m_blockSize(RoundUp(blockSize)),
+      m_next(0),
+      m_end(0),
+      m_nuObjects(0),
+      m_nuBytes(0)
+{ }
+
+SgNodeArena::~SgNodeArena()
+{
+    SG_ASSERT(m_nuObjects == 0);
+    FreeBlocks(0);
+}
+
+void* SgNodeArena::Allocate(size_t size)
+{
+    size = HEADER_SIZE + RoundUp(size);
+    SgNodeArena* arena = t_currentArena;
+    Header* header;
+    if (arena == 0)
+        header = static_cast<Header*>(::operator new(size));
+    else
+    {
+        header = static_cast<Header*>(arena->AllocateInBlock(size));
+        ++arena->m_nuObjects;
+    }
+    header->m_arena = arena;
+    return header + 1;
+}
+
+void* SgNodeArena::AllocateInBlock(size_t size)
+{
+    if (size > static_cast<size_t>(m_end - m_next))
+    {
+        if (size > m_blockSize)
+        {
+            // Own block, keep using the current block for small objects
+            char* block = static_cast<char*>(::operator new(size));
+            m_blocks.insert(m_blocks.begin(), std::make_pair(block, size));
+            m_nuBytes += size;
+            return block;
+        }
+        char* block = static_cast<char*>(::operator new(m_blockSize));
+        m_blocks.push_back(std::make_pair(block, m_blockSize));
+        m_nuBytes += m_blockSize;
+        m_next = block;
+        m_end = block + m_blockSize;
+    }
+    void* p = m_next;
+    m_next += size;
+    return p;
+}
+
+void SgNodeArena::Clear()
+{
+    SG_ASSERT(m_nuObjects == 0);
+    FreeBlocks(1);
+}
+
+SgNodeArena* SgNodeArena::Current()
+{
+    return t_currentArena;
+}
+
+void SgNodeArena::Free(void* p)
+{
+    if (p == 0)
+        return;
+    Header* header = static_cast<Header*>(p) - 1;
+    SgNodeArena* arena = header->m_arena;
+    if (arena == 0)
+        ::operator delete(header);
+    else
+    {
+        SG_ASSERT(arena->m_nuObjects > 0);
+        --arena->m_nuObjects;
+    }
+}
+
+void SgNodeArena::FreeBlocks(size_t nuKeep)
+{
+    while (m_blocks.size() > nuKeep)
+    {
+        ::operator delete(m_blocks.back().first);
+        m_nuBytes -= m_blocks.back().second;
+        m_blocks.pop_back();
+    }
+    if (m_blocks.empty())
+    {
+        m_next = 0;
+        m_end = 0;
+    }
+    else
+    {
+        m_next = m_blocks[0].first;
+        m_end = m_next + m_blocks[0].second;
+    }
+}
+
+//----------------------------------------------------------------------------
@@ -0,0 +1,121 @@
+//----------------------------------------------------------------------------
+/** @file SgNodeArena.h
+    Memory arena for the nodes and properties of game trees. */
+//----------------------------------------------------------------------------
+
+#ifndef SG_NODEARENA_H
+#define SG_NODEARENA_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+//----------------------------------------------------------------------------
+
+/** Memory arena for the nodes and properties of game trees.
+    SgNode and SgProp objects are allocated with Allocate(). While an
+    SgNodeArena::Scope is active in the current thread, Allocate() takes the
+    memory from the arena of the scope by advancing a pointer in a large
+    block, and Free() only decreases the number of objects of the arena.
+    The blocks are released all at once by Clear() or the destructor.
+    Without an active scope, the objects are allocated on the heap as usual.
+
+    Each object remembers where it was allocated, so trees with nodes from
+    different arenas or the heap are safe, as long as an arena lives longer
+    than its objects. The trees still need to be deleted with
+    SgNode::DeleteTree() before the arena is cleared, because members of
+    nodes and properties (e.g. property lists and strings) use the heap.
+
+    An arena is not thread-safe. Objects in an arena must be created and
+    deleted by one thread at a time.
+    @see SgNode::DeleteTree() */
+class SgNodeArena
+{
+public:
+    /** Makes an arena the current arena of this thread while it exists. */
+    class Scope
+    {
+    public:
+        /** @param arena The arena, or null to allocate on the heap. */
+        explicit Scope(SgNodeArena* arena);
+
+        ~Scope();
+
+    private:
+        SgNodeArena* m_oldArena;
+
+        /** Not implemented. */
+        Scope(const Scope&);
+
+        /** Not implemented. */
+        Scope& operator=(const Scope&);
+    };
+
+    /** @param blockSize The size of the memory blocks. Larger objects get
+        their own block. */
+    explicit SgNodeArena(std::size_t blockSize = 256 * 1024);
+
+    /** Release the memory.
+        REQUIRES: NuObjects() == 0 */
+    ~SgNodeArena();
+
+    /** Release the memory of all blocks except the first, which is
+        reused.
+        REQUIRES: NuObjects() == 0 */
+    void Clear();
+
+    /** Number of objects allocated in this arena and not yet freed. */
+    std::size_t NuObjects() const;
+
+    /** Size of all memory blocks. */
+    std::size_t NuBytes() const;
+
+    /** The current arena of this thread, null if none. */
+    static SgNodeArena* Current();
+
+    /** Allocate memory in the current arena, or on the heap if there is
+        no current arena. */
+    static void* Allocate(std::size_t size);
+
+    /** Free memory allocated with Allocate(). */
+    static void Free(void* p);
+
+private:
+    const std::size_t m_blockSize;
+
+    /** Start and size of the memory blocks. */
+    std::vector<std::pair<char*,std::size_t> > m_blocks;
+
+    /** Free memory in the current block. */
+    char* m_next;
+
+    char* m_end;
+
+    std::size_t m_nuObjects;
+
+    std::size_t m_nuBytes;
+
+    /** Not implemented. */
+    SgNodeArena(const SgNodeArena&);
+
+    /** Not implemented. */
+    SgNodeArena& operator=(const SgNodeArena&);
+
+    void* AllocateInBlock(std::size_t size);
+
+    void FreeBlocks(std::size_t nuKeep);
+};
+
+inline std::size_t SgNodeArena::NuBytes() const
+{
+    return m_nuBytes;
+}
+
+inline std::size_t SgNodeArena::NuObjects() const
+{
+    return m_nuObjects;
+}
+
+//----------------------------------------------------------------------------
+
+#endif // SG_NODEARENA_H
@@ -6,6 +6,10 @@
 #include "SgPlatform.h"
 
 #include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
 
 #ifdef WIN32
 #include <windows.h>
@@ -15,6 +19,14 @@
 #ifdef HAVE_SYS_SYSCTL_H
 #include <sys/sysctl.h>
 #endif
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+#ifdef __APPLE__
+#include <mach/mach.h>
+#include <mach/thread_policy.h>
+#endif
 
 namespace fs = std::filesystem;
 
@@ -83,3 +95,163 @@ std::size_t SgPlatform::TotalMemory()
 
 //----------------------------------------------------------------------------
 
+namespace {
+
+/** All CPUs as a single node. */
+std::vector<std::vector<int> > AllCpus()
+{
+    std::vector<int> cpus;
+    unsigned int nuCpus = std::max(std::thread::hardware_concurrency(), 1u);
+    for (unsigned int i = 0; i < nuCpus; ++i)
+        cpus.push_back(static_cast<int>(i));
+    return std::vector<std::vector<int> >(1, cpus);
+}
+
+#ifdef __linux__
+
+/** The CPU affinity mask of the process at the first call. */
+const cpu_set_t& ProcessCpuSet()
+{
+    static const cpu_set_t s_cpuSet = []()
+    {
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        if (sched_getaffinity(0, sizeof(cpuSet), &cpuSet) != 0)
+            for (int i = 0; i < CPU_SETSIZE; ++i)
+                CPU_SET(i, &cpuSet);
+        return cpuSet;
+    }();
+    return s_cpuSet;
+}
+
+/** Parse a Linux CPU list like "0-3,8-11". */
+std::vector<int> ParseCpuList(const std::string& list)
+{
+    std::vector<int> cpus;
+    std::istringstream in(list);
+    std::string range;
+    while (std::getline(in, range, ','))
+    {
+        int first;
+        int last;
+        char separator;
+        std::istringstream rangeIn(range);
+        if (! (rangeIn >> first))
+            continue;
+        if (! (rangeIn >> separator >> last) || separator != '-')
+            last = first;
+        for (int cpu = first; cpu <= last && cpu < CPU_SETSIZE; ++cpu)
+            if (CPU_ISSET(cpu, &ProcessCpuSet()))
+                cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+std::vector<std::vector<int> > ReadNumaNodes()
+{
+    std::vector<std::vector<int> > nodes;
+    const fs::path nodeDir("/sys/devices/system/node");
+    std::error_code ec;
+    // Node numbers can have gaps, only the order matters
+    for (int node = 0; node < 1024; ++node)
+    {
+        fs::path dir = nodeDir / ("node" + std::to_string(node));
+        if (! fs::exists(dir, ec))
+            continue;
+        std::ifstream in((dir / "cpulist").string());
+        std::string list;
+        if (! std::getline(in, list))
+            continue;
+        std::vector<int> cpus = ParseCpuList(list);
+        if (! cpus.empty())
+            nodes.push_back(cpus);
+    }
+    if (nodes.empty())
+    {
+        std::vector<int> cpus;
+        for (int i = 0; i < CPU_SETSIZE; ++i)
+            if (CPU_ISSET(i, &ProcessCpuSet()))
+                cpus.push_back(i);
+        if (cpus.empty())
+            return AllCpus();
+        nodes.push_back(cpus);
+    }
+    return nodes;
+}
+
+#else
+
+std::vector<std::vector<int> > ReadNumaNodes()
+{
+    return AllCpus();
+}
+
+#endif
+
+} // namespace
+
+const std::vector<std::vector<int> >& SgPlatform::NumaNodes()
+{
+    static const std::vector<std::vector<int> > s_nodes = ReadNumaNodes();
+    return s_nodes;
+}
+
+bool SgPlatform::SetThreadAffinity(int cpu)
+{
+#if defined __linux__
+    cpu_set_t cpuSet;
+    if (cpu < 0)
+        cpuSet = ProcessCpuSet();
+    else
+    {
+        if (cpu >= CPU_SETSIZE)
+            return false;
+        CPU_ZERO(&cpuSet);
+        CPU_SET(cpu, &cpuSet);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet)
+           == 0;
+#elif defined WIN32
+    DWORD_PTR processMask;
+    DWORD_PTR systemMask;
+    if (! GetProcessAffinityMask(GetCurrentProcess(), &processMask,
+                                 &systemMask))
+        return false;
+    DWORD_PTR mask = processMask;
+    if (cpu >= 0)
+    {
+        if (cpu >= static_cast<int>(8 * sizeof(DWORD_PTR)))
+            return false;
+        mask = DWORD_PTR(1) << cpu;
+    }
+    return SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#elif defined __APPLE__
+    thread_affinity_policy_data_t policy;
+    policy.affinity_tag = (cpu < 0 ? THREAD_AFFINITY_TAG_NULL : cpu + 1);
+    mach_port_t thread = mach_thread_self();
+    kern_return_t result =
+        thread_policy_set(thread, THREAD_AFFINITY_POLICY,
+                          reinterpret_cast<thread_policy_t>(&policy),
+                          THREAD_AFFINITY_POLICY_COUNT);
+    mach_port_deallocate(mach_task_self(), thread);
+    return result == KERN_SUCCESS;
+#else
+    SG_UNUSED(cpu);
+    return false;
+#endif
+}
+
+bool SgPlatform::ThreadAffinitySupported()
+{
+#if defined __linux__ || defined WIN32
+    return true;
+#elif defined __APPLE__
+    // Setting the null affinity tag does not change the scheduling
+    static const bool s_isSupported = SetThreadAffinity(-1);
+    return s_isSupported;
+#else
+    return false;
+#endif
+}
+
+//----------------------------------------------------------------------------
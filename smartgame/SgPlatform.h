@@ -6,6 +6,7 @@
 
 #include <cstddef>
 #include <filesystem>
+#include <vector>
 
 //----------------------------------------------------------------------------
 
@@ -31,6 +32,28 @@ namespace SgPlatform
         determined. */
     size_t TotalMemory();
 
+    /** Get the CPUs usable by the process grouped by NUMA node.
+        On Linux, the nodes are read from /sys/devices/system/node and
+        restricted to the CPU affinity mask of the process at the first call.
+        On other systems, or if the information is not available, all CPUs
+        are returned as a single node. The result is never empty and contains
+        no empty nodes. */
+    const std::vector<std::vector<int> >& NumaNodes();
+
+    /** Bind the current thread to a CPU.
+        Supported on Linux and Windows. On Mac OS X, the CPU is only used as
+        an affinity tag (a scheduling hint), which is not supported on Apple
+        Silicon.
+        @param cpu The CPU as returned by NumaNodes(), or -1 to allow the
+        thread to run on all CPUs usable by the process again.
+        @return @c false if the affinity could not be set */
+    bool SetThreadAffinity(int cpu);
+
+    /** Check if SetThreadAffinity() is supported on this system.
+        True on Linux and Windows. On Mac OS X, the support for affinity tags
+        is probed at the first call, it is missing on Apple Silicon. */
+    bool ThreadAffinitySupported();
+
 }
 
 //----------------------------------------------------------------------------
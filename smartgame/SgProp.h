@@ -14,6 +14,7 @@
 #include <string>
 #include <vector>
 #include "SgBlackWhite.h"
+#include "SgNodeArena.h"
 #include "SgPoint.h"
 #include "SgVector.h"
 
@@ -262,6 +263,11 @@ public:
 
     virtual ~SgProp();
 
+    /** Allocate in the current SgNodeArena, if there is one. */
+    static void* operator new(std::size_t size);
+
+    static void operator delete(void* p);
+
     /** Override this function for each property class to return an exact
         duplicate of this property. */
     virtual SgProp* Duplicate() const = 0;
@@ -398,6 +404,16 @@ inline bool SgProp::Flag(SgPropFlags flags) const
     return (Flags() & flags) != 0;
 }
 
+inline void SgProp::operator delete(void* p)
+{
+    SgNodeArena::Free(p);
+}
+
+inline void* SgProp::operator new(std::size_t size)
+{
+    return SgNodeArena::Allocate(size);
+}
+
 //----------------------------------------------------------------------------
 
 /** Unknown property.
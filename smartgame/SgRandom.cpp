@@ -21,13 +21,17 @@ SgRandom::GlobalData::GlobalData()
 
 SgRandom::SgRandom() : m_floatGenerator(m_generator)
 {
+    GlobalData& data = GetGlobalData();
+    std::lock_guard<std::mutex> lock(data.m_mutex);
     SetSeed();
-    GetGlobalData().m_allGenerators.push_back(this);
+    data.m_allGenerators.push_back(this);
 }
 
 SgRandom::~SgRandom()
 {
-    GetGlobalData().m_allGenerators.remove(this);
+    GlobalData& data = GetGlobalData();
+    std::lock_guard<std::mutex> lock(data.m_mutex);
+    data.m_allGenerators.remove(this);
 }
 
 SgRandom& SgRandom::Global()
@@ -44,9 +48,13 @@ SgRandom::GlobalData& SgRandom::GetGlobalData()
 
 int SgRandom::Seed()
 {
-    return GetGlobalData().m_seed;
+    GlobalData& data = GetGlobalData();
+    std::lock_guard<std::mutex> lock(data.m_mutex);
+    return data.m_seed;
 }
 
+/** Seed the generator with the global seed.
+    The caller must hold the mutex of the global data. */
 void SgRandom::SetSeed()
 {
     boost::mt19937::result_type seed = GetGlobalData().m_seed;
@@ -57,21 +65,21 @@ void SgRandom::SetSeed()
 
 void SgRandom::SetSeed(int seed)
 {
+    GlobalData& data = GetGlobalData();
+    std::lock_guard<std::mutex> lock(data.m_mutex);
     if (seed < 0)
     {
-        GetGlobalData().m_seed = 0;
+        data.m_seed = 0;
         return;
     }
     if (seed == 0)
-        GetGlobalData().m_seed =
-            static_cast<boost::mt19937::result_type>(std::time(0));
+        data.m_seed = static_cast<boost::mt19937::result_type>(std::time(0));
     else
-        GetGlobalData().m_seed = seed;
-    SgDebug() << "SgRandom::SetSeed: " << GetGlobalData().m_seed << '\n';
-    for_each(GetGlobalData().m_allGenerators.begin(),
-             GetGlobalData().m_allGenerators.end(),
+        data.m_seed = seed;
+    SgDebug() << "SgRandom::SetSeed: " << data.m_seed << '\n';
+    for_each(data.m_allGenerators.begin(), data.m_allGenerators.end(),
              [](SgRandom* prnd) { prnd->SetSeed(); });
-    srand(GetGlobalData().m_seed);
+    srand(data.m_seed);
 }
 
 //----------------------------------------------------------------------------
@@ -8,6 +8,7 @@
 
 #include <algorithm>
 #include <list>
+#include <mutex>
 #include <boost/random/mersenne_twister.hpp>
 #include <boost/random/uniform_01.hpp>
 #include "SgArray.h"
@@ -20,9 +21,9 @@
     high quality ones. All random generators are internally registered to
     make it possible to change the random seed for all of them.
 
-    SgRandom is thread-safe (w.r.t. different instances) after construction
-    (the constructor is not thread-safe, because it uses a global variable
-    for registration). */
+    SgRandom is thread-safe w.r.t. different instances. Instances can be
+    constructed and destructed in different threads concurrently (the
+    registration in a global list is protected by a mutex). */
 class SgRandom
 {
 public:
@@ -42,7 +43,8 @@ public:
         non-deterministic random seed will be used (e.g. derived from the
         current time).
         Also calls std::srand()
-        @note This function is not thread-safe. */
+        @note This function reseeds the existing instances, it must not be
+        called while other threads use them. */
     static void SetSeed(int seed);
 
     /** Get random seed.
@@ -106,6 +108,9 @@ private:
 
         std::list<SgRandom*> m_allGenerators;
 
+        /** Protects m_seed and m_allGenerators. */
+        std::mutex m_mutex;
+
         GlobalData();
     };
 
@@ -11,7 +11,9 @@
 #include <limits>
 #include <sstream>
 #include <math.h>
+#include "SgConcurrentHashTable.h"
 #include "SgDebug.h"
+#include "SgException.h"
 #include "SgHashTable.h"
 #include "SgMath.h"
 #include "SgNode.h"
@@ -126,6 +128,7 @@ const int SgSearch::SG_INFINITY = numeric_limits<int>::max();
 
 SgSearch::SgSearch(SgSearchHashTable* hash)
     : m_hash(hash),
+      m_concurrentHash(0),
       m_tracer(0),
       m_currentDepth(0),
       m_useScout(false),
@@ -140,7 +143,10 @@ SgSearch::SgSearch(SgSearchHashTable* hash)
       m_timerLevel(0),
       m_control(0),
       m_probcut(0),
-      m_abortFrequency(1)
+      m_abortFrequency(1),
+      m_numberThreads(1),
+      m_stopFlag(false),
+      m_stop(&m_stopFlag)
 {
     InitSearch();
 }
@@ -159,6 +165,19 @@ void SgSearch::CallGenerate(SgVector<SgMove>* moves, int depth)
     }
 }
 
+void SgSearch::ClearHash()
+{
+    if (m_concurrentHash)
+        m_concurrentHash->Clear();
+    else if (m_hash)
+        m_hash->Clear();
+}
+
+std::unique_ptr<SgSearch> SgSearch::CreateThreadSearch() const
+{
+    return std::unique_ptr<SgSearch>();
+}
+
 void SgSearch::InitSearch(int startDepth)
 {
     m_currentDepth = startDepth;
@@ -175,7 +194,12 @@ void SgSearch::InitSearch(int startDepth)
 bool SgSearch::LookupHash(SgSearchHashData& data) const
 {
     SG_ASSERT(! data.IsValid());
-    if (m_hash == 0 || ! m_hash->Lookup(GetHashCode(), &data))
+    if (m_concurrentHash)
+    {
+        if (! m_concurrentHash->Lookup(GetHashCode(), &data))
+            return false;
+    }
+    else if (m_hash == 0 || ! m_hash->Lookup(GetHashCode(), &data))
         return false;
     if (DEBUG_SEARCH)
     {
@@ -203,7 +227,7 @@ void SgSearch::SetProbCut(SgProbCut* probcut)
 void SgSearch::StoreHash(int depth, int value, SgMove move,
                          bool isUpperBound, bool isLowerBound, bool isExact)
 {
-    SG_ASSERT(m_hash);
+    SG_ASSERT(HasHash());
     SgSearchHashData data(depth, value, move, isUpperBound, isLowerBound,
                           isExact);
     if (DEBUG_SEARCH)
@@ -212,7 +236,15 @@ void SgSearch::StoreHash(int depth, int value, SgMove move,
                   << ": ";
         WriteSgSearchHashData(SgDebug(), *this, data);
     }
-    m_hash->Store(GetHashCode(), data);
+    StoreHashData(data);
+}
+
+void SgSearch::StoreHashData(const SgSearchHashData& data)
+{
+    if (m_concurrentHash)
+        m_concurrentHash->Store(GetHashCode(), data);
+    else
+        m_hash->Store(GetHashCode(), data);
 }
 
 bool SgSearch::TraceIsOn() const
@@ -224,6 +256,12 @@ bool SgSearch::AbortSearch()
 {
     if (! m_aborted)
     {
+        if (m_stop->load(std::memory_order_relaxed))
+        {
+            // The main thread of a parallel search has finished
+            m_aborted = true;
+            return true;
+        }
         // Checking abort is potentially expensive, involves system call.
         // Only check every m_abortFrequency nodes
         if (m_stat.NumNodes() % m_abortFrequency != 0)
@@ -330,7 +368,7 @@ void SgSearch::CreateTracer()
 
 void SgSearch::AddSequenceToHash(const SgVector<SgMove>& sequence, int depth)
 {
-    if (! m_hash)
+    if (! HasHash())
         return;
     int numMovesToUndo = 0;
     for (SgVectorIterator<SgMove> iter(sequence); iter; ++iter)
@@ -345,7 +383,7 @@ void SgSearch::AddSequenceToHash(const SgVector<SgMove>& sequence, int depth)
             // Move is the only relevant data for seeding the hash table.
             SgSearchHashData data(0, 0, move);
             SG_ASSERT(move != SG_NULLMOVE);
-            m_hash->Store(GetHashCode(), data);
+            StoreHashData(data);
             if (DEBUG_SEARCH)
                 SgDebug() << "SgSearch::AddSequenceToHash: "
                           << MoveString(move) << '\n';
@@ -388,6 +426,8 @@ int SgSearch::DepthFirstSearch(int depthLimit, int boundLo, int boundHi,
                                SgNode* traceNode)
 {
     SG_ASSERT(sequence);
+    if (m_numberThreads > 1 && m_concurrentHash)
+        CreateThreadSearches();
     OnStartSearch();
     if (m_tracer && traceNode)
     {
@@ -396,14 +436,21 @@ int SgSearch::DepthFirstSearch(int depthLimit, int boundLo, int boundHi,
         m_tracer->InitTracing("DepthFirstSearch");
     }
     StartTime();
-    if (clearHash && m_hash)
+    if (clearHash && HasHash())
     {
-        m_hash->Clear();
+        ClearHash();
         AddSequenceToHash(*sequence, 0);
     }
     m_depthLimit = 0;
-    bool isExactValue = true;
-    int value = DFS(0, depthLimit, boundLo, boundHi, sequence, &isExactValue);
+    int value;
+    if (m_numberThreads > 1 && m_concurrentHash)
+        value = SearchParallel(depthLimit, depthLimit, boundLo, boundHi,
+                               sequence, false);
+    else
+    {
+        bool isExactValue = true;
+        value = DFS(0, depthLimit, boundLo, boundHi, sequence, &isExactValue);
+    }
     StopTime();
     if (m_tracer && traceNode)
         m_tracer->AppendTrace(traceNode);
@@ -415,6 +462,8 @@ int SgSearch::IteratedSearch(int depthMin, int depthMax, int boundLo,
                              bool clearHash, SgNode* traceNode)
 {
     SG_ASSERT(sequence);
+    if (m_numberThreads > 1 && m_concurrentHash)
+        CreateThreadSearches();
     OnStartSearch();
     if (m_tracer && traceNode)
     {
@@ -423,12 +472,32 @@ int SgSearch::IteratedSearch(int depthMin, int depthMax, int boundLo,
         m_tracer->InitTracing("IteratedSearch");
     }
     StartTime();
-    if (clearHash && m_hash)
+    if (clearHash && HasHash())
     {
-        m_hash->Clear();
+        ClearHash();
         AddSequenceToHash(*sequence, 0);
     }
 
+    int value;
+    if (m_numberThreads > 1 && m_concurrentHash)
+        value = SearchParallel(depthMin, depthMax, boundLo, boundHi,
+                               sequence, true);
+    else
+        value = IterateDepths(depthMin, depthMax, boundLo, boundHi,
+                              sequence);
+
+    StopTime();
+    if (m_tracer && traceNode)
+        m_tracer->AppendTrace(traceNode);
+    return value;
+}
+
+/** Run fixed-depth searches with increasing depth limits.
+    Used for IteratedSearch() and by the other threads of a parallel
+    search. Stops at the conditions described at IteratedSearch(). */
+int SgSearch::IterateDepths(int depthMin, int depthMax, int boundLo,
+                            int boundHi, SgVector<SgMove>* sequence)
+{
     int value = 0;
     m_depthLimit = depthMin;
     // done in DFS, but that's too late, is tested after StartOfDepth
@@ -493,10 +562,89 @@ int SgSearch::IteratedSearch(int depthMin, int depthMax, int boundLo,
             && ! m_aborted
             && (! CheckDepthLimitReached() || m_reachedDepthLimit)
             );
+    return value;
+}
 
-    StopTime();
-    if (m_tracer && traceNode)
-        m_tracer->AppendTrace(traceNode);
+/** Create the searches of the other threads of a parallel search.
+    Called before the search starts, because CreateThreadSearch() needs the
+    current position.
+    @throws SgException if CreateThreadSearch() returns null */
+void SgSearch::CreateThreadSearches()
+{
+    m_threadSearches.clear();
+    for (std::size_t i = 1; i < m_numberThreads; ++i)
+    {
+        std::unique_ptr<SgSearch> search = CreateThreadSearch();
+        if (! search)
+            throw SgException("SgSearch: CreateThreadSearch() is needed "
+                              "for more than one thread");
+        m_threadSearches.push_back(std::move(search));
+    }
+}
+
+/** Search with NumberThreads() threads (lazy SMP).
+    The searches of the other threads must have been created with
+    CreateThreadSearches(); they share the hash table of this search. This
+    search runs IterateDepths() if iterate is true, otherwise a fixed-depth
+    search to depthMax. The other threads run IterateDepths() from depthMin,
+    or from depth 1 for a fixed-depth search, to depthMax, where every second
+    thread starts one depth higher, until they are finished or this search
+    has finished. Adds the statistics of the other threads to the statistics
+    of this search. */
+int SgSearch::SearchParallel(int depthMin, int depthMax, int boundLo,
+                             int boundHi, SgVector<SgMove>* sequence,
+                             bool iterate)
+{
+    for (std::size_t i = 0; i < m_threadSearches.size(); ++i)
+    {
+        SgSearch& search = *m_threadSearches[i];
+        search.m_hash = m_hash;
+        search.m_concurrentHash = m_concurrentHash;
+        search.m_stop = &m_stopFlag;
+        // Only the main thread uses the search control
+        search.m_control = 0;
+        search.m_probcut = m_probcut;
+        search.m_useScout = m_useScout;
+        search.m_useKillers = m_useKillers;
+        search.m_useOpponentBest = m_useOpponentBest;
+        search.m_useNullMove = m_useNullMove;
+        search.m_nullMoveDepth = m_nullMoveDepth;
+        search.m_abortFrequency = m_abortFrequency;
+        search.m_numberThreads = 1;
+    }
+    int value = 0;
+    m_threadPool.SetNumberThreads(m_numberThreads);
+    m_threadPool.RunOnAll([&](std::size_t threadIndex)
+    {
+        if (threadIndex == 0)
+        {
+            if (iterate)
+                value = IterateDepths(depthMin, depthMax, boundLo, boundHi,
+                                      sequence);
+            else
+            {
+                bool isExactValue = true;
+                value = DFS(0, depthMax, boundLo, boundHi, sequence,
+                            &isExactValue);
+            }
+            m_stopFlag = true;
+            return;
+        }
+        SgSearch& search = *m_threadSearches[threadIndex - 1];
+        const int startDepth = (iterate ? depthMin : 1)
+                             + static_cast<int>(threadIndex % 2);
+        SgVector<SgMove> threadSequence;
+        search.OnStartSearch();
+        search.StartTime();
+        search.IterateDepths(min(startDepth, depthMax), depthMax, boundLo,
+                             boundHi, &threadSequence);
+        search.StopTime();
+    });
+    m_stopFlag = false;
+    const int depthReached = m_stat.DepthReached();
+    for (std::size_t i = 0; i < m_threadSearches.size(); ++i)
+        m_stat += m_threadSearches[i]->m_stat;
+    m_stat.SetDepthReached(depthReached);
     return value;
 }
 
@@ -844,7 +992,7 @@ int SgSearch::SearchEngine(int depth, int alpha, int beta,
                 || SgSearchValue::IsSolved(loValue)
                 || (hasMove && allExact);
         // || EndOfGame(); bug: cannot store exact score after two passes.
-        if (  m_hash
+        if (  HasHash()
            && ! m_aborted
            && (isSolved || stack.NonEmpty())
            )
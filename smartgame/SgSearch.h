@@ -9,15 +9,21 @@
 #ifndef SG_SEARCH_H
 #define SG_SEARCH_H
 
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
 #include "SgBlackWhite.h"
 #include "SgHash.h"
 #include "SgMove.h"
 #include "SgSearchStatistics.h"
 #include "SgSearchTracer.h"
 #include "SgStack.h"
+#include "SgThreadPool.h"
 #include "SgTimer.h"
 #include "SgVector.h"
 
+template <class DATA, int BLOCK_SIZE> class SgConcurrentHashTable;
 template <class DATA, int BLOCK_SIZE> class SgHashTable;
 class SgNode;
 class SgProbCut;
@@ -81,8 +87,6 @@ public:
                      bool isOnlyLowerBound = false,
                      bool isExactValue = false);
 
-    ~SgSearchHashData();
-
     int Depth() const;
 
     int Value() const;
@@ -121,8 +125,16 @@ private:
     SgMove m_bestMove;
 };
 
+/** Hash table used in class SgSearch. */
 typedef SgHashTable<SgSearchHashData, 4> SgSearchHashTable;
 
+/** Thread-safe hash table used in class SgSearch.
+    Can be shared by the threads of a parallel search (see
+    SgSearch::NumberThreads()), but is slower than SgSearchHashTable in a
+    single-threaded search. */
+typedef SgConcurrentHashTable<SgSearchHashData, 4>
+    SgSearchConcurrentHashTable;
+
 inline SgSearchHashData::SgSearchHashData()
     : m_depth(0),
       m_isUpperBound(false),
@@ -152,9 +164,6 @@ inline SgSearchHashData::SgSearchHashData(int depth, signed value,
     SG_ASSERT(m_value == value);
 }
 
-inline SgSearchHashData::~SgSearchHashData()
-{ }
-
 inline int SgSearchHashData::Depth() const
 {
     return static_cast<int> (m_depth);
@@ -268,8 +277,17 @@ public:
 
     const SgSearchHashTable* HashTable() const;
 
+    /** Set the hash table.
+        Resets the concurrent hash table. */
     void SetHashTable(SgSearchHashTable* hashtable);
 
+    const SgSearchConcurrentHashTable* ConcurrentHashTable() const;
+
+    /** Use a thread-safe hash table instead of the hash table.
+        Needed for a parallel search (see NumberThreads()). Resets the hash
+        table; pass 0 to use no hash table. */
+    void SetConcurrentHashTable(SgSearchConcurrentHashTable* hashtable);
+
     const SgSearchControl* SearchControl() const;
 
     /** Search control.
@@ -354,6 +372,32 @@ public:
 
     void SetNullMoveDepth(int depth);
 
+    /** Number of threads.
+        With more than one thread, DepthFirstSearch() and IteratedSearch()
+        use a lazy SMP search: the other threads run iterated searches of
+        the same position with the shared hash table, while the main thread
+        runs the normal search. Every second of the other threads starts one
+        depth higher, such that the threads tend to search different parts
+        of the tree. The other threads only help the main thread through the
+        hash table entries; the result is the result of the main thread.
+        The other threads stop when the main thread is finished. Only the
+        main thread uses the search control and the tracer. The statistics
+        are summed over all threads after the search.
+        Needs CreateThreadSearch() and a concurrent hash table (see
+        SetConcurrentHashTable()); without it, the search uses one thread.
+        Default is 1. */
+    std::size_t NumberThreads() const;
+
+    /** See NumberThreads() */
+    void SetNumberThreads(std::size_t numberThreads);
+
+    /** Create a search for an additional thread of a parallel search.
+        Needed for NumberThreads() greater than one. The new search must be
+        in the current position of this search and must not share state
+        with it; the hash table, the search control and the search flags
+        are set by the caller. The default implementation returns null. */
+    virtual std::unique_ptr<SgSearch> CreateThreadSearch() const;
+
     /** Get the current statistics. Can be called during search. */
     void GetStatistics(SgSearchStatistics* stat);
 
@@ -410,8 +454,9 @@ public:
     virtual SgBlackWhite GetToPlay() const = 0;
 
     /** Test whether search should be aborted.
-        Return true to abort search. Default implementation checks Abort() of
-        the installed search control. */
+        Return true to abort search. Default implementation checks whether
+        the main thread of a parallel search has finished and Abort() of the
+        installed search control. */
     virtual bool AbortSearch();
 
     /** Return the hash code for the current position. */
@@ -462,6 +507,9 @@ private:
     /** Hash table */
     SgSearchHashTable* m_hash;
 
+    /** Thread-safe hash table, used instead of m_hash if not null */
+    SgSearchConcurrentHashTable* m_concurrentHash;
+
     /** Used to build a trace tree of the search for debugging */
     SgSearchTracer* m_tracer;
 
@@ -518,11 +566,44 @@ private:
 
     int m_abortFrequency;
 
+    /** See NumberThreads() */
+    std::size_t m_numberThreads;
+
+    /** Threads of a parallel search, the main thread is this search. */
+    SgThreadPool m_threadPool;
+
+    /** Searches of the other threads of the last parallel search. */
+    std::vector<std::unique_ptr<SgSearch> > m_threadSearches;
+
+    /** Flag to stop the other threads of a parallel search, set when the
+        main thread is finished. */
+    std::atomic<bool> m_stopFlag;
+
+    /** The m_stopFlag of the search of the main thread. */
+    std::atomic<bool>* m_stop;
+
     /** Depth-first search (see implementation) */
     int DFS(int startDepth, int depthLimit, int boundLo, int boundHi,
             SgVector<SgMove>* sequence, bool* isExactValue);
 
-    /** Try to find current position in m_hash */
+    /** Iterated search loop of IteratedSearch() (see implementation) */
+    int IterateDepths(int depthMin, int depthMax, int boundLo, int boundHi,
+                      SgVector<SgMove>* sequence);
+
+    /** See implementation */
+    void CreateThreadSearches();
+
+    /** Search with NumberThreads() threads (see implementation) */
+    int SearchParallel(int depthMin, int depthMax, int boundLo, int boundHi,
+                       SgVector<SgMove>* sequence, bool iterate);
+
+    /** Clear the hash table in use */
+    void ClearHash();
+
+    /** Is a hash table in use? */
+    bool HasHash() const;
+
+    /** Try to find current position in the hash table in use */
     bool LookupHash(SgSearchHashData& data) const;
 
     bool NullMovePrune(int depth, int delta, int beta);
@@ -531,6 +612,9 @@ private:
     void StoreHash(int depth, int value, SgMove move, bool isUpperBound,
                    bool isLowerBound, bool isExact);
 
+    /** Store data for current position in the hash table in use */
+    void StoreHashData(const SgSearchHashData& data);
+
     /** Seed the hash table with the given sequence. */
     void AddSequenceToHash(const SgVector<SgMove>& sequence, int depth);
 
@@ -595,6 +679,25 @@ inline const SgSearchHashTable* SgSearch::HashTable() const
 inline void SgSearch::SetHashTable(SgSearchHashTable* hashtable)
 {
     m_hash = hashtable;
+    m_concurrentHash = 0;
+}
+
+inline const SgSearchConcurrentHashTable* SgSearch::ConcurrentHashTable()
+    const
+{
+    return m_concurrentHash;
+}
+
+inline void SgSearch::SetConcurrentHashTable(
+                                       SgSearchConcurrentHashTable* hashtable)
+{
+    m_concurrentHash = hashtable;
+    m_hash = 0;
+}
+
+inline bool SgSearch::HasHash() const
+{
+    return m_hash != 0 || m_concurrentHash != 0;
 }
 
 inline int SgSearch::IteratedSearchDepthLimit() const
@@ -626,6 +729,11 @@ inline const SgSearchControl* SgSearch::SearchControl() const
     return m_control;
 }
 
+inline std::size_t SgSearch::NumberThreads() const
+{
+    return m_numberThreads;
+}
+
 inline void SgSearch::SetAbortFrequency(int value)
 {
     m_abortFrequency = value;
@@ -651,6 +759,12 @@ inline void SgSearch::SetNullMoveDepth(int depth)
     m_nullMoveDepth = depth;
 }
 
+inline void SgSearch::SetNumberThreads(std::size_t numberThreads)
+{
+    SG_ASSERT(numberThreads >= 1);
+    m_numberThreads = numberThreads;
+}
+
 inline void SgSearch::SetOpponentBest(bool flag)
 {
     m_useOpponentBest = flag;
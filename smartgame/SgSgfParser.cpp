@@ -0,0 +1,212 @@
+//----------------------------------------------------------------------------
+/** @file SgSgfParser.cpp
+    See SgSgfParser.h */
+//----------------------------------------------------------------------------
+
+#include "SgSystem.h"
+#include "SgSgfParser.h"
+
+#include <charconv>
+#include <cstring>
+#include <string>
+
+using std::size_t;
+using std::string_view;
+
+//----------------------------------------------------------------------------
+
+namespace {
+
+bool GetIntValue(const std::vector<string_view>& values, int& value)
+{
+    if (values.empty())
+        return false;
+    string_view s = values[0];
+    while (! s.empty() && (s.front() == ' ' || s.front() == '\t'))
+        s.remove_prefix(1);
+    return std::from_chars(s.data(), s.data() + s.size(), value).ec
+        == std::errc();
+}
+
+inline bool IsLabelChar(char c)
+{
+    return ('A' <= c && c <= 'Z') || ('a' <= c && c <= 'z')
+        || ('0' <= c && c <= '9');
+}
+
+inline bool IsWhiteSpace(char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v'
+        || c == '\f';
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------
+
+SgSgfHandler::~SgSgfHandler()
+{ }
+
+void SgSgfHandler::EndGame()
+{ }
+
+void SgSgfHandler::EndVariation()
+{ }
+
+void SgSgfHandler::Move(SgBlackWhite color, SgPoint move)
+{
+    SG_UNUSED(color);
+    SG_UNUSED(move);
+}
+
+void SgSgfHandler::Property(string_view label,
+                            const std::vector<string_view>& values)
+{
+    SG_UNUSED(label);
+    SG_UNUSED(values);
+}
+
+void SgSgfHandler::StartGame()
+{ }
+
+void SgSgfHandler::StartNode()
+{ }
+
+void SgSgfHandler::StartVariation()
+{ }
+
+//----------------------------------------------------------------------------
+
+SgSgfParser::SgSgfParser(string_view data, int defaultSize)
+    : m_data(data),
+      m_pos(0),
+      m_defaultSize(defaultSize),
+      m_boardSize(defaultSize),
+      m_fmt(SG_PROPPOINTFMT_GO)
+{ }
+
+void SgSgfParser::EndNode(SgSgfHandler& handler)
+{
+    for (size_t i = 0; i < m_moves.size(); ++i)
+    {
+        // SgfStringToPoint() needs a string, which is short enough for the
+        // small string optimization
+        SgPoint p =
+            SgPropUtil::SgfStringToPoint(std::string(m_moves[i].second),
+                                         m_boardSize, m_fmt);
+        if (p != SG_NULLMOVE)
+            handler.Move(m_moves[i].first, p);
+    }
+    m_moves.clear();
+}
+
+bool SgSgfParser::ParseGame(SgSgfHandler& handler)
+{
+    const size_t size = m_data.size();
+    m_pos = m_data.find('(', m_pos);
+    if (m_pos == string_view::npos)
+    {
+        m_pos = size;
+        return false;
+    }
+    ++m_pos;
+    m_boardSize = m_defaultSize;
+    m_fmt = SG_PROPPOINTFMT_GO;
+    m_moves.clear();
+    handler.StartGame();
+    int depth = 1;
+    while (m_pos < size && depth > 0)
+    {
+        const char c = m_data[m_pos];
+        if ('A' <= c && c <= 'Z')
+        {
+            ParseProperty(handler);
+            continue;
+        }
+        ++m_pos;
+        if (c == ';')
+        {
+            EndNode(handler);
+            handler.StartNode();
+        }
+        else if (c == '(')
+        {
+            EndNode(handler);
+            ++depth;
+            handler.StartVariation();
+        }
+        else if (c == ')')
+        {
+            EndNode(handler);
+            if (--depth > 0)
+                handler.EndVariation();
+        }
+    }
+    EndNode(handler);
+    handler.EndGame();
+    return true;
+}
+
+size_t SgSgfParser::ParseGames(SgSgfHandler& handler)
+{
+    size_t nuGames = 0;
+    while (ParseGame(handler))
+        ++nuGames;
+    return nuGames;
+}
+
+void SgSgfParser::ParseProperty(SgSgfHandler& handler)
+{
+    const size_t size = m_data.size();
+    const size_t labelStart = m_pos;
+    while (m_pos < size && IsLabelChar(m_data[m_pos]))
+        ++m_pos;
+    const string_view label = m_data.substr(labelStart, m_pos - labelStart);
+    m_values.clear();
+    SkipWhiteSpace();
+    while (m_pos < size && m_data[m_pos] == '[')
+    {
+        const size_t valueStart = ++m_pos;
+        // Find the first unescaped ']'
+        while (true)
+        {
+            const void* end = memchr(m_data.data() + m_pos, ']', size - m_pos);
+            if (end == 0)
+            {
+                m_pos = size;
+                break;
+            }
+            m_pos = static_cast<const char*>(end) - m_data.data();
+            size_t nuBackslashes = 0;
+            while (  m_pos - nuBackslashes > valueStart
+                  && m_data[m_pos - nuBackslashes - 1] == '\\'
+                  )
+                ++nuBackslashes;
+            if (nuBackslashes % 2 == 0)
+                break;
+            ++m_pos;
+        }
+        m_values.push_back(m_data.substr(valueStart, m_pos - valueStart));
+        if (m_pos < size)
+            ++m_pos;
+        SkipWhiteSpace();
+    }
+    int value;
+    if (label == "SZ" && GetIntValue(m_values, value)
+        && value >= SG_MIN_SIZE && value <= SG_MAX_SIZE)
+        m_boardSize = value;
+    else if (label == "GM" && GetIntValue(m_values, value))
+        m_fmt = SgPropUtil::GetPointFmt(value);
+    else if ((label == "B" || label == "W") && ! m_values.empty())
+        m_moves.push_back(std::make_pair(label == "B" ? SG_BLACK : SG_WHITE,
+                                         m_values[0]));
+    handler.Property(label, m_values);
+}
+
+void SgSgfParser::SkipWhiteSpace()
+{
+    while (m_pos < m_data.size() && IsWhiteSpace(m_data[m_pos]))
+        ++m_pos;
+}
+
+//----------------------------------------------------------------------------
@@ -0,0 +1,111 @@
+//----------------------------------------------------------------------------
+/** @file SgSgfParser.h
+    Streaming parser for SGF data in memory. */
+//----------------------------------------------------------------------------
+
+#ifndef SG_SGFPARSER_H
+#define SG_SGFPARSER_H
+
+#include <cstddef>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "SgBlackWhite.h"
+#include "SgPoint.h"
+#include "SgProp.h"
+
+//----------------------------------------------------------------------------
+
+/** Receives the events of SgSgfParser.
+    The default implementations do nothing. The string views passed to the
+    functions point into the buffer of the parser and are only valid as long
+    as the buffer is. */
+class SgSgfHandler
+{
+public:
+    virtual ~SgSgfHandler();
+
+    /** Start of a game tree. */
+    virtual void StartGame();
+
+    /** End of a game tree. */
+    virtual void EndGame();
+
+    /** Start of a variation inside a game tree. */
+    virtual void StartVariation();
+
+    /** End of a variation inside a game tree. */
+    virtual void EndVariation();
+
+    /** Start of a node. */
+    virtual void StartNode();
+
+    /** A property of the current node.
+        @param label The property label
+        @param values The raw values without the brackets. Escape characters
+        and line breaks are not removed. */
+    virtual void Property(std::string_view label,
+                          const std::vector<std::string_view>& values);
+
+    /** A move of the current node.
+        Called for each B or W property with a valid point value, after all
+        Property() calls of the node, so that an SZ property anywhere in the
+        node is taken into account.
+        @param color The color of the move
+        @param move The point or SG_PASS */
+    virtual void Move(SgBlackWhite color, SgPoint move);
+};
+
+//----------------------------------------------------------------------------
+
+/** Streaming parser for SGF data in memory.
+    Unlike SgGameReader, it does not create SgNode trees or SgProp objects,
+    but calls the functions of a SgSgfHandler for each game tree, variation,
+    node and property, with string views into the buffer. It is meant for
+    processing large collections of games, e.g. from a file mapped with
+    SgMappedFile. Like SgGameReader, it ignores characters outside of
+    property values that are not part of the SGF syntax. */
+class SgSgfParser
+{
+public:
+    /** Create parser.
+        @param data The SGF data. Must stay valid while parsing.
+        @param defaultSize The (game-dependent) default board size, if a
+        game contains no SZ property. */
+    SgSgfParser(std::string_view data, int defaultSize = 19);
+
+    /** Parse the next game tree.
+        @return false if there is no next game tree */
+    bool ParseGame(SgSgfHandler& handler);
+
+    /** Parse all remaining game trees.
+        @return The number of game trees */
+    std::size_t ParseGames(SgSgfHandler& handler);
+
+private:
+    std::string_view m_data;
+
+    std::size_t m_pos;
+
+    const int m_defaultSize;
+
+    int m_boardSize;
+
+    SgPropPointFmt m_fmt;
+
+    /** Reused for the values of a property. */
+    std::vector<std::string_view> m_values;
+
+    /** Moves of the current node, reported at the end of the node. */
+    std::vector<std::pair<SgBlackWhite,std::string_view> > m_moves;
+
+    void EndNode(SgSgfHandler& handler);
+
+    void ParseProperty(SgSgfHandler& handler);
+
+    void SkipWhiteSpace();
+};
+
+//----------------------------------------------------------------------------
+
+#endif // SG_SGFPARSER_H
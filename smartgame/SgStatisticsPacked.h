@@ -0,0 +1,304 @@
+//----------------------------------------------------------------------------
+/** @file SgStatisticsPacked.h
+    Specialized version of SgStatisticsBase that keeps count and mean in a
+    single machine word. Unlike SgStatisticsVltBase, which writes mean and
+    count with two separate stores, all updates are done with a single
+    compare-and-swap on the packed word. Concurrent updates from several
+    threads are therefore never lost and readers never see a mean that does
+    not belong to the count. The price is reduced precision: count and mean
+    are stored as single precision floats. */
+//----------------------------------------------------------------------------
+
+#ifndef SG_STATISTICSPACKED_H
+#define SG_STATISTICSPACKED_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include "SgException.h"
+
+//----------------------------------------------------------------------------
+
+/** Lock-free statistics with count and mean packed into 64 bits.
+    The interface is the same as SgStatisticsVltBase. VALUE and COUNT are the
+    types used in the interface; internally both are stored as float.
+    @see SgStatisticsPacked.h SgStatisticsBase */
+template<typename VALUE, typename COUNT>
+class SgStatisticsPackedBase
+{
+public:
+    SgStatisticsPackedBase();
+
+    /** Create statistics initialized with values.
+        Note that value must be initialized to 0 if count is 0.
+        Equivalent to creating a statistics and calling @c count times
+        Add(val) */
+    SgStatisticsPackedBase(VALUE val, COUNT count);
+
+    SgStatisticsPackedBase(const SgStatisticsPackedBase& rhs);
+
+    SgStatisticsPackedBase& operator=(const SgStatisticsPackedBase& rhs);
+
+    void Add(VALUE val);
+
+    void Remove(VALUE val);
+
+    /** Add a value n times */
+    void Add(VALUE val, COUNT n);
+
+    /** Remove a value n times. */
+    void Remove(VALUE val, COUNT n);
+
+    void Clear();
+
+    COUNT Count() const;
+
+    /** Initialize with values.
+        Equivalent to calling Clear() and calling @c count times
+        Add(val) */
+    void Initialize(VALUE val, COUNT count);
+
+    /** Check if the mean value is defined.
+        See SgStatisticsVltBase::IsDefined() */
+    bool IsDefined() const;
+
+    VALUE Mean() const;
+
+    /** Read count and mean from the same snapshot.
+        Count() and Mean() each read the packed word separately, so with
+        concurrent writers two consecutive calls can return values from
+        different updates. */
+    void Get(VALUE& mean, COUNT& count) const;
+
+    /** Write in human readable format. */
+    void Write(std::ostream& out) const;
+
+    /** Save in a compact platform-independent text format.
+        The data is written in a single line, without trailing newline. */
+    void SaveAsText(std::ostream& out) const;
+
+    /** Load from text format.
+        See SaveAsText() */
+    void LoadFromText(std::istream& in);
+
+private:
+    /** Mean in the upper 32 bits, count in the lower 32 bits. */
+    std::atomic<std::uint64_t> m_data;
+
+    static std::uint64_t Pack(float mean, float count);
+
+    static void Unpack(std::uint64_t data, float& mean, float& count);
+
+    static bool IsDefined(float count);
+
+    /** Apply an update function to a consistent snapshot with a CAS loop.
+        @param f Function taking mean and count by reference. */
+    template<typename FUNCTION>
+    void Update(FUNCTION f);
+};
+
+template<typename VALUE, typename COUNT>
+inline SgStatisticsPackedBase<VALUE,COUNT>::SgStatisticsPackedBase()
+    : m_data(Pack(0, 0))
+{ }
+
+template<typename VALUE, typename COUNT>
+inline SgStatisticsPackedBase<VALUE,COUNT>::SgStatisticsPackedBase(VALUE val,
+                                                                  COUNT count)
+    : m_data(Pack(float(val), float(count)))
+{ }
+
+template<typename VALUE, typename COUNT>
+inline SgStatisticsPackedBase<VALUE,COUNT>::SgStatisticsPackedBase(
+                                            const SgStatisticsPackedBase& rhs)
+    : m_data(rhs.m_data.load())
+{ }
+
+template<typename VALUE, typename COUNT>
+inline SgStatisticsPackedBase<VALUE,COUNT>&
+SgStatisticsPackedBase<VALUE,COUNT>::operator=(
+                                            const SgStatisticsPackedBase& rhs)
+{
+    m_data.store(rhs.m_data.load());
+    return *this;
+}
+
+template<typename VALUE, typename COUNT>
+inline std::uint64_t SgStatisticsPackedBase<VALUE,COUNT>::Pack(float mean,
+                                                               float count)
+{
+    std::uint32_t m;
+    std::uint32_t c;
+    std::memcpy(&m, &mean, sizeof(m));
+    std::memcpy(&c, &count, sizeof(c));
+    return (std::uint64_t(m) << 32) | c;
+}
+
+template<typename VALUE, typename COUNT>
+inline void SgStatisticsPackedBase<VALUE,COUNT>::Unpack(std::uint64_t data,
+                                                        float& mean,
+                                                        float& count)
+{
+    std::uint32_t m = std::uint32_t(data >> 32);
+    std::uint32_t c = std::uint32_t(data);
+    std::memcpy(&mean, &m, sizeof(mean));
+    std::memcpy(&count, &c, sizeof(count));
+}
+
+template<typename VALUE, typename COUNT>
+inline bool SgStatisticsPackedBase<VALUE,COUNT>::IsDefined(float count)
+{
+    if (std::numeric_limits<COUNT>::is_exact)
+        return count > 0;
+    else
+        return count > std::numeric_limits<float>::epsilon();
+}
+
+template<typename VALUE, typename COUNT>
+template<typename FUNCTION>
+inline void SgStatisticsPackedBase<VALUE,COUNT>::Update(FUNCTION f)
+{
+    std::uint64_t oldData = m_data.load(std::memory_order_relaxed);
+    std::uint64_t newData;
+    do
+    {
+        float mean;
+        float count;
+        Unpack(oldData, mean, count);
+        f(mean, count);
+        newData = Pack(mean, count);
+    }
+    while (! m_data.compare_exchange_weak(oldData, newData,
+                                          std::memory_order_release,
+                                          std::memory_order_relaxed));
+}
+
+template<typename VALUE, typename COUNT>
+inline void SgStatisticsPackedBase<VALUE,COUNT>::Add(VALUE val)
+{
+    Add(val, COUNT(1));
+}
+
+template<typename VALUE, typename COUNT>
+void SgStatisticsPackedBase<VALUE,COUNT>::Add(VALUE val, COUNT n)
+{
+    const float v = float(val);
+    const float w = float(n);
+    Update([v, w](float& mean, float& count)
+    {
+        count += w;
+        mean += w * (v - mean) / count;
+    });
+}
+
+template<typename VALUE, typename COUNT>
+inline void SgStatisticsPackedBase<VALUE,COUNT>::Remove(VALUE val)
+{
+    Remove(val, COUNT(1));
+}
+
+template<typename VALUE, typename COUNT>
+void SgStatisticsPackedBase<VALUE,COUNT>::Remove(VALUE val, COUNT n)
+{
+    const float v = float(val);
+    const float w = float(n);
+    Update([v, w](float& mean, float& count)
+    {
+        if (count > w)
+        {
+            count -= w;
+            mean += w * (mean - v) / count;
+        }
+        else
+        {
+            count = 0;
+            mean = 0;
+        }
+    });
+}
+
+template<typename VALUE, typename COUNT>
+inline void SgStatisticsPackedBase<VALUE,COUNT>::Clear()
+{
+    m_data.store(Pack(0, 0));
+}
+
+template<typename VALUE, typename COUNT>
+inline COUNT SgStatisticsPackedBase<VALUE,COUNT>::Count() const
+{
+    float mean;
+    float count;
+    Unpack(m_data.load(std::memory_order_acquire), mean, count);
+    return COUNT(count);
+}
+
+template<typename VALUE, typename COUNT>
+inline void SgStatisticsPackedBase<VALUE,COUNT>::Get(VALUE& mean,
+                                                     COUNT& count) const
+{
+    float m;
+    float c;
+    Unpack(m_data.load(std::memory_order_acquire), m, c);
+    mean = VALUE(m);
+    count = COUNT(c);
+}
+
+template<typename VALUE, typename COUNT>
+inline void SgStatisticsPackedBase<VALUE,COUNT>::Initialize(VALUE val,
+                                                            COUNT count)
+{
+    SG_ASSERT(count > 0);
+    m_data.store(Pack(float(val), float(count)));
+}
+
+template<typename VALUE, typename COUNT>
+inline bool SgStatisticsPackedBase<VALUE,COUNT>::IsDefined() const
+{
+    float mean;
+    float count;
+    Unpack(m_data.load(std::memory_order_acquire), mean, count);
+    return IsDefined(count);
+}
+
+template<typename VALUE, typename COUNT>
+void SgStatisticsPackedBase<VALUE,COUNT>::LoadFromText(std::istream& in)
+{
+    float count;
+    float mean;
+    in >> count >> mean;
+    m_data.store(Pack(mean, count));
+}
+
+template<typename VALUE, typename COUNT>
+inline VALUE SgStatisticsPackedBase<VALUE,COUNT>::Mean() const
+{
+    SG_ASSERT(IsDefined());
+    float mean;
+    float count;
+    Unpack(m_data.load(std::memory_order_acquire), mean, count);
+    return VALUE(mean);
+}
+
+template<typename VALUE, typename COUNT>
+void SgStatisticsPackedBase<VALUE,COUNT>::Write(std::ostream& out) const
+{
+    if (IsDefined())
+        out << Mean();
+    else
+        out << '-';
+}
+
+template<typename VALUE, typename COUNT>
+void SgStatisticsPackedBase<VALUE,COUNT>::SaveAsText(std::ostream& out) const
+{
+    float mean;
+    float count;
+    Unpack(m_data.load(), mean, count);
+    out << count << ' ' << mean;
+}
+
+//----------------------------------------------------------------------------
+
+#endif // SG_STATISTICSPACKED_H
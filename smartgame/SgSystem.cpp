@@ -38,6 +38,9 @@ namespace {
 
 volatile bool s_userAbort = false;
 
+/** User abort flag of the current thread, 0 for s_userAbort. */
+thread_local volatile bool* t_userAbortFlag = 0;
+
 /** Assertion handlers.
     Stored in a static function variable to ensure, that they exist at
     first usage, if this function is called from global variables in
@@ -83,14 +86,42 @@ void SgHandleAssertion(const char* expr, const char* file, int line)
 
 //----------------------------------------------------------------------------
 
+void SgSetThreadUserAbortFlag(volatile bool* flag)
+{
+    t_userAbortFlag = flag;
+}
+
 void SgSetUserAbort(bool aborted)
 {
-    s_userAbort = aborted;
+    if (t_userAbortFlag != 0)
+        *t_userAbortFlag = aborted;
+    else
+        s_userAbort = aborted;
+}
+
+volatile bool* SgThreadUserAbortFlag()
+{
+    return t_userAbortFlag;
 }
 
 bool SgUserAbort()
 {
+    if (t_userAbortFlag != 0)
+        return *t_userAbortFlag;
     return s_userAbort;
 }
 
 //----------------------------------------------------------------------------
+
+SgUserAbortScope::SgUserAbortScope(volatile bool* flag)
+    : m_previousFlag(t_userAbortFlag)
+{
+    t_userAbortFlag = flag;
+}
+
+SgUserAbortScope::~SgUserAbortScope()
+{
+    t_userAbortFlag = m_previousFlag;
+}
+
+//----------------------------------------------------------------------------
@@ -145,13 +145,48 @@ const bool SG_HEAVYCHECK = false;
     Lengthy functions should poll the user abort flag with SgUserAbort and
     abort, if necessary; they should not reset the flag themselves.
     It can also be called from a different thread (the abort flag is
-    declared volatile). */
+    declared volatile), as long as neither thread uses its own flag (see
+    SgSetThreadUserAbortFlag()). */
 void SgSetUserAbort(bool aborted);
 
 /** Poll for user abort.
     @see SgSetUserAbort. */
 bool SgUserAbort();
 
+/** Use a different user abort flag in the current thread.
+    By default, SgSetUserAbort() and SgUserAbort() use a global flag in all
+    threads. Several engines in the same process (see FuegoEnginePool) give
+    each of their commands its own flag, so that aborting one command does
+    not abort the others. SgThreadPool passes the flag of the calling thread
+    on to its worker threads.
+    @param flag The flag or 0 for using the global flag again */
+void SgSetThreadUserAbortFlag(volatile bool* flag);
+
+/** The user abort flag of the current thread.
+    @return The flag set with SgSetThreadUserAbortFlag() or 0 if the thread
+    uses the global flag */
+volatile bool* SgThreadUserAbortFlag();
+
+/** Uses a user abort flag in the current thread during the lifetime of
+    this object and restores the previous flag afterwards.
+    @see SgSetThreadUserAbortFlag() */
+class SgUserAbortScope
+{
+public:
+    explicit SgUserAbortScope(volatile bool* flag);
+
+    ~SgUserAbortScope();
+
+private:
+    volatile bool* m_previousFlag;
+
+    /** Not implemented */
+    SgUserAbortScope(const SgUserAbortScope&);
+
+    /** Not implemented */
+    SgUserAbortScope& operator=(const SgUserAbortScope&);
+};
+
 //----------------------------------------------------------------------------
 
 inline void SgSynchronizeThreadMemory()
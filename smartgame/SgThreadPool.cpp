@@ -0,0 +1,152 @@
+//----------------------------------------------------------------------------
+/** @file SgThreadPool.cpp
+    See SgThreadPool.h */
+//----------------------------------------------------------------------------
+
+#include "SgSystem.h"
+#include "SgThreadPool.h"
+
+//----------------------------------------------------------------------------
+
+namespace {
+
+/** Pool of the current worker thread, 0 if not a worker thread. */
+thread_local const SgThreadPool* t_pool = 0;
+
+} // namespace
+
+//----------------------------------------------------------------------------
+
+SgThreadPool::SgThreadPool()
+    : m_epoch(0),
+      m_runGeneration(0),
+      m_nuRunning(0),
+      m_quit(false),
+      m_function(0),
+      m_userAbortFlag(0)
+{ }
+
+SgThreadPool::~SgThreadPool()
+{
+    StopWorkers();
+}
+
+void SgThreadPool::RunOnAll(const std::function<void(std::size_t)>& f)
+{
+    SG_ASSERT(t_pool != this);
+    SG_ASSERT(m_function == 0);
+    m_function = &f;
+    m_userAbortFlag = SgThreadUserAbortFlag();
+    m_nuRunning.store(m_workers.size(), std::memory_order_relaxed);
+    m_runGeneration.fetch_add(1, std::memory_order_release);
+    WakeUp();
+    std::exception_ptr exception;
+    try
+    {
+        f(0);
+    }
+    catch (...)
+    {
+        // The workers still use f, wait for them before passing it on
+        exception = std::current_exception();
+    }
+    while (true)
+    {
+        std::size_t nuRunning = m_nuRunning.load(std::memory_order_acquire);
+        if (nuRunning == 0)
+            break;
+        m_nuRunning.wait(nuRunning, std::memory_order_acquire);
+    }
+    m_function = 0;
+    m_userAbortFlag = 0;
+    for (std::unique_ptr<Worker>& worker : m_workers)
+    {
+        if (! exception)
+            exception = worker->m_exception;
+        worker->m_exception = std::exception_ptr();
+    }
+    if (exception)
+        std::rethrow_exception(exception);
+}
+
+void SgThreadPool::SetNumberThreads(std::size_t n)
+{
+    SG_ASSERT(n >= 1);
+    SG_ASSERT(m_function == 0);
+    if (n == NuThreads())
+        return;
+    StopWorkers();
+    const std::uint64_t runGeneration = m_runGeneration.load();
+    for (std::size_t i = 0; i + 1 < n; ++i)
+        m_workers.emplace_back(new Worker());
+    // Start the threads only after all workers are in the vector, because
+    // WorkerLoop() accesses the vector
+    for (std::size_t i = 0; i + 1 < n; ++i)
+        m_workers[i]->m_thread = std::thread(&SgThreadPool::WorkerLoop, this,
+                                             i, runGeneration);
+}
+
+void SgThreadPool::StopWorkers()
+{
+    if (m_workers.empty())
+        return;
+    m_quit.store(true, std::memory_order_release);
+    WakeUp();
+    for (std::unique_ptr<Worker>& worker : m_workers)
+        worker->m_thread.join();
+    m_workers.clear();
+    m_quit.store(false, std::memory_order_release);
+}
+
+void SgThreadPool::WakeUp()
+{
+    m_epoch.fetch_add(1, std::memory_order_release);
+    m_epoch.notify_all();
+}
+
+/** Main loop of a worker thread.
+    The epoch is read before checking for work and the thread only sleeps,
+    if the epoch is still the same, so a WakeUp() after the check cannot be
+    lost.
+    @param workerIndex The index in m_workers
+    @param runGeneration The value of m_runGeneration when the thread was
+    started */
+void SgThreadPool::WorkerLoop(std::size_t workerIndex,
+                              std::uint64_t runGeneration)
+{
+    t_pool = this;
+    Worker& worker = *m_workers[workerIndex];
+    while (true)
+    {
+        const std::uint64_t epoch = m_epoch.load(std::memory_order_acquire);
+        if (m_quit.load(std::memory_order_acquire))
+            break;
+        if (m_runGeneration.load(std::memory_order_acquire) != runGeneration)
+        {
+            ++runGeneration;
+            try
+            {
+                SgUserAbortScope scope(m_userAbortFlag);
+                (*m_function)(workerIndex + 1);
+            }
+            catch (...)
+            {
+                // Passed on to the caller of RunOnAll()
+                worker.m_exception = std::current_exception();
+            }
+            if (m_nuRunning.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                m_nuRunning.notify_all();
+            continue;
+        }
+        for (int i = 0; i < SPIN_COUNT; ++i)
+        {
+            if (m_epoch.load(std::memory_order_acquire) != epoch)
+                break;
+            std::this_thread::yield();
+        }
+        m_epoch.wait(epoch, std::memory_order_acquire);
+    }
+    t_pool = 0;
+}
+
+//----------------------------------------------------------------------------
@@ -0,0 +1,113 @@
+//----------------------------------------------------------------------------
+/** @file SgThreadPool.h
+    Persistent pool of worker threads. */
+//----------------------------------------------------------------------------
+
+#ifndef SG_THREADPOOL_H
+#define SG_THREADPOOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+//----------------------------------------------------------------------------
+
+/** Pool of persistent worker threads.
+    RunOnAll() runs a function concurrently on all threads of the pool and
+    waits until all have returned. This is used for the search loops of
+    SgUctSearch, SgSearch and SgDfpnSearch, which need to run concurrently
+    (they synchronize with each other). The threads are kept between the
+    calls, so that a search does not pay for creating and joining threads.
+
+    The calling thread counts as thread 0 of the pool and runs its share of
+    the work in RunOnAll() itself, so a pool with one thread has no worker
+    threads and causes no context switches. Idle workers spin briefly before
+    going to sleep, so that consecutive short jobs (e.g. a series of searches
+    with a small time limit) do not pay the full wake-up latency.
+
+    The functions of RunOnAll() use the user abort flag of the thread that
+    called RunOnAll() (see SgSetThreadUserAbortFlag()).
+    @ingroup sguctgroup */
+class SgThreadPool
+{
+public:
+    /** Construct a pool containing only the calling thread. */
+    SgThreadPool();
+
+    ~SgThreadPool();
+
+    /** Number of threads including the calling thread. */
+    std::size_t NuThreads() const;
+
+    /** Change the number of threads.
+        Stops and joins all worker threads and starts n - 1 new ones, if the
+        number of threads differs from NuThreads(). Must not be called while
+        RunOnAll() is running. */
+    void SetNumberThreads(std::size_t n);
+
+    /** Run a function on all threads of the pool.
+        Calls f(i) for i = 0..NuThreads()-1, f(0) in the calling thread and
+        the others in the worker threads, and returns after all calls have
+        returned. If calls throw an exception, the exception of the call
+        with the lowest index is rethrown. Must not be called recursively or
+        from a worker thread. */
+    void RunOnAll(const std::function<void(std::size_t)>& f);
+
+private:
+    struct Worker
+    {
+        std::thread m_thread;
+
+        /** Exception thrown by the function of the current RunOnAll(). */
+        std::exception_ptr m_exception;
+    };
+
+    /** Number of spin iterations of an idle worker before it sleeps. */
+    static const int SPIN_COUNT = 2000;
+
+    std::vector<std::unique_ptr<Worker> > m_workers;
+
+    /** Incremented whenever workers need to check for new work. */
+    std::atomic<std::uint64_t> m_epoch;
+
+    /** Incremented at each RunOnAll(). */
+    std::atomic<std::uint64_t> m_runGeneration;
+
+    /** Number of worker threads still running the function of RunOnAll(). */
+    std::atomic<std::size_t> m_nuRunning;
+
+    std::atomic<bool> m_quit;
+
+    /** The function of the current RunOnAll(). */
+    const std::function<void(std::size_t)>* m_function;
+
+    /** The user abort flag of the caller of the current RunOnAll().
+        @see SgSetThreadUserAbortFlag() */
+    volatile bool* m_userAbortFlag;
+
+    void StopWorkers();
+
+    void WakeUp();
+
+    void WorkerLoop(std::size_t workerIndex, std::uint64_t runGeneration);
+
+    /** Not implemented. */
+    SgThreadPool(const SgThreadPool&);
+
+    /** Not implemented. */
+    SgThreadPool& operator=(const SgThreadPool&);
+};
+
+inline std::size_t SgThreadPool::NuThreads() const
+{
+    return m_workers.size() + 1;
+}
+
+//----------------------------------------------------------------------------
+
+#endif // SG_THREADPOOL_H
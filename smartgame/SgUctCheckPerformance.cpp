@@ -0,0 +1,320 @@
+//----------------------------------------------------------------------------
+/** @file SgUctCheckPerformance.cpp
+    See SgUctCheckPerformance.h */
+//----------------------------------------------------------------------------
+
+#include "SgSystem.h"
+#include "SgUctCheckPerformance.h"
+
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "SgDebug.h"
+#include "SgRandom.h"
+#include "SgTimer.h"
+#include "SgUctSearch.h"
+#include "SgWrite.h"
+
+using std::fixed;
+using std::setprecision;
+
+//----------------------------------------------------------------------------
+
+namespace {
+
+/** Number of legal moves in each position of the artificial game. */
+const int NU_MOVES = 64;
+
+/** Length of each game of the artificial game. */
+const std::size_t GAME_LENGTH = 60;
+
+/** Thread state for the artificial game.
+    The position is only represented by the move sequence, the game result
+    is a pseudo-random function of the sequence. */
+class CheckThreadState
+    : public SgUctThreadState
+{
+public:
+    CheckThreadState(unsigned int threadId);
+
+    SgUctValue Evaluate();
+
+    void Execute(SgMove move);
+
+    void ExecutePlayout(SgMove move);
+
+    bool GenerateAllMoves(SgUctValue count, std::vector<SgUctMoveInfo>& moves,
+                          SgUctProvenType& provenType);
+
+    SgMove GeneratePlayoutMove(bool& skipRaveUpdate);
+
+    void StartSearch();
+
+    void TakeBackInTree(std::size_t nuMoves);
+
+    void TakeBackPlayout(std::size_t nuMoves);
+
+private:
+    std::vector<SgMove> m_sequence;
+
+    std::vector<unsigned int> m_hash;
+
+    SgRandom m_random;
+};
+
+CheckThreadState::CheckThreadState(unsigned int threadId)
+    : SgUctThreadState(threadId, NU_MOVES)
+{
+    m_hash.push_back(threadId);
+}
+
+SgUctValue CheckThreadState::Evaluate()
+{
+    return (m_hash.back() >> 7) % 3 == 0 ? 1 : 0;
+}
+
+void CheckThreadState::Execute(SgMove move)
+{
+    m_sequence.push_back(move);
+    m_hash.push_back(m_hash.back() * 1000003u ^ (unsigned int)(move + 1));
+}
+
+void CheckThreadState::ExecutePlayout(SgMove move)
+{
+    Execute(move);
+}
+
+bool CheckThreadState::GenerateAllMoves(SgUctValue count,
+                                        std::vector<SgUctMoveInfo>& moves,
+                                        SgUctProvenType& provenType)
+{
+    SG_UNUSED(count);
+    SG_UNUSED(provenType);
+    if (m_sequence.size() >= GAME_LENGTH)
+        return false;
+    for (SgMove move = 0; move < NU_MOVES; ++move)
+        moves.push_back(SgUctMoveInfo(move));
+    return false;
+}
+
+SgMove CheckThreadState::GeneratePlayoutMove(bool& skipRaveUpdate)
+{
+    SG_UNUSED(skipRaveUpdate);
+    if (m_sequence.size() >= GAME_LENGTH)
+        return SG_NULLMOVE;
+    return m_random.SmallInt(NU_MOVES);
+}
+
+void CheckThreadState::StartSearch()
+{
+    m_sequence.clear();
+    m_hash.resize(1);
+}
+
+void CheckThreadState::TakeBackInTree(std::size_t nuMoves)
+{
+    m_sequence.resize(m_sequence.size() - nuMoves);
+    m_hash.resize(m_hash.size() - nuMoves);
+}
+
+void CheckThreadState::TakeBackPlayout(std::size_t nuMoves)
+{
+    TakeBackInTree(nuMoves);
+}
+
+class CheckThreadStateFactory
+    : public SgUctThreadStateFactory
+{
+public:
+    std::unique_ptr<SgUctThreadState> Create(unsigned int threadId,
+                                             const SgUctSearch& search);
+};
+
+std::unique_ptr<SgUctThreadState>
+CheckThreadStateFactory::Create(unsigned int threadId,
+                                const SgUctSearch& search)
+{
+    SG_UNUSED(search);
+    return std::make_unique<CheckThreadState>(threadId);
+}
+
+class CheckSearch
+    : public SgUctSearch
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    CheckSearch();
+
+    std::string MoveString(SgMove move) const;
+
+    SgUctValue UnknownEval() const;
+
+    /** Time when the first game of the last search was finished. */
+    Clock::time_point FirstGameTime() const;
+
+    void OnSearchIteration(SgUctValue gameNumber, unsigned int threadId,
+                           const SgUctGameInfo& info);
+
+    void OnStartSearch();
+
+private:
+    std::atomic<bool> m_isFirstGame;
+
+    Clock::time_point m_firstGameTime;
+};
+
+CheckSearch::CheckSearch()
+    : SgUctSearch(new CheckThreadStateFactory(), NU_MOVES),
+      m_isFirstGame(true)
+{ }
+
+CheckSearch::Clock::time_point CheckSearch::FirstGameTime() const
+{
+    return m_firstGameTime;
+}
+
+void CheckSearch::OnSearchIteration(SgUctValue gameNumber,
+                                    unsigned int threadId,
+                                    const SgUctGameInfo& info)
+{
+    SgUctSearch::OnSearchIteration(gameNumber, threadId, info);
+    if (m_isFirstGame.exchange(false))
+        m_firstGameTime = Clock::now();
+}
+
+void CheckSearch::OnStartSearch()
+{
+    SgUctSearch::OnStartSearch();
+    m_isFirstGame = true;
+}
+
+std::string CheckSearch::MoveString(SgMove move) const
+{
+    std::ostringstream buffer;
+    buffer << move;
+    return buffer.str();
+}
+
+SgUctValue CheckSearch::UnknownEval() const
+{
+    return 0.5;
+}
+
+/** Let all threads add results to the children of the root concurrently.
+    @return The number of updates that were lost. */
+SgUctValue LostUpdates(std::size_t nuThreads)
+{
+    const int NU_CHILDREN = 4;
+    const int NU_UPDATES = 200000;
+    SgUctTree tree;
+    tree.CreateAllocators(1);
+    tree.SetMaxNodes(NU_CHILDREN);
+    std::vector<SgUctMoveInfo> moves;
+    for (SgMove move = 0; move < NU_CHILDREN; ++move)
+        moves.push_back(SgUctMoveInfo(move));
+    tree.CreateChildren(0, tree.Root(), moves);
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < nuThreads; ++i)
+        threads.emplace_back([&tree, i]()
+        {
+            const SgUctNode& root = tree.Root();
+            for (int j = 0; j < NU_UPDATES; ++j)
+            {
+                SgUctChildIterator it(tree, root);
+                for (int k = (int(i) + j) % NU_CHILDREN; k > 0; --k)
+                    ++it;
+                tree.AddGameResult(*it, &root, SgUctValue(j % 2));
+                tree.AddRaveValue(*it, SgUctValue(j % 2), 1);
+            }
+        });
+    for (std::size_t i = 0; i < nuThreads; ++i)
+        threads[i].join();
+    SgUctValue count = 0;
+    for (SgUctChildIterator it(tree, tree.Root()); it; ++it)
+        count += (*it).MoveCount();
+    return SgUctValue(nuThreads) * NU_UPDATES - count;
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------
+
+void SgUctCheckPerformance::CheckNodePerformance(std::ostream& out,
+                                                 std::size_t nuThreads,
+                                                 double maxTime)
+{
+    const std::size_t GB = 1024 * 1024 * 1024;
+    const std::size_t MAX_NODES = 2000000;
+    out << SgWriteLabel("Layout")
+        << (SG_UCT_COMPACT_NODE ? "compact" : "default") << '\n'
+        << SgWriteLabel("NodeSize") << sizeof(SgUctNode) << '\n'
+        << SgWriteLabel("NodesPerLine") << fixed << setprecision(2)
+        << 64.0 / double(sizeof(SgUctNode)) << '\n'
+        << SgWriteLabel("NodesPerGB") << GB / sizeof(SgUctNode) << '\n';
+
+    CheckSearch search;
+    search.SetNumberThreads(nuThreads);
+    search.SetMaxNodes(MAX_NODES);
+    search.SetLockFree(true);
+    search.SetRave(true);
+    search.SetVirtualLoss(nuThreads > 1);
+    search.SetPruneFullTree(false);
+    std::vector<SgMove> sequence;
+    search.Search(std::numeric_limits<SgUctValue>::max(), maxTime, sequence);
+    const SgUctSearchStat& stat = search.Statistics();
+    out << SgWriteLabel("Threads") << nuThreads << '\n'
+        << SgWriteLabel("Games") << fixed << setprecision(0)
+        << search.GamesPlayed() << '\n'
+        << SgWriteLabel("Games/s") << fixed << setprecision(1)
+        << stat.m_gamesPerSecond << '\n'
+        << SgWriteLabel("Nodes") << search.Tree().NuNodes() << '\n'
+        << SgWriteLabel("LostUpdates") << fixed << setprecision(0)
+        << LostUpdates(nuThreads) << '\n';
+}
+
+void SgUctCheckPerformance::CheckStartLatency(std::ostream& out,
+                                              std::size_t maxThreads)
+{
+    typedef CheckSearch::Clock Clock;
+    const int NU_SEARCHES = 200;
+    CheckSearch search;
+    search.SetMaxNodes(100000);
+    search.SetLockFree(true);
+    search.SetRave(true);
+    out << "Threads FirstGame[us] Search[us]\n";
+    for (std::size_t nuThreads = 1; nuThreads <= maxThreads; nuThreads *= 2)
+    {
+        search.SetNumberThreads(nuThreads);
+        search.SetVirtualLoss(nuThreads > 1);
+        search.CreateThreads();
+        double firstGameTime = 0;
+        double searchTime = 0;
+        std::vector<SgMove> sequence;
+        {
+            // Don't write the reason for terminating each search
+            SgDebugToString debugToString(false);
+            for (int i = 0; i < NU_SEARCHES; ++i)
+            {
+                Clock::time_point start = Clock::now();
+                search.Search(SgUctValue(nuThreads),
+                              std::numeric_limits<double>::max(), sequence);
+                Clock::time_point end = Clock::now();
+                firstGameTime += std::chrono::duration<double, std::micro>(
+                                       search.FirstGameTime() - start).count();
+                searchTime += std::chrono::duration<double, std::micro>(
+                                                        end - start).count();
+            }
+        }
+        out << std::setw(7) << nuThreads << ' '
+            << std::setw(14) << fixed << setprecision(1)
+            << firstGameTime / NU_SEARCHES << ' '
+            << std::setw(10) << searchTime / NU_SEARCHES << '\n';
+    }
+}
+
+//----------------------------------------------------------------------------
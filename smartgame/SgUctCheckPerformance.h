@@ -0,0 +1,55 @@
+//----------------------------------------------------------------------------
+/** @file SgUctCheckPerformance.h
+    Check performance of SgUctTree and SgUctSearch independent of a game.
+
+    The checks use an artificial game with a fixed number of moves per
+    position and a fixed game length, so that the measured times are
+    dominated by the tree operations (selection, expansion, backup, RAVE
+    updates) and not by the game logic. Run them in a build with and without
+    SG_UCT_COMPACT_NODE to compare the two node layouts. */
+//----------------------------------------------------------------------------
+
+#ifndef SG_UCTCHECKPERFORMANCE_H
+#define SG_UCTCHECKPERFORMANCE_H
+
+#include <cstddef>
+#include <iosfwd>
+
+//----------------------------------------------------------------------------
+
+namespace SgUctCheckPerformance
+{
+
+/** Performance check of the SgUctNode layout.
+    Writes the node size, the number of nodes per cache line and per GB, the
+    games per second of a lock-free SgUctSearch with RAVE on the artificial
+    game, and the number of updates lost when all threads concurrently add
+    game results to the same nodes.
+
+    @verbatim
+    Layout          default  compact
+    NodeSize        80       48
+    NodesPerGB      13421772 22369621
+    @endverbatim
+
+    @param out The stream to write the results to
+    @param nuThreads The number of search threads
+    @param maxTime The time for the search part of the check in seconds */
+void CheckNodePerformance(std::ostream& out, std::size_t nuThreads,
+                          double maxTime);
+
+/** Performance check of starting a search.
+    Runs many very short searches on the artificial game with 1, 2, 4, ...
+    up to maxThreads threads and writes the average time from calling
+    SgUctSearch::Search() until the first game was played and the average
+    time for the whole search, both in microseconds. This is dominated by
+    waking up and synchronizing the search threads.
+    @param out The stream to write the results to
+    @param maxThreads The maximum number of search threads */
+void CheckStartLatency(std::ostream& out, std::size_t maxThreads);
+
+} // namespace SgUctCheckPerformance
+
+//----------------------------------------------------------------------------
+
+#endif // SG_UCTCHECKPERFORMANCE_H
@@ -0,0 +1,154 @@
+//----------------------------------------------------------------------------
+/** @file SgUctPhaseStatistics.cpp
+    See SgUctPhaseStatistics.h */
+//----------------------------------------------------------------------------
+
+#include "SgSystem.h"
+#include "SgUctPhaseStatistics.h"
+
+#include <algorithm>
+#include <bit>
+#include <iomanip>
+#include <iostream>
+#include <boost/io/ios_state.hpp>
+
+using boost::io::ios_all_saver;
+
+//----------------------------------------------------------------------------
+
+const char* SgUctPhaseName(SgUctPhase phase)
+{
+    switch (phase)
+    {
+    case SG_UCTPHASE_INTREE:
+        return "intree";
+    case SG_UCTPHASE_EXPAND:
+        return "expand";
+    case SG_UCTPHASE_PLAYOUT:
+        return "playout";
+    case SG_UCTPHASE_BACKUP:
+        return "backup";
+    default:
+        SG_ASSERT(false);
+        return "?";
+    }
+}
+
+//----------------------------------------------------------------------------
+
+const int SgUctPhaseHistogram::NU_BINS;
+
+SgUctPhaseHistogram::SgUctPhaseHistogram()
+{
+    Clear();
+}
+
+void SgUctPhaseHistogram::Add(std::chrono::nanoseconds duration)
+{
+    std::uint64_t ns =
+        static_cast<std::uint64_t>(std::max(duration.count(),
+                                            std::chrono::nanoseconds::rep(0)));
+    int bin = std::min(static_cast<int>(std::bit_width(ns)), NU_BINS - 1);
+    Increment(m_bins[bin], 1);
+    Increment(m_count, 1);
+    Increment(m_total, ns);
+}
+
+void SgUctPhaseHistogram::Clear()
+{
+    m_count.store(0, std::memory_order_relaxed);
+    m_total.store(0, std::memory_order_relaxed);
+    for (int i = 0; i < NU_BINS; ++i)
+        m_bins[i].store(0, std::memory_order_relaxed);
+}
+
+double SgUctPhaseHistogram::Mean() const
+{
+    std::uint64_t count = Count();
+    if (count == 0)
+        return 0;
+    return double(Total()) / double(count);
+}
+
+void SgUctPhaseHistogram::Merge(const SgUctPhaseHistogram& histogram)
+{
+    for (int i = 0; i < NU_BINS; ++i)
+        Increment(m_bins[i], histogram.BinCount(i));
+    Increment(m_count, histogram.Count());
+    Increment(m_total, histogram.Total());
+}
+
+std::uint64_t SgUctPhaseHistogram::Percentile(double p) const
+{
+    SG_ASSERT(p >= 0 && p <= 1);
+    std::uint64_t count = 0;
+    for (int i = 0; i < NU_BINS; ++i)
+        count += BinCount(i);
+    if (count == 0)
+        return 0;
+    const double threshold = p * double(count);
+    std::uint64_t sum = 0;
+    for (int i = 0; i < NU_BINS; ++i)
+    {
+        sum += BinCount(i);
+        if (sum > 0 && double(sum) >= threshold)
+            return std::uint64_t(1) << i;
+    }
+    return std::uint64_t(1) << (NU_BINS - 1);
+}
+
+//----------------------------------------------------------------------------
+
+void SgUctPhaseStatistics::Clear()
+{
+    for (int i = 0; i < SG_UCTPHASE_NU; ++i)
+        m_histograms[i].Clear();
+}
+
+void SgUctPhaseStatistics::Merge(const SgUctPhaseStatistics& statistics)
+{
+    for (int i = 0; i < SG_UCTPHASE_NU; ++i)
+        m_histograms[i].Merge(statistics.m_histograms[i]);
+}
+
+void SgUctPhaseStatistics::Write(std::ostream& out) const
+{
+    ios_all_saver saver(out);
+    std::uint64_t total = 0;
+    for (int i = 0; i < SG_UCTPHASE_NU; ++i)
+        total += m_histograms[i].Total();
+    out << "Phase       Count   Mean[us]    P50[us]    P90[us]    P99[us]"
+           " Time[%]\n"
+        << std::fixed << std::setprecision(1);
+    for (int i = 0; i < SG_UCTPHASE_NU; ++i)
+    {
+        const SgUctPhaseHistogram& histogram = m_histograms[i];
+        out << std::left << std::setw(7)
+            << SgUctPhaseName(static_cast<SgUctPhase>(i)) << std::right
+            << ' ' << std::setw(9) << histogram.Count()
+            << ' ' << std::setw(10) << histogram.Mean() / 1000
+            << ' ' << std::setw(10) << double(histogram.Percentile(0.5)) / 1000
+            << ' ' << std::setw(10) << double(histogram.Percentile(0.9)) / 1000
+            << ' ' << std::setw(10)
+            << double(histogram.Percentile(0.99)) / 1000
+            << ' ' << std::setw(7)
+            << (total == 0 ? 0 : 100 * double(histogram.Total()) / total)
+            << '\n';
+    }
+}
+
+void SgUctPhaseStatistics::WriteRaw(std::ostream& out,
+                                    const std::string& label) const
+{
+    for (int i = 0; i < SG_UCTPHASE_NU; ++i)
+    {
+        const SgUctPhaseHistogram& histogram = m_histograms[i];
+        out << label << ' ' << SgUctPhaseName(static_cast<SgUctPhase>(i))
+            << ' ' << histogram.Count() << ' ' << histogram.Total();
+        for (int j = 0; j < SgUctPhaseHistogram::NU_BINS; ++j)
+            out << ' ' << histogram.BinCount(j);
+        out << '\n';
+    }
+}
+
+//----------------------------------------------------------------------------
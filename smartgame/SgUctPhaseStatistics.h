@@ -0,0 +1,210 @@
+//----------------------------------------------------------------------------
+/** @file SgUctPhaseStatistics.h
+    Time spent by a search thread in the phases of a game. */
+//----------------------------------------------------------------------------
+
+#ifndef SG_UCTPHASESTATISTICS_H
+#define SG_UCTPHASESTATISTICS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+//----------------------------------------------------------------------------
+
+/** Phases of a game played by SgUctSearch::PlayGame().
+    @ingroup sguctgroup */
+enum SgUctPhase
+{
+    /** Selection of the moves in the tree, including the in-tree
+        evaluation of terminal positions, but not the expansion. */
+    SG_UCTPHASE_INTREE,
+
+    /** Generating the moves and prior knowledge of a node and creating its
+        children. In a search thread, it is recorded only for games that
+        generated moves in the tree; in an expand thread, it is the time for
+        a batch of nodes. */
+    SG_UCTPHASE_EXPAND,
+
+    /** The playouts. */
+    SG_UCTPHASE_PLAYOUT,
+
+    /** Updating the values in the tree, including the time waiting for the
+        global lock, if the search is not lock-free. */
+    SG_UCTPHASE_BACKUP,
+
+    SG_UCTPHASE_NU
+};
+
+/** Name of a phase used in the output of SgUctPhaseStatistics. */
+const char* SgUctPhaseName(SgUctPhase phase);
+
+//----------------------------------------------------------------------------
+
+/** Histogram of durations with logarithmic bins.
+    Bin 0 counts durations of 0 ns, bin i > 0 durations in
+    [2^(i-1), 2^i) ns; the last bin also counts all longer durations.
+    The histogram is lock-free: it must be written only by one thread (the
+    search thread that owns it), but other threads may read it at any time
+    and get consistent values for each counter (though not necessarily a
+    consistent snapshot of all counters). Adding a value costs a few relaxed
+    loads and stores and no atomic read-modify-write operation.
+    @ingroup sguctgroup */
+class SgUctPhaseHistogram
+{
+public:
+    static const int NU_BINS = 40;
+
+    SgUctPhaseHistogram();
+
+    void Add(std::chrono::nanoseconds duration);
+
+    void Clear();
+
+    /** Add the counts of another histogram. */
+    void Merge(const SgUctPhaseHistogram& histogram);
+
+    std::uint64_t BinCount(int i) const;
+
+    std::uint64_t Count() const;
+
+    /** Sum of all durations in ns. */
+    std::uint64_t Total() const;
+
+    /** Mean duration in ns. */
+    double Mean() const;
+
+    /** Upper limit of the bin that contains a percentile in ns.
+        @param p The percentile in [0..1]
+        @return The upper limit or 0, if the histogram is empty */
+    std::uint64_t Percentile(double p) const;
+
+private:
+    std::atomic<std::uint64_t> m_count;
+
+    std::atomic<std::uint64_t> m_total;
+
+    std::atomic<std::uint64_t> m_bins[NU_BINS];
+
+    static void Increment(std::atomic<std::uint64_t>& counter,
+                          std::uint64_t n);
+
+    /** Not implemented. */
+    SgUctPhaseHistogram(const SgUctPhaseHistogram&);
+
+    /** Not implemented. */
+    SgUctPhaseHistogram& operator=(const SgUctPhaseHistogram&);
+};
+
+inline void SgUctPhaseHistogram::Increment(std::atomic<std::uint64_t>& counter,
+                                           std::uint64_t n)
+{
+    // Only one thread writes, so a fetch_add is not needed
+    counter.store(counter.load(std::memory_order_relaxed) + n,
+                  std::memory_order_relaxed);
+}
+
+inline std::uint64_t SgUctPhaseHistogram::BinCount(int i) const
+{
+    return m_bins[i].load(std::memory_order_relaxed);
+}
+
+inline std::uint64_t SgUctPhaseHistogram::Count() const
+{
+    return m_count.load(std::memory_order_relaxed);
+}
+
+inline std::uint64_t SgUctPhaseHistogram::Total() const
+{
+    return m_total.load(std::memory_order_relaxed);
+}
+
+//----------------------------------------------------------------------------
+
+/** Histograms of the durations of all phases of a thread.
+    @ingroup sguctgroup */
+class SgUctPhaseStatistics
+{
+public:
+    void Add(SgUctPhase phase, std::chrono::nanoseconds duration);
+
+    void Clear();
+
+    const SgUctPhaseHistogram& Histogram(SgUctPhase phase) const;
+
+    void Merge(const SgUctPhaseStatistics& statistics);
+
+    /** Write a table with count, mean and percentiles in microseconds and
+        the share of the total time of each phase.
+        @verbatim
+        Phase       Count   Mean[us]    P50[us]    P90[us]    P99[us] Time[%]
+        intree       8035        4.9        8.2       16.4       32.8    11.4
+        @endverbatim */
+    void Write(std::ostream& out) const;
+
+    /** Write the histograms in a machine-readable format.
+        One line per phase: the label, the phase name, the count, the total
+        time in ns and the counts of all bins of SgUctPhaseHistogram.
+        @param out The stream
+        @param label The first column of each line (e.g. the thread) */
+    void WriteRaw(std::ostream& out, const std::string& label) const;
+
+private:
+    SgUctPhaseHistogram m_histograms[SG_UCTPHASE_NU];
+};
+
+inline void SgUctPhaseStatistics::Add(SgUctPhase phase,
+                                      std::chrono::nanoseconds duration)
+{
+    m_histograms[phase].Add(duration);
+}
+
+inline const SgUctPhaseHistogram&
+SgUctPhaseStatistics::Histogram(SgUctPhase phase) const
+{
+    return m_histograms[phase];
+}
+
+//----------------------------------------------------------------------------
+
+/** Adds the time of a scope to a duration, if enabled.
+    Does not read the clock if disabled.
+    @ingroup sguctgroup */
+class SgUctPhaseTimer
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    SgUctPhaseTimer(bool enabled, std::chrono::nanoseconds& duration);
+
+    ~SgUctPhaseTimer();
+
+private:
+    const bool m_enabled;
+
+    std::chrono::nanoseconds& m_duration;
+
+    Clock::time_point m_start;
+};
+
+inline SgUctPhaseTimer::SgUctPhaseTimer(bool enabled,
+                                        std::chrono::nanoseconds& duration)
+    : m_enabled(enabled),
+      m_duration(duration)
+{
+    if (m_enabled)
+        m_start = Clock::now();
+}
+
+inline SgUctPhaseTimer::~SgUctPhaseTimer()
+{
+    if (m_enabled)
+        m_duration += Clock::now() - m_start;
+}
+
+//----------------------------------------------------------------------------
+
+#endif // SG_UCTPHASESTATISTICS_H
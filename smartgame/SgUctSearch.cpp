@@ -7,7 +7,10 @@
 
 #include <algorithm>
 #include <cmath>
+#include <exception>
 #include <iomanip>
+#include <limits>
+#include <sstream>
 #include <vector>
 
 #include <boost/format.hpp>
@@ -17,6 +20,7 @@
 #include "SgHashTable.h"
 #include "SgMath.h"
 #include "SgPlatform.h"
+#include "SgUctTreeUtil.h"
 #include "SgWrite.h"
 
 using boost::format;
@@ -74,10 +78,32 @@ size_t GetMaxNodesDefault()
     return nodesPerTree;
 }
 
-void Notify(std::mutex& aMutex, std::condition_variable& aCondition)
+/** Binds the current thread to a CPU during the lifetime of the object.
+    Afterwards the thread can run on all CPUs of the process again. */
+class ThreadAffinityScope
 {
-    std::scoped_lock lock(aMutex);
-    aCondition.notify_all();
+public:
+    /** @param cpu The CPU, or -1 for not binding the thread */
+    explicit ThreadAffinityScope(int cpu);
+
+    ~ThreadAffinityScope();
+
+private:
+    bool m_isBound;
+
+    ThreadAffinityScope(const ThreadAffinityScope&);
+
+    ThreadAffinityScope& operator=(const ThreadAffinityScope&);
+};
+
+ThreadAffinityScope::ThreadAffinityScope(int cpu)
+    : m_isBound(cpu >= 0 && SgPlatform::SetThreadAffinity(cpu))
+{ }
+
+ThreadAffinityScope::~ThreadAffinityScope()
+{
+    if (m_isBound)
+        SgPlatform::SetThreadAffinity(-1);
 }
 
 } // namespace
@@ -87,6 +113,7 @@ void Notify(std::mutex& aMutex, std::condition_variable& aCondition)
 void SgUctGameInfo::Clear(std::size_t numberPlayouts)
 {
     m_nodes.clear();
+    m_entries.clear();
     m_inTreeSequence.clear();
     if (numberPlayouts != m_sequence.size())
     {
@@ -107,7 +134,9 @@ void SgUctGameInfo::Clear(std::size_t numberPlayouts)
 SgUctThreadState::SgUctThreadState(unsigned int threadId, int moveRange)
     : m_threadId(threadId),
       m_isSearchInitialized(false),
-      m_isTreeOutOfMem(false)
+      m_isTreeOutOfMem(false),
+      m_nuGames(0),
+      m_expandTime(0)
 {
     if (moveRange > 0)
     {
@@ -124,6 +153,17 @@ void SgUctThreadState::EndPlayout()
     // Default implementation does nothing
 }
 
+std::uint64_t SgUctThreadState::PositionHash() const
+{
+    return 0;
+}
+
+void SgUctThreadState::GenerateLeafMoves(std::vector<SgUctMoveInfo>& moves,
+                                         SgUctProvenType& provenType)
+{
+    GenerateAllMoves(0, moves, provenType);
+}
+
 void SgUctThreadState::GameStart()
 {
     // Default implementation does nothing
@@ -141,64 +181,11 @@ void SgUctThreadState::StartPlayouts()
 
 //----------------------------------------------------------------------------
 
-SgUctSearch::Thread::Function::Function(Thread& thread)
-    : m_thread(thread)
-{ }
-
-void SgUctSearch::Thread::Function::operator()()
-{
-    m_thread();
-}
-
 SgUctSearch::Thread::Thread(SgUctSearch& search,
                             std::unique_ptr<SgUctThreadState> state)
     : m_state(std::move(state)),
-      m_search(search),
-      m_quit(false),
-      m_threadReady(2, []() noexcept {}),
-      m_playFinishedLock(m_playFinishedMutex),
-      m_globalLock(search.m_globalMutex, std::defer_lock),
-      m_thread(Function(*this))
-{
-    m_threadReady.arrive_and_wait();
-}
-
-SgUctSearch::Thread::~Thread()
-{
-    m_quit = true;
-    StartPlay();
-    m_thread.join();
-}
-
-void SgUctSearch::Thread::operator()()
-{
-    if (DEBUG_THREADS)
-        SgDebug() << "SgUctSearch::Thread: starting thread "
-                  << m_state->m_threadId << '\n';
-    std::unique_lock lock(m_startPlayMutex);
-    m_threadReady.arrive_and_wait();
-    while (true)
-    {
-        m_startPlay.wait(lock);
-        if (m_quit)
-            break;
-        m_search.SearchLoop(*m_state, &m_globalLock);
-        Notify(m_playFinishedMutex, m_playFinished);
-    }
-    if (DEBUG_THREADS)
-        SgDebug() << "SgUctSearch::Thread: finishing thread "
-                  << m_state->m_threadId << '\n';
-}
-
-void SgUctSearch::Thread::StartPlay()
-{
-    Notify(m_startPlayMutex, m_startPlay);
-}
-
-void SgUctSearch::Thread::WaitPlayFinished()
-{
-    m_playFinished.wait(m_playFinishedLock);
-}
+      m_globalLock(search.m_globalMutex, std::defer_lock)
+{ }
 
 //----------------------------------------------------------------------------
 
@@ -210,6 +197,7 @@ void SgUctSearchStat::Clear()
     m_gameLength.Clear();
     m_movesInTree.Clear();
     m_aborted.Clear();
+    m_threadGamesPerSecond.clear();
 }
 
 void SgUctSearchStat::Write(std::ostream& out) const
@@ -226,6 +214,13 @@ void SgUctSearchStat::Write(std::ostream& out) const
         << static_cast<int>(100 * m_aborted.Mean()) << "%\n"
         << SgWriteLabel("Games/s") << fixed << setprecision(1)
         << m_gamesPerSecond << '\n';
+    if (m_threadGamesPerSecond.size() > 1)
+    {
+        out << SgWriteLabel("Games/s/thread");
+        for (size_t i = 0; i < m_threadGamesPerSecond.size(); ++i)
+            out << (i > 0 ? " " : "") << m_threadGamesPerSecond[i];
+        out << '\n';
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -237,6 +232,14 @@ SgUctSearch::SgUctSearch(SgUctThreadStateFactory* threadStateFactory,
       m_rave(false),
       m_knowledgeThreshold(),
       m_maxKnowledgeThreads(1024),
+      m_numberExpandThreads(0),
+      m_expandBatchSize(16),
+      m_analyzeInterval(1),
+      m_analyzeMoves(10),
+      m_nextAnalyzeTime(0),
+      m_threadAffinity(SG_UCTTHREADAFFINITY_NONE),
+      m_phaseStatistics(false),
+      m_isThreadAffinitySet(false),
       m_moveSelect(SG_UCTMOVESELECT_COUNT),
       m_raveCheckSame(false),
       m_randomizeRaveFrequency(20),
@@ -261,7 +264,9 @@ SgUctSearch::SgUctSearch(SgUctThreadStateFactory* threadStateFactory,
       m_raveWeightInitial(0.9f),
       m_raveWeightFinal(20000),
       m_virtualLoss(false),
+      m_transpositionTableSize(0),
       m_logFileName("uctsearch.log"),
+      m_nuSearchLoopsRunning(0),
       m_fastLog(10),
       m_mpiSynchronizer(SgMpiNullSynchronizer::Create())
 {
@@ -275,6 +280,44 @@ SgUctSearch::~SgUctSearch()
     DeleteThreads();
 }
 
+std::string SgUctSearch::AnalyzeInfo() const
+{
+    const double time = m_timer.GetTime();
+    const SgUctValue gamesPlayed = GamesPlayed();
+    std::ostringstream out;
+    out << "playouts " << std::fixed << std::setprecision(0) << gamesPlayed
+        << " playouts_per_second " << std::setprecision(1)
+        << (time > std::numeric_limits<double>::epsilon() ?
+            gamesPlayed / time : 0);
+    const SgUctNode& root = m_tree.Root();
+    if (! root.HasChildren())
+        return out.str();
+    std::vector<const SgUctNode*> children;
+    for (SgUctChildIterator it(m_tree, root); it; ++it)
+        if ((*it).HasMean())
+            children.push_back(&(*it));
+    const size_t nuMoves = std::min(children.size(), m_analyzeMoves);
+    std::partial_sort(children.begin(), children.begin() + nuMoves,
+                      children.end(),
+                      [](const SgUctNode* n1, const SgUctNode* n2)
+                      {
+                          return n1->MoveCount() > n2->MoveCount();
+                      });
+    for (size_t i = 0; i < nuMoves; ++i)
+    {
+        const SgUctNode* child = children[i];
+        const SgUctValue winrate = InverseEval(child->Mean());
+        out << " info move " << MoveString(child->Move())
+            << " visits " << std::setprecision(0) << child->MoveCount()
+            << " winrate " << static_cast<int>(winrate * 10000 + 0.5)
+            << " order " << i << " pv";
+        for (const SgUctNode* node = child; node != 0;
+             node = FindBestChild(*node))
+            out << ' ' << MoveString(node->Move());
+    }
+    return out.str();
+}
+
 void SgUctSearch::ApplyRootFilter(std::vector<SgUctMoveInfo>& moves)
 {
     // Filter without changing the order of the unfiltered moves
@@ -300,7 +343,8 @@ bool SgUctSearch::CheckAbortSearch(SgUctThreadState& state)
         return true;
     }
     const SgUctNode& root = m_tree.Root();
-    if (! SgUctValueUtil::IsPrecise(root.MoveCount()) && m_checkFloatPrecision)
+    if (  ! SgUctValueUtil::IsPrecise(SgUctNodeCount(root.MoveCount()))
+       && m_checkFloatPrecision)
     {
         Debug(state, "SgUctSearch: floating point type precision reached");
         return true;
@@ -408,14 +452,91 @@ bool SgUctSearch::CheckEarlyAbort() const
           && root.Mean() > m_earlyAbort->m_threshold;
 }
 
+/** Count the children of a node as duplicate nodes, if the position of the
+    node was first reached at another node.
+    See SgUctTranspositionStatistics::m_nuDuplicateNodes */
+void SgUctSearch::CountDuplicateNodes(SgUctThreadState& state,
+                                      const SgUctNode& node)
+{
+    const SgUctTranspositionEntry* entry = state.m_gameInfo.m_entries.back();
+    if (  entry != 0
+       && entry->m_node.load(std::memory_order_relaxed) != &node
+       )
+        state.m_transpositionStatistics.m_nuDuplicateNodes +=
+            node.NuChildren();
+}
+
+/** Create the thread states and the threads of the pool.
+    The thread states are created by the threads of the pool, after they
+    are bound to their CPUs (see ThreadAffinity()). The calling thread,
+    which has index 0, is only bound while it creates its thread state.
+    The workers of the pool are also unbound, if they were bound by the
+    last call and the affinity is now SG_UCTTHREADAFFINITY_NONE, because
+    the pool keeps its threads. */
 void SgUctSearch::CreateThreads()
 {
     DeleteThreads();
-    for (unsigned int i = 0; i < m_numberThreads; ++i)
+    const size_t nuThreads = m_numberThreads + m_numberExpandThreads;
+    m_threadPool.SetNumberThreads(nuThreads);
+    m_threads.resize(m_numberThreads);
+    m_expandThreads.resize(m_numberExpandThreads);
+    const bool isAffinitySupported = SgPlatform::ThreadAffinitySupported();
+    const bool setAffinity =
+        isAffinitySupported
+        && (m_threadAffinity != SG_UCTTHREADAFFINITY_NONE
+            || m_isThreadAffinitySet);
+    std::mutex createMutex;
+    std::vector<std::exception_ptr> exceptions(nuThreads);
+    m_threadPool.RunOnAll([&](std::size_t i)
     {
-        m_threads.emplace_back(std::make_shared<Thread>(*this, m_threadStateFactory->Create(i, *this)));
+        try
+        {
+            const int cpu = ThreadCpu(i);
+            ThreadAffinityScope scope(i == 0 && isAffinitySupported ?
+                                      cpu : -1);
+            if (i > 0 && setAffinity && ! SgPlatform::SetThreadAffinity(cpu))
+            {
+                GlobalLock lock(m_globalMutex);
+                SgWarning() << "SgUctSearch: could not bind thread " << i
+                            << " to CPU " << cpu << '\n';
+            }
+            // The constructors of thread states need not be thread-safe
+            std::lock_guard<std::mutex> lock(createMutex);
+            unsigned int threadId = static_cast<unsigned int>(i);
+            std::shared_ptr<Thread> thread = std::make_shared<Thread>(
+                *this, m_threadStateFactory->Create(threadId, *this));
+            if (i < m_numberThreads)
+                m_threads[i] = thread;
+            else
+                m_expandThreads[i - m_numberThreads] = thread;
+        }
+        catch (...)
+        {
+            exceptions[i] = std::current_exception();
+        }
+    });
+    m_isThreadAffinitySet =
+        (isAffinitySupported
+         && m_threadAffinity != SG_UCTTHREADAFFINITY_NONE);
+    for (const std::exception_ptr& exception : exceptions)
+        if (exception)
+        {
+            DeleteThreads();
+            std::rethrow_exception(exception);
+        }
+    if (DEBUG_THREADS)
+    {
+        SgDebug() << "SgUctSearch: using " << m_threadPool.NuThreads()
+                  << " threads";
+        if (m_isThreadAffinitySet)
+        {
+            SgDebug() << ", CPUs";
+            for (size_t i = 0; i < nuThreads; ++i)
+                SgDebug() << ' ' << ThreadCpu(i);
+        }
+        SgDebug() << '\n';
     }
-    m_tree.CreateAllocators(m_numberThreads);
+    m_tree.CreateAllocators(nuThreads);
     m_tree.SetMaxNodes(m_maxNodes);
 
     m_searchLoopFinished.reset(new std::barrier<void(*)()noexcept>(m_numberThreads, []()noexcept{}));
@@ -443,6 +564,100 @@ void SgUctSearch::Debug(const SgUctThreadState& state,
 void SgUctSearch::DeleteThreads()
 {
     m_threads.clear();
+    m_expandThreads.clear();
+}
+
+/** Add the children of a batch of queued nodes.
+    The moves are generated without holding the global lock, which is only
+    acquired once for adding the children of all nodes of the batch. */
+void SgUctSearch::ExpandBatch(SgUctThreadState& state,
+                              std::vector<ExpandRequest>& batch,
+                              GlobalLock* lock)
+{
+    state.m_expandTime = std::chrono::nanoseconds(0);
+    SgUctPhaseTimer timer(m_phaseStatistics, state.m_expandTime);
+    for (ExpandRequest& request : batch)
+    {
+        const size_t nuMoves = request.m_nodes.size() - 1;
+        state.GameStart();
+        for (size_t i = 1; i <= nuMoves; ++i)
+            state.Execute(request.m_nodes[i]->Move());
+        request.m_provenType = SG_NOT_PROVEN;
+        request.m_deleteChildTrees =
+            state.GenerateAllMoves(request.m_count, request.m_moves,
+                                   request.m_provenType);
+        if (nuMoves == 0)
+            ApplyRootFilter(request.m_moves);
+        state.TakeBackInTree(nuMoves);
+    }
+    const unsigned int threadId = state.m_threadId;
+    if (lock != 0)
+        lock->lock();
+    for (ExpandRequest& request : batch)
+    {
+        const SgUctNode& node = *request.m_nodes.back();
+        const std::vector<SgUctMoveInfo>& moves = request.m_moves;
+        // Another request for the same leaf could have been queued by a
+        // search thread that saw the leaf before it was marked as queued
+        if (! moves.empty()
+            && (request.m_count > 0 || ! node.HasChildren()))
+        {
+            if (! m_tree.EnsureCapacity(threadId, moves.size()))
+            {
+                Debug(state,
+                      str(format("SgUctSearch: maximum tree size %1% reached")
+                          % m_tree.MaxNodes()));
+                m_isTreeOutOfMemory = true;
+                SgSynchronizeThreadMemory();
+                break;
+            }
+            if (request.m_count == 0)
+                m_tree.CreateChildren(threadId, node, moves);
+            else
+                m_tree.MergeChildren(threadId, node, moves,
+                                     request.m_deleteChildTrees);
+        }
+        if (request.m_provenType != SG_NOT_PROVEN)
+        {
+            m_tree.SetProvenType(node, request.m_provenType);
+            PropagateProvenStatus(request.m_nodes);
+        }
+    }
+    if (lock != 0)
+        lock->unlock();
+}
+
+/** Loop invoked by each expand thread.
+    Runs until all search threads have left SearchLoop(). Requests still in
+    the queue at this time are dropped. */
+void SgUctSearch::ExpandLoop(SgUctThreadState& state, GlobalLock* lock)
+{
+    if (m_lockFree)
+        lock = 0;
+    std::vector<ExpandRequest> batch;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> expandLock(m_expandMutex);
+            m_expandAvailable.wait(expandLock, [this]
+            {
+                return ! m_expandQueue.empty() || m_nuSearchLoopsRunning == 0;
+            });
+            if (m_nuSearchLoopsRunning == 0)
+                break;
+            while (! m_expandQueue.empty()
+                   && batch.size() < m_expandBatchSize)
+            {
+                batch.push_back(std::move(m_expandQueue.front()));
+                m_expandQueue.pop_front();
+            }
+        }
+        ExpandBatch(state, batch, lock);
+        if (m_phaseStatistics)
+            state.m_phaseStatistics.Add(SG_UCTPHASE_EXPAND,
+                                        state.m_expandTime);
+        batch.clear();
+    }
 }
 
 /** Expand a node.
@@ -451,7 +666,7 @@ void SgUctSearch::DeleteThreads()
 void SgUctSearch::ExpandNode(SgUctThreadState& state, const SgUctNode& node)
 {
     unsigned int threadId = state.m_threadId;
-    if (! m_tree.HasCapacity(threadId, state.m_moves.size()))
+    if (! m_tree.EnsureCapacity(threadId, state.m_moves.size()))
     {
         Debug(state, str(format("SgUctSearch: maximum tree size %1% reached")
                          % m_tree.MaxNodes()));
@@ -588,9 +803,10 @@ SgUctTree& SgUctSearch::GetTempTree()
     // Use NumberThreads() (not m_tree.NuAllocators()) and MaxNodes() (not
     // m_tree.MaxNodes()), because of the delayed thread (and thereby
     // allocator) creation in SgUctSearch
-    if (m_tempTree.NuAllocators() != NumberThreads())
+    const size_t nuAllocators = NumberThreads() + NumberExpandThreads();
+    if (m_tempTree.NuAllocators() != nuAllocators)
     {
-        m_tempTree.CreateAllocators(NumberThreads());
+        m_tempTree.CreateAllocators(nuAllocators);
         m_tempTree.SetMaxNodes(MaxNodes());
     }
     else if (m_tempTree.MaxNodes() != MaxNodes())
@@ -600,6 +816,25 @@ SgUctTree& SgUctSearch::GetTempTree()
     return m_tempTree;
 }
 
+bool SgUctSearch::RerootTree(SgUctTree& initTree,
+                             const std::vector<SgMove>& sequence)
+{
+    SG_ASSERT(&initTree == &m_tempTree);
+    initTree.Clear();
+    const SgUctNode* node = &m_tree.Root();
+    for (std::vector<SgMove>::const_iterator it = sequence.begin();
+         it != sequence.end(); ++it)
+    {
+        node = SgUctTreeUtil::FindChildWithMove(m_tree, *node, *it);
+        if (node == 0)
+            return false;
+    }
+    if (node != &m_tree.Root())
+        m_tree.Reroot(*node);
+    m_tree.Swap(initTree);
+    return true;
+}
+
 SgUctValue SgUctSearch::GetValueEstimate(bool useRave, const SgUctNode& child) const
 {
     SgUctValue value = 0;
@@ -715,6 +950,21 @@ SgUctValue SgUctSearch::GetValueEstimateRave(const SgUctNode& child) const
     return value;
 }
 
+/** Add the transposition table entry of the current position of the state
+    to the game info.
+    @param state The thread state
+    @param node The node of the current position */
+void SgUctSearch::LookupTransposition(SgUctThreadState& state,
+                                      const SgUctNode& node)
+{
+    SgUctTranspositionEntry* entry = 0;
+    const std::uint64_t key = state.PositionHash();
+    if (key != 0)
+        entry = m_transpositionTable->Lookup(key, node,
+                                             state.m_transpositionStatistics);
+    state.m_gameInfo.m_entries.push_back(entry);
+}
+
 std::string SgUctSearch::LastGameSummaryLine() const
 {
     return SummaryLine(LastGameInfo());
@@ -736,7 +986,7 @@ void SgUctSearch::CreateChildren(SgUctThreadState& state,
                                  bool deleteChildTrees)
 {
     unsigned int threadId = state.m_threadId;
-    if (! m_tree.HasCapacity(threadId, state.m_moves.size()))
+    if (! m_tree.EnsureCapacity(threadId, state.m_moves.size()))
     {
         Debug(state, str(format("SgUctSearch: maximum tree size %1% reached")
                          % m_tree.MaxNodes()));
@@ -772,6 +1022,30 @@ bool SgUctSearch::NeedToComputeKnowledge(const SgUctNode* current)
     return false;
 }
 
+/** Queue a node for the expand threads.
+    @param state The state of the search thread; its current in-tree nodes
+    end with the node
+    @param node The node
+    @param count See ExpandRequest::m_count */
+void SgUctSearch::QueueExpand(SgUctThreadState& state, const SgUctNode& node,
+                              SgUctValue count)
+{
+    SG_ASSERT(state.m_gameInfo.m_nodes.back() == &node);
+    {
+        std::lock_guard<std::mutex> expandLock(m_expandMutex);
+        // Knowledge thresholds are already marked as handled by
+        // NeedToComputeKnowledge(), but a leaf stays a leaf until the
+        // request was processed
+        if (count == 0 && ! m_expandQueued.insert(&node).second)
+            return;
+        m_expandQueue.emplace_back();
+        ExpandRequest& request = m_expandQueue.back();
+        request.m_nodes = state.m_gameInfo.m_nodes;
+        request.m_count = count;
+    }
+    m_expandAvailable.notify_one();
+}
+
 void SgUctSearch::OnStartSearch()
 {
     m_mpiSynchronizer->OnStartSearch(*this);
@@ -836,6 +1110,14 @@ void SgUctSearch::OnSearchIteration(SgUctValue gameNumber,
 
 void SgUctSearch::PlayGame(SgUctThreadState& state, GlobalLock* lock)
 {
+    typedef SgUctPhaseTimer::Clock Clock;
+    const bool timePhases = m_phaseStatistics;
+    Clock::time_point phaseStart;
+    if (timePhases)
+    {
+        phaseStart = Clock::now();
+        state.m_expandTime = std::chrono::nanoseconds(0);
+    }
     state.m_isTreeOutOfMem = false;
     state.GameStart();
     SgUctGameInfo& info = state.m_gameInfo;
@@ -857,6 +1139,16 @@ void SgUctSearch::PlayGame(SgUctThreadState& state, GlobalLock* lock)
             m_tree.SetProvenType(terminalNode, SG_PROVEN_LOSS);
         PropagateProvenStatus(info.m_nodes);
     }
+    if (timePhases)
+    {
+        Clock::time_point now = Clock::now();
+        state.m_phaseStatistics.Add(SG_UCTPHASE_INTREE,
+                                    now - phaseStart - state.m_expandTime);
+        if (state.m_expandTime.count() > 0)
+            state.m_phaseStatistics.Add(SG_UCTPHASE_EXPAND,
+                                        state.m_expandTime);
+        phaseStart = now;
+    }
 
     size_t nuMovesInTree = info.m_inTreeSequence.size();
 
@@ -902,6 +1194,12 @@ void SgUctSearch::PlayGame(SgUctThreadState& state, GlobalLock* lock)
         }
     }
     state.TakeBackInTree(nuMovesInTree);
+    if (timePhases)
+    {
+        Clock::time_point now = Clock::now();
+        state.m_phaseStatistics.Add(SG_UCTPHASE_PLAYOUT, now - phaseStart);
+        phaseStart = now;
+    }
 
     // End of unlocked part if ! m_lockFree
     if (lock != 0)
@@ -911,6 +1209,9 @@ void SgUctSearch::PlayGame(SgUctThreadState& state, GlobalLock* lock)
     if (m_rave)
         UpdateRaveValues(state);
     UpdateStatistics(info);
+    if (timePhases)
+        state.m_phaseStatistics.Add(SG_UCTPHASE_BACKUP,
+                                    Clock::now() - phaseStart);
 }
 
 /** Backs up proven information. Last node of nodes is the newly
@@ -959,6 +1260,8 @@ bool SgUctSearch::PlayInTree(SgUctThreadState& state, bool& isTerminal)
     if (m_virtualLoss && m_numberThreads > 1)
         m_tree.AddVirtualLoss(*current);
     nodes.push_back(current);
+    if (m_transpositionTable)
+        state.m_gameInfo.m_entries.push_back(0);
     bool breakAfterSelect = false;
     isTerminal = false;
     bool useBiasTerm = false;
@@ -977,9 +1280,13 @@ bool SgUctSearch::PlayInTree(SgUctThreadState& state, bool& isTerminal)
             break;
         if (! current->HasChildren())
         {
+            SgUctPhaseTimer timer(m_phaseStatistics, state.m_expandTime);
             state.m_moves.clear();
             SgUctProvenType provenType = SG_NOT_PROVEN;
-            state.GenerateAllMoves(0, state.m_moves, provenType);
+            if (m_numberExpandThreads > 0)
+                state.GenerateLeafMoves(state.m_moves, provenType);
+            else
+                state.GenerateAllMoves(0, state.m_moves, provenType);
             if (current == root)
                 ApplyRootFilter(state.m_moves);
             if (provenType != SG_NOT_PROVEN)
@@ -995,9 +1302,18 @@ bool SgUctSearch::PlayInTree(SgUctThreadState& state, bool& isTerminal)
             }
             if (current->MoveCount() >= m_expandThreshold)
             {
+                if (m_numberExpandThreads > 0)
+                {
+                    // Play the game from the leaf until an expand thread
+                    // has added the children
+                    QueueExpand(state, *current, 0);
+                    break;
+                }
                 ExpandNode(state, *current);
                 if (state.m_isTreeOutOfMem)
                     return true;
+                if (m_transpositionTable)
+                    CountDuplicateNodes(state, *current);
                 breakAfterSelect = true;
             }
             else
@@ -1006,29 +1322,35 @@ bool SgUctSearch::PlayInTree(SgUctThreadState& state, bool& isTerminal)
         else if (state.m_threadId < m_maxKnowledgeThreads 
                  && NeedToComputeKnowledge(current))
         {
+            SgUctPhaseTimer timer(m_phaseStatistics, state.m_expandTime);
             m_statistics.m_knowledge++;
-            state.m_moves.clear();
-            SgUctProvenType provenType = SG_NOT_PROVEN;
-            bool truncate = state.GenerateAllMoves(current->KnowledgeCount(), 
-                                                   state.m_moves,
-                                                   provenType);
-            if (current == root)
-                ApplyRootFilter(state.m_moves);
-            CreateChildren(state, *current, truncate);
-            if (provenType != SG_NOT_PROVEN)
-            {
-                m_tree.SetProvenType(*current, provenType);
-                PropagateProvenStatus(nodes);
-                break;
-            }
-            if (state.m_moves.empty())
+            if (m_numberExpandThreads > 0)
+                QueueExpand(state, *current, current->KnowledgeCount());
+            else
             {
-                isTerminal = true;
-                break;
+                state.m_moves.clear();
+                SgUctProvenType provenType = SG_NOT_PROVEN;
+                bool truncate =
+                    state.GenerateAllMoves(current->KnowledgeCount(),
+                                           state.m_moves, provenType);
+                if (current == root)
+                    ApplyRootFilter(state.m_moves);
+                CreateChildren(state, *current, truncate);
+                if (provenType != SG_NOT_PROVEN)
+                {
+                    m_tree.SetProvenType(*current, provenType);
+                    PropagateProvenStatus(nodes);
+                    break;
+                }
+                if (state.m_moves.empty())
+                {
+                    isTerminal = true;
+                    break;
+                }
+                if (state.m_isTreeOutOfMem)
+                    return true;
+                breakAfterSelect = true;
             }
-            if (state.m_isTreeOutOfMem)
-                return true;
-            breakAfterSelect = true;
         }
         current = &SelectChild(state.m_randomizeRaveCounter, useBiasTerm, *current);
         if (m_virtualLoss && m_numberThreads > 1)
@@ -1037,6 +1359,8 @@ bool SgUctSearch::PlayInTree(SgUctThreadState& state, bool& isTerminal)
         SgMove move = current->Move();
         state.Execute(move);
         sequence.push_back(move);
+        if (m_transpositionTable)
+            LookupTransposition(state, *current);
         if (breakAfterSelect)
             break;
     }
@@ -1089,17 +1413,38 @@ SgUctValue SgUctSearch::Search(SgUctValue maxGames, double maxTime,
     for (size_t i = 0; i < m_threads.size(); ++i)
     {
         m_threads[i]->m_state->m_isSearchInitialized = false;
+        m_threads[i]->m_state->m_nuGames = 0;
+        m_threads[i]->m_state->m_phaseStatistics.Clear();
+        m_threads[i]->m_state->m_transpositionStatistics.Clear();
     }
+    for (size_t i = 0; i < m_expandThreads.size(); ++i)
+        m_expandThreads[i]->m_state->m_phaseStatistics.Clear();
     StartSearch(rootFilter, initTree);
+    // The calling thread is thread 0 of the pool, it is bound to its CPU
+    // only during the search
+    ThreadAffinityScope affinityScope(m_isThreadAffinitySet ?
+                                      ThreadCpu(0) : -1);
     SgUctValue pruneMinCount = m_pruneMinCount;
     while (true)
     {
         m_isTreeOutOfMemory = false;
+        m_expandQueue.clear();
+        m_expandQueued.clear();
+        m_nuSearchLoopsRunning = m_numberThreads;
         SgSynchronizeThreadMemory();
-        for (size_t i = 0; i < m_threads.size(); ++i)
-            m_threads[i]->StartPlay();
-        for (size_t i = 0; i < m_threads.size(); ++i)
-            m_threads[i]->WaitPlayFinished();
+        m_threadPool.RunOnAll([this](std::size_t i)
+        {
+            if (i < m_threads.size())
+            {
+                Thread& thread = *m_threads[i];
+                SearchLoop(*thread.m_state, &thread.m_globalLock);
+            }
+            else
+            {
+                Thread& thread = *m_expandThreads[i - m_threads.size()];
+                ExpandLoop(*thread.m_state, &thread.m_globalLock);
+            }
+        });
         if (m_aborted || ! m_pruneFullTree)
             break;
         else
@@ -1120,20 +1465,39 @@ SgUctValue SgUctSearch::Search(SgUctValue maxGames, double maxTime,
             else
                  pruneMinCount = m_pruneMinCount; 
             m_tree.Swap(tempTree);
+            // Return the chunks of the unpruned tree to its node pool now,
+            // they are reused by the next prune or extraction
+            tempTree.Clear();
         }
     }
     EndSearch();
     m_statistics.m_time = m_timer.GetTime();
     if (m_statistics.m_time > std::numeric_limits<double>::epsilon())
+    {
         m_statistics.m_gamesPerSecond = GamesPlayed() / m_statistics.m_time;
+        m_statistics.m_threadGamesPerSecond.clear();
+        for (size_t i = 0; i < m_threads.size(); ++i)
+            m_statistics.m_threadGamesPerSecond.push_back(
+                double(m_threads[i]->m_state->m_nuGames)
+                / m_statistics.m_time);
+    }
     if (m_logGames)
         m_log.close();
+    if (m_analyzeCallback)
+        m_analyzeCallback(AnalyzeInfo());
     FindBestSequence(sequence);
     return m_tree.Root().MoveCount() > 0 ? 
            m_tree.Root().Mean() : 
            SgUctValue(0.5);
 }
 
+bool SgUctSearch::Reserve(std::size_t nuNodes)
+{
+    if (m_threads.size() == 0)
+        CreateThreads();
+    return m_tree.Reserve(nuNodes);
+}
+
 /** Loop invoked by each thread for playing games. */
 void SgUctSearch::SearchLoop(SgUctThreadState& state, GlobalLock* lock)
 {
@@ -1143,7 +1507,9 @@ void SgUctSearch::SearchLoop(SgUctThreadState& state, GlobalLock* lock)
         state.m_isSearchInitialized = true;
     }
 
-    if (NumberThreads() == 1 || m_lockFree)
+    // The expand threads also modify the tree, so a single search thread
+    // needs the lock, too
+    if ((NumberThreads() == 1 && m_numberExpandThreads == 0) || m_lockFree)
         lock = 0;
     if (lock != 0)
         lock->lock();
@@ -1153,9 +1519,12 @@ void SgUctSearch::SearchLoop(SgUctThreadState& state, GlobalLock* lock)
         PlayGame(state, lock);
         OnSearchIteration(m_numberGames + 1, state.m_threadId,
                           state.m_gameInfo);
+        if (state.m_threadId == 0)
+            WriteAnalyzeInfo(lock);
         if (m_logGames)
             m_log << SummaryLine(state.m_gameInfo) << '\n';
         ++m_numberGames;
+        ++state.m_nuGames;
         if (m_isTreeOutOfMemory)
             break;
         if (m_aborted || CheckAbortSearch(state))
@@ -1168,6 +1537,14 @@ void SgUctSearch::SearchLoop(SgUctThreadState& state, GlobalLock* lock)
     if (lock != 0)
         lock->unlock();
 
+    if (m_numberExpandThreads > 0)
+    {
+        {
+            std::lock_guard<std::mutex> expandLock(m_expandMutex);
+            --m_nuSearchLoopsRunning;
+        }
+        m_expandAvailable.notify_all();
+    }
     m_searchLoopFinished->arrive_and_wait();
     if (m_aborted || ! m_pruneFullTree)
         OnThreadEndSearch(state);
@@ -1243,6 +1620,10 @@ SgPoint SgUctSearch::SearchOnePly(SgUctValue maxGames, double maxTime,
     return bestMove;
 }
 
+/** Select the child with the highest bound.
+    The children are iterated only once, because the children of a node can
+    be replaced by other threads in lock-free mode or by the expand
+    threads. */
 const SgUctNode& SgUctSearch::SelectChild(int& randomizeCounter, 
                                           bool useBiasTerm,
                                           const SgUctNode& node)
@@ -1268,6 +1649,7 @@ const SgUctNode& SgUctSearch::SelectChild(int& randomizeCounter,
         return *SgUctChildIterator(m_tree, node);
         
     const SgUctValue logPosCount = Log(posCount);
+    const SgUctNode* firstChild = 0;
     const SgUctNode* bestChild = 0;
     SgUctValue bestUpperBound = 0;
     const SgUctValue predictorWeight = 
@@ -1276,6 +1658,8 @@ const SgUctNode& SgUctSearch::SelectChild(int& randomizeCounter,
     for (SgUctChildIterator it(m_tree, node); it; ++it)
     {
         const SgUctNode& child = *it;
+        if (firstChild == 0)
+            firstChild = &child;
         if (! child.IsProvenWin()) // Avoid losing moves
         {
             SgUctValue bound = GetBound(useRave, useBiasTerm, 
@@ -1300,7 +1684,7 @@ const SgUctNode& SgUctSearch::SelectChild(int& randomizeCounter,
     // in this state but this thread got in here before that information
     // was propagated up the tree. So just return the first child
     // in this case.
-    return *node.FirstChild();
+    return *firstChild;
 }
 
 void SgUctSearch::SetNumberThreads(size_t n)
@@ -1312,6 +1696,29 @@ void SgUctSearch::SetNumberThreads(size_t n)
     CreateThreads();
 }
 
+void SgUctSearch::SetThreadAffinity(SgUctThreadAffinity affinity)
+{
+    if (m_threadAffinity == affinity)
+        return;
+    m_threadAffinity = affinity;
+    if (! SgPlatform::ThreadAffinitySupported())
+    {
+        if (affinity != SG_UCTTHREADAFFINITY_NONE)
+            SgWarning() << "SgUctSearch: thread affinity is not supported"
+                           " on this system\n";
+        return;
+    }
+    CreateThreads();
+}
+
+void SgUctSearch::SetNumberExpandThreads(size_t n)
+{
+    if (m_numberExpandThreads == n)
+        return;
+    m_numberExpandThreads = n;
+    CreateThreads();
+}
+
 void SgUctSearch::SetCheckTimeInterval(SgUctValue n)
 {
     SG_ASSERT(n >= 0);
@@ -1354,6 +1761,10 @@ void SgUctSearch::StartSearch(const std::vector<SgMove>& rootFilter,
     else
     {
         m_tree.Swap(*initTree);
+        // The previous search tree is no longer needed, return its chunks
+        // to its node pool
+        if (initTree == &m_tempTree)
+            m_tempTree.Clear();
         if (m_tree.HasCapacity(0, m_tree.Root().NuChildren()))
             m_tree.ApplyFilter(0, m_tree.Root(), rootFilter);
         else
@@ -1361,6 +1772,17 @@ void SgUctSearch::StartSearch(const std::vector<SgMove>& rootFilter,
                 "SgUctSearch: "
                 "root filter not applied (tree reached maximum size)\n";
     }
+    // Reuse the table, if it has the size for m_transpositionTableSize
+    if (m_transpositionTableSize == 0)
+        m_transpositionTable.reset();
+    else if (  m_transpositionTable
+            && m_transpositionTable->MaxEntries() >= m_transpositionTableSize
+            && m_transpositionTable->MaxEntries() / 2 < m_transpositionTableSize
+            )
+        m_transpositionTable->Clear();
+    else
+        m_transpositionTable.reset(
+                      new SgUctTranspositionTable(m_transpositionTableSize));
     m_statistics.Clear();
     m_aborted = false;
     m_wasEarlyAbort = false;
@@ -1368,6 +1790,7 @@ void SgUctSearch::StartSearch(const std::vector<SgMove>& rootFilter,
        m_checkTimeInterval = 1;
     m_numberGames = 0;
     m_lastScoreDisplayTime = m_timer.GetTime();
+    m_nextAnalyzeTime = m_lastScoreDisplayTime + m_analyzeInterval;
     OnStartSearch();
     
     m_nextCheckTime = SgUctValue(m_checkTimeInterval);
@@ -1380,6 +1803,8 @@ void SgUctSearch::StartSearch(const std::vector<SgMove>& rootFilter,
         state.m_randomizeBiasCounter = m_biasTermFrequency;
         state.StartSearch();
     }
+    for (unsigned int i = 0; i < m_expandThreads.size(); ++i)
+        m_expandThreads[i]->m_state->StartSearch();
 }
 
 void SgUctSearch::EndSearch()
@@ -1403,6 +1828,47 @@ std::string SgUctSearch::SummaryLine(const SgUctGameInfo& info) const
     return buffer.str();
 }
 
+/** The CPU of a thread according to ThreadAffinity().
+    @param threadIndex The index of the thread in m_threadPool
+    @return The CPU or -1 for SG_UCTTHREADAFFINITY_NONE */
+int SgUctSearch::ThreadCpu(std::size_t threadIndex) const
+{
+    const std::vector<std::vector<int> >& nodes = SgPlatform::NumaNodes();
+    switch (m_threadAffinity)
+    {
+    case SG_UCTTHREADAFFINITY_COMPACT:
+        {
+            size_t nuCpus = 0;
+            for (const std::vector<int>& node : nodes)
+                nuCpus += node.size();
+            size_t i = threadIndex % nuCpus;
+            for (const std::vector<int>& node : nodes)
+            {
+                if (i < node.size())
+                    return node[i];
+                i -= node.size();
+            }
+            SG_ASSERT(false);
+            return -1;
+        }
+    case SG_UCTTHREADAFFINITY_SCATTER:
+        {
+            const std::vector<int>& node = nodes[threadIndex % nodes.size()];
+            return node[(threadIndex / nodes.size()) % node.size()];
+        }
+    default:
+        return -1;
+    }
+}
+
+SgUctTranspositionStatistics SgUctSearch::TranspositionStatistics() const
+{
+    SgUctTranspositionStatistics statistics;
+    for (size_t i = 0; i < m_threads.size(); ++i)
+        statistics.Merge(m_threads[i]->m_state->m_transpositionStatistics);
+    return statistics;
+}
+
 void SgUctSearch::UpdateCheckTimeInterval(double time)
 {
     if (time < std::numeric_limits<double>::epsilon())
@@ -1546,18 +2012,60 @@ void SgUctSearch::UpdateTree(const SgUctGameInfo& info)
     const std::vector<const SgUctNode*>& nodes = info.m_nodes;
     const SgUctValue count = 
     	SgUctValue(m_updateMultiplePlayoutsAsSingle ? 1 : m_numberPlayouts);
+    const std::vector<SgUctTranspositionEntry*>& entries = info.m_entries;
+    SG_ASSERT(entries.empty() || entries.size() == nodes.size());
     for (size_t i = 0; i < nodes.size(); ++i)
     {
         const SgUctNode& node = *nodes[i];
         const SgUctNode* father = (i > 0 ? nodes[i - 1] : 0);
-        m_tree.AddGameResults(node, father, i % 2 == 0 ? eval : inverseEval,
-                              count);
+        const SgUctValue value = (i % 2 == 0 ? eval : inverseEval);
+        m_tree.AddGameResults(node, father, value, count);
+        if (! entries.empty() && entries[i] != 0)
+            UpdateTransposition(node, *entries[i], value, count);
         // Remove the virtual loss
         if (m_virtualLoss && m_numberThreads > 1)
             m_tree.RemoveVirtualLoss(node);
     }
 }
 
+/** Add a game result to the statistics of a position in the transposition
+    table and let the node use the statistics of the position, if they contain
+    more games than its own. The statistics are only copied to the nodes
+    visited in a game, such that the selection of the children does not need
+    lookups in the table. The position count of the father node is not
+    changed. */
+void SgUctSearch::UpdateTransposition(const SgUctNode& node,
+                                      SgUctTranspositionEntry& entry,
+                                      SgUctValue eval, SgUctValue count)
+{
+    entry.m_statistics.Add(eval, count);
+    SgUctValue mean;
+    SgUctValue entryCount;
+    entry.m_statistics.Get(mean, entryCount);
+    if (entryCount > node.MoveCount())
+        m_tree.InitializeValue(node, mean, entryCount);
+}
+
+/** Pass a line of AnalyzeInfo() to the analyze callback, if it is due.
+    Called by the first search thread after each game. The global lock is
+    released while the line is built and passed on, such that the other
+    threads are not stalled (see AnalyzeInfo()).
+    @param lock The global lock held by the thread, or 0 */
+void SgUctSearch::WriteAnalyzeInfo(GlobalLock* lock)
+{
+    if (! m_analyzeCallback || m_analyzeInterval <= 0)
+        return;
+    const double currTime = m_timer.GetTime();
+    if (currTime < m_nextAnalyzeTime)
+        return;
+    m_nextAnalyzeTime = currTime + m_analyzeInterval;
+    if (lock != 0)
+        lock->unlock();
+    m_analyzeCallback(AnalyzeInfo());
+    if (lock != 0)
+        lock->lock();
+}
+
 void SgUctSearch::WriteStatistics(std::ostream& out) const
 {
     out << SgWriteLabel("Count") << m_tree.Root().MoveCount() << '\n'
@@ -1569,7 +2077,49 @@ void SgUctSearch::WriteStatistics(std::ostream& out) const
             << m_statistics.m_knowledge * 100.0 / m_tree.Root().MoveCount()
             << "%)\n";
     m_statistics.Write(out);
+    if (m_transpositionTable)
+        m_transpositionTable->Write(out, TranspositionStatistics(),
+                                    m_tree.NuNodes());
     m_mpiSynchronizer->WriteStatistics(out);
 }
 
+void SgUctSearch::WritePhaseStatistics(std::ostream& out, bool raw) const
+{
+    if (! m_phaseStatistics)
+        return;
+    if (raw)
+    {
+        out << "bins";
+        for (int i = 0; i < SgUctPhaseHistogram::NU_BINS; ++i)
+            out << ' ' << (std::uint64_t(1) << i);
+        out << '\n';
+        for (size_t i = 0; i < m_threads.size(); ++i)
+            m_threads[i]->m_state->m_phaseStatistics.WriteRaw(out,
+                                            "search" + std::to_string(i));
+        for (size_t i = 0; i < m_expandThreads.size(); ++i)
+            m_expandThreads[i]->m_state->m_phaseStatistics.WriteRaw(out,
+                                            "expand" + std::to_string(i));
+        return;
+    }
+    SgUctPhaseStatistics total;
+    for (size_t i = 0; i < m_threads.size(); ++i)
+    {
+        const SgUctPhaseStatistics& statistics =
+            m_threads[i]->m_state->m_phaseStatistics;
+        out << "Search thread " << i << ":\n";
+        statistics.Write(out);
+        total.Merge(statistics);
+    }
+    for (size_t i = 0; i < m_expandThreads.size(); ++i)
+    {
+        out << "Expand thread " << i << ":\n";
+        m_expandThreads[i]->m_state->m_phaseStatistics.Write(out);
+    }
+    if (m_threads.size() > 1)
+    {
+        out << "All search threads:\n";
+        total.Write(out);
+    }
+}
+
 //----------------------------------------------------------------------------
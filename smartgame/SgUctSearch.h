@@ -6,17 +6,24 @@
 #pragma once
 
 #include <fstream>
+#include <functional>
+#include <string>
 #include <vector>
 #include <memory>
 #include <thread>
 #include <mutex>
 #include <barrier>
 #include <condition_variable>
+#include <deque>
+#include <unordered_set>
 
 #include "SgAdditiveKnowledge.h"
 #include "SgBlackWhite.h"
 #include "SgBWArray.h"
+#include "SgThreadPool.h"
 #include "SgTimer.h"
+#include "SgUctPhaseStatistics.h"
+#include "SgUctTranspositionTable.h"
 #include "SgUctTree.h"
 #include "SgMpiSynchronizer.h"
 
@@ -226,6 +233,12 @@ struct SgUctGameInfo
     /** Nodes visited in the in-tree phase. */
     std::vector<const SgUctNode*> m_nodes;
 
+    /** Transposition table entries of the positions of m_nodes.
+        Only used if the search has a transposition table. Null for the root
+        and for positions that are not in the table.
+        See SgUctSearch::TranspositionTableSize() */
+    std::vector<SgUctTranspositionEntry*> m_entries;
+
     /** Flag to skip RAVE update for moves of the playout(s).
         For convenient usage, the index corresponds to the move number from
         the root position on, even if the flag is currently only used for
@@ -258,6 +271,26 @@ enum SgUctMoveSelect
 
 //----------------------------------------------------------------------------
 
+/** Binding of the search threads to CPUs.
+    The CPUs are taken from SgPlatform::NumaNodes(). The thread with index 0
+    is the thread that calls SgUctSearch::Search(), the expand threads have
+    the indices following the search threads.
+    @ingroup sguctgroup */
+enum SgUctThreadAffinity
+{
+    /** Let the operating system schedule the threads. */
+    SG_UCTTHREADAFFINITY_NONE,
+
+    /** Bind the threads to consecutive CPUs, filling one NUMA node before
+        using the next. */
+    SG_UCTTHREADAFFINITY_COMPACT,
+
+    /** Distribute the threads round-robin over the NUMA nodes. */
+    SG_UCTTHREADAFFINITY_SCATTER
+};
+
+//----------------------------------------------------------------------------
+
 /** Base class for the thread state.
     Subclasses must be thread-safe, it must be possible to use different
     instances of this class in different threads (after construction, the
@@ -279,6 +312,17 @@ public:
         maximum tree size was reached. */
     bool m_isTreeOutOfMem;
 
+    /** Number of games played by this thread in the current search. */
+    std::size_t m_nuGames;
+
+    /** Time spent in the phases of the games in the current search.
+        Only recorded if SgUctSearch::PhaseStatistics() is enabled. */
+    SgUctPhaseStatistics m_phaseStatistics;
+
+    /** Local variable for SgUctSearch::PlayGame().
+        Time spent in expanding nodes in the current game. */
+    std::chrono::nanoseconds m_expandTime;
+
     SgUctGameInfo m_gameInfo;
 
     /** Local variable for SgUctSearch::UpdateRaveValues().
@@ -306,6 +350,10 @@ public:
     /** Thread's counter for Randomized Bias in SgUctSearch::PlayInTree(). */
     int m_randomizeBiasCounter;
 
+    /** Lookups of this thread in the transposition table in the current
+        search. */
+    SgUctTranspositionStatistics m_transpositionStatistics;
+
     SgUctThreadState(unsigned int threadId, int moveRange = 0);
 
     virtual ~SgUctThreadState();
@@ -341,6 +389,18 @@ public:
                                   std::vector<SgUctMoveInfo>& moves,
                                   SgUctProvenType& provenType) = 0;
 
+    /** Generate moves at a node whose expansion is deferred.
+        Used by the search threads instead of GenerateAllMoves(), if
+        SgUctSearch::NumberExpandThreads() is greater than zero. The moves are
+        only used to detect the end of the game; the moves of the new
+        children and their prior knowledge are generated later with
+        GenerateAllMoves() by an expand thread. The default implementation
+        calls GenerateAllMoves() with count 0.
+        @param[out] moves The generated moves or empty list at end of game
+        @param[out] provenType */
+    virtual void GenerateLeafMoves(std::vector<SgUctMoveInfo>& moves,
+                                   SgUctProvenType& provenType);
+
     /** Generate random move.
         Generate a random move in the play-out phase (outside the UCT tree).
         @param[out] skipRaveUpdate This value should be set to true, if the
@@ -392,6 +452,13 @@ public:
         Default implementation does nothing. */
     virtual void EndPlayout();
 
+    /** Hash code of the current position in the in-tree phase.
+        Used for the transposition table (see
+        SgUctSearch::TranspositionTableSize()). Must include the color to
+        play. The default implementation returns zero, which means that
+        positions are not looked up in the transposition table. */
+    virtual std::uint64_t PositionHash() const;
+
     // @} // name
 };
 
@@ -432,6 +499,9 @@ struct SgUctSearchStat
 
     SgUctStatistics m_aborted;
 
+    /** Games per second of each search thread. */
+    std::vector<double> m_threadGamesPerSecond;
+
     void Clear();
 
     void Write(std::ostream& out) const;
@@ -554,6 +624,18 @@ public:
         of the thread state. */
     void GenerateAllMoves(std::vector<SgUctMoveInfo>& moves);
 
+    /** Create the thread states and allocate the tree in advance.
+        Usually the thread states are created and the memory of the tree is
+        allocated in the first search. Calling this function before moves
+        the cost out of the first search, e.g. for engines that are kept in
+        a pool until they are needed. Changing parameters that recreate the
+        threads (e.g. NumberThreads()) or the tree (MaxNodes()) afterwards
+        releases the memory again.
+        @param nuNodes The number of nodes of the tree to allocate. At most
+        MaxNodes() nodes are allocated.
+        @return false if the memory allocation failed */
+    bool Reserve(std::size_t nuNodes);
+
     /** Play a single game.
         Plays a single game using the thread state of the first thread.
         Call StartSearch() before calling this function. */
@@ -609,6 +691,25 @@ public:
         @param[out] sequence The resulting sequence. */
     void FindBestSequence(std::vector<SgMove>& sequence) const;
 
+    /** One line of analysis output for the current state of the search.
+        The line starts with the number of games played in this search and
+        the games per second, followed by an entry for each of the
+        AnalyzeMoves() root children with the highest move counts, in the
+        format of the lz-analyze GTP extension:
+        @verbatim
+        playouts 12000 playouts_per_second 6000.0 info move D4 visits 5000
+        winrate 5230 order 0 pv D4 Q16 info move Q16 ...
+        @endverbatim
+        The winrate is the mean value of the move from the point of view
+        of the player to move at the root, scaled to [0..10000]. The
+        principal variation starts with the move and continues with
+        FindBestChild(). Children without a mean value are skipped.
+        Can be called during a search without holding the global lock,
+        also if the search is not lock-free, because it only reads the tree
+        and the tree structure changes the same way as in lock-free mode
+        (see @ref sguctsearchlockfreetree). */
+    std::string AnalyzeInfo() const;
+
     /** Return the bound of a move.
         This is the bound that was used for move selection. It can be the
         pure UCT bound or the combined bound if RAVE is used.
@@ -647,6 +748,18 @@ public:
         used by other code while the search is not running. */
     SgUctTree& GetTempTree();
 
+    /** Reuse the subtree after a sequence of moves without copying it.
+        Re-roots the search tree in place (see SgUctTree::Reroot()) and swaps
+        it with initTree, which can then be passed to Search(). This takes
+        constant time, unlike SgUctTree::ExtractSubtree(). The nodes that are
+        no longer reachable are reclaimed lazily, when the search prunes the
+        full tree (see PruneFullTree()) or the tree is cleared.
+        @param[out] initTree The tree returned by GetTempTree().
+        @param sequence The moves leading from the root to the new root.
+        @return @c false, if the sequence does not correspond to a sequence
+        of nodes in the tree; initTree is empty in this case. */
+    bool RerootTree(SgUctTree& initTree, const std::vector<SgMove>& sequence);
+
     // @} // name
 
 
@@ -690,6 +803,59 @@ public:
 
     void SetMaxKnowledgeThreads(unsigned int threads);
 
+    /** Number of threads that expand nodes and compute prior knowledge.
+        If zero (the default), a search thread that reaches a node to expand
+        or a knowledge threshold calls GenerateAllMoves() itself. Otherwise
+        it queues the node and continues its game from the node, while the
+        expand threads take the queued nodes in batches, replay their
+        positions and add the children with the moves and knowledge of
+        GenerateAllMoves(). Then expensive knowledge does not stall the
+        search threads or, if the search is not lock-free, the global lock.
+        The expand threads are used in addition to NumberThreads(). */
+    size_t NumberExpandThreads() const;
+
+    /** See NumberExpandThreads() */
+    void SetNumberExpandThreads(size_t n);
+
+    /** Maximum number of queued nodes an expand thread takes at once.
+        If the search is not lock-free, the expand thread acquires the
+        global lock once per batch to add the children.
+        See NumberExpandThreads() */
+    size_t ExpandBatchSize() const;
+
+    /** See ExpandBatchSize() */
+    void SetExpandBatchSize(size_t n);
+
+    /** Function that receives the analysis output during a search.
+        See AnalyzeInfo(), AnalyzeInterval() */
+    typedef std::function<void(const std::string&)> AnalyzeCallback;
+
+    /** Set the function that receives the analysis output.
+        The function is called from the first search thread after a game,
+        every AnalyzeInterval() seconds and once at the end of Search().
+        The line is built and the function is called without holding the
+        global lock, also if the search is not lock-free, so the other
+        threads continue searching meanwhile. An empty function disables
+        the analysis output (the default). */
+    void SetAnalyzeCallback(const AnalyzeCallback& callback);
+
+    /** Time between two lines of analysis output in seconds.
+        Zero means that only the final line at the end of the search is
+        written. Default is 1.
+        See SetAnalyzeCallback() */
+    double AnalyzeInterval() const;
+
+    /** See AnalyzeInterval() */
+    void SetAnalyzeInterval(double interval);
+
+    /** Maximum number of moves in a line of analysis output.
+        Default is 10.
+        See AnalyzeInfo() */
+    size_t AnalyzeMoves() const;
+
+    /** See AnalyzeMoves() */
+    void SetAnalyzeMoves(size_t n);
+
     /** Maximum number of nodes in the tree.
         @note The search owns two trees, one of which is used as a temporary
         tree for some operations (see GetTempTree()). This functions sets
@@ -703,6 +869,33 @@ public:
     /** The number of threads to use during the search. */
     size_t NumberThreads() const;
 
+    /** Binding of the search and expand threads to CPUs.
+        The thread states are constructed in their threads after the threads
+        are bound, so that their memory is allocated on the NUMA node of the
+        thread by operating systems with first-touch memory placement (like
+        Linux). The same holds for the node chunks of the allocators of the
+        tree (see SgUctNodePool::Acquire()). The thread that calls
+        Search() is only bound during Search() and during the construction
+        of its thread state. If SgPlatform::ThreadAffinitySupported() is
+        false, the setting has no effect. Default is
+        SG_UCTTHREADAFFINITY_NONE. */
+    SgUctThreadAffinity ThreadAffinity() const;
+
+    /** See ThreadAffinity()
+        Recreates the threads if the affinity changes. Writes a warning if
+        the affinity is not supported. */
+    void SetThreadAffinity(SgUctThreadAffinity affinity);
+
+    /** Record the time spent in the phases of each game.
+        Records histograms of the durations of the in-tree phase, expansion,
+        playouts and backup per thread (see SgUctPhaseStatistics and
+        WritePhaseStatistics()). This costs about four reads of the clock
+        per game. Default is false. */
+    bool PhaseStatistics() const;
+
+    /** See PhaseStatistics() */
+    void SetPhaseStatistics(bool enable);
+
     /** See SetNumberThreads() */
     void SetNumberThreads(size_t n);
 
@@ -837,6 +1030,17 @@ public:
     /** See VirtualLoss() */
     void SetVirtualLoss(bool enable);
 
+    /** Size of the transposition table.
+        If not zero, the positions of the nodes in the tree are looked up in
+        a lock-free transposition table (see SgUctTranspositionTable), and
+        nodes with the same position share their move statistics. Needs
+        SgUctThreadState::PositionHash(). The table is cleared at the start of
+        each search. Default is zero (no transposition table). */
+    std::size_t TranspositionTableSize() const;
+
+    /** See TranspositionTableSize() */
+    void SetTranspositionTableSize(std::size_t size);
+
     /** Prune nodes with low counts if tree is full.
         This will prune nodes below a minimum count, if the tree gets full
         during a search. The minimum count is PruneMinCount() at the beginning
@@ -876,8 +1080,27 @@ public:
 
     const SgUctSearchStat& Statistics() const;
 
+    /** The transposition table, null if TranspositionTableSize() is zero or
+        no search was run since it was set. */
+    const SgUctTranspositionTable* TranspositionTable() const;
+
+    /** Lookups of all threads in the transposition table in the last
+        search. */
+    SgUctTranspositionStatistics TranspositionStatistics() const;
+
     void WriteStatistics(std::ostream& out) const;
 
+    /** Write the phase statistics of the last search.
+        Writes a table per thread (see SgUctPhaseStatistics::Write()) and one
+        for all search threads together, or with raw=true the histograms of
+        all threads in the format of SgUctPhaseStatistics::WriteRaw() with the
+        label "search<i>" or "expand<i>" and a first line with the upper
+        limits of the bins in ns. Writes nothing if PhaseStatistics() is
+        disabled.
+        @param out The stream
+        @param raw Write the machine-readable format */
+    void WritePhaseStatistics(std::ostream& out, bool raw) const;
+
     // @} // name
 
     /** Get state of one of the threads.
@@ -902,62 +1125,16 @@ private:
     
     friend class Thread;
 
+    /** State of a search thread.
+        The search loops are run by the threads of m_threadPool. */
     class Thread
     {
     public:
         std::unique_ptr<SgUctThreadState> m_state;
 
-        Thread(SgUctSearch& search, std::unique_ptr<SgUctThreadState> state);
-
-        ~Thread();
-
-        void StartPlay();
-
-        void WaitPlayFinished();
-
-    private:
-        /** Copyable function object that invokes Thread::operator().
-            Needed because the the constructor of boost::thread copies the
-            function object argument. */
-        class Function
-        {
-        public:
-            Function(Thread& thread);
-
-            void operator()();
-
-        private:
-            Thread& m_thread;
-        };
-
-        friend class Thread::Function;
-
-        SgUctSearch& m_search;
-
-        bool m_quit;
-
-        std::barrier<void(*)() noexcept> m_threadReady;
-
-        std::mutex m_startPlayMutex;
-
-        std::mutex m_playFinishedMutex;
-
-        std::condition_variable m_startPlay;
-
-        std::condition_variable m_playFinished;
-
-        std::unique_lock<std::mutex> m_playFinishedLock;
-        
         GlobalLock m_globalLock;
 
-        /** The thread.
-            Order dependency: must be constructed as the last member, because
-            the constructor starts the thread. */
-        std::thread m_thread;
-
-        void operator()();
-
-        void PlayGames();
+        Thread(SgUctSearch& search, std::unique_ptr<SgUctThreadState> state);
     };
 
     std::unique_ptr<SgUctThreadStateFactory> m_threadStateFactory;
@@ -973,6 +1150,34 @@ private:
     
     unsigned int m_maxKnowledgeThreads;
 
+    /** See NumberExpandThreads() */
+    size_t m_numberExpandThreads;
+
+    /** See ExpandBatchSize() */
+    size_t m_expandBatchSize;
+
+    /** See SetAnalyzeCallback() */
+    AnalyzeCallback m_analyzeCallback;
+
+    /** See AnalyzeInterval() */
+    double m_analyzeInterval;
+
+    /** See AnalyzeMoves() */
+    size_t m_analyzeMoves;
+
+    /** Time of the next line of analysis output in the current search. */
+    double m_nextAnalyzeTime;
+
+    /** See ThreadAffinity() */
+    SgUctThreadAffinity m_threadAffinity;
+
+    /** See PhaseStatistics() */
+    bool m_phaseStatistics;
+
+    /** The threads of the pool were bound to CPUs by the last
+        CreateThreads(). */
+    bool m_isThreadAffinitySet;
+
     /** Flag indicating that the search was terminated because the maximum
         time or number of games was reached. */
     volatile bool m_aborted;
@@ -1079,6 +1284,12 @@ private:
     /** See VirtualLoss() */
     bool m_virtualLoss;
 
+    /** See TranspositionTableSize() */
+    std::size_t m_transpositionTableSize;
+
+    /** See TranspositionTableSize() */
+    std::unique_ptr<SgUctTranspositionTable> m_transpositionTable;
+
     std::string m_logFileName;
 
     SgTimer m_timer;
@@ -1106,6 +1317,46 @@ private:
         auto_ptr should not be used with standard containers) */
     std::vector<std::shared_ptr<Thread> > m_threads;
 
+    /** Threads running ExpandLoop(). See NumberExpandThreads() */
+    std::vector<std::shared_ptr<Thread> > m_expandThreads;
+
+    /** A node queued for expansion by the expand threads. */
+    struct ExpandRequest
+    {
+        /** Nodes from the root to the node to expand. */
+        std::vector<const SgUctNode*> m_nodes;
+
+        /** Count argument for SgUctThreadState::GenerateAllMoves().
+            Zero for expanding a leaf, the knowledge threshold otherwise. */
+        SgUctValue m_count;
+
+        /** Moves generated by the expand thread. */
+        std::vector<SgUctMoveInfo> m_moves;
+
+        SgUctProvenType m_provenType;
+
+        bool m_deleteChildTrees;
+    };
+
+    /** Protects m_expandQueue, m_expandQueued and m_nuSearchLoopsRunning. */
+    std::mutex m_expandMutex;
+
+    std::condition_variable m_expandAvailable;
+
+    std::deque<ExpandRequest> m_expandQueue;
+
+    /** Nodes queued in the current run of the search loops.
+        Avoids queuing a node again while it is waiting for its expansion. */
+    std::unordered_set<const SgUctNode*> m_expandQueued;
+
+    /** Number of search threads that have not yet left SearchLoop(). */
+    size_t m_nuSearchLoopsRunning;
+
+    /** Threads running SearchLoop() and ExpandLoop().
+        Contains the thread calling Search() and one persistent worker thread
+        for each other search thread and each expand thread. */
+    SgThreadPool m_threadPool;
+
 #if SG_UCTFASTLOG
     SgFastLog m_fastLog;
 #endif
@@ -1123,10 +1374,17 @@ private:
     bool CheckCountAbort(SgUctThreadState& state,
                          SgUctValue remainingGames) const;
 
+    void CountDuplicateNodes(SgUctThreadState& state, const SgUctNode& node);
+
     void Debug(const SgUctThreadState& state, const std::string& textLine);
 
     void DeleteThreads();
 
+    void ExpandBatch(SgUctThreadState& state,
+                     std::vector<ExpandRequest>& batch, GlobalLock* lock);
+
+    void ExpandLoop(SgUctThreadState& state, GlobalLock* lock);
+
     void ExpandNode(SgUctThreadState& state, const SgUctNode& node);
 
     void CreateChildren(SgUctThreadState& state, const SgUctNode& node,
@@ -1142,8 +1400,13 @@ private:
 
     SgUctValue Log(SgUctValue x) const;
 
+    void LookupTransposition(SgUctThreadState& state, const SgUctNode& node);
+
     bool NeedToComputeKnowledge(const SgUctNode* current);
 
+    void QueueExpand(SgUctThreadState& state, const SgUctNode& node,
+                     SgUctValue count);
+
     void PlayGame(SgUctThreadState& state, GlobalLock* lock);
 
     bool PlayInTree(SgUctThreadState& state, bool& isTerminal);
@@ -1158,6 +1421,8 @@ private:
 
     std::string SummaryLine(const SgUctGameInfo& info) const;
 
+    int ThreadCpu(std::size_t threadIndex) const;
+
     void UpdateCheckTimeInterval(double time);
 
     void UpdateDynRaveBias();
@@ -1173,7 +1438,13 @@ private:
 
     void UpdateStatistics(const SgUctGameInfo& info);
 
+    void UpdateTransposition(const SgUctNode& node,
+                             SgUctTranspositionEntry& entry, SgUctValue eval,
+                             SgUctValue count);
+
     void UpdateTree(const SgUctGameInfo& info);
+
+    void WriteAnalyzeInfo(GlobalLock* lock);
 };
 
 inline SgAdditiveKnowledge& SgUctSearch::AdditiveKnowledge()
@@ -1277,6 +1548,21 @@ inline size_t SgUctSearch::NumberThreads() const
     return m_numberThreads;
 }
 
+inline SgUctThreadAffinity SgUctSearch::ThreadAffinity() const
+{
+    return m_threadAffinity;
+}
+
+inline bool SgUctSearch::PhaseStatistics() const
+{
+    return m_phaseStatistics;
+}
+
+inline void SgUctSearch::SetPhaseStatistics(bool enable)
+{
+    m_phaseStatistics = enable;
+}
+
 inline SgUctValue SgUctSearch::CheckTimeInterval() const
 {
     return m_checkTimeInterval;
@@ -1397,6 +1683,49 @@ SgUctSearch::SetMaxKnowledgeThreads(unsigned int threads)
     m_maxKnowledgeThreads = threads;
 }
 
+inline size_t SgUctSearch::NumberExpandThreads() const
+{
+    return m_numberExpandThreads;
+}
+
+inline double SgUctSearch::AnalyzeInterval() const
+{
+    return m_analyzeInterval;
+}
+
+inline size_t SgUctSearch::AnalyzeMoves() const
+{
+    return m_analyzeMoves;
+}
+
+inline size_t SgUctSearch::ExpandBatchSize() const
+{
+    return m_expandBatchSize;
+}
+
+inline void SgUctSearch::SetAnalyzeCallback(const AnalyzeCallback& callback)
+{
+    m_analyzeCallback = callback;
+}
+
+inline void SgUctSearch::SetAnalyzeInterval(double interval)
+{
+    SG_ASSERT(interval >= 0);
+    m_analyzeInterval = interval;
+}
+
+inline void SgUctSearch::SetAnalyzeMoves(size_t n)
+{
+    SG_ASSERT(n >= 1);
+    m_analyzeMoves = n;
+}
+
+inline void SgUctSearch::SetExpandBatchSize(size_t n)
+{
+    SG_ASSERT(n >= 1);
+    m_expandBatchSize = n;
+}
+
 inline void SgUctSearch::SetNumberPlayouts(size_t n)
 {
     SG_ASSERT(n >= 1);
@@ -1474,6 +1803,21 @@ inline void SgUctSearch::SetVirtualLoss(bool enable)
     m_virtualLoss = enable;
 }
 
+inline std::size_t SgUctSearch::TranspositionTableSize() const
+{
+    return m_transpositionTableSize;
+}
+
+inline void SgUctSearch::SetTranspositionTableSize(std::size_t size)
+{
+    m_transpositionTableSize = size;
+}
+
+inline const SgUctTranspositionTable* SgUctSearch::TranspositionTable() const
+{
+    return m_transpositionTable.get();
+}
+
 inline const SgUctSearchStat& SgUctSearch::Statistics() const
 {
     return m_statistics;
@@ -0,0 +1,168 @@
+//----------------------------------------------------------------------------
+/** @file SgUctTranspositionTable.cpp
+    See SgUctTranspositionTable.h */
+//----------------------------------------------------------------------------
+
+#include "SgSystem.h"
+#include "SgUctTranspositionTable.h"
+
+#include <iomanip>
+#include <iostream>
+#include <boost/io/ios_state.hpp>
+#include "SgUctTree.h"
+#include "SgWrite.h"
+
+using boost::io::ios_all_saver;
+using std::fixed;
+using std::setprecision;
+using std::size_t;
+using std::uint64_t;
+
+//----------------------------------------------------------------------------
+
+namespace {
+
+/** The keys are hash codes, but only the lower bits are used for the
+    index, so mix in the upper bits. */
+inline size_t KeyHash(uint64_t key)
+{
+    return static_cast<size_t>(key ^ (key >> 29) ^ (key >> 47));
+}
+
+double Percent(size_t n, size_t total)
+{
+    return total == 0 ? 0 : 100.0 * double(n) / double(total);
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------
+
+SgUctTranspositionStatistics::SgUctTranspositionStatistics()
+{
+    Clear();
+}
+
+void SgUctTranspositionStatistics::Clear()
+{
+    m_nuLookups = 0;
+    m_nuHits = 0;
+    m_nuFull = 0;
+    m_nuSharedPositions = 0;
+    m_nuDuplicateNodes = 0;
+}
+
+void SgUctTranspositionStatistics::Merge(
+                                const SgUctTranspositionStatistics& statistics)
+{
+    m_nuLookups += statistics.m_nuLookups;
+    m_nuHits += statistics.m_nuHits;
+    m_nuFull += statistics.m_nuFull;
+    m_nuSharedPositions += statistics.m_nuSharedPositions;
+    m_nuDuplicateNodes += statistics.m_nuDuplicateNodes;
+}
+
+//----------------------------------------------------------------------------
+
+const size_t SgUctTranspositionTable::MAX_PROBES;
+
+SgUctTranspositionTable::SgUctTranspositionTable(size_t maxEntries)
+{
+    size_t size = 1;
+    while (size < maxEntries)
+        size *= 2;
+    m_mask = size - 1;
+    m_entries.reset(new SgUctTranspositionEntry[size]);
+    Clear();
+}
+
+SgUctTranspositionTable::~SgUctTranspositionTable()
+{ }
+
+void SgUctTranspositionTable::Clear()
+{
+    for (size_t i = 0; i <= m_mask; ++i)
+    {
+        SgUctTranspositionEntry& entry = m_entries[i];
+        entry.m_key.store(0, std::memory_order_relaxed);
+        entry.m_node.store(0, std::memory_order_relaxed);
+        entry.m_statistics.Clear();
+        entry.m_isShared.store(false, std::memory_order_relaxed);
+    }
+}
+
+SgUctTranspositionEntry*
+SgUctTranspositionTable::Lookup(uint64_t key, const SgUctNode& node,
+                                SgUctTranspositionStatistics& statistics)
+{
+    ++statistics.m_nuLookups;
+    if (key == 0)
+        key = 1;
+    size_t index = KeyHash(key) & m_mask;
+    for (size_t i = 0; i < MAX_PROBES; ++i, index = (index + 1) & m_mask)
+    {
+        SgUctTranspositionEntry& entry = m_entries[index];
+        uint64_t entryKey = entry.m_key.load(std::memory_order_acquire);
+        if (entryKey == 0)
+        {
+            if (entry.m_key.compare_exchange_strong(entryKey, key,
+                                                    std::memory_order_acq_rel))
+            {
+                entry.m_node.store(&node, std::memory_order_release);
+                return &entry;
+            }
+            // Another thread claimed the entry, entryKey is its key now
+        }
+        if (entryKey != key)
+            continue;
+        // The node can still be null, if another thread has just claimed the
+        // entry; then it is not known if the entry belongs to another node
+        const SgUctNode* entryNode =
+            entry.m_node.load(std::memory_order_acquire);
+        if (entryNode != 0 && entryNode != &node)
+        {
+            ++statistics.m_nuHits;
+            if (  ! entry.m_isShared.load(std::memory_order_relaxed)
+               && ! entry.m_isShared.exchange(true)
+               )
+                ++statistics.m_nuSharedPositions;
+        }
+        return &entry;
+    }
+    ++statistics.m_nuFull;
+    return 0;
+}
+
+size_t SgUctTranspositionTable::NuEntries() const
+{
+    size_t n = 0;
+    for (size_t i = 0; i <= m_mask; ++i)
+        if (m_entries[i].m_key.load(std::memory_order_relaxed) != 0)
+            ++n;
+    return n;
+}
+
+void SgUctTranspositionTable::Write(std::ostream& out,
+                               const SgUctTranspositionStatistics& statistics,
+                               size_t nuNodes) const
+{
+    ios_all_saver saver(out);
+    const size_t nuEntries = NuEntries();
+    const size_t duplicateBytes =
+        statistics.m_nuDuplicateNodes * sizeof(SgUctNode);
+    out << fixed << setprecision(1)
+        << SgWriteLabel("TT entries") << nuEntries << " / " << MaxEntries()
+        << " (" << Percent(nuEntries, MaxEntries()) << "%, "
+        << MemoryUsed() / (1024 * 1024) << " MB)\n"
+        << SgWriteLabel("TT lookups") << statistics.m_nuLookups
+        << " (hits " << Percent(statistics.m_nuHits, statistics.m_nuLookups)
+        << "%, full "
+        << Percent(statistics.m_nuFull, statistics.m_nuLookups) << "%)\n"
+        << SgWriteLabel("TT shared") << statistics.m_nuSharedPositions
+        << " positions\n"
+        << SgWriteLabel("TT duplicate") << statistics.m_nuDuplicateNodes
+        << " nodes (" << Percent(statistics.m_nuDuplicateNodes, nuNodes)
+        << "% of tree, " << duplicateBytes / 1024 << " KB)\n";
+}
+
+//----------------------------------------------------------------------------
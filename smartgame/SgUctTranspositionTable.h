@@ -0,0 +1,157 @@
+//----------------------------------------------------------------------------
+/** @file SgUctTranspositionTable.h
+    Lock-free transposition table for sharing statistics between the nodes
+    of SgUctSearch with the same position. */
+//----------------------------------------------------------------------------
+
+#ifndef SG_UCTTRANSPOSITIONTABLE_H
+#define SG_UCTTRANSPOSITIONTABLE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include "SgUctValue.h"
+
+class SgUctNode;
+
+//----------------------------------------------------------------------------
+
+/** Entry of SgUctTranspositionTable.
+    @ingroup sguctgroup */
+struct SgUctTranspositionEntry
+{
+    /** Hash code of the position, zero if the entry is empty. */
+    std::atomic<std::uint64_t> m_key;
+
+    /** The first node that looked up the entry. */
+    std::atomic<const SgUctNode*> m_node;
+
+    /** Move statistics of all nodes with the position.
+        From the view of the player who made the move to the position, like
+        the statistics of SgUctNode. */
+    SgUctStatisticsPacked m_statistics;
+
+    /** Was the entry looked up by more than one node? */
+    std::atomic<bool> m_isShared;
+};
+
+//----------------------------------------------------------------------------
+
+/** Counters of the lookups in SgUctTranspositionTable.
+    Each search thread keeps its own counters to avoid contention.
+    @ingroup sguctgroup */
+struct SgUctTranspositionStatistics
+{
+    /** Number of lookups. */
+    std::size_t m_nuLookups;
+
+    /** Number of lookups that found an entry of another node. */
+    std::size_t m_nuHits;
+
+    /** Number of lookups that found no free entry. */
+    std::size_t m_nuFull;
+
+    /** Number of entries that became shared by the lookup. */
+    std::size_t m_nuSharedPositions;
+
+    /** Number of children created for nodes, whose position was first
+        reached at another node of the tree.
+        An estimate of the number of nodes that a search, which also shares
+        the subtrees of transpositions, would not need to create. */
+    std::size_t m_nuDuplicateNodes;
+
+    SgUctTranspositionStatistics();
+
+    void Clear();
+
+    /** Add the counters of another statistics. */
+    void Merge(const SgUctTranspositionStatistics& statistics);
+};
+
+//----------------------------------------------------------------------------
+
+/** Lock-free transposition table for SgUctSearch.
+    Maps the hash code of a position to the combined move statistics of all
+    nodes in the search tree with this position, such that transpositions
+    reached by different move orders share their statistics. This
+    corresponds to the variant UCT2 in: Childs, Brodeur, Kocsis:
+    <a href="http://ieeexplore.ieee.org/document/5035667/">
+    Transpositions and Move Groups in Monte Carlo Tree Search</a>, CIG 2008.
+    The tree itself remains a tree; only the statistics are shared.
+
+    The table uses open addressing with linear probing in an array of fixed
+    size. An entry is claimed with a compare-and-swap of its key and stays
+    in the table until Clear(); the statistics are updated with a single
+    compare-and-swap (see SgStatisticsPackedBase). Therefore lookups and
+    updates from several threads need no lock. If no free entry is found
+    within MAX_PROBES probes, the position is not stored.
+    @ingroup sguctgroup */
+class SgUctTranspositionTable
+{
+public:
+    /** Maximum number of entries probed in a lookup. */
+    static const std::size_t MAX_PROBES = 8;
+
+    /** Create table.
+        @param maxEntries The size is maxEntries rounded up to a power of
+        two. */
+    explicit SgUctTranspositionTable(std::size_t maxEntries);
+
+    ~SgUctTranspositionTable();
+
+    /** Remove all entries.
+        Not thread-safe, must not be called during a search. */
+    void Clear();
+
+    /** Find or create the entry for a position.
+        @param key The hash code of the position. Zero is mapped to another
+        value, because it marks empty entries.
+        @param node The node with the position.
+        @param[in,out] statistics The counters to update.
+        @return The entry, or null if the table is full at the position of
+        the key. */
+    SgUctTranspositionEntry* Lookup(std::uint64_t key, const SgUctNode& node,
+                                    SgUctTranspositionStatistics& statistics);
+
+    /** Number of entries in use.
+        Counts the entries, so it should not be called during a search. */
+    std::size_t NuEntries() const;
+
+    /** Size of the table. */
+    std::size_t MaxEntries() const;
+
+    /** Memory used by the entries in bytes. */
+    std::size_t MemoryUsed() const;
+
+    /** Write the table usage and the counters of a search. */
+    void Write(std::ostream& out,
+               const SgUctTranspositionStatistics& statistics,
+               std::size_t nuNodes) const;
+
+private:
+    std::size_t m_mask;
+
+    std::unique_ptr<SgUctTranspositionEntry[]> m_entries;
+
+    /** Not implemented. */
+    SgUctTranspositionTable(const SgUctTranspositionTable&);
+
+    /** Not implemented. */
+    SgUctTranspositionTable& operator=(const SgUctTranspositionTable&);
+};
+
+inline std::size_t SgUctTranspositionTable::MaxEntries() const
+{
+    return m_mask + 1;
+}
+
+inline std::size_t SgUctTranspositionTable::MemoryUsed() const
+{
+    return MaxEntries() * sizeof(SgUctTranspositionEntry);
+}
+
+//----------------------------------------------------------------------------
+
+#endif // SG_UCTTRANSPOSITIONTABLE_H
@@ -14,40 +14,198 @@ using boost::format;
 
 //----------------------------------------------------------------------------
 
+const std::size_t SgUctNodePool::MAX_CHUNK_SIZE;
+
+SgUctNodePool::SgUctNodePool()
+    : m_chunkSize(0),
+      m_maxChunks(0),
+      m_nuFreeChunks(0)
+{ }
+
+SgUctNodePool::~SgUctNodePool()
+{
+    FreeAll();
+}
+
+SgUctNode* SgUctNodePool::Acquire(std::size_t home)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_nuFreeChunks > 0)
+    {
+        const std::size_t nuLists = m_freeChunks.size();
+        for (std::size_t i = 0; i < nuLists; ++i)
+        {
+            std::vector<SgUctNode*>& freeChunks =
+                m_freeChunks[(home + i) % nuLists];
+            if (! freeChunks.empty())
+            {
+                SgUctNode* chunk = freeChunks.back();
+                freeChunks.pop_back();
+                --m_nuFreeChunks;
+                return chunk;
+            }
+        }
+        SG_ASSERT(false);
+    }
+    if (m_chunks.size() >= m_maxChunks)
+        return 0;
+    // Don't throw std::bad_alloc, this is called by the search threads.
+    // Running out of system memory is handled like a full tree.
+    void* ptr = std::malloc(m_chunkSize * sizeof(SgUctNode));
+    if (ptr == 0)
+        return 0;
+    SgUctNode* chunk = static_cast<SgUctNode*>(ptr);
+    m_chunks.push_back(chunk);
+    return chunk;
+}
+
+bool SgUctNodePool::CanAcquire() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_nuFreeChunks > 0 || m_chunks.size() < m_maxChunks;
+}
+
+void SgUctNodePool::FreeAll()
+{
+    SG_ASSERT(m_nuFreeChunks == m_chunks.size());
+    for (SgUctNode* chunk : m_chunks)
+        std::free(chunk);
+    m_chunks.clear();
+    m_freeChunks.clear();
+    m_nuFreeChunks = 0;
+}
+
+std::size_t SgUctNodePool::NuUsedChunks() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_chunks.size() - m_nuFreeChunks;
+}
+
+void SgUctNodePool::Release(SgUctNode* chunk, std::size_t home)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (home >= m_freeChunks.size())
+        m_freeChunks.resize(home + 1);
+    m_freeChunks[home].push_back(chunk);
+    ++m_nuFreeChunks;
+}
+
+bool SgUctNodePool::Reserve(std::size_t nuChunks, std::size_t nuAllocators)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    nuChunks = std::min(nuChunks, m_maxChunks);
+    if (m_freeChunks.size() < std::max(nuAllocators, std::size_t(1)))
+        m_freeChunks.resize(std::max(nuAllocators, std::size_t(1)));
+    while (m_chunks.size() < nuChunks)
+    {
+        void* ptr = std::malloc(m_chunkSize * sizeof(SgUctNode));
+        if (ptr == 0)
+            return false;
+        SgUctNode* chunk = static_cast<SgUctNode*>(ptr);
+        m_chunks.push_back(chunk);
+        m_freeChunks[m_chunks.size() % m_freeChunks.size()].push_back(chunk);
+        ++m_nuFreeChunks;
+    }
+    return true;
+}
+
+void SgUctNodePool::SetMaxNodes(std::size_t maxNodes, std::size_t chunkSize)
+{
+    SG_ASSERT(chunkSize > 0);
+    FreeAll();
+    m_chunkSize = chunkSize;
+    m_maxChunks = maxNodes / chunkSize;
+    m_chunks.reserve(m_maxChunks);
+}
+
+//----------------------------------------------------------------------------
+
 SgUctAllocator::~SgUctAllocator()
 {
+    Clear();
+}
+
+void SgUctAllocator::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_chunksMutex);
+    for (const Chunk& chunk : m_fullChunks)
+    {
+        DestructNodes(chunk.first, chunk.second);
+        m_pool->Release(chunk.first, m_poolIndex);
+    }
+    m_fullChunks.clear();
     if (m_start != 0)
     {
-        Clear();
-        std::free(m_start);
+        DestructNodes(m_start, m_finish);
+        m_pool->Release(m_start, m_poolIndex);
     }
+    m_nuNodesFullChunks = 0;
+    m_start = 0;
+    m_finish = 0;
+    m_endOfStorage = 0;
 }
 
 bool SgUctAllocator::Contains(const SgUctNode& node) const
 {
-    return (&node >= m_start && &node < m_finish);
+    // The current chunk is checked up to its end of storage, because m_finish
+    // is changed by the owning thread without locking
+    std::lock_guard<std::mutex> lock(m_chunksMutex);
+    if (  m_start != 0
+       && &node >= m_start && &node < m_start + m_pool->ChunkSize()
+       )
+        return true;
+    for (const Chunk& chunk : m_fullChunks)
+        if (&node >= chunk.first && &node < chunk.second)
+            return true;
+    return false;
 }
 
-void SgUctAllocator::Swap(SgUctAllocator& allocator)
+void SgUctAllocator::DestructNodes(SgUctNode* start, SgUctNode* finish)
 {
-    std::swap(m_start, allocator.m_start);
-    std::swap(m_finish, allocator.m_finish);
-    std::swap(m_endOfStorage, allocator.m_endOfStorage);
+    for (SgUctNode* it = start; it != finish; ++it)
+        it->~SgUctNode();
 }
 
-void SgUctAllocator::SetMaxNodes(std::size_t maxNodes)
+bool SgUctAllocator::NextChunk(std::size_t n)
 {
+    SG_ASSERT(m_pool != 0);
+    if (n > m_pool->ChunkSize())
+        return false;
+    SgUctNode* chunk = m_pool->Acquire(m_poolIndex);
+    if (chunk == 0)
+        return false;
+    std::lock_guard<std::mutex> lock(m_chunksMutex);
     if (m_start != 0)
     {
-        Clear();
-        std::free(m_start);
+        m_fullChunks.push_back(Chunk(m_start, m_finish));
+        m_nuNodesFullChunks += m_finish - m_start;
     }
-    void* ptr = std::malloc(maxNodes * sizeof(SgUctNode));
-    if (ptr == 0)
-        throw std::bad_alloc();
-    m_start = static_cast<SgUctNode*>(ptr);
-    m_finish = m_start;
-    m_endOfStorage = m_start + maxNodes;
+    m_start = chunk;
+    m_finish = chunk;
+    m_endOfStorage = chunk + m_pool->ChunkSize();
+    return true;
+}
+
+void SgUctAllocator::SetPool(SgUctNodePool* pool, std::size_t index)
+{
+    Clear();
+    m_pool = pool;
+    m_poolIndex = index;
+}
+
+void SgUctAllocator::Swap(SgUctAllocator& allocator)
+{
+    std::lock(m_chunksMutex, allocator.m_chunksMutex);
+    std::lock_guard<std::mutex> lock(m_chunksMutex, std::adopt_lock);
+    std::lock_guard<std::mutex> lock2(allocator.m_chunksMutex,
+                                      std::adopt_lock);
+    std::swap(m_pool, allocator.m_pool);
+    std::swap(m_poolIndex, allocator.m_poolIndex);
+    m_fullChunks.swap(allocator.m_fullChunks);
+    std::swap(m_nuNodesFullChunks, allocator.m_nuNodesFullChunks);
+    std::swap(m_start, allocator.m_start);
+    std::swap(m_finish, allocator.m_finish);
+    std::swap(m_endOfStorage, allocator.m_endOfStorage);
 }
 
 //----------------------------------------------------------------------------
@@ -68,14 +226,19 @@ std::ostream& operator<<(std::ostream& stream, const SgUctMoveInfo& info)
 
 SgUctTree::SgUctTree()
     : m_maxNodes(0),
-      m_root(SG_NULLMOVE)
+      m_root(SG_NULLMOVE),
+      m_pool(new SgUctNodePool())
 { }
 
 void SgUctTree::ApplyFilter(std::size_t allocatorId, const SgUctNode& node,
                             const vector<SgMove>& rootFilter)
 {
     SG_ASSERT(Contains(node));
-    SG_ASSERT(Allocator(allocatorId).HasCapacity(node.NuChildren()));
+    // Also takes a new chunk from the pool, if needed
+    const bool hasCapacity =
+        Allocator(allocatorId).EnsureCapacity(node.NuChildren());
+    SG_ASSERT(hasCapacity);
+    SG_DEBUG_ONLY(hasCapacity);
     if (! node.HasChildren())
         return;
 
@@ -112,7 +275,11 @@ void SgUctTree::SetChildren(std::size_t allocatorId, const SgUctNode& node,
                             const vector<SgMove>& moves)
 {
     SG_ASSERT(Contains(node));
-    SG_ASSERT(Allocator(allocatorId).HasCapacity(moves.size()));
+    // Also takes a new chunk from the pool, if needed
+    const bool hasCapacity =
+        Allocator(allocatorId).EnsureCapacity(moves.size());
+    SG_ASSERT(hasCapacity);
+    SG_DEBUG_ONLY(hasCapacity);
     SG_ASSERT(node.HasChildren());
 
     SgUctAllocator& allocator = Allocator(allocatorId);
@@ -236,7 +403,7 @@ SgUctProvenType SgUctTree::CopySubtree(SgUctTree& target, SgUctNode& targetNode,
     int nuChildren = node.NuChildren();
     if (! abort)
     {
-        if (! targetAllocator.HasCapacity(nuChildren))
+        if (! targetAllocator.EnsureCapacity(nuChildren))
         {
             // This can happen even if target tree has same maximum number of
             // nodes, because allocators are used differently.
@@ -305,15 +472,20 @@ void SgUctTree::CreateAllocators(std::size_t nuThreads)
     for (size_t i = 0; i < nuThreads; ++i)
     {
         m_allocators.emplace_back(std::make_shared<SgUctAllocator>());
+        m_allocators.back()->SetPool(m_pool.get(), i);
     }
 }
 
 void SgUctTree::DumpDebugInfo(std::ostream& out) const
 {
-    out << "Root " << &m_root << '\n';
+    out << "Root " << &m_root << '\n'
+        << "Chunks used=" << m_pool->NuUsedChunks()
+        << " max=" << m_pool->MaxChunks()
+        << " size=" << m_pool->ChunkSize() << '\n';
     for (size_t i = 0; i < NuAllocators(); ++i)
         out << "Allocator " << i
             << " size=" << Allocator(i).NuNodes()
+            << " chunks=" << Allocator(i).NuChunks()
             << " start=" << Allocator(i).Start()
             << " finish=" << Allocator(i).Finish() << '\n';
 }
@@ -355,7 +527,10 @@ void SgUctTree::MergeChildren(std::size_t allocatorId, const SgUctNode& node,
     }
 
     SgUctAllocator& allocator = Allocator(allocatorId);
-    SG_ASSERT(allocator.HasCapacity(nuNewChildren));
+    // Also takes a new chunk from the pool, if needed
+    const bool hasCapacity = allocator.EnsureCapacity(nuNewChildren);
+    SG_ASSERT(hasCapacity);
+    SG_DEBUG_ONLY(hasCapacity);
 
     const SgUctNode* newFirstChild = allocator.Finish();
     SgUctValue parentCount = allocator.Create(moves);
@@ -414,6 +589,17 @@ std::size_t SgUctTree::NuNodes() const
     return nuNodes;
 }
 
+void SgUctTree::Reroot(const SgUctNode& node)
+{
+    SG_ASSERT(Contains(node));
+    SG_ASSERT(&node != &m_root);
+    int nuChildren = node.NuChildren();
+    const SgUctNode* firstChild = (nuChildren > 0 ? node.FirstChild() : 0);
+    m_root.CopyDataFrom(node);
+    m_root.SetFirstChild(firstChild);
+    m_root.SetNuChildren(nuChildren);
+}
+
 void SgUctTree::SetMaxNodes(std::size_t maxNodes)
 {
     Clear();
@@ -425,9 +611,20 @@ void SgUctTree::SetMaxNodes(std::size_t maxNodes)
         return;
     }
     m_maxNodes = maxNodes;
-    size_t maxNodesPerAlloc = maxNodes / nuAllocators;
+    size_t chunkSize = std::min(SgUctNodePool::MAX_CHUNK_SIZE,
+                                maxNodes / nuAllocators);
+    m_pool->SetMaxNodes(maxNodes, std::max(chunkSize, size_t(1)));
     for (size_t i = 0; i < NuAllocators(); ++i)
-        Allocator(i).SetMaxNodes(maxNodesPerAlloc);
+        Allocator(i).SetPool(m_pool.get(), i);
+}
+
+bool SgUctTree::Reserve(std::size_t nuNodes)
+{
+    const size_t chunkSize = m_pool->ChunkSize();
+    if (chunkSize == 0)
+        return true;
+    return m_pool->Reserve((nuNodes + chunkSize - 1) / chunkSize,
+                           NuAllocators());
 }
 
 void SgUctTree::Swap(SgUctTree& tree)
@@ -436,6 +633,7 @@ void SgUctTree::Swap(SgUctTree& tree)
     SG_ASSERT(NuAllocators() == tree.NuAllocators());
     using std::swap;
     swap(m_root, tree.m_root);
+    swap(m_pool, tree.m_pool);
     for (size_t i = 0; i < NuAllocators(); ++i)
         Allocator(i).Swap(tree.Allocator(i));
 }
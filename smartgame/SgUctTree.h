@@ -10,6 +10,9 @@
 #include <stack>
 #include <memory>
 #include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
 #include "SgMove.h"
 #include "SgStatistics.h"
 #include "SgStatisticsVlt.h"
@@ -23,6 +26,35 @@ typedef SgStatisticsBase<float,std::size_t> SgUctStatisticsBase;
 
 typedef SgStatisticsVltBase<float,std::size_t> SgUctStatisticsBaseVolatile;
 
+/** @def SG_UCT_COMPACT_NODE
+    Use the compact node layout of SgUctNode.
+    Enabled with the CMake option FUEGO_UCT_COMPACT_NODE.
+    @see SgUctNode */
+#ifndef SG_UCT_COMPACT_NODE
+#define SG_UCT_COMPACT_NODE 0
+#endif
+
+#if SG_UCT_COMPACT_NODE
+
+/** Statistics type used for move and RAVE values in SgUctNode. */
+typedef SgUctStatisticsPacked SgUctNodeStatistics;
+
+/** Type used for counts stored in SgUctNode.
+    Nothing clamps the counts. A float represents all integers only up to
+    2^24, larger counts are rounded and adding one to them has no effect.
+    If SgUctSearch::CheckFloatPrecision() is enabled, the search stops when
+    the count of the root reaches this limit (see
+    SgUctValueUtil::IsPrecise()). */
+typedef float SgUctNodeCount;
+
+#else
+
+typedef SgUctStatisticsVolatile SgUctNodeStatistics;
+
+typedef SgUctValue SgUctNodeCount;
+
+#endif
+
 //----------------------------------------------------------------------------
 
 /** Used for node creation. */
@@ -117,6 +149,15 @@ typedef enum
     relies on the fact that m_firstChild is valid, if m_nuChildren is greater
     zero or that the mean value of the move and RAVE value statistics is valid
     if the corresponding count is greater zero.
+
+    If SG_UCT_COMPACT_NODE is set, a compact layout is used: move and RAVE
+    statistics store count and mean as floats packed into one 64-bit word
+    that is updated with a single compare-and-swap (see
+    SgStatisticsPackedBase), the move and the number of children share
+    another 64-bit word, and the remaining counts use single precision. This
+    reduces the node size from 80 to 48 bytes on 64-bit platforms and removes
+    lost and torn statistics updates in lock-free mode, at the cost of
+    limiting counts to the precision of a float.
     @ingroup sguctgroup */
 /** apotocki note: that's absolutely the wrong approach. OK, volatile makes the compiler stop reordering code,
     but code execution can be reordered in runtime by modern processors.
@@ -264,7 +305,35 @@ public:
     void SetProvenType(SgUctProvenType type);
 
 private:
-    SgUctStatisticsVolatile m_statistics;
+#if SG_UCT_COMPACT_NODE
+
+    std::atomic<const SgUctNode*> m_firstChild;
+
+    SgUctNodeStatistics m_statistics;
+
+    /** RAVE statistics. */
+    SgUctNodeStatistics m_raveValue;
+
+    /** Move in the upper 32 bits, number of children in the lower 32 bits.
+        See PackMoveAndNuChildren() */
+    std::atomic<std::uint64_t> m_moveAndNuChildren;
+
+    std::atomic<SgUctNodeCount> m_posCount;
+
+    std::atomic<SgUctNodeCount> m_knowledgeCount;
+
+    /* Value of additive predictor */
+    std::atomic<float> m_predictorValue;
+
+    std::atomic<std::int16_t> m_virtualLossCount;
+
+    std::atomic<std::uint8_t> m_provenType;
+
+    static std::uint64_t PackMoveAndNuChildren(SgMove move, int nuChildren);
+
+#else
+
+    SgUctNodeStatistics m_statistics;
 
     std::atomic<const SgUctNode*> m_firstChild;
 
@@ -278,17 +347,56 @@ private:
     /** RAVE statistics.
         Uses double for count to allow adding fractional values if RAVE
         updates are weighted. */
-    SgUctStatisticsVolatile m_raveValue;
+    SgUctNodeStatistics m_raveValue;
 
-    std::atomic<SgUctValue> m_posCount;
+    std::atomic<SgUctNodeCount> m_posCount;
 
-    std::atomic<SgUctValue> m_knowledgeCount;
+    std::atomic<SgUctNodeCount> m_knowledgeCount;
 
     std::atomic<SgUctProvenType> m_provenType;
 
     std::atomic<int> m_virtualLossCount;
+
+#endif
 };
 
+#if SG_UCT_COMPACT_NODE
+
+inline std::uint64_t SgUctNode::PackMoveAndNuChildren(SgMove move,
+                                                      int nuChildren)
+{
+    return (std::uint64_t(std::uint32_t(move)) << 32)
+        | std::uint32_t(nuChildren);
+}
+
+inline SgUctNode::SgUctNode(const SgUctMoveInfo& info)
+    : m_statistics(info.m_value, info.m_count),
+      m_raveValue(info.m_raveValue, info.m_raveCount),
+      m_moveAndNuChildren(PackMoveAndNuChildren(info.m_move, 0)),
+      m_posCount(0),
+      m_knowledgeCount(0),
+      m_predictorValue(info.m_predictorValue),
+      m_virtualLossCount(0),
+      m_provenType(SG_NOT_PROVEN)
+{
+    // m_firstChild is not initialized, only defined if NuChildren() > 0
+}
+
+inline SgUctNode& SgUctNode::operator=(const SgUctMoveInfo& info)
+{
+    m_statistics = SgUctNodeStatistics(info.m_value, info.m_count);
+    m_raveValue = SgUctNodeStatistics(info.m_raveValue, info.m_raveCount);
+    m_moveAndNuChildren.store(PackMoveAndNuChildren(info.m_move, 0));
+    m_posCount.store(0);
+    m_knowledgeCount.store(0);
+    m_predictorValue.store(info.m_predictorValue);
+    m_virtualLossCount.store(0);
+    m_provenType.store(SG_NOT_PROVEN);
+    return *this;
+}
+
+#else
+
 inline SgUctNode::SgUctNode(const SgUctMoveInfo& info)
     : m_statistics(info.m_value, info.m_count),
       m_nuChildren(0),
@@ -305,11 +413,11 @@ inline SgUctNode::SgUctNode(const SgUctMoveInfo& info)
 
 inline SgUctNode& SgUctNode::operator=(const SgUctMoveInfo& info)
 {
-    m_statistics = SgUctStatisticsVolatile(info.m_value, info.m_count);
+    m_statistics = SgUctNodeStatistics(info.m_value, info.m_count);
     m_nuChildren.store(0);
     m_move.store(info.m_move);
     m_predictorValue.store(info.m_predictorValue);
-    m_raveValue = SgUctStatisticsVolatile(info.m_raveValue, info.m_raveCount);
+    m_raveValue = SgUctNodeStatistics(info.m_raveValue, info.m_raveCount);
     m_posCount.store(0);
     m_knowledgeCount.store(0);
     m_provenType.store(SG_NOT_PROVEN);
@@ -317,6 +425,8 @@ inline SgUctNode& SgUctNode::operator=(const SgUctMoveInfo& info)
     return *this;
 }
 
+#endif
+
 template <typename T>
 void fuzzy_swap(std::atomic<T> &l, std::atomic<T> &r)
 {
@@ -328,6 +438,17 @@ void fuzzy_swap(std::atomic<T> &l, std::atomic<T> &r)
 inline void swap(SgUctNode & l, SgUctNode & r)
 {
     using std::swap;
+#if SG_UCT_COMPACT_NODE
+    swap(l.m_statistics, r.m_statistics);
+    swap(l.m_raveValue, r.m_raveValue);
+    fuzzy_swap(l.m_firstChild, r.m_firstChild);
+    fuzzy_swap(l.m_moveAndNuChildren, r.m_moveAndNuChildren);
+    fuzzy_swap(l.m_posCount, r.m_posCount);
+    fuzzy_swap(l.m_knowledgeCount, r.m_knowledgeCount);
+    fuzzy_swap(l.m_predictorValue, r.m_predictorValue);
+    fuzzy_swap(l.m_virtualLossCount, r.m_virtualLossCount);
+    fuzzy_swap(l.m_provenType, r.m_provenType);
+#else
     swap(l.m_statistics, r.m_statistics);
     fuzzy_swap(l.m_firstChild, r.m_firstChild);
     fuzzy_swap(l.m_nuChildren, r.m_nuChildren);
@@ -338,6 +459,7 @@ inline void swap(SgUctNode & l, SgUctNode & r)
     fuzzy_swap(l.m_knowledgeCount, r.m_knowledgeCount);
     fuzzy_swap(l.m_provenType, r.m_provenType);
     fuzzy_swap(l.m_virtualLossCount, r.m_virtualLossCount);
+#endif
 }
 
 inline void SgUctNode::AddGameResult(SgUctValue eval)
@@ -385,6 +507,17 @@ inline void SgUctNode::RemoveRaveValue(SgUctValue value, SgUctValue weight)
 
 inline void SgUctNode::CopyDataFrom(const SgUctNode& node)
 {
+#if SG_UCT_COMPACT_NODE
+    m_statistics = node.m_statistics;
+    m_raveValue = node.m_raveValue;
+    SgMove move = SgMove(std::int32_t(node.m_moveAndNuChildren.load() >> 32));
+    m_moveAndNuChildren.store(PackMoveAndNuChildren(move, NuChildren()));
+    m_posCount.store(node.m_posCount.load());
+    m_knowledgeCount.store(node.m_knowledgeCount.load());
+    m_predictorValue.store(node.m_predictorValue.load());
+    m_virtualLossCount.store(node.m_virtualLossCount.load());
+    m_provenType.store(node.m_provenType.load());
+#else
     m_statistics = node.m_statistics;
     m_move.store(node.m_move.load());
     m_predictorValue.store(node.m_predictorValue.load());
@@ -393,6 +526,7 @@ inline void SgUctNode::CopyDataFrom(const SgUctNode& node)
     m_knowledgeCount.store(node.m_knowledgeCount.load());
     m_provenType.store(node.m_provenType.load());
     m_virtualLossCount.store(node.m_virtualLossCount.load());
+#endif
 }
 
 inline const SgUctNode* SgUctNode::FirstChild() const
@@ -416,7 +550,7 @@ inline bool SgUctNode::HasChildren() const
     // memory synchronization below is necessary on architectures that
     // do not guarantee read order consistency.
 
-    bool retval = (m_nuChildren > 0);
+    bool retval = (NuChildren() > 0);
     SgSynchronizeThreadMemory();
     return retval;
 }
@@ -456,15 +590,15 @@ inline void SgUctNode::IncPosCount()
 
 inline void SgUctNode::IncPosCount(SgUctValue count)
 {
-    SgUctValue prev_value;
-    {
-        prev_value = m_posCount.load();
-    } while (!m_posCount.compare_exchange_strong(prev_value, prev_value + count));
+    SgUctNodeCount prev_value = m_posCount.load();
+    while (! m_posCount.compare_exchange_weak(prev_value,
+                                   SgUctNodeCount(prev_value + count)))
+        ;
 }
 
 inline void SgUctNode::DecPosCount()
 {
-    SgUctValue posCount = m_posCount;
+    SgUctNodeCount posCount = m_posCount;
     if (posCount > 0)
     {
         m_posCount = posCount - 1;
@@ -473,10 +607,10 @@ inline void SgUctNode::DecPosCount()
 
 inline void SgUctNode::DecPosCount(SgUctValue count)
 {
-    SgUctValue posCount = m_posCount;
+    SgUctNodeCount posCount = m_posCount;
     if (posCount >= count)
     {
-        m_posCount = posCount - count;
+        m_posCount = SgUctNodeCount(posCount - count);
     }
 }
 
@@ -497,8 +631,13 @@ inline SgUctValue SgUctNode::Mean() const
 
 inline SgMove SgUctNode::Move() const
 {
-    SG_ASSERT(m_move != SG_NULLMOVE);
-    return m_move;
+#if SG_UCT_COMPACT_NODE
+    SgMove move = SgMove(std::int32_t(m_moveAndNuChildren.load() >> 32));
+#else
+    SgMove move = m_move;
+#endif
+    SG_ASSERT(move != SG_NULLMOVE);
+    return move;
 }
 
 inline SgUctValue SgUctNode::MoveCount() const
@@ -508,7 +647,11 @@ inline SgUctValue SgUctNode::MoveCount() const
 
 inline int SgUctNode::NuChildren() const
 {
+#if SG_UCT_COMPACT_NODE
+    return int(std::int32_t(m_moveAndNuChildren.load()));
+#else
     return m_nuChildren;
+#endif
 }
 
 inline SgUctValue SgUctNode::PosCount() const
@@ -539,12 +682,22 @@ inline void SgUctNode::SetFirstChild(const SgUctNode* child)
 inline void SgUctNode::SetNuChildren(int nuChildren)
 {
     SG_ASSERT(nuChildren >= 0);
+#if SG_UCT_COMPACT_NODE
+    // The move part never changes after construction, the CAS loop only
+    // keeps it intact if several threads expand the node concurrently
+    std::uint64_t oldValue = m_moveAndNuChildren.load();
+    while (! m_moveAndNuChildren.compare_exchange_weak(oldValue,
+                 PackMoveAndNuChildren(SgMove(std::int32_t(oldValue >> 32)),
+                                       nuChildren)))
+        ;
+#else
     m_nuChildren = nuChildren;
+#endif
 }
 
 inline void SgUctNode::SetPosCount(SgUctValue value)
 {
-    m_posCount = value;
+    m_posCount = SgUctNodeCount(value);
 }
 
 inline SgUctValue SgUctNode::KnowledgeCount() const
@@ -554,39 +707,161 @@ inline SgUctValue SgUctNode::KnowledgeCount() const
 
 inline void SgUctNode::SetKnowledgeCount(SgUctValue count)
 {
-    m_knowledgeCount = count;
+    m_knowledgeCount = SgUctNodeCount(count);
 }
 
 inline bool SgUctNode::IsProven() const
 {
-    return m_provenType != SG_NOT_PROVEN;
+    return ProvenType() != SG_NOT_PROVEN;
 }
 
 inline bool SgUctNode::IsProvenWin() const
 {
-    return m_provenType == SG_PROVEN_WIN;
+    return ProvenType() == SG_PROVEN_WIN;
 }
 
 inline bool SgUctNode::IsProvenLoss() const
 {
-    return m_provenType == SG_PROVEN_LOSS;
+    return ProvenType() == SG_PROVEN_LOSS;
 }
 
 inline SgUctProvenType SgUctNode::ProvenType() const
 {
+#if SG_UCT_COMPACT_NODE
+    return SgUctProvenType(m_provenType.load());
+#else
     return m_provenType;
+#endif
 }
 
 inline void SgUctNode::SetProvenType(SgUctProvenType type)
 {
+#if SG_UCT_COMPACT_NODE
+    m_provenType = std::uint8_t(type);
+#else
     m_provenType = type;
+#endif
+}
+
+//----------------------------------------------------------------------------
+
+/** Shared pool of fixed-size chunks of node storage for SgUctAllocator.
+    The memory of a chunk is only allocated when a chunk is requested for
+    the first time. Chunks returned with Release() are kept in a free list
+    and reused; the memory is only freed in SetMaxNodes() and in the
+    destructor. The total number of chunks is bounded by the maximum number of
+    nodes of the tree. Acquire() and Release() are thread-safe.
+
+    Chunks are returned to the pool when an allocator is cleared, so nodes
+    are recycled one tree at a time, not one subtree at a time. SgUctSearch
+    clears the tree it no longer needs right after it is replaced by a tree
+    from SgUctTree::ExtractSubtree() or SgUctTree::CopyPruneLowCount(), so
+    its chunks are reused by the next extraction or prune. Nodes that become
+    unreachable in the tree that is searched (siblings of the new root after
+    SgUctTree::Reroot(), or children replaced by SgUctTree::MergeChildren())
+    are not recycled until the tree is pruned or cleared. They share chunks
+    with reachable nodes, and in lock-free mode other threads may still read
+    them.
+    @ingroup sguctgroup */
+class SgUctNodePool
+{
+public:
+    /** Maximum number of nodes in a chunk.
+        Must be larger than the maximum number of children of a node. */
+    static const std::size_t MAX_CHUNK_SIZE = 4096;
+
+    SgUctNodePool();
+
+    ~SgUctNodePool();
+
+    /** Get a chunk.
+        Prefers a chunk from the free list of the allocator, then a chunk from
+        any other free list and allocates a new chunk only if all free lists
+        are empty. New chunks are first written by the thread that acquires
+        them, so with first-touch memory placement, the chunks of a thread
+        bound to a CPU stay on its NUMA node.
+        @param home The index of the allocator
+        @return The start of the chunk or 0, if the maximum number of chunks
+        is reached or the memory allocation failed */
+    SgUctNode* Acquire(std::size_t home);
+
+    /** Check if Acquire() can return a chunk.
+        Does not check if the memory for a new chunk can be allocated. */
+    bool CanAcquire() const;
+
+    /** Return a chunk to the free list of an allocator.
+        The nodes in the chunk must already be destructed.
+        @param chunk The chunk
+        @param home The index of the allocator that used the chunk */
+    void Release(SgUctNode* chunk, std::size_t home);
+
+    std::size_t ChunkSize() const;
+
+    std::size_t MaxChunks() const;
+
+    /** Number of chunks currently in use by allocators. */
+    std::size_t NuUsedChunks() const;
+
+    /** Allocate the memory of chunks in advance.
+        Puts new chunks into the free lists until there are nuChunks chunks
+        with allocated memory or the maximum number of chunks is reached.
+        @param nuChunks The number of chunks
+        @param nuAllocators The number of allocators, the chunks are
+        distributed over their free lists
+        @return false if the memory allocation failed */
+    bool Reserve(std::size_t nuChunks, std::size_t nuAllocators);
+
+    /** Free all memory and change chunk size and number of chunks.
+        All chunks must have been returned with Release(). */
+    void SetMaxNodes(std::size_t maxNodes, std::size_t chunkSize);
+
+private:
+    mutable std::mutex m_mutex;
+
+    std::size_t m_chunkSize;
+
+    std::size_t m_maxChunks;
+
+    /** All chunks with allocated memory. */
+    std::vector<SgUctNode*> m_chunks;
+
+    /** Chunks with allocated memory not used by an allocator.
+        One list per allocator index. */
+    std::vector<std::vector<SgUctNode*> > m_freeChunks;
+
+    /** Total number of chunks in m_freeChunks. */
+    std::size_t m_nuFreeChunks;
+
+    void FreeAll();
+
+    /** Not implemented. */
+    SgUctNodePool(const SgUctNodePool&);
+
+    /** Not implemented. */
+    SgUctNodePool& operator=(const SgUctNodePool&);
+};
+
+inline std::size_t SgUctNodePool::ChunkSize() const
+{
+    return m_chunkSize;
+}
+
+inline std::size_t SgUctNodePool::MaxChunks() const
+{
+    return m_maxChunks;
 }
 
 //----------------------------------------------------------------------------
 
 /** Allocater for nodes used in the implementation of SgUctTree.
     Each thread has its own node allocator to allow lock-free usage of
-    SgUctTree.
+    SgUctTree. The storage of an allocator is a list of chunks taken from a
+    SgUctNodePool shared by all allocators of a tree. Nodes are created at the
+    end of the current chunk; if it has no capacity left, EnsureCapacity() takes
+    a new chunk from the pool. Therefore a thread can keep expanding the tree
+    as long as any memory is left in the pool, instead of being limited to a
+    fixed share of the maximum number of nodes. The children of a node are
+    always contiguous in one chunk.
     @ingroup sguctgroup */
 class SgUctAllocator
 {
@@ -595,16 +870,35 @@ public:
 
     ~SgUctAllocator();
 
+    /** Destruct all nodes and return all chunks to the pool. */
     void Clear();
 
-    /** Does the allocator have the capacity for n more nodes? */
+    /** Does the allocator have the capacity for n more nodes?
+        True, if the n nodes fit into the current chunk, or if the pool has a
+        chunk left and n is not larger than the chunk size. Does not take a
+        chunk from the pool, see EnsureCapacity(). */
     bool HasCapacity(std::size_t n) const;
 
+    /** Make sure that n more nodes can be created.
+        The nodes must be contiguous, so if the current chunk is too small,
+        a new chunk is taken from the pool (the rest of the current chunk
+        stays unused until the next Clear()). Must only be called by the
+        thread owning the allocator.
+        @return @c false if the pool has no more chunks or n is larger than
+        the chunk size */
+    bool EnsureCapacity(std::size_t n);
+
     std::size_t NuNodes() const;
 
-    std::size_t MaxNodes() const;
+    /** Number of chunks in use by this allocator. */
+    std::size_t NuChunks() const;
 
-    void SetMaxNodes(std::size_t maxNodes);
+    /** Set the pool to take chunks from.
+        Also clears the allocator.
+        @param pool The pool
+        @param index The index of the allocator in the tree, used as the
+        home of the chunks in the pool */
+    void SetPool(SgUctNodePool* pool, std::size_t index);
 
     /** Check if allocator contains node.
         This function uses pointer comparisons. Since the result of
@@ -614,6 +908,7 @@ public:
         for nodes not in the allocator. */
     bool Contains(const SgUctNode& node) const;
 
+    /** Start of the current chunk. */
     const SgUctNode* Start() const;
 
     SgUctNode* Finish();
@@ -621,31 +916,53 @@ public:
     const SgUctNode* Finish() const;
 
     /** Create a new node at the end of the storage.
-        REQUIRES: HasCapacity(1)
+        REQUIRES: EnsureCapacity(1)
         @param move The constructor argument.
         @return A pointer to new newly created node. */
     SgUctNode* CreateOne(SgMove move);
 
     /** Create a number of new nodes with a given list of moves at the end of
         the storage. Returns the sum of counts of moves.
-        REQUIRES: HasCapacity(moves.size())
+        REQUIRES: EnsureCapacity(moves.size())
         @param moves The list of moves. */
     SgUctValue Create(const std::vector<SgUctMoveInfo>& moves);
 
     /** Create a number of new nodes at the end of the storage.
-        REQUIRES: HasCapacity(n)
+        REQUIRES: EnsureCapacity(n)
         @param n The number of nodes to create. */
     void CreateN(std::size_t n);
 
     void Swap(SgUctAllocator& allocator);
 
 private:
+    /** Start and finish of the used part of a chunk. */
+    typedef std::pair<SgUctNode*,SgUctNode*> Chunk;
+
+    SgUctNodePool* m_pool;
+
+    /** See SetPool() */
+    std::size_t m_poolIndex;
+
+    /** Protects m_fullChunks and m_start, which Contains() reads while the
+        thread owning the allocator can take a new chunk. */
+    mutable std::mutex m_chunksMutex;
+
+    /** Chunks in use, not including the current chunk. */
+    std::vector<Chunk> m_fullChunks;
+
+    /** Number of nodes in m_fullChunks. */
+    std::size_t m_nuNodesFullChunks;
+
     SgUctNode* m_start;
 
     SgUctNode* m_finish;
 
     SgUctNode* m_endOfStorage;
 
+    static void DestructNodes(SgUctNode* start, SgUctNode* finish);
+
+    bool NextChunk(std::size_t n);
+
     /** Not implemented.
         Cannot be copied because array contains pointers to elements.
         Use Swap() instead. */
@@ -653,23 +970,17 @@ private:
 };
 
 inline SgUctAllocator::SgUctAllocator()
-{
-    m_start = 0;
-}
-
-inline void SgUctAllocator::Clear()
-{
-    if (m_start != 0)
-    {
-        for (SgUctNode* it = m_start; it != m_finish; ++it)
-            it->~SgUctNode();
-        m_finish = m_start;
-    }
-}
+    : m_pool(0),
+      m_poolIndex(0),
+      m_nuNodesFullChunks(0),
+      m_start(0),
+      m_finish(0),
+      m_endOfStorage(0)
+{ }
 
 inline SgUctNode* SgUctAllocator::CreateOne(SgMove move)
 {
-    SG_ASSERT(HasCapacity(1));
+    SG_ASSERT(m_finish + 1 <= m_endOfStorage);
     new(m_finish) SgUctNode(move);
     return (m_finish++);
 }
@@ -677,7 +988,7 @@ inline SgUctNode* SgUctAllocator::CreateOne(SgMove move)
 inline SgUctValue SgUctAllocator::Create(
                                          const std::vector<SgUctMoveInfo>& moves)
 {
-    SG_ASSERT(HasCapacity(moves.size()));
+    SG_ASSERT(m_finish + moves.size() <= m_endOfStorage);
     SgUctValue count = 0;
     for (std::vector<SgUctMoveInfo>::const_iterator it = moves.begin();
          it != moves.end(); ++it, ++m_finish)
@@ -690,7 +1001,7 @@ inline SgUctValue SgUctAllocator::Create(
 
 inline void SgUctAllocator::CreateN(std::size_t n)
 {
-    SG_ASSERT(HasCapacity(n));
+    SG_ASSERT(m_finish + n <= m_endOfStorage);
     SgUctNode* newFinish = m_finish + n;
     for ( ; m_finish != newFinish; ++m_finish)
         new(m_finish) SgUctNode(SG_NULLMOVE);
@@ -706,19 +1017,31 @@ inline const SgUctNode* SgUctAllocator::Finish() const
     return m_finish;
 }
 
+inline bool SgUctAllocator::EnsureCapacity(std::size_t n)
+{
+    if (m_finish + n <= m_endOfStorage)
+        return true;
+    return NextChunk(n);
+}
+
 inline bool SgUctAllocator::HasCapacity(std::size_t n) const
 {
-    return (m_finish + n <= m_endOfStorage);
+    if (m_finish + n <= m_endOfStorage)
+        return true;
+    return (  m_pool != 0
+           && n <= m_pool->ChunkSize()
+           && m_pool->CanAcquire()
+           );
 }
 
-inline std::size_t SgUctAllocator::MaxNodes() const
+inline std::size_t SgUctAllocator::NuChunks() const
 {
-    return m_endOfStorage - m_start;
+    return m_fullChunks.size() + (m_start != 0 ? 1 : 0);
 }
 
 inline std::size_t SgUctAllocator::NuNodes() const
 {
-    return m_finish - m_start;
+    return m_nuNodesFullChunks + (m_finish - m_start);
 }
 
 inline const SgUctNode* SgUctAllocator::Start() const
@@ -789,28 +1112,48 @@ public:
     std::size_t MaxNodes() const;
 
     /** Change maximum number of nodes.
-        Also clears the tree. This will call SetMaxNodes() at each registered
-        allocator with maxNodes / numberAllocators as an argument. The real
-        maximum number of nodes can be higher (because the root node is
-        owned by this class, not an allocator) or lower (if maxNodes is not
-        a multiple of the number of allocators).
+        Also clears the tree. The node pool is resized to maxNodes nodes,
+        divided into chunks of at most SgUctNodePool::MAX_CHUNK_SIZE nodes,
+        but not more than maxNodes / numberAllocators, such that each
+        allocator can get at least one chunk. The real maximum number of
+        nodes can be higher (because the root node is owned by this class,
+        not an allocator) or lower (if maxNodes is not a multiple of the
+        chunk size, or due to unused nodes at the end of chunks).
         @param maxNodes Maximum number of nodes */
     void SetMaxNodes(std::size_t maxNodes);
 
+    /** Allocate the memory for nuNodes nodes in advance.
+        By default, the memory of the node pool is allocated during the
+        search, when the allocators need it. Reserving it avoids the
+        allocations in the first search, e.g. for engines that are created
+        before they are used.
+        @param nuNodes The number of nodes. At most MaxNodes() nodes are
+        reserved.
+        @return false if the memory allocation failed */
+    bool Reserve(std::size_t nuNodes);
+
     /** Swap content with another tree.
         The other tree must have the same number of allocators and
         the same maximum number of nodes. */
     void Swap(SgUctTree& tree);
 
+    /** Check that an allocator has capacity for n more nodes.
+        See SgUctAllocator::HasCapacity() */
     bool HasCapacity(std::size_t allocatorId, std::size_t n) const;
 
+    /** Make sure that an allocator can create n more nodes.
+        See SgUctAllocator::EnsureCapacity(). Takes a new chunk from the node
+        pool if necessary, so it must only be called by the thread owning
+        the allocator. */
+    bool EnsureCapacity(std::size_t allocatorId, std::size_t n);
+
     /** Create children nodes.
-        Requires: Allocator(allocatorId).HasCapacity(moves.size()) */
+        Requires: Allocator(allocatorId).EnsureCapacity(moves.size()) */
     void CreateChildren(std::size_t allocatorId, const SgUctNode& node,
                         const std::vector<SgUctMoveInfo>& moves);
 
     /** Merge new children with old.
-        Requires: Allocator(allocatorId).HasCapacity(moves.size()) */
+        Requires: Allocator(allocatorId).EnsureCapacity(moves.size()) */
     void MergeChildren(std::size_t allocatorId, const SgUctNode& node,
                        const std::vector<SgUctMoveInfo>& moves,
                        bool deleteChildTrees);
@@ -856,6 +1199,12 @@ public:
     /** Number of nodes in one of the allocators. */
     std::size_t NuNodes(std::size_t allocatorId) const;
 
+    /** Number of node chunks in use by all allocators. */
+    std::size_t NuUsedChunks() const;
+
+    /** Maximum number of node chunks. */
+    std::size_t MaxChunks() const;
+
     /** Add a game result value to the RAVE value of a node.
         @param node The node with the move
         @param value
@@ -880,8 +1229,19 @@ public:
         knowledge. */
     void InitializeRaveValue(const SgUctNode& node, SgUctValue value, SgUctValue count);
 
+    /** Make a node the new root without copying its subtree.
+        The data of the node is copied to the root node and the children of
+        the node become the children of the root. The nodes that are no
+        longer reachable from the root are not reclaimed immediately; they
+        stay in the allocators (and are still counted by NuNodes()) until the
+        tree is cleared or copied with CopyPruneLowCount() or
+        ExtractSubtree(). Must not be called during a search.
+        @param node The new root. Must be a node in the tree other than the
+        root. */
+    void Reroot(const SgUctNode& node);
+
     /** Remove some children of a node according to a list of filtered moves.
-        Requires: Allocator(allocatorId).HasCapacity(node.NuChildren()) <br>
+        Requires: Allocator(allocatorId).EnsureCapacity(node.NuChildren()) <br>
         For efficiency, no reorganization of the tree is done to remove
         the dead subtrees (and NuNodes() will not report the real number of
         nodes in the tree). This function can be used in lock-free mode. */
@@ -891,7 +1251,7 @@ public:
     /** Sets the children under node to be exactly those in moves,
         reusing the old children if possible. Children not in moves
         are pruned, children missing from moves are added as leaves.
-        Requires: Allocator(allocatorId).HasCapacity(moves.size()) */
+        Requires: Allocator(allocatorId).EnsureCapacity(moves.size()) */
     void SetChildren(std::size_t allocatorId, const SgUctNode& node,
                      const vector<SgMove>& moves);
 
@@ -919,6 +1279,11 @@ private:
 
     SgUctNode m_root;
 
+    /** Pool of node chunks shared by the allocators.
+        Declared before m_allocators, because allocators return their chunks
+        on destruction. */
+    std::unique_ptr<SgUctNodePool> m_pool;
+
     /** Allocators.
         The elements are owned by the vector (shared_ptr is only used because
         auto_ptr should not be used with standard containers) */
@@ -978,7 +1343,10 @@ inline void SgUctTree::CreateChildren(std::size_t allocatorId,
     int nuChildren = int(moves.size());
     SG_ASSERT(nuChildren > 0);
     SgUctAllocator& allocator = Allocator(allocatorId);
-    SG_ASSERT(allocator.HasCapacity(nuChildren));
+    // Also takes a new chunk from the pool, if needed
+    const bool hasCapacity = allocator.EnsureCapacity(nuChildren);
+    SG_ASSERT(hasCapacity);
+    SG_DEBUG_ONLY(hasCapacity);
 
     // In lock-free multi-threading, a node can be expanded multiple times
     // (the later thread overwrites the children information of the previous
@@ -1062,6 +1430,12 @@ inline const SgUctAllocator& SgUctTree::Allocator(std::size_t i) const
     return *m_allocators[i];
 }
 
+inline bool SgUctTree::EnsureCapacity(std::size_t allocatorId,
+                                      std::size_t n)
+{
+    return Allocator(allocatorId).EnsureCapacity(n);
+}
+
 inline bool SgUctTree::HasCapacity(std::size_t allocatorId,
                                    std::size_t n) const
 {
@@ -1091,6 +1465,11 @@ inline std::size_t SgUctTree::MaxNodes() const
     return m_maxNodes;
 }
 
+inline std::size_t SgUctTree::MaxChunks() const
+{
+    return m_pool->MaxChunks();
+}
+
 inline std::size_t SgUctTree::NuAllocators() const
 {
     return m_allocators.size();
@@ -1101,6 +1480,11 @@ inline std::size_t SgUctTree::NuNodes(std::size_t allocatorId) const
     return Allocator(allocatorId).NuNodes();
 }
 
+inline std::size_t SgUctTree::NuUsedChunks() const
+{
+    return m_pool->NuUsedChunks();
+}
+
 inline const SgUctNode& SgUctTree::Root() const
 {
     return m_root;
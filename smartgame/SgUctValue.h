@@ -8,6 +8,7 @@
 #include <cmath>
 #include <limits>
 #include "SgStatistics.h"
+#include "SgStatisticsPacked.h"
 #include "SgStatisticsVlt.h"
 
 //----------------------------------------------------------------------------
@@ -34,6 +35,8 @@ typedef SgStatisticsBase<SgUctValue,SgUctValue> SgUctStatistics;
 
 typedef SgStatisticsVltBase<SgUctValue,SgUctValue> SgUctStatisticsVolatile;
 
+typedef SgStatisticsPackedBase<SgUctValue,SgUctValue> SgUctStatisticsPacked;
+
 //----------------------------------------------------------------------------
 
 namespace SgUctValueUtil
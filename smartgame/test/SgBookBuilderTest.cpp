@@ -0,0 +1,391 @@
+//----------------------------------------------------------------------------
+/** @file SgBookBuilderTest.cpp
+    Unit tests for SgBookBuilder. */
+//----------------------------------------------------------------------------
+
+#include "SgSystem.h"
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <boost/test/unit_test.hpp>
+#include "SgBookBuilder.h"
+
+using namespace std;
+
+//----------------------------------------------------------------------------
+
+namespace {
+
+typedef vector<SgMove> Sequence;
+
+/** Value of terminal positions (a win or a loss for SgBookNode). */
+const float TERMINAL_VALUE = 1000;
+
+unsigned int Hash(const Sequence& sequence)
+{
+    unsigned int h = 17;
+    for (size_t i = 0; i < sequence.size(); ++i)
+        h = h * 31 + static_cast<unsigned int>(sequence[i] + 1);
+    h ^= h >> 13;
+    h *= 0x5bd1e995u;
+    h ^= h >> 15;
+    return h;
+}
+
+/** Heuristic value in [-1, 1] from the view of the player to move. */
+float Evaluate(const Sequence& sequence)
+{
+    return static_cast<float>(Hash(sequence) % 2001) / 1000.f - 1.f;
+}
+
+float TerminalValue(const Sequence& sequence)
+{
+    return (Hash(sequence) % 2 == 0 ? TERMINAL_VALUE : -TERMINAL_VALUE);
+}
+
+/** Builds a book for a uniform game tree of a given width and depth.
+    Values are from the view of the player to move. Positions at the
+    maximum depth are determined wins or losses. The book is a map from the
+    move sequences to the nodes. */
+class TestBookBuilder
+    : public SgBookBuilder
+{
+public:
+    /** @param useThreads Evaluate each leaf of a parallel expansion in its
+        own thread instead of using SgBookBuilder::EvaluateLeaves(). */
+    TestBookBuilder(int width, int depth, bool useThreads = false);
+
+    float InverseEval(float eval) const;
+
+    bool IsLoss(float eval) const;
+
+    float Value(const SgBookNode& node) const;
+
+    const map<Sequence,SgBookNode>& Book() const;
+
+    /** Leaves of each parallel expansion. */
+    const vector<vector<Sequence> >& Batches() const;
+
+    int NumFlushes() const;
+
+    /** Minimax value of the current state. */
+    float Solve();
+
+protected:
+    string MoveString(SgMove move) const;
+
+    void PrintMessage(string msg);
+
+    void PlayMove(SgMove move);
+
+    void UndoMove(SgMove move);
+
+    bool GetNode(SgBookNode& node) const;
+
+    void WriteNode(const SgBookNode& node);
+
+    void FlushBook();
+
+    void EnsureRootExists();
+
+    bool GenerateMoves(size_t count, vector<SgMove>& moves, float& value);
+
+    void GetAllLegalMoves(vector<SgMove>& moves);
+
+    void EvaluateChildren(const vector<SgMove>& childrenToDo,
+                          vector<pair<SgMove, float> >& scores);
+
+    void EvaluateLeaves(const vector<Sequence>& leaves, size_t count,
+                        vector<LeafEvaluation>& evaluations);
+
+    void ClearAllVisited();
+
+    void MarkAsVisited();
+
+    bool HasBeenVisited();
+
+private:
+    int m_width;
+
+    int m_depth;
+
+    bool m_useThreads;
+
+    Sequence m_moves;
+
+    map<Sequence,SgBookNode> m_book;
+
+    set<Sequence> m_visited;
+
+    vector<vector<Sequence> > m_batches;
+
+    int m_numFlushes;
+
+    void EvaluateLeaf(const Sequence& leaf, size_t count,
+                      LeafEvaluation& evaluation) const;
+};
+
+TestBookBuilder::TestBookBuilder(int width, int depth, bool useThreads)
+    : m_width(width),
+      m_depth(depth),
+      m_useThreads(useThreads),
+      m_numFlushes(0)
+{ }
+
+const vector<vector<Sequence> >& TestBookBuilder::Batches() const
+{
+    return m_batches;
+}
+
+const map<Sequence,SgBookNode>& TestBookBuilder::Book() const
+{
+    return m_book;
+}
+
+void TestBookBuilder::ClearAllVisited()
+{
+    m_visited.clear();
+}
+
+void TestBookBuilder::EnsureRootExists()
+{
+    SgBookNode root;
+    if (! GetNode(root))
+        WriteNode(SgBookNode(Evaluate(m_moves)));
+}
+
+void TestBookBuilder::EvaluateChildren(const vector<SgMove>& childrenToDo,
+                                       vector<pair<SgMove, float> >& scores)
+{
+    for (size_t i = 0; i < childrenToDo.size(); ++i)
+    {
+        Sequence child(m_moves);
+        child.push_back(childrenToDo[i]);
+        scores.push_back(make_pair(childrenToDo[i], Evaluate(child)));
+    }
+}
+
+/** Same result as SgBookBuilder::EvaluateLeaves(), but only reads the
+    book, so it can run in several threads. */
+void TestBookBuilder::EvaluateLeaf(const Sequence& leaf, size_t count,
+                                   LeafEvaluation& evaluation) const
+{
+    Sequence sequence(m_moves);
+    sequence.insert(sequence.end(), leaf.begin(), leaf.end());
+    if (static_cast<int>(sequence.size()) >= m_depth)
+    {
+        evaluation.m_isDetermined = true;
+        evaluation.m_value = TerminalValue(sequence);
+        return;
+    }
+    const int limit = min(static_cast<int>(count), m_width);
+    for (int i = 0; i < limit; ++i)
+    {
+        Sequence child(sequence);
+        child.push_back(i);
+        if (m_book.count(child) == 0)
+            evaluation.m_scores.push_back(make_pair(i, Evaluate(child)));
+    }
+}
+
+void TestBookBuilder::EvaluateLeaves(const vector<Sequence>& leaves,
+                                     size_t count,
+                                     vector<LeafEvaluation>& evaluations)
+{
+    m_batches.push_back(leaves);
+    if (! m_useThreads)
+    {
+        SgBookBuilder::EvaluateLeaves(leaves, count, evaluations);
+        return;
+    }
+    evaluations.assign(leaves.size(), LeafEvaluation());
+    vector<thread> threads;
+    for (size_t i = 0; i < leaves.size(); ++i)
+        threads.push_back(thread(&TestBookBuilder::EvaluateLeaf, this,
+                                 cref(leaves[i]), count,
+                                 ref(evaluations[i])));
+    for (size_t i = 0; i < threads.size(); ++i)
+        threads[i].join();
+}
+
+void TestBookBuilder::FlushBook()
+{
+    ++m_numFlushes;
+}
+
+bool TestBookBuilder::GenerateMoves(size_t count, vector<SgMove>& moves,
+                                    float& value)
+{
+    if (static_cast<int>(m_moves.size()) >= m_depth)
+    {
+        value = TerminalValue(m_moves);
+        return true;
+    }
+    for (int i = 0; i < min(static_cast<int>(count), m_width); ++i)
+        moves.push_back(i);
+    return false;
+}
+
+void TestBookBuilder::GetAllLegalMoves(vector<SgMove>& moves)
+{
+    if (static_cast<int>(m_moves.size()) < m_depth)
+        for (int i = 0; i < m_width; ++i)
+            moves.push_back(i);
+}
+
+bool TestBookBuilder::GetNode(SgBookNode& node) const
+{
+    map<Sequence,SgBookNode>::const_iterator it = m_book.find(m_moves);
+    if (it == m_book.end())
+        return false;
+    node = it->second;
+    return true;
+}
+
+bool TestBookBuilder::HasBeenVisited()
+{
+    return m_visited.count(m_moves) > 0;
+}
+
+float TestBookBuilder::InverseEval(float eval) const
+{
+    return -eval;
+}
+
+bool TestBookBuilder::IsLoss(float eval) const
+{
+    return eval < -100;
+}
+
+void TestBookBuilder::MarkAsVisited()
+{
+    m_visited.insert(m_moves);
+}
+
+string TestBookBuilder::MoveString(SgMove move) const
+{
+    ostringstream buffer;
+    buffer << move;
+    return buffer.str();
+}
+
+int TestBookBuilder::NumFlushes() const
+{
+    return m_numFlushes;
+}
+
+void TestBookBuilder::PlayMove(SgMove move)
+{
+    m_moves.push_back(move);
+}
+
+void TestBookBuilder::PrintMessage(string msg)
+{
+    SG_UNUSED(msg);
+}
+
+float TestBookBuilder::Solve()
+{
+    if (static_cast<int>(m_moves.size()) >= m_depth)
+        return TerminalValue(m_moves);
+    float value = -TERMINAL_VALUE;
+    for (int i = 0; i < m_width; ++i)
+    {
+        PlayMove(i);
+        value = max(value, -Solve());
+        UndoMove(i);
+    }
+    return value;
+}
+
+void TestBookBuilder::UndoMove(SgMove move)
+{
+    SG_UNUSED(move);
+    m_moves.pop_back();
+}
+
+float TestBookBuilder::Value(const SgBookNode& node) const
+{
+    return node.m_value;
+}
+
+void TestBookBuilder::WriteNode(const SgBookNode& node)
+{
+    m_book[m_moves] = node;
+}
+
+float RootValue(const TestBookBuilder& builder)
+{
+    return builder.Book().find(Sequence())->second.m_value;
+}
+
+/** Check that parallel expansions select different leaves with the
+    virtual loss and solve the game like sequential expansions, and that
+    evaluating the leaves in several threads does not change the book. */
+BOOST_AUTO_TEST_CASE(SgBookBuilderTest_ParallelExpansion)
+{
+    const int width = 3;
+    const int depth = 5;
+    TestBookBuilder sequential(width, depth);
+    const float value = sequential.Solve();
+    sequential.Expand(1000);
+    BOOST_CHECK(sequential.Batches().empty());
+    BOOST_CHECK_EQUAL(RootValue(sequential), value);
+
+    TestBookBuilder parallel(width, depth);
+    parallel.SetNumParallelExpansions(4);
+    parallel.Expand(1000);
+    BOOST_CHECK_EQUAL(RootValue(parallel), value);
+    size_t maxBatchSize = 0;
+    for (size_t i = 0; i < parallel.Batches().size(); ++i)
+    {
+        const vector<Sequence>& batch = parallel.Batches()[i];
+        BOOST_CHECK(batch.size() <= 4);
+        BOOST_CHECK_EQUAL(set<Sequence>(batch.begin(), batch.end()).size(),
+                          batch.size());
+        maxBatchSize = max(maxBatchSize, batch.size());
+    }
+    BOOST_CHECK_EQUAL(maxBatchSize, 4u);
+    // The virtual losses are removed after each expansion
+    for (map<Sequence,SgBookNode>::const_iterator it
+             = parallel.Book().begin(); it != parallel.Book().end(); ++it)
+        if (it->second.IsLeaf())
+            BOOST_CHECK_EQUAL(it->second.m_priority,
+                              SgBookNode::LEAF_PRIORITY);
+
+    TestBookBuilder threaded(width, depth, true);
+    threaded.SetNumParallelExpansions(4);
+    threaded.Expand(1000);
+    BOOST_CHECK(threaded.Batches() == parallel.Batches());
+    BOOST_REQUIRE_EQUAL(threaded.Book().size(), parallel.Book().size());
+    for (map<Sequence,SgBookNode>::const_iterator it
+             = parallel.Book().begin(); it != parallel.Book().end(); ++it)
+    {
+        map<Sequence,SgBookNode>::const_iterator it2
+            = threaded.Book().find(it->first);
+        BOOST_REQUIRE(it2 != threaded.Book().end());
+        BOOST_CHECK_EQUAL(it2->second.m_value, it->second.m_value);
+        BOOST_CHECK_EQUAL(it2->second.m_heurValue, it->second.m_heurValue);
+        BOOST_CHECK_EQUAL(it2->second.m_priority, it->second.m_priority);
+        BOOST_CHECK_EQUAL(it2->second.m_count, it->second.m_count);
+    }
+}
+
+/** Check that the book is flushed every 100 expansions and at the end. */
+BOOST_AUTO_TEST_CASE(SgBookBuilderTest_Flush)
+{
+    TestBookBuilder builder(2, 30);
+    builder.Expand(99);
+    BOOST_CHECK_EQUAL(builder.NumFlushes(), 1);
+    TestBookBuilder builder2(2, 30);
+    builder2.Expand(200);
+    BOOST_CHECK_EQUAL(builder2.NumFlushes(), 3);
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------
@@ -0,0 +1,128 @@
+//----------------------------------------------------------------------------
+/** @file SgBookStoreTest.cpp
+    Unit tests for SgBookStore. */
+//----------------------------------------------------------------------------
+
+#include "SgSystem.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <boost/test/unit_test.hpp>
+#include "SgBookStore.h"
+#include "SgException.h"
+
+using namespace std;
+
+//----------------------------------------------------------------------------
+
+namespace {
+
+SgBookNode MakeNode(float value, unsigned count)
+{
+    SgBookNode node(value);
+    node.m_count = count;
+    return node;
+}
+
+BOOST_AUTO_TEST_CASE(SgBookStoreTest_PutGet)
+{
+    SgBookStore store;
+    SgBookNode node;
+    BOOST_CHECK(! store.Get(1, node));
+    // Enough keys to grow the hash table
+    for (unsigned i = 0; i < 5000; ++i)
+        store.Put(i * 0x10000ULL, MakeNode(float(i), i));
+    store.Put(7 * 0x10000ULL, MakeNode(-1.f, 3));
+    BOOST_CHECK_EQUAL(store.Size(), 5000u);
+    BOOST_REQUIRE(store.Get(7 * 0x10000ULL, node));
+    BOOST_CHECK_EQUAL(node.m_value, -1.f);
+    BOOST_CHECK_EQUAL(node.m_count, 3u);
+    BOOST_REQUIRE(store.Get(4999 * 0x10000ULL, node));
+    BOOST_CHECK_EQUAL(node.m_value, 4999.f);
+    BOOST_CHECK(! store.Get(5000 * 0x10000ULL, node));
+    size_t n = 0;
+    for (SgBookStore::Iterator it(store); it; ++it)
+        ++n;
+    BOOST_CHECK_EQUAL(n, 5000u);
+}
+
+/** Test that flushed nodes and nodes changed after a flush are found after
+    reopening the file, and that Save() compacts the file. */
+BOOST_AUTO_TEST_CASE(SgBookStoreTest_FlushAndReopen)
+{
+    const string fileName = "SgBookStoreTest.book";
+    const string compactFileName = "SgBookStoreTest_compact.book";
+    std::remove(fileName.c_str());
+    {
+        SgBookStore store;
+        store.Open(fileName);
+        BOOST_CHECK(store.IsOpen());
+        BOOST_CHECK_EQUAL(store.Size(), 0u);
+        store.Put(1, MakeNode(0.5f, 1));
+        store.Put(2, MakeNode(0.25f, 0));
+        store.Flush();
+        store.Put(1, MakeNode(0.75f, 2));
+        store.Put(3, MakeNode(0.125f, 0));
+        SgBookNode node;
+        BOOST_REQUIRE(store.Get(1, node));
+        BOOST_CHECK_EQUAL(node.m_value, 0.75f);
+        store.Flush();
+        BOOST_CHECK_THROW(store.Save(fileName), SgException);
+        store.Save(compactFileName);
+    }
+    BOOST_CHECK(SgBookStore::IsBookFile(fileName));
+    BOOST_CHECK(filesystem::file_size(compactFileName)
+                < filesystem::file_size(fileName));
+    for (int i = 0; i < 2; ++i)
+    {
+        SgBookStore store;
+        store.Open(i == 0 ? fileName : compactFileName);
+        BOOST_CHECK_EQUAL(store.Size(), 3u);
+        SgBookNode node;
+        BOOST_REQUIRE(store.Get(1, node));
+        BOOST_CHECK_EQUAL(node.m_value, 0.75f);
+        BOOST_CHECK_EQUAL(node.m_count, 2u);
+        BOOST_REQUIRE(store.Get(2, node));
+        BOOST_CHECK_EQUAL(node.m_value, 0.25f);
+        BOOST_REQUIRE(store.Get(3, node));
+        BOOST_CHECK_EQUAL(node.m_value, 0.125f);
+    }
+    std::remove(fileName.c_str());
+    std::remove(compactFileName.c_str());
+}
+
+/** Test that an incomplete record at the end of the file is removed. */
+BOOST_AUTO_TEST_CASE(SgBookStoreTest_IncompleteRecord)
+{
+    const string fileName = "SgBookStoreTest_incomplete.book";
+    std::remove(fileName.c_str());
+    {
+        SgBookStore store;
+        store.Open(fileName);
+        store.Put(1, MakeNode(0.5f, 1));
+        store.Flush();
+    }
+    const uintmax_t size = filesystem::file_size(fileName);
+    {
+        ofstream out(fileName.c_str(), ios::binary | ios::app);
+        out << "garbage";
+    }
+    {
+        SgBookStore store;
+        store.Open(fileName);
+        BOOST_CHECK_EQUAL(filesystem::file_size(fileName), size);
+        SgBookNode node;
+        BOOST_CHECK(store.Get(1, node));
+        store.Put(2, MakeNode(0.25f, 1));
+        store.Flush();
+        BOOST_CHECK(store.Get(2, node));
+    }
+    std::remove(fileName.c_str());
+}
+
+//----------------------------------------------------------------------------
+
+} // namespace
+
+//----------------------------------------------------------------------------
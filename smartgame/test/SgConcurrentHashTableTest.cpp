@@ -0,0 +1,216 @@
+//----------------------------------------------------------------------------
+/** @file SgConcurrentHashTableTest.cpp
+    Unit tests for SgConcurrentHashTable. */
+//----------------------------------------------------------------------------
+
+#include "SgSystem.h"
+
+#include <atomic>
+#include <cstdint>
+#include <boost/test/unit_test.hpp>
+#include "SgConcurrentHashTable.h"
+#include "SgDfpnSearch.h"
+#include "SgSearch.h"
+#include "SgThreadPool.h"
+
+using namespace std;
+
+//----------------------------------------------------------------------------
+
+namespace {
+
+/** Data that can be checked against the hash code it is stored under. */
+struct TestData
+{
+    unsigned int m_code1;
+
+    unsigned int m_code2;
+
+    unsigned int m_check;
+
+    int m_depth;
+
+    bool m_isValid;
+
+    TestData()
+        : m_code1(0),
+          m_code2(0),
+          m_check(0),
+          m_depth(0),
+          m_isValid(false)
+    { }
+
+    TestData(const SgHashCode& code, int depth)
+        : m_code1(code.Code1()),
+          m_code2(code.Code2()),
+          m_check(Check(code, depth)),
+          m_depth(depth),
+          m_isValid(true)
+    { }
+
+    static unsigned int Check(const SgHashCode& code, int depth)
+    {
+        return code.Code1() ^ (code.Code2() * 3) ^ depth;
+    }
+
+    /** Is the data consistent and was it stored under this code? */
+    bool Matches(const SgHashCode& code) const
+    {
+        return m_isValid && m_code1 == code.Code1()
+            && m_code2 == code.Code2() && m_check == Check(code, m_depth);
+    }
+
+    bool IsBetterThan(const TestData& data) const
+    {
+        return m_depth > data.m_depth;
+    }
+
+    bool IsValid() const
+    {
+        return m_isValid;
+    }
+
+    void Invalidate()
+    {
+        m_isValid = false;
+    }
+
+    void AgeData()
+    {
+        m_depth = 0;
+        m_check = m_code1 ^ (m_code2 * 3);
+    }
+};
+
+BOOST_AUTO_TEST_CASE(SgConcurrentHashTableTest_StoreLookup)
+{
+    SgConcurrentHashTable<TestData, 4> table(1000);
+    BOOST_CHECK_EQUAL(1000, table.MaxHash());
+    const SgHashCode code(1);
+    TestData data;
+    BOOST_CHECK(! table.Lookup(code, &data));
+    table.Store(code, TestData(code, 5));
+    BOOST_REQUIRE(table.Lookup(code, &data));
+    BOOST_CHECK(data.Matches(code));
+    BOOST_CHECK_EQUAL(5, data.m_depth);
+    table.Store(code, TestData(code, 2));
+    BOOST_REQUIRE(table.Lookup(code, &data));
+    BOOST_CHECK_EQUAL(2, data.m_depth);
+    BOOST_CHECK(! table.Lookup(SgHashCode(2), &data));
+    BOOST_CHECK_EQUAL(2u, table.NuStores());
+    BOOST_CHECK_EQUAL(4u, table.NuLookups());
+    BOOST_CHECK_EQUAL(2u, table.NuFound());
+    table.Clear();
+    BOOST_CHECK(! table.Lookup(code, &data));
+}
+
+/** Test that the entries are replaced as in SgHashTable.
+    With one hash index, all codes go to the same block. */
+BOOST_AUTO_TEST_CASE(SgConcurrentHashTableTest_Replacement)
+{
+    SgConcurrentHashTable<TestData, 4> table(1);
+    SgHashTable<TestData, 4> reference(1);
+    const int depth[] = { 3, 1, 4, 1, 5, 9, 2, 6 };
+    for (int i = 0; i < 8; ++i)
+    {
+        const SgHashCode code(i);
+        table.Store(code, TestData(code, depth[i]));
+        reference.Store(code, TestData(code, depth[i]));
+        for (int j = 0; j <= i; ++j)
+        {
+            TestData data;
+            TestData referenceData;
+            const SgHashCode code(j);
+            BOOST_CHECK_EQUAL(reference.Lookup(code, &referenceData),
+                              table.Lookup(code, &data));
+            BOOST_CHECK_EQUAL(referenceData.m_depth, data.m_depth);
+        }
+    }
+    BOOST_CHECK_EQUAL(reference.NuCollisions(), table.NuCollisions());
+}
+
+BOOST_AUTO_TEST_CASE(SgConcurrentHashTableTest_Age)
+{
+    SgConcurrentHashTable<TestData, 4> table(100);
+    for (int i = 0; i < 10; ++i)
+        table.Store(SgHashCode(i), TestData(SgHashCode(i), i + 1));
+    table.Age();
+    for (int i = 0; i < 10; ++i)
+    {
+        TestData data;
+        BOOST_REQUIRE(table.Lookup(SgHashCode(i), &data));
+        BOOST_CHECK(data.Matches(SgHashCode(i)));
+        BOOST_CHECK_EQUAL(0, data.m_depth);
+    }
+}
+
+/** Test that the table can be instantiated with the data of the search
+    hash tables. */
+BOOST_AUTO_TEST_CASE(SgConcurrentHashTableTest_SearchData)
+{
+    SgConcurrentHashTable<SgSearchHashData, 4> table(100);
+    const SgHashCode code(7);
+    table.Store(code, SgSearchHashData(3, 10, 42));
+    SgSearchHashData data;
+    BOOST_REQUIRE(table.Lookup(code, &data));
+    BOOST_CHECK_EQUAL(42, data.BestMove());
+    SgConcurrentHashTable<DfpnData, 4> dfpnTable(100);
+    dfpnTable.Store(code, DfpnData(DfpnBounds(1, 2), 42, 5));
+    DfpnData dfpnData;
+    BOOST_REQUIRE(dfpnTable.Lookup(code, &dfpnData));
+    BOOST_CHECK_EQUAL(42, dfpnData.m_bestMove);
+}
+
+/** Several threads store and look up a small set of codes in a small
+    table, such that the threads often access the same entries. Every
+    lookup must return data that was stored under the code. */
+BOOST_AUTO_TEST_CASE(SgConcurrentHashTableTest_Stress)
+{
+    const size_t nuThreads = 4;
+    const int nuOperations = 200000;
+    const unsigned int nuCodes = 500;
+    SgConcurrentHashTable<TestData, 4> table(64);
+    SgThreadPool pool;
+    pool.SetNumberThreads(nuThreads);
+    atomic<int> nuErrors(0);
+    atomic<int> nuFound(0);
+    pool.RunOnAll([&](size_t threadIndex)
+    {
+        uint32_t random = 12345u + static_cast<uint32_t>(threadIndex);
+        int errors = 0;
+        int found = 0;
+        for (int i = 0; i < nuOperations; ++i)
+        {
+            random = random * 1664525u + 1013904223u;
+            const SgHashCode code((random >> 8) % nuCodes);
+            if ((random >> 4) % 2 == 0)
+                table.Store(code, TestData(code, (random >> 16) % 100 + 1));
+            else
+            {
+                TestData data;
+                if (table.Lookup(code, &data))
+                {
+                    ++found;
+                    if (! data.Matches(code))
+                        ++errors;
+                }
+            }
+        }
+        nuErrors += errors;
+        nuFound += found;
+    });
+    BOOST_CHECK_EQUAL(0, nuErrors.load());
+    BOOST_CHECK(nuFound.load() > 0);
+    BOOST_CHECK_EQUAL(nuThreads * nuOperations,
+                      table.NuStores() + table.NuLookups());
+    for (unsigned int i = 0; i < nuCodes; ++i)
+    {
+        TestData data;
+        if (table.Lookup(SgHashCode(i), &data))
+            BOOST_CHECK(data.Matches(SgHashCode(i)));
+    }
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------
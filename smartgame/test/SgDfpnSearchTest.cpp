@@ -0,0 +1,184 @@
+//----------------------------------------------------------------------------
+/** @file SgDfpnSearchTest.cpp
+    Unit tests for DfpnSolver. */
+//----------------------------------------------------------------------------
+
+#include "SgSystem.h"
+
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "SgDfpnSearch.h"
+#include "SgException.h"
+
+using namespace std;
+
+//----------------------------------------------------------------------------
+
+namespace {
+
+const int NU_HEAPS = 3;
+
+/** Solver for Nim: a move removes stones from one heap, the player who
+    removes the last stone wins. The player to move wins, if the bitwise
+    exclusive or of the heap sizes is not zero. */
+class NimSolver
+    : public DfpnSolver
+{
+public:
+    NimSolver(const int heaps[NU_HEAPS], SgBlackWhite toPlay = SG_BLACK);
+
+    void GenerateChildren(vector<SgMove>& children) const;
+
+    void PlayMove(SgMove move);
+
+    void UndoMove();
+
+    bool TerminalState(SgBoardColor colorToPlay, SgEmptyBlackWhite& winner);
+
+    SgBoardColor GetColorToMove() const;
+
+    SgHashCode Hash() const;
+
+    void WriteMoveSequence(ostream& stream,
+                           const PointSequence& sequence) const;
+
+    std::unique_ptr<DfpnSolver> CreateThreadSolver() const;
+
+private:
+    int m_heaps[NU_HEAPS];
+
+    SgBlackWhite m_toPlay;
+
+    vector<SgMove> m_moves;
+};
+
+NimSolver::NimSolver(const int heaps[NU_HEAPS], SgBlackWhite toPlay)
+    : m_toPlay(toPlay)
+{
+    for (int i = 0; i < NU_HEAPS; ++i)
+        m_heaps[i] = heaps[i];
+}
+
+std::unique_ptr<DfpnSolver> NimSolver::CreateThreadSolver() const
+{
+    return std::make_unique<NimSolver>(m_heaps, m_toPlay);
+}
+
+void NimSolver::GenerateChildren(vector<SgMove>& children) const
+{
+    for (int i = 0; i < NU_HEAPS; ++i)
+        for (int n = 1; n <= m_heaps[i]; ++n)
+            children.push_back(i * 16 + n);
+}
+
+SgBoardColor NimSolver::GetColorToMove() const
+{
+    return m_toPlay;
+}
+
+SgHashCode NimSolver::Hash() const
+{
+    unsigned int key = (m_toPlay == SG_BLACK ? 1 : 0);
+    for (int i = 0; i < NU_HEAPS; ++i)
+        key = key * 16 + m_heaps[i];
+    return SgHashCode(key);
+}
+
+void NimSolver::PlayMove(SgMove move)
+{
+    m_heaps[move / 16] -= move % 16;
+    SG_ASSERT(m_heaps[move / 16] >= 0);
+    m_moves.push_back(move);
+    m_toPlay = SgOppBW(m_toPlay);
+}
+
+bool NimSolver::TerminalState(SgBoardColor colorToPlay,
+                              SgEmptyBlackWhite& winner)
+{
+    for (int i = 0; i < NU_HEAPS; ++i)
+        if (m_heaps[i] > 0)
+            return false;
+    winner = SgOppBW(colorToPlay);
+    return true;
+}
+
+void NimSolver::UndoMove()
+{
+    const SgMove move = m_moves.back();
+    m_moves.pop_back();
+    m_heaps[move / 16] += move % 16;
+    m_toPlay = SgOppBW(m_toPlay);
+}
+
+void NimSolver::WriteMoveSequence(ostream& stream,
+                                  const PointSequence& sequence) const
+{
+    for (size_t i = 0; i < sequence.size(); ++i)
+        stream << sequence[i] / 16 << '-' << sequence[i] % 16 << ' ';
+}
+
+template<class HASHTABLE>
+void CheckSolve(const int heaps[NU_HEAPS], size_t nuThreads)
+{
+    NimSolver solver(heaps);
+    solver.SetNumberThreads(nuThreads);
+    HASHTABLE hashTable(1 << 16);
+    PointSequence pv;
+    const SgEmptyBlackWhite winner = solver.StartSearch(hashTable, pv);
+    const bool isWin = ((heaps[0] ^ heaps[1] ^ heaps[2]) != 0);
+    BOOST_CHECK_EQUAL(isWin ? SG_BLACK : SG_WHITE, winner);
+    BOOST_CHECK(! pv.empty());
+    SgSearchTracer tracer(0);
+    BOOST_CHECK(solver.Validate(hashTable, winner, tracer));
+}
+
+BOOST_AUTO_TEST_CASE(SgDfpnSearchTest_Nim)
+{
+    const int win[NU_HEAPS] = { 3, 4, 6 };
+    CheckSolve<DfpnHashTable>(win, 1);
+    CheckSolve<DfpnConcurrentHashTable>(win, 1);
+    const int loss[NU_HEAPS] = { 3, 5, 6 };
+    CheckSolve<DfpnHashTable>(loss, 1);
+    CheckSolve<DfpnConcurrentHashTable>(loss, 1);
+}
+
+/** Test that a search with several threads finds the same results. */
+BOOST_AUTO_TEST_CASE(SgDfpnSearchTest_NimParallel)
+{
+    const int win[NU_HEAPS] = { 5, 9, 11 };
+    CheckSolve<DfpnConcurrentHashTable>(win, 4);
+    const int loss[NU_HEAPS] = { 6, 9, 15 };
+    CheckSolve<DfpnConcurrentHashTable>(loss, 4);
+}
+
+/** Test that a search with several threads needs CreateThreadSolver().
+    With a DfpnHashTable, the search uses one thread and does not need it. */
+BOOST_AUTO_TEST_CASE(SgDfpnSearchTest_NoThreadSolver)
+{
+    class Solver
+        : public NimSolver
+    {
+    public:
+        Solver(const int heaps[NU_HEAPS])
+            : NimSolver(heaps)
+        { }
+
+        std::unique_ptr<DfpnSolver> CreateThreadSolver() const
+        {
+            return DfpnSolver::CreateThreadSolver();
+        }
+    };
+    const int heaps[NU_HEAPS] = { 1, 2, 4 };
+    Solver solver(heaps);
+    solver.SetNumberThreads(2);
+    DfpnConcurrentHashTable hashTable(1 << 10);
+    PointSequence pv;
+    BOOST_CHECK_THROW(solver.StartSearch(hashTable, pv), SgException);
+    DfpnHashTable singleThreadHashTable(1 << 10);
+    BOOST_CHECK_EQUAL(SG_BLACK,
+                      solver.StartSearch(singleThreadHashTable, pv));
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------
@@ -70,6 +70,36 @@ BOOST_AUTO_TEST_CASE(SgNodeTreeIndexTest)
     n1->DeleteTree();
 }
 
+/** Test that nodes and properties created in a SgNodeArena::Scope are
+    allocated in the arena and can be mixed with nodes on the heap. */
+BOOST_AUTO_TEST_CASE(SgNodeArenaTest)
+{
+    SgNodeArena arena;
+    SgNode* root;
+    {
+        SgNodeArena::Scope scope(&arena);
+        BOOST_CHECK_EQUAL(SgNodeArena::Current(), &arena);
+        root = new SgNode();
+        SgNode* node = root->NewRightMostSon();
+        node->AddComment("comment");
+        node->NewRightMostSon();
+        root->NewRightMostSon()->NewLeftMostSon();
+    }
+    BOOST_CHECK(SgNodeArena::Current() == 0);
+    BOOST_CHECK_EQUAL(arena.NuObjects(), 6u);
+    BOOST_CHECK(arena.NuBytes() > 0);
+    SgNode* heapNode = root->LeftMostSon()->NewLeftMostSon();
+    heapNode->AddComment("heap");
+    BOOST_CHECK_EQUAL(arena.NuObjects(), 6u);
+    BOOST_CHECK_EQUAL(root->CountNodes(false), 6);
+    root->LeftMostSon()->DeleteSubtree();
+    BOOST_CHECK_EQUAL(arena.NuObjects(), 5u);
+    BOOST_CHECK_EQUAL(root->CountNodes(false), 4);
+    root->DeleteTree();
+    BOOST_CHECK_EQUAL(arena.NuObjects(), 0u);
+    arena.Clear();
+}
+
 BOOST_AUTO_TEST_CASE(SgNodeIteratorTest)
 {
     // Test node iterator.
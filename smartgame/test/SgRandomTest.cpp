@@ -5,6 +5,8 @@
 
 #include "SgSystem.h"
 
+#include <thread>
+#include <vector>
 #include <boost/test/unit_test.hpp>
 #include "SgRandom.h"
 
@@ -37,6 +39,33 @@ BOOST_AUTO_TEST_CASE(SgRandomTestFloat)
     }
 }
 
+/** Test that instances constructed in several threads concurrently are
+    seeded like other instances. */
+BOOST_AUTO_TEST_CASE(SgRandomTestConcurrentConstruction)
+{
+    std::vector<std::vector<unsigned int> > numbers(4);
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < numbers.size(); ++i)
+        threads.push_back(std::thread([&numbers, i]()
+        {
+            for (int j = 0; j < 1000; ++j)
+            {
+                SgRandom r;
+                numbers[i].push_back(r.Int());
+            }
+        }));
+    for (std::size_t i = 0; i < threads.size(); ++i)
+        threads[i].join();
+    SgRandom r;
+    const unsigned int first = r.Int();
+    for (std::size_t i = 0; i < numbers.size(); ++i)
+    {
+        BOOST_REQUIRE_EQUAL(numbers[i].size(), 1000u);
+        for (int j = 0; j < 1000; ++j)
+            BOOST_CHECK_EQUAL(numbers[i][j], first);
+    }
+}
+
 } // namespace
 
 //----------------------------------------------------------------------------
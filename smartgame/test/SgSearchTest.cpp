@@ -8,7 +8,9 @@
 #include <sstream>
 #include <vector>
 #include <boost/test/unit_test.hpp>
+#include "SgConcurrentHashTable.h"
 #include "SgDebug.h"
+#include "SgException.h"
 #include "SgHashTable.h"
 #include "SgSearch.h"
 #include "SgSearchControl.h"
@@ -22,7 +24,7 @@ namespace {
 
 /** Test class that allows to define artificial game trees for testing
     SgSearch.
-    - Does not use hash tables yet
+    - The hash code of a position is the index of its node
     - Black (max) is always the first player */
 class TestSearch
     : public SgSearch
@@ -34,11 +36,10 @@ public:
     /** Constant indicating no node for node indices. */
     static const size_t NO_NODE;
 
-    TestSearch();
+    TestSearch(SgSearchHashTable* hash = 0);
 
     ~TestSearch();
 
-
     /** Add node to test tree.
         @param father Index of father node, NO_NODE if root node. */
     void AddNode(size_t father, SgMove move, int eval);
@@ -67,6 +68,8 @@ public:
 
     bool EndOfGame() const;
 
+    std::unique_ptr<SgSearch> CreateThreadSearch() const;
+
 private:
     /** Node in the artificial game tree of class TestSearch. */
     struct TestNode
@@ -101,8 +104,8 @@ private:
 
 const size_t TestSearch::NO_NODE = numeric_limits<size_t>::max();
 
-TestSearch::TestSearch()
-    : SgSearch(0),
+TestSearch::TestSearch(SgSearchHashTable* hash)
+    : SgSearch(hash),
       m_write(false),
       m_currentNode(0),
       m_lastEvaluated(NO_NODE),
@@ -112,7 +115,6 @@ TestSearch::TestSearch()
 TestSearch::~TestSearch()
 { }
 
-
 void TestSearch::AddNode(size_t father, SgMove move, int eval)
 {
     TestNode node;
@@ -138,6 +140,15 @@ void TestSearch::AddNode(size_t father, SgMove move, int eval)
     m_nodes.push_back(node);
 }
 
+std::unique_ptr<SgSearch> TestSearch::CreateThreadSearch() const
+{
+    TestSearch* search = new TestSearch;
+    search->m_nodes = m_nodes;
+    search->m_currentNode = m_currentNode;
+    search->m_toPlay = m_toPlay;
+    return std::unique_ptr<SgSearch>(search);
+}
+
 bool TestSearch::CheckDepthLimitReached() const
 {
     return true;
@@ -367,6 +378,92 @@ BOOST_AUTO_TEST_CASE(SgSearchTest_NewBestInIncompleteIteration)
     delete control;
 }
 
+/** Add a uniform tree with pseudo-random evaluations below a node.
+    @return The minimax value of the node from the view of the player to
+    move at the node. */
+int AddRandomTree(TestSearch& search, size_t father, int width, int height,
+                  unsigned int& random, size_t& nuNodes)
+{
+    SG_ASSERT(height > 0);
+    int value = -SgSearch::SG_INFINITY;
+    for (int i = 0; i < width; ++i)
+    {
+        random = random * 1664525u + 1013904223u;
+        const int eval = static_cast<int>((random >> 16) % 201) - 100;
+        const size_t index = nuNodes++;
+        search.AddNode(father, static_cast<SgMove>(index), eval);
+        const int childValue =
+            (height == 1 ? eval
+             : AddRandomTree(search, index, width, height - 1, random,
+                             nuNodes));
+        value = max(value, -childValue);
+    }
+    return value;
+}
+
+/** Test that a search with several threads finds the minimax value of a
+    random tree. The search depth is the height of the tree, so the hash
+    table entries of the deeper searches of the other threads do not change
+    the value. */
+BOOST_AUTO_TEST_CASE(SgSearchTest_Parallel)
+{
+    const int height = 5;
+    SgSearchConcurrentHashTable hashTable(1 << 12);
+    TestSearch search;
+    search.SetConcurrentHashTable(&hashTable);
+    search.AddNode(TestSearch::NO_NODE, SG_NULLMOVE, 0);
+    unsigned int random = 4711;
+    size_t nuNodes = 1;
+    const int minimax =
+        AddRandomTree(search, 0, 4, height, random, nuNodes);
+    for (size_t nuThreads = 1; nuThreads <= 4; nuThreads *= 2)
+    {
+        search.SetNumberThreads(nuThreads);
+        SgVector<SgMove> sequence;
+        BOOST_CHECK_EQUAL(minimax,
+                          search.IteratedSearch(1, height, -1000, 1000,
+                                                &sequence));
+        BOOST_CHECK_EQUAL(height, sequence.Length());
+        sequence.Clear();
+        BOOST_CHECK_EQUAL(minimax,
+                          search.DepthFirstSearch(height, -1000, 1000,
+                                                  &sequence));
+        BOOST_CHECK_EQUAL(height, sequence.Length());
+        BOOST_CHECK(search.Statistics().NumNodes() > 0);
+    }
+}
+
+/** Test that a search with several threads needs CreateThreadSearch().
+    With a SgSearchHashTable, the search uses one thread and does not need
+    it. */
+BOOST_AUTO_TEST_CASE(SgSearchTest_NoThreadSearch)
+{
+    class Search
+        : public TestSearch
+    {
+    public:
+        Search(SgSearchHashTable* hash)
+            : TestSearch(hash)
+        { }
+
+        std::unique_ptr<SgSearch> CreateThreadSearch() const
+        {
+            return SgSearch::CreateThreadSearch();
+        }
+    };
+    SgSearchHashTable hashTable(1 << 10);
+    Search search(&hashTable);
+    search.AddNode(TestSearch::NO_NODE, SG_NULLMOVE, 0);
+    search.AddNode(0, 1, 0);
+    search.SetNumberThreads(2);
+    SgVector<SgMove> sequence;
+    BOOST_CHECK_EQUAL(0, search.IteratedSearch(1, 2, &sequence));
+    SgSearchConcurrentHashTable concurrentHashTable(1 << 10);
+    search.SetConcurrentHashTable(&concurrentHashTable);
+    BOOST_CHECK(search.HashTable() == 0);
+    BOOST_CHECK_THROW(search.IteratedSearch(1, 2, &sequence), SgException);
+}
+
 } // namespace
 
 //----------------------------------------------------------------------------
@@ -0,0 +1,111 @@
+//----------------------------------------------------------------------------
+/** @file SgSgfParserTest.cpp
+    Unit tests for SgSgfParser. */
+//----------------------------------------------------------------------------
+
+#include "SgSystem.h"
+
+#include <sstream>
+#include <string>
+#include <boost/test/unit_test.hpp>
+#include "SgSgfParser.h"
+
+using namespace std;
+using SgPointUtil::Pt;
+
+//----------------------------------------------------------------------------
+
+namespace {
+
+/** Records the events as text. */
+class RecordingHandler
+    : public SgSgfHandler
+{
+public:
+    ostringstream m_out;
+
+    vector<SgPoint> m_moves;
+
+    void StartGame()
+    {
+        m_out << "(";
+    }
+
+    void EndGame()
+    {
+        m_out << ")";
+    }
+
+    void StartVariation()
+    {
+        m_out << "(";
+    }
+
+    void EndVariation()
+    {
+        m_out << ")";
+    }
+
+    void StartNode()
+    {
+        m_out << ";";
+    }
+
+    void Property(string_view label, const vector<string_view>& values)
+    {
+        m_out << label;
+        for (size_t i = 0; i < values.size(); ++i)
+            m_out << '[' << values[i] << ']';
+    }
+
+    void Move(SgBlackWhite color, SgPoint move)
+    {
+        SG_UNUSED(color);
+        m_moves.push_back(move);
+    }
+};
+
+BOOST_AUTO_TEST_CASE(SgSgfParserTest_Events)
+{
+    string data = "junk (;FF[4] SZ[9]\n;B[ee] ;W[tt](;B[aa])(;B[ii]C[a\\]b\\\\])"
+                  ")\n(;AB[aa]\n [bb])";
+    SgSgfParser parser(data);
+    RecordingHandler handler;
+    BOOST_CHECK_EQUAL(parser.ParseGames(handler), 2u);
+    BOOST_CHECK_EQUAL(handler.m_out.str(),
+                      "(;FF[4]SZ[9];B[ee];W[tt](;B[aa])(;B[ii]C[a\\]b\\\\]))"
+                      "(;AB[aa][bb])");
+    BOOST_REQUIRE_EQUAL(handler.m_moves.size(), 4u);
+    BOOST_CHECK_EQUAL(handler.m_moves[0], Pt(5, 5));
+    BOOST_CHECK_EQUAL(handler.m_moves[1], SG_PASS);
+    BOOST_CHECK_EQUAL(handler.m_moves[2], Pt(1, 9));
+    BOOST_CHECK_EQUAL(handler.m_moves[3], Pt(9, 1));
+    BOOST_CHECK(! parser.ParseGame(handler));
+}
+
+/** Test that moves are converted with the board size of the node, even if
+    SZ comes after the move. */
+BOOST_AUTO_TEST_CASE(SgSgfParserTest_SizeAfterMove)
+{
+    string data = "(;B[aa]SZ[9])";
+    SgSgfParser parser(data);
+    RecordingHandler handler;
+    BOOST_CHECK(parser.ParseGame(handler));
+    BOOST_REQUIRE_EQUAL(handler.m_moves.size(), 1u);
+    BOOST_CHECK_EQUAL(handler.m_moves[0], Pt(1, 9));
+}
+
+/** Test that an unterminated game and value do not read past the end. */
+BOOST_AUTO_TEST_CASE(SgSgfParserTest_Unterminated)
+{
+    string data = "(;B[aa";
+    SgSgfParser parser(data);
+    RecordingHandler handler;
+    BOOST_CHECK(parser.ParseGame(handler));
+    BOOST_CHECK_EQUAL(handler.m_out.str(), "(;B[aa])");
+    BOOST_CHECK(! parser.ParseGame(handler));
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------
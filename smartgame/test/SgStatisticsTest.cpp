@@ -7,7 +7,10 @@
 
 #include <boost/test/unit_test.hpp>
 #include <boost/test/tools/floating_point_comparison.hpp>
+#include <thread>
+#include <vector>
 #include "SgStatistics.h"
+#include "SgStatisticsPacked.h"
 
 using namespace std;
 
@@ -71,6 +74,48 @@ BOOST_AUTO_TEST_CASE(SgStatisticsBaseTest_CheckRemove)
 
 //----------------------------------------------------------------------------
 
+BOOST_AUTO_TEST_CASE(SgStatisticsPackedTest_AddRemove)
+{
+    SgStatisticsPackedBase<double,double> stat;
+    BOOST_CHECK(! stat.IsDefined());
+    stat.Add(0.0, 1);
+    stat.Add(1.0, 2);
+    stat.Add(0.5, 4);
+    BOOST_CHECK_CLOSE(stat.Count(), 7.0, 0.001);
+    BOOST_CHECK_CLOSE(stat.Mean(), 4.0 / 7.0, 0.001);
+    stat.Remove(1.5, 2);
+    BOOST_CHECK_CLOSE(stat.Count(), 5.0, 0.001);
+    BOOST_CHECK_CLOSE(stat.Mean(), 1.0 / 5.0, 0.001);
+    double mean;
+    double count;
+    stat.Get(mean, count);
+    BOOST_CHECK_CLOSE(count, 5.0, 0.001);
+    BOOST_CHECK_CLOSE(mean, 1.0 / 5.0, 0.001);
+    stat.Remove(0.2, 5);
+    BOOST_CHECK(! stat.IsDefined());
+}
+
+/** Test that concurrent updates are not lost. */
+BOOST_AUTO_TEST_CASE(SgStatisticsPackedTest_Concurrent)
+{
+    const int NU_THREADS = 4;
+    const int NU_UPDATES = 20000;
+    SgStatisticsPackedBase<double,double> stat;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < NU_THREADS; ++i)
+        threads.emplace_back([&stat]()
+        {
+            for (int j = 0; j < NU_UPDATES; ++j)
+                stat.Add(j % 2);
+        });
+    for (int i = 0; i < NU_THREADS; ++i)
+        threads[i].join();
+    BOOST_CHECK_EQUAL(stat.Count(), double(NU_THREADS * NU_UPDATES));
+    BOOST_CHECK_CLOSE(stat.Mean(), 0.5, 0.1);
+}
+
+//----------------------------------------------------------------------------
+
 BOOST_AUTO_TEST_CASE(SgStatisticsTest_Basics)
 {
     typedef SgStatistics<double,std::size_t> Statistics;
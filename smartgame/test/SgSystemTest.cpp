@@ -29,6 +29,27 @@ BOOST_AUTO_TEST_CASE(SgSystemTestGccBitSetBug)
     BOOST_CHECK(set1.test(0));
 }
 
+/** Test that SgUserAbortScope uses its own flag instead of the global one
+    and restores the previous flag. */
+BOOST_AUTO_TEST_CASE(SgSystemTest_UserAbortScope)
+{
+    SgSetUserAbort(false);
+    volatile bool flag = false;
+    {
+        SgUserAbortScope scope(&flag);
+        BOOST_CHECK(SgThreadUserAbortFlag() == &flag);
+        SgSetUserAbort(true);
+        BOOST_CHECK(flag);
+        BOOST_CHECK(SgUserAbort());
+    }
+    BOOST_CHECK(SgThreadUserAbortFlag() == 0);
+    BOOST_CHECK(! SgUserAbort());
+    flag = false;
+    SgSetUserAbort(true);
+    BOOST_CHECK(! flag);
+    SgSetUserAbort(false);
+}
+
 } // namespace
 
 //----------------------------------------------------------------------------
@@ -0,0 +1,116 @@
+//----------------------------------------------------------------------------
+/** @file SgThreadPoolTest.cpp
+    Unit tests for SgThreadPool. */
+//----------------------------------------------------------------------------
+
+#include "SgSystem.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include "SgThreadPool.h"
+
+using namespace std;
+
+//----------------------------------------------------------------------------
+
+namespace {
+
+BOOST_AUTO_TEST_CASE(SgThreadPoolTest_RunOnAll)
+{
+    SgThreadPool pool;
+    pool.SetNumberThreads(4);
+    BOOST_CHECK_EQUAL(pool.NuThreads(), 4u);
+    for (int i = 0; i < 100; ++i)
+    {
+        vector<int> count(4, 0);
+        pool.RunOnAll([&count](size_t threadIndex)
+        {
+            ++count[threadIndex];
+        });
+        for (size_t j = 0; j < 4; ++j)
+            BOOST_CHECK_EQUAL(count[j], 1);
+    }
+}
+
+/** Test that the functions of RunOnAll() run concurrently.
+    Each call waits until all others have started. */
+BOOST_AUTO_TEST_CASE(SgThreadPoolTest_RunOnAllConcurrent)
+{
+    SgThreadPool pool;
+    pool.SetNumberThreads(3);
+    atomic<int> nuStarted(0);
+    pool.RunOnAll([&nuStarted](size_t)
+    {
+        ++nuStarted;
+        while (nuStarted.load() < 3)
+            ;
+    });
+    BOOST_CHECK_EQUAL(nuStarted.load(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(SgThreadPoolTest_SetNumberThreads)
+{
+    SgThreadPool pool;
+    BOOST_CHECK_EQUAL(pool.NuThreads(), 1u);
+    pool.SetNumberThreads(3);
+    BOOST_CHECK_EQUAL(pool.NuThreads(), 3u);
+    pool.SetNumberThreads(2);
+    BOOST_CHECK_EQUAL(pool.NuThreads(), 2u);
+    atomic<int> sum(0);
+    pool.RunOnAll([&sum](size_t threadIndex)
+    {
+        sum += int(threadIndex) + 1;
+    });
+    BOOST_CHECK_EQUAL(sum.load(), 3);
+}
+
+/** Test that an exception thrown in a worker thread is passed on to the
+    caller of RunOnAll() and that the pool can be used again afterwards. */
+BOOST_AUTO_TEST_CASE(SgThreadPoolTest_RunOnAllException)
+{
+    SgThreadPool pool;
+    pool.SetNumberThreads(4);
+    atomic<int> count(0);
+    BOOST_CHECK_THROW(pool.RunOnAll([&count](size_t threadIndex)
+                      {
+                          ++count;
+                          if (threadIndex == 2)
+                              throw runtime_error("worker");
+                      }),
+                      runtime_error);
+    BOOST_CHECK_EQUAL(count.load(), 4);
+    count = 0;
+    pool.RunOnAll([&count](size_t) { ++count; });
+    BOOST_CHECK_EQUAL(count.load(), 4);
+}
+
+/** Test that RunOnAll() uses the user abort flag of the calling thread. */
+BOOST_AUTO_TEST_CASE(SgThreadPoolTest_UserAbortFlag)
+{
+    SgThreadPool pool;
+    pool.SetNumberThreads(4);
+    volatile bool flag = true;
+    vector<int> aborted(4, 0);
+    {
+        SgUserAbortScope scope(&flag);
+        pool.RunOnAll([&aborted](size_t threadIndex)
+        {
+            aborted[threadIndex] = (SgUserAbort() ? 1 : 0);
+        });
+    }
+    for (size_t i = 0; i < 4; ++i)
+        BOOST_CHECK_EQUAL(aborted[i], 1);
+    // Without a flag in the calling thread, the workers use the global flag
+    pool.RunOnAll([&aborted](size_t threadIndex)
+    {
+        aborted[threadIndex] = (SgThreadUserAbortFlag() != 0 ? 1 : 0);
+    });
+    for (size_t i = 0; i < 4; ++i)
+        BOOST_CHECK_EQUAL(aborted[i], 0);
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------
@@ -0,0 +1,97 @@
+//----------------------------------------------------------------------------
+/** @file SgUctPhaseStatisticsTest.cpp
+    Unit tests for SgUctPhaseStatistics. */
+//----------------------------------------------------------------------------
+
+#include "SgSystem.h"
+
+#include <sstream>
+#include <boost/test/unit_test.hpp>
+#include "SgUctPhaseStatistics.h"
+
+using namespace std;
+using std::chrono::nanoseconds;
+
+//----------------------------------------------------------------------------
+
+namespace {
+
+BOOST_AUTO_TEST_CASE(SgUctPhaseHistogramTest_Add)
+{
+    SgUctPhaseHistogram histogram;
+    BOOST_CHECK_EQUAL(histogram.Count(), 0u);
+    BOOST_CHECK_EQUAL(histogram.Percentile(0.5), 0u);
+    histogram.Add(nanoseconds(0));
+    histogram.Add(nanoseconds(1));
+    histogram.Add(nanoseconds(5));
+    histogram.Add(nanoseconds(7));
+    BOOST_CHECK_EQUAL(histogram.Count(), 4u);
+    BOOST_CHECK_EQUAL(histogram.Total(), 13u);
+    BOOST_CHECK_CLOSE(histogram.Mean(), 3.25, 1e-10);
+    BOOST_CHECK_EQUAL(histogram.BinCount(0), 1u);
+    BOOST_CHECK_EQUAL(histogram.BinCount(1), 1u);
+    BOOST_CHECK_EQUAL(histogram.BinCount(3), 2u);
+    BOOST_CHECK_EQUAL(histogram.Percentile(0.25), 1u);
+    BOOST_CHECK_EQUAL(histogram.Percentile(0.5), 2u);
+    BOOST_CHECK_EQUAL(histogram.Percentile(1), 8u);
+    // Durations longer than the range go to the last bin
+    histogram.Add(nanoseconds(std::uint64_t(1) << 50));
+    BOOST_CHECK_EQUAL(
+           histogram.BinCount(SgUctPhaseHistogram::NU_BINS - 1), 1u);
+    histogram.Clear();
+    BOOST_CHECK_EQUAL(histogram.Count(), 0u);
+    BOOST_CHECK_EQUAL(histogram.BinCount(3), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(SgUctPhaseStatisticsTest_Merge)
+{
+    SgUctPhaseStatistics statistics1;
+    statistics1.Add(SG_UCTPHASE_PLAYOUT, nanoseconds(100));
+    SgUctPhaseStatistics statistics2;
+    statistics2.Add(SG_UCTPHASE_PLAYOUT, nanoseconds(300));
+    statistics2.Add(SG_UCTPHASE_BACKUP, nanoseconds(10));
+    statistics1.Merge(statistics2);
+    const SgUctPhaseHistogram& playout =
+        statistics1.Histogram(SG_UCTPHASE_PLAYOUT);
+    BOOST_CHECK_EQUAL(playout.Count(), 2u);
+    BOOST_CHECK_EQUAL(playout.Total(), 400u);
+    BOOST_CHECK_EQUAL(statistics1.Histogram(SG_UCTPHASE_BACKUP).Count(), 1u);
+    BOOST_CHECK_EQUAL(statistics1.Histogram(SG_UCTPHASE_INTREE).Count(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(SgUctPhaseStatisticsTest_WriteRaw)
+{
+    SgUctPhaseStatistics statistics;
+    statistics.Add(SG_UCTPHASE_INTREE, nanoseconds(3));
+    ostringstream out;
+    statistics.WriteRaw(out, "search0");
+    istringstream in(out.str());
+    string line;
+    BOOST_REQUIRE(getline(in, line));
+    istringstream lineIn(line);
+    string label;
+    string phase;
+    std::uint64_t count;
+    std::uint64_t total;
+    lineIn >> label >> phase >> count >> total;
+    BOOST_CHECK_EQUAL(label, "search0");
+    BOOST_CHECK_EQUAL(phase, "intree");
+    BOOST_CHECK_EQUAL(count, 1u);
+    BOOST_CHECK_EQUAL(total, 3u);
+    int nuBins = 0;
+    std::uint64_t binCount;
+    while (lineIn >> binCount)
+    {
+        BOOST_CHECK_EQUAL(binCount, nuBins == 2 ? 1u : 0u);
+        ++nuBins;
+    }
+    BOOST_CHECK_EQUAL(nuBins, SgUctPhaseHistogram::NU_BINS);
+    int nuLines = 1;
+    while (getline(in, line))
+        ++nuLines;
+    BOOST_CHECK_EQUAL(nuLines, SG_UCTPHASE_NU);
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------
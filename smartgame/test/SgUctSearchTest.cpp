@@ -5,10 +5,17 @@
 
 #include "SgSystem.h"
 
+#include <chrono>
+#include <cstdint>
+#include <limits>
 #include <sstream>
+#include <thread>
 #include <vector>
 #include <boost/test/unit_test.hpp>
 #include <boost/test/tools/floating_point_comparison.hpp>
+#ifdef __linux__
+#include <sched.h>
+#endif
 #include "SgDebug.h"
 #include "SgUctSearch.h"
 #include "SgUctTreeUtil.h"
@@ -63,6 +70,10 @@ struct TestNode
     float m_eval;
 
     bool m_isLeaf;
+
+    /** Key of the position of the node for SgUctThreadState::PositionHash().
+        Unique for each node, unless set with TestUctSearch::SetPosition(). */
+    uint64_t m_position;
 };
 
 //----------------------------------------------------------------------------
@@ -86,6 +97,8 @@ public:
 
     void ExecutePlayout(SgMove move);
 
+    uint64_t PositionHash() const;
+
     bool GenerateAllMoves(SgUctValue count, vector<SgUctMoveInfo>& moves,
                           SgUctProvenType& provenType);
 
@@ -215,6 +228,11 @@ inline const TestNode& TestThreadState::Node(size_t index) const
     return m_nodes[index];
 }
 
+uint64_t TestThreadState::PositionHash() const
+{
+    return CurrentNode().m_position;
+}
+
 void TestThreadState::StartSearch()
 { }
 
@@ -294,6 +312,9 @@ public:
         @param father Index of father node, NO_NODE if root node. */
     void AddNode(size_t father, SgMove move);
 
+    /** Give a node the position of another node (a transposition). */
+    void SetPosition(size_t node, size_t positionNode);
+
     // @} // @name
 
     /** @name Virtual functions of SgUctSearch */
@@ -356,9 +377,17 @@ void TestUctSearch::AddNode(size_t father, SgMove move, bool isLeaf,
     node.m_move = move;
     node.m_eval = eval;
     node.m_isLeaf = isLeaf;
+    node.m_position = index + 1;
     m_nodes.push_back(node);
 }
 
+void TestUctSearch::SetPosition(size_t node, size_t positionNode)
+{
+    SG_ASSERT(node < m_nodes.size());
+    SG_ASSERT(positionNode < m_nodes.size());
+    m_nodes[node].m_position = m_nodes[positionNode].m_position;
+}
+
 string TestUctSearch::MoveString(SgMove move) const
 {
     ostringstream buffer;
@@ -638,6 +667,249 @@ BOOST_AUTO_TEST_CASE(SgUctSearchTest_Knowledge)
 
 //----------------------------------------------------------------------------
 
+/** Search the test tree of SgUctSearchTest_Simple with deferred expansion.
+    The search thread queues the nodes to expand and an expand thread adds
+    the children. Checks that the tree is built and the root is proven; the
+    exact sequence of games depends on the thread timing. */
+BOOST_AUTO_TEST_CASE(SgUctSearchTest_ExpandThreads)
+{
+    TestUctSearch search;
+    search.SetExpandThreshold(1);
+    search.SetNumberExpandThreads(1);
+    search.SetExpandBatchSize(2);
+    search.SetMaxNodes(1000);
+    search.SetMoveSelect(SG_UCTMOVESELECT_VALUE);
+
+    search.AddNode(NO_NODE, SG_NULLMOVE);
+    search.AddNode(0, 1);
+    search.AddNode(0, 2);
+    search.AddNode(0, 3);
+    search.AddNode(0, 4);
+    search.AddLeafNode(1, 5, 0.f);
+    search.AddLeafNode(1, 6, 1.f);
+    search.AddLeafNode(2, 7, 1.f);
+    search.AddLeafNode(2, 8, 1.f);
+    search.AddLeafNode(3, 9, 1.f);
+    search.AddLeafNode(3, 10, 0.f);
+    search.AddLeafNode(4, 11, 0.f);
+    search.AddLeafNode(4, 12, 0.f);
+
+    vector<SgMove> sequence;
+    search.Search(100000, numeric_limits<double>::max(), sequence);
+    const SgUctTree& tree = search.Tree();
+    BOOST_CHECK_EQUAL(4, tree.Root().NuChildren());
+    BOOST_CHECK_EQUAL(SG_PROVEN_WIN, tree.Root().ProvenType());
+    BOOST_REQUIRE(! sequence.empty());
+    BOOST_CHECK_EQUAL(2, sequence[0]);
+    BOOST_CHECK(GetNode(tree, 2)->HasChildren());
+}
+
+/** Test that the chunks of the previous search tree are returned to the node
+    pool, when a search starts from a tree extracted with
+    SgUctTree::ExtractSubtree(). */
+BOOST_AUTO_TEST_CASE(SgUctSearchTest_InitTreeChunks)
+{
+    TestUctSearch search;
+    search.SetExpandThreshold(1);
+    search.SetMaxNodes(1000);
+
+    search.AddNode(NO_NODE, SG_NULLMOVE);
+    search.AddNode(0, 1);
+    search.AddNode(0, 2);
+    search.AddLeafNode(1, 3, 0.f);
+    search.AddLeafNode(1, 4, 1.f);
+    search.AddLeafNode(2, 5, 1.f);
+    search.AddLeafNode(2, 6, 1.f);
+
+    vector<SgMove> sequence;
+    search.Search(100, numeric_limits<double>::max(), sequence);
+    BOOST_REQUIRE(search.Tree().NuUsedChunks() > 0);
+    SgUctTree& initTree = search.GetTempTree();
+    search.Tree().ExtractSubtree(initTree, search.Tree().Root(), false);
+    const size_t nuNodes = initTree.NuNodes();
+    BOOST_REQUIRE(nuNodes > 1);
+    search.Search(100, numeric_limits<double>::max(), sequence,
+                  vector<SgMove>(), &initTree);
+    BOOST_CHECK(search.Tree().NuNodes() >= nuNodes);
+    BOOST_CHECK_EQUAL(initTree.NuNodes(), 1u);
+    BOOST_CHECK_EQUAL(initTree.NuUsedChunks(), 0u);
+}
+
+/** Test that the analysis callback receives the final line of a search
+    with AnalyzeInterval() zero, and that the line contains the move with
+    the most visits. */
+BOOST_AUTO_TEST_CASE(SgUctSearchTest_AnalyzeCallback)
+{
+    TestUctSearch search;
+    search.SetMaxNodes(1000);
+    search.SetAnalyzeInterval(0);
+    search.SetAnalyzeMoves(1);
+    vector<string> lines;
+    search.SetAnalyzeCallback([&lines](const string& line)
+                              {
+                                  lines.push_back(line);
+                              });
+
+    search.AddNode(NO_NODE, SG_NULLMOVE);
+    search.AddNode(0, 1);
+    search.AddNode(0, 2);
+    search.AddLeafNode(1, 3, 0.f);
+    search.AddLeafNode(1, 4, 1.f);
+    search.AddLeafNode(2, 5, 1.f);
+    search.AddLeafNode(2, 6, 1.f);
+
+    vector<SgMove> sequence;
+    search.Search(1000, numeric_limits<double>::max(), sequence);
+    BOOST_REQUIRE_EQUAL(1u, lines.size());
+    BOOST_CHECK_EQUAL(0u, lines[0].find("playouts "));
+    BOOST_CHECK(lines[0].find(" info move 2 visits ") != string::npos);
+    BOOST_CHECK(lines[0].find(" winrate 10000 order 0 pv 2")
+                != string::npos);
+    BOOST_CHECK(lines[0].find("move 1 ") == string::npos);
+}
+
+/** Test that the other threads of a search that is not lock-free continue
+    to play games while the analysis callback runs. */
+BOOST_AUTO_TEST_CASE(SgUctSearchTest_AnalyzeCallbackUnlocked)
+{
+    TestUctSearch search;
+    search.SetNumberThreads(2);
+    search.SetLockFree(false);
+    search.SetMaxNodes(1000);
+    search.SetAnalyzeInterval(0.001);
+    bool isChecked = false;
+    bool isOtherThreadRunning = false;
+    search.SetAnalyzeCallback([&](const string&)
+                              {
+                                  if (isChecked)
+                                      return;
+                                  isChecked = true;
+                                  const SgUctValue games =
+                                      search.GamesPlayed();
+                                  for (int i = 0; i < 5000; ++i)
+                                  {
+                                      if (search.GamesPlayed() > games)
+                                      {
+                                          isOtherThreadRunning = true;
+                                          break;
+                                      }
+                                      this_thread::sleep_for(
+                                          chrono::milliseconds(1));
+                                  }
+                              });
+
+    search.AddNode(NO_NODE, SG_NULLMOVE);
+    search.AddNode(0, 1);
+    search.AddNode(0, 2);
+    // Values that do not prove the root, which would end the search
+    search.AddLeafNode(1, 3, 0.5f);
+    search.AddLeafNode(1, 4, 0.5f);
+    search.AddLeafNode(2, 5, 0.5f);
+    search.AddLeafNode(2, 6, 0.5f);
+
+    vector<SgMove> sequence;
+    search.Search(1000000000, 1, sequence);
+    BOOST_REQUIRE(isChecked);
+    BOOST_CHECK(isOtherThreadRunning);
+}
+
+/** Test that a search with threads bound to CPUs works and reports the
+    games per second of each thread.
+    Switching back to SG_UCTTHREADAFFINITY_NONE must unbind the threads.
+    On Linux, also checks that the thread calling Search() can run on the
+    same CPUs after the search as before. */
+BOOST_AUTO_TEST_CASE(SgUctSearchTest_ThreadAffinity)
+{
+#ifdef __linux__
+    cpu_set_t cpuSet;
+    BOOST_REQUIRE_EQUAL(0, sched_getaffinity(0, sizeof(cpuSet), &cpuSet));
+    const int nuCpus = CPU_COUNT(&cpuSet);
+#endif
+    TestUctSearch search;
+    search.SetNumberThreads(2);
+    search.SetLockFree(false);
+    search.SetThreadAffinity(SG_UCTTHREADAFFINITY_SCATTER);
+    search.SetMaxNodes(1000);
+
+    search.AddNode(NO_NODE, SG_NULLMOVE);
+    search.AddNode(0, 1);
+    search.AddNode(0, 2);
+    search.AddLeafNode(1, 3, 0.f);
+    search.AddLeafNode(1, 4, 1.f);
+    search.AddLeafNode(2, 5, 1.f);
+    search.AddLeafNode(2, 6, 1.f);
+
+    for (int i = 0; i < 2; ++i)
+    {
+        vector<SgMove> sequence;
+        search.Search(1000, numeric_limits<double>::max(), sequence);
+        BOOST_REQUIRE(! sequence.empty());
+        BOOST_CHECK_EQUAL(2, sequence[0]);
+        BOOST_CHECK_EQUAL(2u,
+                       search.Statistics().m_threadGamesPerSecond.size());
+#ifdef __linux__
+        BOOST_REQUIRE_EQUAL(0, sched_getaffinity(0, sizeof(cpuSet), &cpuSet));
+        BOOST_CHECK_EQUAL(nuCpus, CPU_COUNT(&cpuSet));
+#endif
+        search.SetThreadAffinity(SG_UCTTHREADAFFINITY_NONE);
+    }
+}
+
+/** Search a test tree with a transposition.
+    @verbatim
+    Numbers are node indices; L = Loss, W = Win for player at root
+    Nodes 3 and 5 have the same position.
+    0--1--3--7  W
+    |  |  \--8  W
+    |  \--4     W
+    \--2--5--9  W
+       |  \--10 W
+       \--6     L
+    @endverbatim
+    Both paths to the transposition must find the entry of the position,
+    and the transposition table must not change the result of the
+    search. */
+BOOST_AUTO_TEST_CASE(SgUctSearchTest_TranspositionTable)
+{
+    TestUctSearch search;
+    search.SetExpandThreshold(1);
+    search.SetMaxNodes(1000);
+    search.SetTranspositionTableSize(64);
+
+    search.AddNode(NO_NODE, SG_NULLMOVE);
+    search.AddNode(0, 1);
+    search.AddNode(0, 2);
+    search.AddNode(1, 3);
+    search.AddLeafNode(1, 4, 1.f);
+    search.AddNode(2, 5);
+    search.AddLeafNode(2, 6, 0.f);
+    search.AddLeafNode(3, 7, 1.f);
+    search.AddLeafNode(3, 8, 1.f);
+    search.AddLeafNode(5, 9, 1.f);
+    search.AddLeafNode(5, 10, 1.f);
+    search.SetPosition(5, 3);
+
+    vector<SgMove> sequence;
+    search.Search(1000, numeric_limits<double>::max(), sequence);
+    BOOST_REQUIRE(! sequence.empty());
+    BOOST_CHECK_EQUAL(1, sequence[0]);
+    BOOST_REQUIRE(search.TranspositionTable() != 0);
+    // At most all nodes except the root and one of the nodes 3 and 5
+    BOOST_CHECK(search.TranspositionTable()->NuEntries() <= 9);
+    const SgUctTranspositionStatistics statistics =
+        search.TranspositionStatistics();
+    BOOST_CHECK(statistics.m_nuHits > 0);
+    BOOST_CHECK_EQUAL(1u, statistics.m_nuSharedPositions);
+    BOOST_CHECK_EQUAL(0u, statistics.m_nuFull);
+
+    search.SetTranspositionTableSize(0);
+    search.Search(1000, numeric_limits<double>::max(), sequence);
+    BOOST_CHECK(search.TranspositionTable() == 0);
+    BOOST_CHECK_EQUAL(0u, search.TranspositionStatistics().m_nuLookups);
+}
+
+//----------------------------------------------------------------------------
+
 } // namespace
 
 //----------------------------------------------------------------------------
@@ -0,0 +1,65 @@
+//----------------------------------------------------------------------------
+/** @file SgUctTranspositionTableTest.cpp
+    Unit tests for SgUctTranspositionTable. */
+//----------------------------------------------------------------------------
+
+#include "SgSystem.h"
+
+#include <boost/test/unit_test.hpp>
+#include "SgUctTranspositionTable.h"
+#include "SgUctTree.h"
+
+using namespace std;
+
+//----------------------------------------------------------------------------
+
+namespace {
+
+BOOST_AUTO_TEST_CASE(SgUctTranspositionTableTest_Size)
+{
+    SgUctTranspositionTable table(100);
+    BOOST_CHECK_EQUAL(128u, table.MaxEntries());
+    BOOST_CHECK_EQUAL(0u, table.NuEntries());
+}
+
+/** Test that a lookup of the same position returns the same entry and
+    counts a hit only for another node. */
+BOOST_AUTO_TEST_CASE(SgUctTranspositionTableTest_Lookup)
+{
+    SgUctTranspositionTable table(16);
+    SgUctTranspositionStatistics statistics;
+    SgUctNode node1(SgUctMoveInfo(1));
+    SgUctNode node2(SgUctMoveInfo(2));
+    SgUctTranspositionEntry* entry = table.Lookup(42, node1, statistics);
+    BOOST_REQUIRE(entry != 0);
+    BOOST_CHECK_EQUAL(&node1, entry->m_node.load());
+    BOOST_CHECK_EQUAL(entry, table.Lookup(42, node1, statistics));
+    BOOST_CHECK_EQUAL(0u, statistics.m_nuHits);
+    BOOST_CHECK_EQUAL(entry, table.Lookup(42, node2, statistics));
+    BOOST_CHECK_EQUAL(entry, table.Lookup(42, node2, statistics));
+    BOOST_CHECK_EQUAL(&node1, entry->m_node.load());
+    BOOST_CHECK_EQUAL(4u, statistics.m_nuLookups);
+    BOOST_CHECK_EQUAL(2u, statistics.m_nuHits);
+    BOOST_CHECK_EQUAL(1u, statistics.m_nuSharedPositions);
+    BOOST_CHECK(entry != table.Lookup(43, node2, statistics));
+    BOOST_CHECK_EQUAL(2u, table.NuEntries());
+    table.Clear();
+    BOOST_CHECK_EQUAL(0u, table.NuEntries());
+}
+
+/** Test that a lookup returns null, if all probed entries are used. */
+BOOST_AUTO_TEST_CASE(SgUctTranspositionTableTest_Full)
+{
+    SgUctTranspositionTable table(SgUctTranspositionTable::MAX_PROBES);
+    SgUctTranspositionStatistics statistics;
+    SgUctNode node(SgUctMoveInfo(1));
+    for (uint64_t key = 1; key <= SgUctTranspositionTable::MAX_PROBES; ++key)
+        BOOST_CHECK(table.Lookup(key, node, statistics) != 0);
+    BOOST_CHECK_EQUAL(0u, statistics.m_nuFull);
+    BOOST_CHECK(table.Lookup(1000, node, statistics) == 0);
+    BOOST_CHECK_EQUAL(1u, statistics.m_nuFull);
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------
@@ -108,6 +108,87 @@ BOOST_AUTO_TEST_CASE(SgUctTreeIteratorTest_ApplyFilter)
     BOOST_CHECK_CLOSE((*it).Mean(), SgUctValue(0.5), 1e-4);
 }
 
+/** Test that allocators share the chunks of the node pool.
+    With two allocators, one allocator can use more than half of the maximum
+    number of nodes, and the chunks are reused after SgUctTree::Clear(). */
+BOOST_AUTO_TEST_CASE(SgUctTreeTest_SharedNodePool)
+{
+    SgUctTree tree;
+    tree.CreateAllocators(2);
+    tree.SetMaxNodes(20);
+    BOOST_CHECK_EQUAL(tree.MaxChunks(), 2u);
+    vector<SgUctMoveInfo> moves;
+    for (int i = 1; i <= 5; ++i)
+        moves.push_back(SgUctMoveInfo(10 * i));
+    const SgUctNode& root = tree.Root();
+    BOOST_REQUIRE(tree.HasCapacity(0, moves.size()));
+    tree.CreateChildren(0, root, moves);
+    for (int i = 0; i < 3; ++i)
+    {
+        const SgUctNode& child = *FindChildWithMove(tree, root, 10 * (i + 1));
+        BOOST_REQUIRE(tree.HasCapacity(0, moves.size()));
+        tree.CreateChildren(0, child, moves);
+    }
+    BOOST_CHECK_EQUAL(tree.NuNodes(0), 20u);
+    BOOST_CHECK_EQUAL(tree.NuUsedChunks(), 2u);
+    BOOST_CHECK(! tree.HasCapacity(0, 1));
+    BOOST_CHECK(! tree.HasCapacity(1, 1));
+    tree.Clear();
+    BOOST_CHECK_EQUAL(tree.NuUsedChunks(), 0u);
+    BOOST_CHECK(tree.HasCapacity(1, 10));
+    BOOST_CHECK(! tree.HasCapacity(1, 11));
+    BOOST_CHECK_EQUAL(tree.NuUsedChunks(), 0u);
+    BOOST_CHECK(tree.EnsureCapacity(1, 10));
+    BOOST_CHECK(! tree.EnsureCapacity(1, 11));
+    BOOST_CHECK_EQUAL(tree.NuUsedChunks(), 1u);
+}
+
+/** Test that the allocators use the chunks reserved with
+    SgUctTree::Reserve() and that reserving more than the maximum number of
+    nodes reserves only the maximum. */
+BOOST_AUTO_TEST_CASE(SgUctTreeTest_Reserve)
+{
+    SgUctTree tree;
+    tree.CreateAllocators(2);
+    tree.SetMaxNodes(20);
+    BOOST_CHECK(tree.Reserve(1000));
+    BOOST_CHECK_EQUAL(tree.NuUsedChunks(), 0u);
+    BOOST_CHECK(tree.EnsureCapacity(0, 10));
+    BOOST_CHECK(tree.EnsureCapacity(1, 10));
+    BOOST_CHECK_EQUAL(tree.NuUsedChunks(), 2u);
+    tree.Clear();
+    BOOST_CHECK_EQUAL(tree.NuUsedChunks(), 0u);
+}
+
+/** Test SgUctTree::Reroot() */
+BOOST_AUTO_TEST_CASE(SgUctTreeTest_Reroot)
+{
+    SgUctTree tree;
+    tree.CreateAllocators(1);
+    tree.SetMaxNodes(10);
+    vector<SgUctMoveInfo> moves;
+    moves.push_back(SgUctMoveInfo(10));
+    moves.push_back(SgUctMoveInfo(20));
+    const SgUctNode& root = tree.Root();
+    tree.CreateChildren(0, root, moves);
+    const SgUctNode& node2 = *FindChildWithMove(tree, root, 20);
+    moves.clear();
+    moves.push_back(SgUctMoveInfo(30));
+    moves.push_back(SgUctMoveInfo(40));
+    tree.CreateChildren(0, node2, moves);
+    const SgUctNode& node4 = *FindChildWithMove(tree, node2, 40);
+    tree.AddGameResult(node2, &root, 1.f);
+    tree.AddGameResult(node4, &node2, 0.f);
+    tree.Reroot(node2);
+    BOOST_CHECK_EQUAL(root.NuChildren(), 2);
+    BOOST_CHECK_EQUAL(root.MoveCount(), 1u);
+    BOOST_CHECK_EQUAL(root.PosCount(), 1u);
+    BOOST_CHECK_EQUAL(FindChildWithMove(tree, root, 40), &node4);
+    BOOST_CHECK(FindChildWithMove(tree, root, 10) == 0);
+    // Unreachable nodes are only reclaimed by Clear()
+    BOOST_CHECK_EQUAL(tree.NuNodes(), 5u);
+}
+
 } // namespace
 
 //----------------------------------------------------------------------------